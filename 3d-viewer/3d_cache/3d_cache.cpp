@@ -24,7 +24,9 @@
 
 #define GLM_FORCE_RADIANS
 
+#include <future>
 #include <mutex>
+#include <set>
 #include <utility>
 
 #include <wx/datetime.h>
@@ -54,14 +56,17 @@
 #include <project.h>
 #include <settings/common_settings.h>
 #include <settings/settings_manager.h>
+#include <thread_pool.h>
 #include <wx_filename.h>
 
 
 #define MASK_3D_CACHE "3D_CACHE"
 
-static std::mutex mutex3D_cache;
 static std::mutex mutex3D_cacheManager;
 
+// Writing a cache file renumbers the global scene graph node names
+static std::mutex mutex3D_cacheFile;
+
 
 static bool isSHA1Same( const unsigned char* shaA, const unsigned char* shaB ) noexcept
 {
@@ -130,10 +135,13 @@ public:
     const wxString GetCacheBaseName();
 
     wxDateTime    modTime;      // file modification time
+    wxULongLong   fileSize;     // file size, checked with modTime before hashing the file
     unsigned char sha1sum[20];
     std::string   pluginInfo;   // PluginName:Version string
     SCENEGRAPH*   sceneData;
     S3DMODEL*     renderData;
+    bool          initialized;  // the model was looked up once, whether it loaded or not
+    std::mutex    mutex;        // held while the entry is loaded or checked
 
 private:
     // prohibit assignment and default copy constructor
@@ -148,6 +156,7 @@ S3D_CACHE_ENTRY::S3D_CACHE_ENTRY()
 {
     sceneData = nullptr;
     renderData = nullptr;
+    initialized = false;
     memset( sha1sum, 0, 20 );
 }
 
@@ -228,58 +237,76 @@ SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, const wxString& aBasePa
         return nullptr;
     }
 
+    S3D_CACHE_ENTRY* ep = nullptr;
+
     // check cache if file is already loaded
-    std::lock_guard<std::mutex> lock( mutex3D_cache );
+    {
+        std::lock_guard<std::mutex> lock( m_CacheMutex );
 
-    std::map< wxString, S3D_CACHE_ENTRY*, rsort_wxString >::iterator mi;
-    mi = m_CacheMap.find( full3Dpath );
+        std::map< wxString, S3D_CACHE_ENTRY*, rsort_wxString >::iterator mi;
+        mi = m_CacheMap.find( full3Dpath );
 
-    if( mi != m_CacheMap.end() )
-    {
-        wxFileName fname( full3Dpath );
+        if( mi != m_CacheMap.end() )
+        {
+            ep = mi->second;
+        }
+        else
+        {
+            ep = new S3D_CACHE_ENTRY;
+            m_CacheList.push_back( ep );
+            m_CacheMap.emplace( full3Dpath, ep );
+        }
+    }
 
-        if( fname.FileExists() )    // Only check if file exists. If not, it will
-        {                           // use the same model in cache.
-            bool       reload = ADVANCED_CFG::GetCfg().m_Skip3DModelMemoryCache;
-            wxDateTime fmdate = fname.GetModificationTime();
+    if( nullptr != aCachePtr )
+        *aCachePtr = ep;
 
-            if( fmdate != mi->second->modTime )
-            {
-                unsigned char hashSum[20];
-                getSHA1( full3Dpath, hashSum );
-                mi->second->modTime = fmdate;
+    // Only the entry is locked from here, so that other models can load at the same time
+    std::lock_guard<std::mutex> lock( ep->mutex );
 
-                if( !isSHA1Same( hashSum, mi->second->sha1sum ) )
-                {
-                    mi->second->SetSHA1( hashSum );
-                    reload = true;
-                }
-            }
+    // a new entry: search for a cache file of the model
+    if( !ep->initialized )
+        return checkCache( full3Dpath, ep );
 
-            if( reload )
-            {
-                if( nullptr != mi->second->sceneData )
-                {
-                    S3D::DestroyNode( mi->second->sceneData );
-                    mi->second->sceneData = nullptr;
-                }
+    wxFileName fname( full3Dpath );
 
-                if( nullptr != mi->second->renderData )
-                    S3D::Destroy3DModel( &mi->second->renderData );
+    if( fname.FileExists() )    // Only check if file exists. If not, it will
+    {                           // use the same model in cache.
+        bool        reload = ADVANCED_CFG::GetCfg().m_Skip3DModelMemoryCache;
+        wxDateTime  fmdate = fname.GetModificationTime();
+        wxULongLong fsize = fname.GetSize();
+
+        // Hashing large models is slow: only do it if the file looks modified
+        if( fmdate != ep->modTime || fsize != ep->fileSize )
+        {
+            unsigned char hashSum[20];
+            getSHA1( full3Dpath, hashSum );
+            ep->modTime = fmdate;
+            ep->fileSize = fsize;
 
-                mi->second->sceneData = m_Plugins->Load3DModel( full3Dpath,
-                                                                mi->second->pluginInfo );
+            if( !isSHA1Same( hashSum, ep->sha1sum ) )
+            {
+                ep->SetSHA1( hashSum );
+                reload = true;
             }
         }
 
-        if( nullptr != aCachePtr )
-            *aCachePtr = mi->second;
+        if( reload )
+        {
+            if( nullptr != ep->sceneData )
+            {
+                S3D::DestroyNode( ep->sceneData );
+                ep->sceneData = nullptr;
+            }
+
+            if( nullptr != ep->renderData )
+                S3D::Destroy3DModel( &ep->renderData );
 
-        return mi->second->sceneData;
+            ep->sceneData = m_Plugins->Load3DModel( full3Dpath, ep->pluginInfo );
+        }
     }
 
-    // a cache item does not exist; search the Filename->Cachename map
-    return checkCache( full3Dpath, aCachePtr );
+    return ep->sceneData;
 }
 
 
@@ -289,55 +316,23 @@ SCENEGRAPH* S3D_CACHE::Load( const wxString& aModelFile, const wxString& aBasePa
 }
 
 
-SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr )
+SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY* aCacheItem )
 {
-    if( aCachePtr )
-        *aCachePtr = nullptr;
-
     unsigned char    sha1sum[20];
-    S3D_CACHE_ENTRY* ep = new S3D_CACHE_ENTRY;
-    m_CacheList.push_back( ep );
+    S3D_CACHE_ENTRY* ep = aCacheItem;
     wxFileName fname( aFileName );
     ep->modTime = fname.GetModificationTime();
+    ep->fileSize = fname.GetSize();
+    ep->initialized = true;
 
     if( !getSHA1( aFileName, sha1sum ) || m_CacheDir.empty() )
     {
         // just in case we can't get a hash digest (for example, on access issues)
-        // or we do not have a configured cache file directory, we create an
+        // or we do not have a configured cache file directory, we keep the
         // entry to prevent further attempts at loading the file
-
-        if( m_CacheMap.emplace( aFileName, ep ).second == false )
-        {
-            wxLogTrace( MASK_3D_CACHE,
-                        wxT( "%s:%s:%d\n * [BUG] duplicate entry in map file; key = '%s'" ),
-                        __FILE__, __FUNCTION__, __LINE__, aFileName );
-
-            m_CacheList.pop_back();
-            delete ep;
-        }
-        else
-        {
-            if( aCachePtr )
-                *aCachePtr = ep;
-        }
-
-        return nullptr;
-    }
-
-    if( m_CacheMap.emplace( aFileName, ep ).second == false )
-    {
-        wxLogTrace( MASK_3D_CACHE,
-                    wxT( "%s:%s:%d\n * [BUG] duplicate entry in map file; key = '%s'" ),
-                    __FILE__, __FUNCTION__, __LINE__, aFileName );
-
-        m_CacheList.pop_back();
-        delete ep;
         return nullptr;
     }
 
-    if( aCachePtr )
-        *aCachePtr = ep;
-
     ep->SetSHA1( sha1sum );
 
     wxString bname = ep->GetCacheBaseName();
@@ -501,6 +496,8 @@ bool S3D_CACHE::saveCacheData( S3D_CACHE_ENTRY* aCacheItem )
         }
     }
 
+    std::lock_guard<std::mutex> lock( mutex3D_cacheFile );
+
     return S3D::WriteCache( fname.ToUTF8(), true, (SGNODE*)aCacheItem->sceneData,
                             aCacheItem->pluginInfo.c_str() );
 }
@@ -578,6 +575,8 @@ bool S3D_CACHE::SetProject( PROJECT* aProject )
 
     if( m_FNResolver->SetProject( aProject, &hasChanged ) && hasChanged )
     {
+        std::lock_guard<std::mutex> lock( m_CacheMutex );
+
         m_CacheMap.clear();
 
         std::list< S3D_CACHE_ENTRY* >::iterator sL = m_CacheList.begin();
@@ -618,6 +617,8 @@ std::list< wxString > const* S3D_CACHE::GetFileFilters() const
 
 void S3D_CACHE::FlushCache( bool closePlugins )
 {
+    std::unique_lock<std::mutex> lock( m_CacheMutex );
+
     std::list< S3D_CACHE_ENTRY* >::iterator sCL = m_CacheList.begin();
     std::list< S3D_CACHE_ENTRY* >::iterator eCL = m_CacheList.end();
 
@@ -629,6 +630,7 @@ void S3D_CACHE::FlushCache( bool closePlugins )
 
     m_CacheList.clear();
     m_CacheMap.clear();
+    lock.unlock();
 
     if( closePlugins )
         ClosePlugins();
@@ -659,15 +661,43 @@ S3DMODEL* S3D_CACHE::GetModel( const wxString& aModelFileName, const wxString& a
         return nullptr;
     }
 
+    // The model may have been reloaded by another thread since load() returned
+    std::lock_guard<std::mutex> lock( cp->mutex );
+
     if( cp->renderData )
         return cp->renderData;
 
-    S3DMODEL* mp = S3D::GetModel( sp );
+    if( !cp->sceneData )
+        return nullptr;
+
+    S3DMODEL* mp = S3D::GetModel( cp->sceneData );
     cp->renderData = mp;
 
     return mp;
 }
 
+
+void S3D_CACHE::PreloadModels( const std::vector<std::pair<wxString, wxString>>& aModels )
+{
+    std::set<std::pair<wxString, wxString>> models( aModels.begin(), aModels.end() );
+    std::vector<std::future<void>>          returns;
+    thread_pool&                            tp = GetKiCadThreadPool();
+
+    returns.reserve( models.size() );
+
+    for( const std::pair<wxString, wxString>& model : models )
+    {
+        returns.emplace_back( tp.submit(
+                [this, &model]()
+                {
+                    GetModel( model.first, model.second );
+                } ) );
+    }
+
+    for( const std::future<void>& ret : returns )
+        ret.wait();
+}
+
 void S3D_CACHE::CleanCacheDir( int aNumDaysOld )
 {
     wxDir         dir;
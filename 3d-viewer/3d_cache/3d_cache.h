@@ -34,6 +34,9 @@
 #include "string_utils.h"
 #include <list>
 #include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
 #include "plugins/3dapi/c3dmodel.h"
 #include <project.h>
 #include <wx/string.h>
@@ -127,6 +130,15 @@ public:
      */
     S3DMODEL* GetModel( const wxString& aModelFileName, const wxString& aBasePath );
 
+    /**
+     * Load a list of models in parallel on the thread pool.
+     *
+     * The later calls to GetModel() for these models are then served from the memory cache.
+     *
+     * @param aModels is a list of model file names, each with the base path to resolve it.
+     */
+    void PreloadModels( const std::vector<std::pair<wxString, wxString>>& aModels );
+
     /**
      * Delete up old cache files in cache directory.
      *
@@ -138,16 +150,16 @@ public:
 
 private:
     /**
-     * Find or create cache entry for file name
+     * Fill a new cache entry for file name.
      *
-     * Searches the cache list for the given filename and retrieves the cache data; a cache
-     * entry is created if one does not already exist.
+     * Loads the scene data from the cache file matching the SHA1 of the file if there is one,
+     * otherwise from the model itself.  The entry must be locked by the caller.
      *
-     * @param aFileName  is the file name (full or partial path).
-     * @param aCachePtr is an optional return address for cache entry pointer.
+     * @param aFileName  is the file name (full path).
+     * @param aCacheItem is the entry created for the file name.
      * @return SCENEGRAPH object associated with file name or NULL on error.
      */
-    SCENEGRAPH* checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr = nullptr );
+    SCENEGRAPH* checkCache( const wxString& aFileName, S3D_CACHE_ENTRY* aCacheItem );
 
     /**
      * Calculate the SHA1 hash of the given file.
@@ -173,6 +185,9 @@ private:
     /// mapping of file names to cache names and data
     std::map< wxString, S3D_CACHE_ENTRY*, rsort_wxString > m_CacheMap;
 
+    /// protects m_CacheList and m_CacheMap; the entries have their own lock
+    std::mutex m_CacheMutex;
+
     FILENAME_RESOLVER*  m_FNResolver;
 
     S3D_PLUGIN_MANAGER* m_Plugins;
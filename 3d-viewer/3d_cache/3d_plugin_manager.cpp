@@ -23,6 +23,7 @@
  */
 
 
+#include <cstring>
 #include <utility>
 #include <iostream>
 #include <sstream>
@@ -363,6 +364,20 @@ void S3D_PLUGIN_MANAGER::addExtensionMap( KICAD_PLUGIN_LDR_3D* aPlugin )
 
     int nExt = aPlugin->GetNExtensions();
 
+    // assign the lock of the plugin now, so that Load3DModel() never modifies the map.  The
+    // VRML and IDF plugins set LC_NUMERIC to "C" while they read a model and restore it after.
+    const char* pluginName = aPlugin->GetKicadPluginName();
+
+    if( pluginName && ( !strcmp( pluginName, "PLUGIN_3D_VRML" )
+                        || !strcmp( pluginName, "PLUGIN_3D_IDF" ) ) )
+    {
+        m_PluginLocks[aPlugin] = &m_LocaleLock;
+    }
+    else
+    {
+        m_PluginLocks[aPlugin] = &m_OwnLocks.emplace_back();
+    }
+
     wxLogTrace( MASK_3D_PLUGINMGR, wxT( "%s:%s:%d * [INFO] adding %d extensions" ),
                 __FILE__, __FUNCTION__, __LINE__, nExt );
 
@@ -415,6 +430,8 @@ SCENEGRAPH* S3D_PLUGIN_MANAGER::Load3DModel( const wxString& aFileName, std::str
 
     while( sL != items.second )
     {
+        std::lock_guard<std::mutex> lock( *m_PluginLocks.at( sL->second ) );
+
         if( sL->second->CanRender() )
         {
             SCENEGRAPH* sp = sL->second->Load( aFileName.ToUTF8() );
@@ -32,6 +32,7 @@
 
 #include <map>
 #include <list>
+#include <mutex>
 #include <string>
 #include <wx/string.h>
 
@@ -53,6 +54,13 @@ public:
      */
     std::list< wxString > const* GetFileFilters( void ) const noexcept;
 
+    /**
+     * Load a model with the first plugin able to read it.
+     *
+     * This may be called from several threads; the calls to a given plugin are serialized as
+     * the plugins are not required to be reentrant.  The plugins switching the locale are
+     * serialized together.
+     */
     SCENEGRAPH* Load3DModel( const wxString& aFileName, std::string& aPluginInfo );
 
     /**
@@ -94,6 +102,16 @@ private:
     /// mapping of extensions to available plugins
     std::multimap< const wxString, KICAD_PLUGIN_LDR_3D* > m_ExtMap;
 
+    /// lock of each plugin in m_ExtMap, held while the plugin loads a model
+    std::map< const KICAD_PLUGIN_LDR_3D*, std::mutex* > m_PluginLocks;
+
+    /// locks of the plugins which don't switch the locale, one per plugin
+    std::list< std::mutex > m_OwnLocks;
+
+    /// lock shared by the plugins which switch the process locale while loading a model, so
+    /// that they can't restore each other's locale in the middle of a load
+    std::mutex m_LocaleLock;
+
     /// list of file filters
     std::list< wxString > m_FileFilters;
 };
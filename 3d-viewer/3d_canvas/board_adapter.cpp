@@ -30,6 +30,8 @@
 #include <3d_rendering/raytracing/shapes2D/polygon_2d.h>
 #include <board.h>
 #include <dialogs/dialog_color_picker.h>
+#include <fp_lib_table.h>
+#include <project.h>
 #include <3d_math.h>
 #include "3d_fastmath.h"
 #include <geometry/geometry_utils.h>
@@ -281,6 +283,52 @@ bool BOARD_ADAPTER::IsFootprintShown( FOOTPRINT_ATTR_T aFPAttributes ) const
 }
 
 
+void BOARD_ADAPTER::Preload3dModels() const
+{
+    if( !m_board || !m_3dModelManager )
+        return;
+
+    std::vector<std::pair<wxString, wxString>> models;
+
+    for( const FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        if( footprint->Models().empty()
+                || !IsFootprintShown( (FOOTPRINT_ATTR_T) footprint->GetAttributes() ) )
+        {
+            continue;
+        }
+
+        wxString libraryName = footprint->GetFPID().GetLibNickname();
+        wxString footprintBasePath = wxEmptyString;
+
+        if( m_board->GetProject() )
+        {
+            try
+            {
+                // FindRow() can throw an exception
+                const FP_LIB_TABLE_ROW* fpRow =
+                        m_board->GetProject()->PcbFootprintLibs()->FindRow( libraryName, false );
+
+                if( fpRow )
+                    footprintBasePath = fpRow->GetFullURI( true );
+            }
+            catch( ... )
+            {
+                // Do nothing if the libraryName is not found in lib table
+            }
+        }
+
+        for( const FP_3DMODEL& fp_model : footprint->Models() )
+        {
+            if( fp_model.m_Show && !fp_model.m_Filename.empty() )
+                models.emplace_back( fp_model.m_Filename, footprintBasePath );
+        }
+    }
+
+    m_3dModelManager->PreloadModels( models );
+}
+
+
 int BOARD_ADAPTER::GetHolePlatingThickness() const noexcept
 {
     return m_board ? m_board->GetDesignSettings().GetHolePlatingThickness()
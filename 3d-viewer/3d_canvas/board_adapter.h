@@ -92,6 +92,13 @@ public:
      */
     bool IsFootprintShown( FOOTPRINT_ATTR_T aFPAttributes ) const;
 
+    /**
+     * Load the 3D models of all the shown footprints into the cache manager, in parallel.
+     *
+     * The renderers still get the models one by one from the cache manager afterwards.
+     */
+    void Preload3dModels() const;
+
     /**
      * Set current board to be rendered.
      *
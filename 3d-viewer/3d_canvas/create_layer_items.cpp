@@ -42,11 +42,14 @@
 #include <zone.h>
 #include <convert_basic_shapes_to_polygon.h>
 #include <trigo.h>
+#include <thread_pool.h>
 #include <vector>
-#include <thread>
 #include <core/arraydim.h>
 #include <algorithm>
-#include <atomic>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
 #include <wx/log.h>
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
@@ -54,6 +57,28 @@
 #endif
 
 
+/// Minimum number of tracks handled by a single copper layer task
+#define COPPER_MIN_TRACKS_PER_TASK 256
+
+
+/**
+ * Run the tasks on the thread pool and wait for all of them to finish.
+ */
+static void runTasks( const std::vector<std::function<void()>>& aTasks )
+{
+    thread_pool&                   tp = GetKiCadThreadPool();
+    std::vector<std::future<void>> returns;
+
+    returns.reserve( aTasks.size() );
+
+    for( const std::function<void()>& task : aTasks )
+        returns.emplace_back( tp.submit( task ) );
+
+    for( const std::future<void>& ret : returns )
+        ret.wait();
+}
+
+
 void BOARD_ADAPTER::destroyLayers()
 {
     if( !m_layers_poly.empty() )
@@ -223,31 +248,7 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
     }
 
     if( aStatusReporter )
-        aStatusReporter->Report( _( "Create tracks and vias" ) );
-
-    // Create tracks as objects and add it to container
-    for( PCB_LAYER_ID layer : layer_ids )
-    {
-        wxASSERT( m_layerMap.find( layer ) != m_layerMap.end() );
-
-        BVH_CONTAINER_2D *layerContainer = m_layerMap[layer];
-
-        for( const PCB_TRACK* track : trackList )
-        {
-            // NOTE: Vias can be on multiple layers
-            if( !track->IsOnLayer( layer ) )
-                continue;
-
-            // Skip vias annulus when not connected on this layer (if removing is enabled)
-            const PCB_VIA *via = dyn_cast< const PCB_VIA*>( track );
-
-            if( via && IsCopperLayer( layer ) && !via->FlashLayer( layer )  )
-                continue;
-
-            // Add object item to layer container
-            createTrack( track, layerContainer );
-        }
-    }
+        aStatusReporter->Report( _( "Create vias and holes" ) );
 
     // Create VIAS and THTs objects and add it to holes containers
     for( PCB_LAYER_ID layer : layer_ids )
@@ -407,37 +408,6 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
         }
     }
 
-    // Creates vertical outline contours of the tracks and add it to the poly of the layer
-    if( m_Cfg->m_Render.opengl_copper_thickness && m_Cfg->m_Render.engine == RENDER_ENGINE::OPENGL )
-    {
-        for( PCB_LAYER_ID layer : layer_ids )
-        {
-            wxASSERT( m_layers_poly.find( layer ) != m_layers_poly.end() );
-
-            SHAPE_POLY_SET *layerPoly = m_layers_poly[layer];
-
-            // ADD TRACKS
-            unsigned int nTracks = trackList.size();
-
-            for( unsigned int trackIdx = 0; trackIdx < nTracks; ++trackIdx )
-            {
-                const PCB_TRACK *track = trackList[trackIdx];
-
-                if( !track->IsOnLayer( layer ) )
-                    continue;
-
-                // Skip vias annulus when not connected on this layer (if removing is enabled)
-                const PCB_VIA *via = dyn_cast<const PCB_VIA*>( track );
-
-                if( via && !via->FlashLayer( layer ) && IsCopperLayer( layer ) )
-                    continue;
-
-                // Add the track/via contour
-                track->TransformShapeToPolygon( *layerPoly, layer, 0, maxError, ERROR_INSIDE );
-            }
-        }
-    }
-
     // Add holes of footprints
     for( FOOTPRINT* footprint : m_board->Footprints() )
     {
@@ -510,163 +480,228 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
     const bool renderPlatedPadsAsPlated = m_Cfg->m_Render.renderPlatedPadsAsPlated
                                                 && m_Cfg->m_Render.realistic;
 
-    // Add footprints PADs objects to containers
-    for( PCB_LAYER_ID layer : layer_ids )
-    {
-        wxASSERT( m_layerMap.find( layer ) != m_layerMap.end() );
+    const bool buildVerticalWallsForCopperLayers = m_Cfg->m_Render.opengl_copper_thickness
+                                            && m_Cfg->m_Render.engine == RENDER_ENGINE::OPENGL;
 
-        BVH_CONTAINER_2D *layerContainer = m_layerMap[layer];
+    if( aStatusReporter )
+        aStatusReporter->Report( _( "Create tracks, pads and graphics" ) );
 
-        // ADD PADS
-        for( FOOTPRINT* footprint : m_board->Footprints() )
-        {
-            // Note: NPTH pads are not drawn on copper layers when the pad has the same shape
-            // as its hole
-            addPads( footprint, layerContainer, layer, true, renderPlatedPadsAsPlated, false );
+    // The copper layers are filled from the thread pool.  Each task builds its objects and
+    // contours in its own containers, which are then merged into the ones of the layer.  The
+    // tracks, usually most of the items of a board, are also split across several tasks.
+    std::vector<std::function<void()>> copperTasks;
+    std::map<PCB_LAYER_ID, std::mutex> layerPolyLocks;
 
-            // Micro-wave footprints may have items on copper layers
-            addFootprintShapes( footprint, layerContainer, layer );
-        }
-    }
+    auto mergeCopperLayer =
+            [&]( PCB_LAYER_ID aLayer, CONTAINER_2D& aObjects, const SHAPE_POLY_SET& aContours )
+            {
+                m_layerMap.at( aLayer )->Splice( aObjects );
 
-    if( renderPlatedPadsAsPlated )
-    {
-        // ADD PLATED PADS
-        for( FOOTPRINT* footprint : m_board->Footprints() )
-        {
-            addPads( footprint, m_platedPadsFront, F_Cu, true, false, true );
-            addPads( footprint, m_platedPadsBack, B_Cu, true, false, true );
-        }
+                if( buildVerticalWallsForCopperLayers )
+                {
+                    std::lock_guard<std::mutex> lock( layerPolyLocks.at( aLayer ) );
+                    m_layers_poly.at( aLayer )->Append( aContours );
+                }
+            };
 
-        m_platedPadsFront->BuildBVH();
-        m_platedPadsBack->BuildBVH();
-    }
+    auto addTracks =
+            [&]( PCB_LAYER_ID aLayer, size_t aBegin, size_t aEnd )
+            {
+                CONTAINER_2D   layerContainer;
+                SHAPE_POLY_SET layerPoly;
 
-    // Add footprints PADs poly contours (vertical outlines)
-    if( m_Cfg->m_Render.opengl_copper_thickness && m_Cfg->m_Render.engine == RENDER_ENGINE::OPENGL )
-    {
-        for( PCB_LAYER_ID layer : layer_ids )
-        {
-            wxASSERT( m_layers_poly.find( layer ) != m_layers_poly.end() );
+                for( size_t trackIdx = aBegin; trackIdx < aEnd; ++trackIdx )
+                {
+                    const PCB_TRACK *track = trackList[trackIdx];
 
-            SHAPE_POLY_SET *layerPoly = m_layers_poly[layer];
+                    // NOTE: Vias can be on multiple layers
+                    if( !track->IsOnLayer( aLayer ) )
+                        continue;
 
-            // Add pads to polygon list
-            for( FOOTPRINT* footprint : m_board->Footprints() )
-            {
-                // Note: NPTH pads are not drawn on copper layers when the pad has same shape as
-                // its hole
-                footprint->TransformPadsToPolySet( *layerPoly, layer, 0, maxError, ERROR_INSIDE,
-                                                   true, renderPlatedPadsAsPlated, false );
+                    // Skip vias annulus when not connected on this layer (if removing is enabled)
+                    const PCB_VIA *via = dyn_cast< const PCB_VIA*>( track );
 
-                transformFPShapesToPolySet( footprint, layer, *layerPoly );
-            }
-        }
+                    if( via && IsCopperLayer( aLayer ) && !via->FlashLayer( aLayer )  )
+                        continue;
 
-        if( renderPlatedPadsAsPlated )
-        {
-            // ADD PLATED PADS contours
-            for( FOOTPRINT* footprint : m_board->Footprints() )
+                    // Add object item to layer container
+                    createTrack( track, &layerContainer );
+
+                    // Add the track/via contour (vertical outlines)
+                    if( buildVerticalWallsForCopperLayers )
+                    {
+                        track->TransformShapeToPolygon( layerPoly, aLayer, 0, maxError,
+                                                        ERROR_INSIDE );
+                    }
+                }
+
+                mergeCopperLayer( aLayer, layerContainer, layerPoly );
+            };
+
+    auto addPadsAndGraphics =
+            [&]( PCB_LAYER_ID aLayer )
             {
-                footprint->TransformPadsToPolySet( *m_frontPlatedPadPolys, F_Cu, 0, maxError,
-                                                   ERROR_INSIDE, true, false, true );
+                CONTAINER_2D   layerContainer;
+                SHAPE_POLY_SET layerPoly;
 
-                footprint->TransformPadsToPolySet( *m_backPlatedPadPolys, B_Cu, 0, maxError,
-                                                   ERROR_INSIDE, true, false, true );
-            }
-        }
-    }
+                // ADD PADS
+                for( FOOTPRINT* footprint : m_board->Footprints() )
+                {
+                    // Note: NPTH pads are not drawn on copper layers when the pad has the same
+                    // shape as its hole
+                    addPads( footprint, &layerContainer, aLayer, true, renderPlatedPadsAsPlated,
+                             false );
 
-    // Add graphic item on copper layers to object containers
-    for( PCB_LAYER_ID layer : layer_ids )
-    {
-        wxASSERT( m_layerMap.find( layer ) != m_layerMap.end() );
+                    // Micro-wave footprints may have items on copper layers
+                    addFootprintShapes( footprint, &layerContainer, aLayer );
 
-        BVH_CONTAINER_2D *layerContainer = m_layerMap[layer];
+                    // Add footprints PADs poly contours (vertical outlines)
+                    if( buildVerticalWallsForCopperLayers )
+                    {
+                        footprint->TransformPadsToPolySet( layerPoly, aLayer, 0, maxError,
+                                                           ERROR_INSIDE, true,
+                                                           renderPlatedPadsAsPlated, false );
 
-        // Add graphic items on copper layers (texts and other graphics)
-        for( BOARD_ITEM* item : m_board->Drawings() )
-        {
-            if( !item->IsOnLayer( layer ) )
-                continue;
+                        transformFPShapesToPolySet( footprint, aLayer, layerPoly );
+                    }
+                }
 
-            switch( item->Type() )
-            {
-            case PCB_SHAPE_T:
-                addShape( static_cast<PCB_SHAPE*>( item ), layerContainer, item );
-                break;
-
-            case PCB_TEXT_T:
-                addText( static_cast<PCB_TEXT*>( item ), layerContainer, item );
-                break;
-
-            case PCB_TEXTBOX_T:
-                addText( static_cast<PCB_TEXTBOX*>( item ), layerContainer, item );
-                addShape( static_cast<PCB_TEXTBOX*>( item ), layerContainer, item );
-                break;
-
-            case PCB_DIM_ALIGNED_T:
-            case PCB_DIM_CENTER_T:
-            case PCB_DIM_RADIAL_T:
-            case PCB_DIM_ORTHOGONAL_T:
-            case PCB_DIM_LEADER_T:
-                addShape( static_cast<PCB_DIMENSION_BASE*>( item ), layerContainer, item );
-                break;
-
-            default:
-                wxLogTrace( m_logTrace, wxT( "createLayers: item type: %d not implemented" ),
-                            item->Type() );
-                break;
-            }
-        }
-    }
+                // Add graphic items on copper layers (texts and other graphics)
+                for( BOARD_ITEM* item : m_board->Drawings() )
+                {
+                    if( !item->IsOnLayer( aLayer ) )
+                        continue;
 
-    // Add graphic item on copper layers to poly contours (vertical outlines)
-    if( m_Cfg->m_Render.opengl_copper_thickness && m_Cfg->m_Render.engine == RENDER_ENGINE::OPENGL )
-    {
-        for( PCB_LAYER_ID layer : layer_ids )
-        {
-            wxASSERT( m_layers_poly.find( layer ) != m_layers_poly.end() );
+                    switch( item->Type() )
+                    {
+                    case PCB_SHAPE_T:
+                        addShape( static_cast<PCB_SHAPE*>( item ), &layerContainer, item );
+                        break;
 
-            SHAPE_POLY_SET *layerPoly = m_layers_poly[layer];
+                    case PCB_TEXT_T:
+                        addText( static_cast<PCB_TEXT*>( item ), &layerContainer, item );
+                        break;
 
-            // Add graphic items on copper layers (texts and other )
-            for( BOARD_ITEM* item : m_board->Drawings() )
-            {
-                if( !item->IsOnLayer( layer ) )
-                    continue;
+                    case PCB_TEXTBOX_T:
+                        addText( static_cast<PCB_TEXTBOX*>( item ), &layerContainer, item );
+                        addShape( static_cast<PCB_TEXTBOX*>( item ), &layerContainer, item );
+                        break;
 
-                switch( item->Type() )
-                {
-                case PCB_SHAPE_T:
-                    item->TransformShapeToPolygon( *layerPoly, layer, 0, maxError, ERROR_INSIDE );
-                    break;
+                    case PCB_DIM_ALIGNED_T:
+                    case PCB_DIM_CENTER_T:
+                    case PCB_DIM_RADIAL_T:
+                    case PCB_DIM_ORTHOGONAL_T:
+                    case PCB_DIM_LEADER_T:
+                        addShape( static_cast<PCB_DIMENSION_BASE*>( item ), &layerContainer,
+                                  item );
+                        break;
 
-                case PCB_TEXT_T:
-                {
-                    PCB_TEXT* text = static_cast<PCB_TEXT*>( item );
+                    default:
+                        wxLogTrace( m_logTrace,
+                                    wxT( "createLayers: item type: %d not implemented" ),
+                                    item->Type() );
+                        break;
+                    }
 
-                    text->TransformTextToPolySet( *layerPoly, layer, 0, maxError, ERROR_INSIDE );
-                    break;
+                    // Add graphic item on copper layers to poly contours (vertical outlines)
+                    if( !buildVerticalWallsForCopperLayers )
+                        continue;
+
+                    switch( item->Type() )
+                    {
+                    case PCB_SHAPE_T:
+                        item->TransformShapeToPolygon( layerPoly, aLayer, 0, maxError,
+                                                       ERROR_INSIDE );
+                        break;
+
+                    case PCB_TEXT_T:
+                    {
+                        PCB_TEXT* text = static_cast<PCB_TEXT*>( item );
+
+                        text->TransformTextToPolySet( layerPoly, aLayer, 0, maxError,
+                                                      ERROR_INSIDE );
+                        break;
+                    }
+
+                    case PCB_TEXTBOX_T:
+                    {
+                        PCB_TEXTBOX* textbox = static_cast<PCB_TEXTBOX*>( item );
+
+                        textbox->TransformTextToPolySet( layerPoly, aLayer, 0, maxError,
+                                                         ERROR_INSIDE );
+                        break;
+                    }
+
+                    default:
+                        break;
+                    }
                 }
 
-                case PCB_TEXTBOX_T:
+                mergeCopperLayer( aLayer, layerContainer, layerPoly );
+            };
+
+    auto addPlatedPads =
+            [&]( PCB_LAYER_ID aLayer, BVH_CONTAINER_2D* aContainer, SHAPE_POLY_SET* aPoly )
+            {
+                for( FOOTPRINT* footprint : m_board->Footprints() )
                 {
-                    PCB_TEXTBOX* textbox = static_cast<PCB_TEXTBOX*>( item );
+                    addPads( footprint, aContainer, aLayer, true, false, true );
 
-                    textbox->TransformTextToPolySet( *layerPoly, layer, 0, maxError, ERROR_INSIDE );
-                    break;
+                    if( buildVerticalWallsForCopperLayers )
+                    {
+                        footprint->TransformPadsToPolySet( *aPoly, aLayer, 0, maxError,
+                                                           ERROR_INSIDE, true, false, true );
+                    }
                 }
 
-                default:
-                    wxLogTrace( m_logTrace, wxT( "createLayers: item type: %d not implemented" ),
-                                item->Type() );
-                    break;
-                }
-            }
+                aContainer->BuildBVH();
+            };
+
+    const size_t tracksPerTask = std::max<size_t>( COPPER_MIN_TRACKS_PER_TASK,
+            trackList.size() / std::max<size_t>( GetKiCadThreadPool().get_thread_count(), 1 ) );
+
+    for( PCB_LAYER_ID layer : layer_ids )
+    {
+        wxASSERT( m_layerMap.find( layer ) != m_layerMap.end() );
+        wxASSERT( !buildVerticalWallsForCopperLayers
+                  || m_layers_poly.find( layer ) != m_layers_poly.end() );
+
+        layerPolyLocks[layer];
+
+        for( size_t begin = 0; begin < trackList.size(); begin += tracksPerTask )
+        {
+            const size_t end = std::min( begin + tracksPerTask, trackList.size() );
+
+            copperTasks.emplace_back( [&addTracks, layer, begin, end]()
+                                      {
+                                          addTracks( layer, begin, end );
+                                      } );
         }
+
+        copperTasks.emplace_back( [&addPadsAndGraphics, layer]()
+                                  {
+                                      addPadsAndGraphics( layer );
+                                  } );
     }
 
+    if( renderPlatedPadsAsPlated )
+    {
+        // ADD PLATED PADS
+        copperTasks.emplace_back( [&]()
+                                  {
+                                      addPlatedPads( F_Cu, m_platedPadsFront,
+                                                     m_frontPlatedPadPolys );
+                                  } );
+
+        copperTasks.emplace_back( [&]()
+                                  {
+                                      addPlatedPads( B_Cu, m_platedPadsBack,
+                                                     m_backPlatedPadPolys );
+                                  } );
+    }
+
+    runTasks( copperTasks );
+
     if( m_Cfg->m_Render.show_zones )
     {
         if( aStatusReporter )
@@ -685,53 +720,35 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
         }
 
         // Add zones objects
-        std::atomic<size_t> nextZone( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
-
-        size_t parallelThreadCount = std::min<size_t>( zones.size(),
-                std::max<size_t>( std::thread::hardware_concurrency(), 2 ) );
+        std::vector<std::function<void()>> zoneTasks;
 
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        for( const std::pair<ZONE*, PCB_LAYER_ID>& zoneLayer : zones )
         {
-            std::thread t = std::thread( [&]()
-            {
-                for( size_t areaId = nextZone.fetch_add( 1 );
-                            areaId < zones.size();
-                            areaId = nextZone.fetch_add( 1 ) )
-                {
-                    ZONE* zone = zones[areaId].first;
-
-                    if( zone == nullptr )
-                        break;
-
-                    PCB_LAYER_ID layer = zones[areaId].second;
-
-                    auto layerContainer = m_layerMap.find( layer );
-                    auto layerPolyContainer = m_layers_poly.find( layer );
-
-                    if( layerContainer != m_layerMap.end() )
-                        addSolidAreasShapes( zone, layerContainer->second, layer );
-
-                    if( m_Cfg->m_Render.opengl_copper_thickness
-                          && m_Cfg->m_Render.engine == RENDER_ENGINE::OPENGL
-                          && layerPolyContainer != m_layers_poly.end() )
+            zoneTasks.emplace_back(
+                    [&, zoneLayer]()
                     {
-                        auto mut_it = layer_lock.find( layer );
+                        ZONE*        zone = zoneLayer.first;
+                        PCB_LAYER_ID layer = zoneLayer.second;
 
-                        std::lock_guard< std::mutex > lock( *( mut_it->second ) );
-                        zone->TransformSolidAreasShapesToPolygon( layer, *layerPolyContainer->second );
-                    }
-                }
+                        auto layerContainer = m_layerMap.find( layer );
+                        auto layerPolyContainer = m_layers_poly.find( layer );
 
-                threadsFinished++;
-            } );
+                        if( layerContainer != m_layerMap.end() )
+                            addSolidAreasShapes( zone, layerContainer->second, layer );
 
-            t.detach();
-        }
+                        if( buildVerticalWallsForCopperLayers
+                              && layerPolyContainer != m_layers_poly.end() )
+                        {
+                            auto mut_it = layer_lock.find( layer );
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+                            std::lock_guard< std::mutex > lock( *( mut_it->second ) );
+                            zone->TransformSolidAreasShapesToPolygon( layer,
+                                                                      *layerPolyContainer->second );
+                        }
+                    } );
+        }
 
+        runTasks( zoneTasks );
     }
 
     // Simplify layer polygons
@@ -791,37 +808,24 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
                                                            (int) selected_layer_id.size() ) );
             }
 
-            std::atomic<size_t> nextItem( 0 );
-            std::atomic<size_t> threadsFinished( 0 );
+            std::vector<std::function<void()>> simplifyTasks;
 
-            size_t parallelThreadCount = std::min<size_t>(
-                    std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-                    selected_layer_id.size() );
-
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            for( PCB_LAYER_ID layer : selected_layer_id )
             {
-                std::thread t = std::thread(
-                        [&nextItem, &threadsFinished, &selected_layer_id, this]()
-                        {
-                            for( size_t i = nextItem.fetch_add( 1 );
-                                        i < selected_layer_id.size();
-                                        i = nextItem.fetch_add( 1 ) )
-                            {
-                                auto layerPoly = m_layers_poly.find( selected_layer_id[i] );
-
-                                if( layerPoly != m_layers_poly.end() )
-                                    // This will make a union of all added contours
-                                    layerPoly->second->Simplify( SHAPE_POLY_SET::PM_FAST );
-                            }
+                auto layerPoly = m_layers_poly.find( layer );
 
-                            threadsFinished++;
-                        } );
-
-                t.detach();
+                if( layerPoly != m_layers_poly.end() )
+                {
+                    // This will make a union of all added contours
+                    simplifyTasks.emplace_back( [layerPoly]()
+                                                {
+                                                    layerPoly->second->Simplify(
+                                                            SHAPE_POLY_SET::PM_FAST );
+                                                } );
+                }
             }
 
-            while( threadsFinished < parallelThreadCount )
-                std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+            runTasks( simplifyTasks );
         }
     }
 
@@ -829,28 +833,38 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
     if( aStatusReporter )
         aStatusReporter->Report( _( "Simplify holes contours" ) );
 
+    std::vector<SHAPE_POLY_SET*> holePolys = { &m_throughHoleOdPolys,
+                                               &m_nonPlatedThroughHoleOdPolys,
+                                               &m_throughHoleViaOdPolys,
+                                               &m_throughHoleAnnularRingPolys };
+
     for( PCB_LAYER_ID layer : layer_ids )
     {
         if( m_layerHoleOdPolys.find( layer ) != m_layerHoleOdPolys.end() )
         {
             // found
-            SHAPE_POLY_SET *polyLayer = m_layerHoleOdPolys[layer];
-            polyLayer->Simplify( SHAPE_POLY_SET::PM_FAST );
+            holePolys.push_back( m_layerHoleOdPolys[layer] );
 
             wxASSERT( m_layerHoleIdPolys.find( layer ) != m_layerHoleIdPolys.end() );
 
-            polyLayer = m_layerHoleIdPolys[layer];
-            polyLayer->Simplify( SHAPE_POLY_SET::PM_FAST );
+            holePolys.push_back( m_layerHoleIdPolys[layer] );
         }
     }
 
-    // End Build Copper layers
+    std::vector<std::function<void()>> holeTasks;
 
     // This will make a union of all added contours
-    m_throughHoleOdPolys.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_nonPlatedThroughHoleOdPolys.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_throughHoleViaOdPolys.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_throughHoleAnnularRingPolys.Simplify( SHAPE_POLY_SET::PM_FAST );
+    for( SHAPE_POLY_SET* polyLayer : holePolys )
+    {
+        holeTasks.emplace_back( [polyLayer]()
+                                {
+                                    polyLayer->Simplify( SHAPE_POLY_SET::PM_FAST );
+                                } );
+    }
+
+    runTasks( holeTasks );
+
+    // End Build Copper layers
 
     // Build Tech layers
     // Based on:
@@ -884,172 +898,191 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
             Margin
         };
 
-    // User layers are not drawn here, only technical layers
-    for( LSEQ seq = LSET::AllNonCuMask().Seq( techLayerList, arrayDim( techLayerList ) );
-         seq;
-         ++seq )
-    {
-        const PCB_LAYER_ID layer = *seq;
+    auto buildTechLayer =
+            [&]( PCB_LAYER_ID layer, BVH_CONTAINER_2D* layerContainer, SHAPE_POLY_SET* layerPoly )
+            {
+                // Add drawing objects
+                for( BOARD_ITEM* item : m_board->Drawings() )
+                {
+                    if( !item->IsOnLayer( layer ) )
+                        continue;
 
-        if( !Is3dLayerEnabled( layer ) )
-            continue;
+                    switch( item->Type() )
+                    {
+                    case PCB_SHAPE_T:
+                        addShape( static_cast<PCB_SHAPE*>( item ), layerContainer, item );
+                        break;
 
-        if( aStatusReporter )
-            aStatusReporter->Report( wxString::Format( _( "Build Tech layer %d" ), (int) layer ) );
+                    case PCB_TEXT_T:
+                        addText( static_cast<PCB_TEXT*>( item ), layerContainer, item );
+                        break;
 
-        BVH_CONTAINER_2D *layerContainer = new BVH_CONTAINER_2D;
-        m_layerMap[layer] = layerContainer;
+                    case PCB_TEXTBOX_T:
+                        addText( static_cast<PCB_TEXTBOX*>( item ), layerContainer, item );
+                        addShape( static_cast<PCB_TEXTBOX*>( item ), layerContainer, item );
+                        break;
 
-        SHAPE_POLY_SET *layerPoly = new SHAPE_POLY_SET;
-        m_layers_poly[layer] = layerPoly;
+                    case PCB_DIM_ALIGNED_T:
+                    case PCB_DIM_CENTER_T:
+                    case PCB_DIM_RADIAL_T:
+                    case PCB_DIM_ORTHOGONAL_T:
+                    case PCB_DIM_LEADER_T:
+                        addShape( static_cast<PCB_DIMENSION_BASE*>( item ), layerContainer, item );
+                        break;
 
-        // Add drawing objects
-        for( BOARD_ITEM* item : m_board->Drawings() )
-        {
-            if( !item->IsOnLayer( layer ) )
-                continue;
+                    default:
+                        break;
+                    }
+                }
 
-            switch( item->Type() )
-            {
-            case PCB_SHAPE_T:
-                addShape( static_cast<PCB_SHAPE*>( item ), layerContainer, item );
-                break;
-
-            case PCB_TEXT_T:
-                addText( static_cast<PCB_TEXT*>( item ), layerContainer, item );
-                break;
-
-            case PCB_TEXTBOX_T:
-                addText( static_cast<PCB_TEXTBOX*>( item ), layerContainer, item );
-                addShape( static_cast<PCB_TEXTBOX*>( item ), layerContainer, item );
-                break;
-
-            case PCB_DIM_ALIGNED_T:
-            case PCB_DIM_CENTER_T:
-            case PCB_DIM_RADIAL_T:
-            case PCB_DIM_ORTHOGONAL_T:
-            case PCB_DIM_LEADER_T:
-                addShape( static_cast<PCB_DIMENSION_BASE*>( item ), layerContainer, item );
-                break;
-
-            default:
-                break;
-            }
-        }
+                // Add drawing contours (vertical walls)
+                if( buildVerticalWallsForTechLayers )
+                {
+                    for( BOARD_ITEM* item : m_board->Drawings() )
+                    {
+                        if( !item->IsOnLayer( layer ) )
+                            continue;
 
-        // Add drawing contours (vertical walls)
-        if( buildVerticalWallsForTechLayers )
-        {
-            for( BOARD_ITEM* item : m_board->Drawings() )
-            {
-                if( !item->IsOnLayer( layer ) )
-                    continue;
+                        switch( item->Type() )
+                        {
+                        case PCB_SHAPE_T:
+                            item->TransformShapeToPolygon( *layerPoly, layer, 0, maxError,
+                                                           ERROR_INSIDE );
+                            break;
 
-                switch( item->Type() )
-                {
-                case PCB_SHAPE_T:
-                    item->TransformShapeToPolygon( *layerPoly, layer, 0, maxError, ERROR_INSIDE );
-                    break;
+                        case PCB_TEXT_T:
+                        {
+                            PCB_TEXT* text = static_cast<PCB_TEXT*>( item );
 
-                case PCB_TEXT_T:
-                {
-                    PCB_TEXT* text = static_cast<PCB_TEXT*>( item );
+                            text->TransformTextToPolySet( *layerPoly, layer, 0, maxError,
+                                                          ERROR_INSIDE );
+                            break;
+                        }
+
+                        case PCB_TEXTBOX_T:
+                        {
+                            PCB_TEXTBOX* textbox = static_cast<PCB_TEXTBOX*>( item );
 
-                    text->TransformTextToPolySet( *layerPoly, layer, 0, maxError, ERROR_INSIDE );
-                    break;
+                            textbox->TransformTextToPolySet( *layerPoly, layer, 0, maxError,
+                                                             ERROR_INSIDE );
+                            break;
+                        }
+
+                        default:
+                            break;
+                        }
+                    }
                 }
 
-                case PCB_TEXTBOX_T:
+                // Add footprints tech layers - objects
+                for( FOOTPRINT* footprint : m_board->Footprints() )
                 {
-                    PCB_TEXTBOX* textbox = static_cast<PCB_TEXTBOX*>( item );
+                    if( layer == F_SilkS || layer == B_SilkS )
+                    {
+                        int linewidth =
+                                m_board->GetDesignSettings().m_LineThickness[ LAYER_CLASS_SILK ];
 
-                    textbox->TransformTextToPolySet( *layerPoly, layer, 0, maxError, ERROR_INSIDE );
-                    break;
-                }
+                        for( PAD* pad : footprint->Pads() )
+                        {
+                            if( !pad->IsOnLayer( layer ) )
+                                continue;
+
+                            buildPadOutlineAsSegments( pad, layerContainer, linewidth );
+                        }
+                    }
+                    else
+                    {
+                        addPads( footprint, layerContainer, layer, false, false, false );
+                    }
 
-                default:
-                    break;
+                    addFootprintShapes( footprint, layerContainer, layer );
                 }
-            }
-        }
 
-        // Add footprints tech layers - objects
-        for( FOOTPRINT* footprint : m_board->Footprints() )
-        {
-            if( layer == F_SilkS || layer == B_SilkS )
-            {
-                int linewidth = m_board->GetDesignSettings().m_LineThickness[ LAYER_CLASS_SILK ];
 
-                for( PAD* pad : footprint->Pads() )
+                // Add footprints tech layers - contours (vertical walls)
+                if( buildVerticalWallsForTechLayers )
                 {
-                    if( !pad->IsOnLayer( layer ) )
-                        continue;
+                    for( FOOTPRINT* footprint : m_board->Footprints() )
+                    {
+                        if( layer == F_SilkS || layer == B_SilkS )
+                        {
+                            int linewidth =
+                                    m_board->GetDesignSettings().m_LineThickness[ LAYER_CLASS_SILK ];
 
-                    buildPadOutlineAsSegments( pad, layerContainer, linewidth );
-                }
-            }
-            else
-            {
-                addPads( footprint, layerContainer, layer, false, false, false );
-            }
+                            for( PAD* pad : footprint->Pads() )
+                            {
+                                if( !pad->IsOnLayer( layer ) )
+                                    continue;
 
-            addFootprintShapes( footprint, layerContainer, layer );
-        }
+                                buildPadOutlineAsPolygon( pad, *layerPoly, linewidth );
+                            }
+                        }
+                        else
+                        {
+                            footprint->TransformPadsToPolySet( *layerPoly, layer, 0, maxError,
+                                                               ERROR_INSIDE );
+                        }
 
+                        // On tech layers, use a poor circle approximation, only for texts
+                        // (stroke font)
+                        footprint->TransformFPTextToPolySet( *layerPoly, layer, 0, maxError,
+                                                             ERROR_INSIDE );
 
-        // Add footprints tech layers - contours (vertical walls)
-        if( buildVerticalWallsForTechLayers )
-        {
-            for( FOOTPRINT* footprint : m_board->Footprints() )
-            {
-                if( layer == F_SilkS || layer == B_SilkS )
+                        // Add the remaining things with dynamic seg count for circles
+                        transformFPShapesToPolySet( footprint, layer, *layerPoly );
+                    }
+                }
+
+                // Draw non copper zones
+                if( m_Cfg->m_Render.show_zones )
                 {
-                    int linewidth = m_board->GetDesignSettings().m_LineThickness[ LAYER_CLASS_SILK ];
+                    for( ZONE* zone : m_board->Zones() )
+                    {
+                        if( zone->IsOnLayer( layer ) )
+                            addSolidAreasShapes( zone, layerContainer, layer );
+                    }
 
-                    for( PAD* pad : footprint->Pads() )
+                    if( buildVerticalWallsForTechLayers )
                     {
-                        if( !pad->IsOnLayer( layer ) )
-                            continue;
+                        for( ZONE* zone : m_board->Zones() )
+                        {
 
-                        buildPadOutlineAsPolygon( pad, *layerPoly, linewidth );
+                            if( zone->IsOnLayer( layer ) )
+                                zone->TransformSolidAreasShapesToPolygon( layer, *layerPoly );
+                        }
                     }
                 }
-                else
-                {
-                    footprint->TransformPadsToPolySet( *layerPoly, layer, 0, maxError, ERROR_INSIDE );
-                }
 
-                // On tech layers, use a poor circle approximation, only for texts (stroke font)
-                footprint->TransformFPTextToPolySet( *layerPoly, layer, 0, maxError, ERROR_INSIDE );
+                // This will make a union of all added contours
+                layerPoly->Simplify( SHAPE_POLY_SET::PM_FAST );
+            };
 
-                // Add the remaining things with dynamic seg count for circles
-                transformFPShapesToPolySet( footprint, layer, *layerPoly );
-            }
-        }
+    std::vector<std::function<void()>> techLayerTasks;
 
-        // Draw non copper zones
-        if( m_Cfg->m_Render.show_zones )
-        {
-            for( ZONE* zone : m_board->Zones() )
-            {
-                if( zone->IsOnLayer( layer ) )
-                    addSolidAreasShapes( zone, layerContainer, layer );
-            }
+    // User layers are not drawn here, only technical layers
+    for( LSEQ seq = LSET::AllNonCuMask().Seq( techLayerList, arrayDim( techLayerList ) );
+         seq;
+         ++seq )
+    {
+        const PCB_LAYER_ID layer = *seq;
 
-            if( buildVerticalWallsForTechLayers )
-            {
-                for( ZONE* zone : m_board->Zones() )
-                {
+        if( !Is3dLayerEnabled( layer ) )
+            continue;
 
-                    if( zone->IsOnLayer( layer ) )
-                        zone->TransformSolidAreasShapesToPolygon( layer, *layerPoly );
-                }
-            }
-        }
+        BVH_CONTAINER_2D *layerContainer = new BVH_CONTAINER_2D;
+        m_layerMap[layer] = layerContainer;
 
-        // This will make a union of all added contours
-        layerPoly->Simplify( SHAPE_POLY_SET::PM_FAST );
+        SHAPE_POLY_SET *layerPoly = new SHAPE_POLY_SET;
+        m_layers_poly[layer] = layerPoly;
+
+        techLayerTasks.emplace_back( [&buildTechLayer, layer, layerContainer, layerPoly]()
+                                     {
+                                         buildTechLayer( layer, layerContainer, layerPoly );
+                                     } );
     }
+
+    runTasks( techLayerTasks );
+
     // End Build Tech layers
 
     // Build BVH (Bounding volume hierarchy) for holes and vias
@@ -1057,21 +1090,33 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
     if( aStatusReporter )
         aStatusReporter->Report( _( "Build BVH for holes and vias" ) );
 
-    m_throughHoleIds.BuildBVH();
-    m_throughHoleOds.BuildBVH();
-    m_throughHoleAnnularRings.BuildBVH();
+    std::vector<BVH_CONTAINER_2D*> bvhContainers = { &m_throughHoleIds,
+                                                     &m_throughHoleOds,
+                                                     &m_throughHoleAnnularRings };
 
     if( !m_layerHoleMap.empty() )
     {
         for( std::pair<const PCB_LAYER_ID, BVH_CONTAINER_2D*>& hole : m_layerHoleMap )
-            hole.second->BuildBVH();
+            bvhContainers.push_back( hole.second );
     }
 
     // We only need the Solder mask to initialize the BVH
     // because..?
     if( m_layerMap[B_Mask] )
-        m_layerMap[B_Mask]->BuildBVH();
+        bvhContainers.push_back( m_layerMap[B_Mask] );
 
     if( m_layerMap[F_Mask] )
-        m_layerMap[F_Mask]->BuildBVH();
+        bvhContainers.push_back( m_layerMap[F_Mask] );
+
+    std::vector<std::function<void()>> bvhTasks;
+
+    for( BVH_CONTAINER_2D* container : bvhContainers )
+    {
+        bvhTasks.emplace_back( [container]()
+                               {
+                                   container->BuildBVH();
+                               } );
+    }
+
+    runTasks( bvhTasks );
 }
@@ -919,6 +919,12 @@ void RENDER_3D_OPENGL::load3dModels( REPORTER* aStatusReporter )
         return;
     }
 
+    if( aStatusReporter )
+        aStatusReporter->Report( _( "Loading 3D models..." ) );
+
+    // Read the models in parallel, the loop below then gets them from the memory cache
+    m_boardAdapter.Preload3dModels();
+
     // Go for all footprints
     for( const FOOTPRINT* footprint : m_boardAdapter.GetBoard()->Footprints() )
     {
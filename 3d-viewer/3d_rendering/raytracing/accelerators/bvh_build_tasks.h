@@ -0,0 +1,102 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bvh_build_tasks.h
+ * @brief Helpers shared by the parallel BVH builders.
+ */
+
+#ifndef BVH_BUILD_TASKS_H
+#define BVH_BUILD_TASKS_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include <thread_pool.h>
+
+
+/// Containers with fewer objects than this are built on the calling thread only.
+#define BVH_PARALLEL_BUILD_MIN_OBJECTS 4096
+
+
+/**
+ * Get the size under which a subtree is built as a single task.
+ *
+ * The top of the tree is split on the calling thread until the subtrees are small enough to
+ * give each thread of the pool a few of them.
+ */
+inline size_t BvhSubtreeGrain( size_t aObjectCount )
+{
+    const size_t threads = std::max<size_t>( GetKiCadThreadPool().get_thread_count(), 1 );
+
+    return std::max<size_t>( aObjectCount / ( threads * 4 ), BVH_PARALLEL_BUILD_MIN_OBJECTS / 4 );
+}
+
+
+/**
+ * Call \a aBuild for each subtree index in [0, aCount) from the thread pool.
+ *
+ * The calling thread builds subtrees too and only waits for the ones already started by the
+ * pool, so this is safe to call from a thread pool task: if all the pool threads are busy the
+ * caller simply builds everything itself.
+ */
+inline void RunBvhSubtreeBuilds( size_t aCount, const std::function<void( size_t )>& aBuild )
+{
+    if( aCount == 0 )
+        return;
+
+    struct STATE
+    {
+        std::atomic<size_t> m_next{ 0 };
+        std::atomic<size_t> m_done{ 0 };
+    };
+
+    // Tasks that start after all the subtrees are done only touch the shared state
+    std::shared_ptr<STATE> state = std::make_shared<STATE>();
+
+    auto worker =
+            [state, aCount, &aBuild]()
+            {
+                for( size_t ii = state->m_next++; ii < aCount; ii = state->m_next++ )
+                {
+                    aBuild( ii );
+                    state->m_done++;
+                }
+            };
+
+    thread_pool& tp = GetKiCadThreadPool();
+    const size_t helpers = std::min<size_t>( tp.get_thread_count(), aCount - 1 );
+
+    for( size_t ii = 0; ii < helpers; ++ii )
+        tp.push_task( worker );
+
+    worker();
+
+    while( state->m_done < aCount )
+        std::this_thread::yield();
+}
+
+#endif // BVH_BUILD_TASKS_H
@@ -67,6 +67,7 @@
  */
 
 #include "bvh_pbrt.h"
+#include "bvh_build_tasks.h"
 #include "../../../3d_fastmath.h"
 #include <macros.h>
 
@@ -144,6 +145,13 @@ struct LBVHTreelet
 };
 
 
+struct BVH_SUBTREE
+{
+    BVHBuildNode* node;
+    int start, end;
+};
+
+
 // BVHAccel Utility Functions
 inline uint32_t LeftShift3( uint32_t x )
 {
@@ -233,7 +241,7 @@ static void RadixSort( std::vector<MortonPrimitive>* v )
 
 
 BVH_PBRT::BVH_PBRT( const CONTAINER_3D_BASE& aObjectContainer, int aMaxPrimsInNode,
-                    SPLITMETHOD aSplitMethod ) :
+                    SPLITMETHOD aSplitMethod, bool aParallelBuild ) :
     m_maxPrimsInNode( std::min( 255, aMaxPrimsInNode ) ),
     m_splitMethod( aSplitMethod )
 {
@@ -275,9 +283,46 @@ BVH_PBRT::BVH_PBRT( const CONTAINER_3D_BASE& aObjectContainer, int aMaxPrimsInNo
     BVHBuildNode *root;
 
     if( m_splitMethod == SPLITMETHOD::HLBVH )
+    {
         root = HLBVHBuild( primitiveInfo, &totalNodes, orderedPrims );
+    }
     else
-        root = recursiveBuild( primitiveInfo, 0, m_primitives.size(), &totalNodes, orderedPrims );
+    {
+        // The leaves fill _orderedPrims_ in place
+        orderedPrims.resize( m_primitives.size() );
+
+        if( !aParallelBuild || m_primitives.size() < BVH_PARALLEL_BUILD_MIN_OBJECTS )
+        {
+            root = recursiveBuild( primitiveInfo, 0, m_primitives.size(), &totalNodes,
+                                   orderedPrims, m_nodesToFree, nullptr, 0 );
+        }
+        else
+        {
+            // Split the top of the tree here, then build the subtrees in parallel
+            std::vector<BVH_SUBTREE> subtrees;
+
+            root = recursiveBuild( primitiveInfo, 0, m_primitives.size(), &totalNodes,
+                                   orderedPrims, m_nodesToFree, &subtrees,
+                                   BvhSubtreeGrain( m_primitives.size() ) );
+
+            std::vector<std::list<void*>> subtreeNodes( subtrees.size() );
+            std::vector<int>              subtreeNodeCount( subtrees.size(), 0 );
+
+            RunBvhSubtreeBuilds( subtrees.size(),
+                    [&]( size_t ii )
+                    {
+                        buildNode( subtrees[ii].node, primitiveInfo, subtrees[ii].start,
+                                   subtrees[ii].end, &subtreeNodeCount[ii], orderedPrims,
+                                   subtreeNodes[ii], nullptr, 0 );
+                    } );
+
+            for( size_t ii = 0; ii < subtrees.size(); ++ii )
+            {
+                totalNodes += subtreeNodeCount[ii];
+                m_nodesToFree.splice( m_nodesToFree.end(), subtreeNodes[ii] );
+            }
+        }
+    }
 
     wxASSERT( m_primitives.size() == orderedPrims.size() );
 
@@ -425,7 +470,9 @@ struct BucketInfo
 
 BVHBuildNode *BVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo>& primitiveInfo,
                                          int start, int end, int* totalNodes,
-                                         CONST_VECTOR_OBJECT& orderedPrims )
+                                         CONST_VECTOR_OBJECT& orderedPrims,
+                                         std::list<void*>& nodesToFree,
+                                         std::vector<BVH_SUBTREE>* deferred, int grain )
 {
     wxASSERT( totalNodes != nullptr );
     wxASSERT( start >= 0 );
@@ -439,7 +486,7 @@ BVHBuildNode *BVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo>& primitiv
 
     // !TODO: implement an memory Arena
     BVHBuildNode *node = static_cast<BVHBuildNode *>( malloc( sizeof( BVHBuildNode ) ) );
-    m_nodesToFree.push_back( node );
+    nodesToFree.push_back( node );
 
     node->bounds.Reset();
     node->firstPrimOffset = 0;
@@ -448,6 +495,29 @@ BVHBuildNode *BVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo>& primitiv
     node->children[0] = nullptr;
     node->children[1] = nullptr;
 
+    if( deferred && ( end - start ) <= grain )
+    {
+        // Compute bounds now, as the parent node needs them
+        for( int i = start; i < end; ++i )
+            node->bounds.Union( primitiveInfo[i].bounds );
+
+        deferred->push_back( { node, start, end } );
+    }
+    else
+    {
+        buildNode( node, primitiveInfo, start, end, totalNodes, orderedPrims, nodesToFree,
+                   deferred, grain );
+    }
+
+    return node;
+}
+
+
+void BVH_PBRT::buildNode( BVHBuildNode* node, std::vector<BVHPrimitiveInfo>& primitiveInfo,
+                          int start, int end, int* totalNodes, CONST_VECTOR_OBJECT& orderedPrims,
+                          std::list<void*>& nodesToFree, std::vector<BVH_SUBTREE>* deferred,
+                          int grain )
+{
     // Compute bounds of all primitives in BVH node
     BBOX_3D bounds;
     bounds.Reset();
@@ -459,14 +529,15 @@ BVHBuildNode *BVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo>& primitiv
 
     if( nPrimitives == 1 )
     {
-        // Create leaf _BVHBuildNode_
-        int firstPrimOffset = orderedPrims.size();
+        // Create leaf _BVHBuildNode_.  The leaves hold consecutive ranges of _primitiveInfo_,
+        // so subtrees built on different threads never write to the same slots.
+        int firstPrimOffset = start;
 
         for( int i = start; i < end; ++i )
         {
             int primitiveNr = primitiveInfo[i].primitiveNumber;
             wxASSERT( primitiveNr < (int)m_primitives.size() );
-            orderedPrims.push_back( m_primitives[ primitiveNr ] );
+            orderedPrims[i] = m_primitives[ primitiveNr ];
         }
 
         node->InitLeaf( firstPrimOffset, nPrimitives, bounds );
@@ -489,7 +560,7 @@ BVHBuildNode *BVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo>& primitiv
                   centroidBounds.Min()[dim] ) < (FLT_EPSILON + FLT_EPSILON) )
         {
             // Create leaf _BVHBuildNode_
-            const int firstPrimOffset = orderedPrims.size();
+            const int firstPrimOffset = start;
 
             for( int i = start; i < end; ++i )
             {
@@ -501,7 +572,7 @@ BVHBuildNode *BVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo>& primitiv
 
                 wxASSERT( obj != nullptr );
 
-                orderedPrims.push_back( obj );
+                orderedPrims[i] = obj;
             }
 
             node->InitLeaf( firstPrimOffset, nPrimitives, bounds );
@@ -644,7 +715,7 @@ BVHBuildNode *BVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo>& primitiv
                     else
                     {
                         // Create leaf _BVHBuildNode_
-                        const int firstPrimOffset = orderedPrims.size();
+                        const int firstPrimOffset = start;
 
                         for( int i = start; i < end; ++i )
                         {
@@ -652,12 +723,12 @@ BVHBuildNode *BVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo>& primitiv
 
                             wxASSERT( primitiveNr < (int)m_primitives.size() );
 
-                            orderedPrims.push_back( m_primitives[ primitiveNr ] );
+                            orderedPrims[i] = m_primitives[ primitiveNr ];
                         }
 
                         node->InitLeaf( firstPrimOffset, nPrimitives, bounds );
 
-                        return node;
+                        return;
                     }
                 }
                 break;
@@ -665,13 +736,11 @@ BVHBuildNode *BVH_PBRT::recursiveBuild ( std::vector<BVHPrimitiveInfo>& primitiv
             }
 
             node->InitInterior( dim, recursiveBuild( primitiveInfo, start, mid, totalNodes,
-                                                     orderedPrims ),
+                                                     orderedPrims, nodesToFree, deferred, grain ),
                                 recursiveBuild( primitiveInfo, mid, end, totalNodes,
-                                                orderedPrims) );
+                                                orderedPrims, nodesToFree, deferred, grain ) );
         }
     }
-
-    return node;
 }
 
 
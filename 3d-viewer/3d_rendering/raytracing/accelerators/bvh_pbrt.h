@@ -73,11 +73,13 @@
 #include "accelerator_3d.h"
 #include <cstdint>
 #include <list>
+#include <vector>
 
 // Forward Declarations
 struct BVHBuildNode;
 struct BVHPrimitiveInfo;
 struct MortonPrimitive;
+struct BVH_SUBTREE;
 
 struct LinearBVHNode
 {
@@ -110,8 +112,11 @@ enum class SPLITMETHOD
 class BVH_PBRT : public ACCELERATOR_3D
 {
 public:
+    /**
+     * @param aParallelBuild builds the subtrees on the thread pool (ignored by HLBVH).
+     */
     BVH_PBRT( const CONTAINER_3D_BASE& aObjectContainer, int aMaxPrimsInNode = 4,
-              SPLITMETHOD aSplitMethod = SPLITMETHOD::SAH );
+              SPLITMETHOD aSplitMethod = SPLITMETHOD::SAH, bool aParallelBuild = true );
 
     ~BVH_PBRT();
 
@@ -121,8 +126,21 @@ public:
     bool IntersectP( const RAY& aRay, float aMaxDistance ) const override;
 
 private:
+    /**
+     * Allocate and build the node for the primitives [start, end).
+     *
+     * If \a deferred is not null, nodes with at most \a grain primitives only get their bounds
+     * and are added to it, to be built later with buildNode().
+     */
     BVHBuildNode* recursiveBuild( std::vector<BVHPrimitiveInfo>& primitiveInfo, int start,
-                                  int end, int* totalNodes, CONST_VECTOR_OBJECT& orderedPrims );
+                                  int end, int* totalNodes, CONST_VECTOR_OBJECT& orderedPrims,
+                                  std::list<void*>& nodesToFree,
+                                  std::vector<BVH_SUBTREE>* deferred, int grain );
+
+    void buildNode( BVHBuildNode* node, std::vector<BVHPrimitiveInfo>& primitiveInfo, int start,
+                    int end, int* totalNodes, CONST_VECTOR_OBJECT& orderedPrims,
+                    std::list<void*>& nodesToFree, std::vector<BVH_SUBTREE>* deferred,
+                    int grain );
 
     BVHBuildNode* HLBVHBuild( const std::vector<BVHPrimitiveInfo>& primitiveInfo,
                               int* totalNodes, CONST_VECTOR_OBJECT& orderedPrims );
@@ -27,7 +27,11 @@
  */
 
 #include "container_2d.h"
+#include "bvh_build_tasks.h"
 #include "../ray.h"
+#include <algorithm>
+#include <cfloat>
+#include <limits>
 #include <boost/range/algorithm/partition.hpp>
 #include <boost/range/algorithm/nth_element.hpp>
 #include <wx/debug.h>
@@ -53,6 +57,19 @@ void CONTAINER_2D_BASE::Clear()
 }
 
 
+void CONTAINER_2D_BASE::Splice( CONTAINER_2D_BASE& aOther )
+{
+    if( &aOther == this )
+        return;
+
+    std::scoped_lock lock( m_lock, aOther.m_lock );
+
+    m_objects.splice( m_objects.end(), aOther.m_objects );
+    m_bbox.Union( aOther.m_bbox );
+    aOther.m_bbox.Reset();
+}
+
+
 CONTAINER_2D_BASE::~CONTAINER_2D_BASE()
 {
     Clear();
@@ -117,9 +134,10 @@ BVH_CONTAINER_2D::~BVH_CONTAINER_2D()
 
 
 #define BVH_CONTAINER2D_MAX_OBJ_PER_LEAF 4
+#define BVH_CONTAINER2D_SAH_BINS 16
 
 
-void BVH_CONTAINER_2D::BuildBVH()
+void BVH_CONTAINER_2D::BuildBVH( BVH_SPLIT_2D aSplitMethod )
 {
     if( m_isInitialized )
         destroy();
@@ -136,12 +154,199 @@ void BVH_CONTAINER_2D::BuildBVH()
     m_elementsToDelete.push_back( m_tree );
     m_tree->m_BBox = m_bbox;
 
-    for( LIST_OBJECT2D::const_iterator ii = m_objects.begin(); ii != m_objects.end(); ++ii )
+    if( aSplitMethod == BVH_SPLIT_2D::MIDDLE )
+    {
+        for( LIST_OBJECT2D::const_iterator ii = m_objects.begin(); ii != m_objects.end(); ++ii )
+        {
+            m_tree->m_LeafList.push_back( static_cast<const OBJECT_2D*>( *ii ) );
+        }
+
+        recursiveBuild_MIDDLE_SPLIT( m_tree );
+        return;
+    }
+
+    std::vector<const OBJECT_2D*> objects( m_objects.begin(), m_objects.end() );
+
+    if( objects.size() < BVH_PARALLEL_BUILD_MIN_OBJECTS )
+    {
+        buildSAH( m_tree, objects, 0, objects.size(), m_elementsToDelete, nullptr, 0 );
+        return;
+    }
+
+    // Split the top of the tree here, then build the subtrees in parallel
+    std::vector<SAH_SUBTREE> subtrees;
+
+    buildSAH( m_tree, objects, 0, objects.size(), m_elementsToDelete, &subtrees,
+              BvhSubtreeGrain( objects.size() ) );
+
+    std::vector<std::list<BVH_CONTAINER_NODE_2D*>> subtreeNodes( subtrees.size() );
+
+    RunBvhSubtreeBuilds( subtrees.size(),
+            [&]( size_t ii )
+            {
+                buildSAH( subtrees[ii].m_node, objects, subtrees[ii].m_start, subtrees[ii].m_end,
+                          subtreeNodes[ii], nullptr, 0 );
+            } );
+
+    for( std::list<BVH_CONTAINER_NODE_2D*>& nodes : subtreeNodes )
+        m_elementsToDelete.splice( m_elementsToDelete.end(), nodes );
+}
+
+
+void BVH_CONTAINER_2D::buildSAH( BVH_CONTAINER_NODE_2D* aNode,
+                                 std::vector<const OBJECT_2D*>& aObjects, size_t aStart,
+                                 size_t aEnd, std::list<BVH_CONTAINER_NODE_2D*>& aNodes,
+                                 std::vector<SAH_SUBTREE>* aDeferred, size_t aGrain )
+{
+    wxASSERT( aNode != nullptr );
+    wxASSERT( aNode->m_BBox.IsInitialized() == true );
+    wxASSERT( aEnd > aStart );
+
+    aNode->m_Children[0] = nullptr;
+    aNode->m_Children[1] = nullptr;
+
+    const size_t count = aEnd - aStart;
+
+    if( count <= BVH_CONTAINER2D_MAX_OBJ_PER_LEAF )
     {
-        m_tree->m_LeafList.push_back( static_cast<const OBJECT_2D*>( *ii ) );
+        aNode->m_LeafList.assign( aObjects.begin() + aStart, aObjects.begin() + aEnd );
+        return;
+    }
+
+    if( aDeferred && count <= aGrain )
+    {
+        aDeferred->push_back( { aNode, aStart, aEnd } );
+        return;
     }
 
-    recursiveBuild_MIDDLE_SPLIT( m_tree );
+    BBOX_2D centroidBBox;
+    centroidBBox.Reset();
+
+    for( size_t i = aStart; i < aEnd; ++i )
+        centroidBBox.Union( aObjects[i]->GetCentroid() );
+
+    const unsigned int axis = centroidBBox.MaxDimension();
+    const float        axisMin = centroidBBox.Min()[axis];
+    const float        axisExtent = centroidBBox.Max()[axis] - axisMin;
+
+    auto binOf =
+            [&]( const OBJECT_2D* aObject ) -> int
+            {
+                const int bin = (int) ( BVH_CONTAINER2D_SAH_BINS
+                                        * ( aObject->GetCentroid()[axis] - axisMin )
+                                        / axisExtent );
+
+                return std::min( bin, BVH_CONTAINER2D_SAH_BINS - 1 );
+            };
+
+    size_t mid = aStart;
+
+    if( axisExtent > FLT_EPSILON )
+    {
+        int     binCount[BVH_CONTAINER2D_SAH_BINS] = { 0 };
+        BBOX_2D binBBox[BVH_CONTAINER2D_SAH_BINS];
+
+        for( BBOX_2D& bbox : binBBox )
+            bbox.Reset();
+
+        for( size_t i = aStart; i < aEnd; ++i )
+        {
+            const int bin = binOf( aObjects[i] );
+
+            binCount[bin]++;
+            binBBox[bin].Union( aObjects[i]->GetBBox() );
+        }
+
+        // Sweep from the right to get the cost of the right side of each split
+        float   rightCost[BVH_CONTAINER2D_SAH_BINS];
+        BBOX_2D rightBBox;
+        int     rightCount = 0;
+
+        rightBBox.Reset();
+
+        for( int i = BVH_CONTAINER2D_SAH_BINS - 1; i > 0; --i )
+        {
+            if( binCount[i] )
+            {
+                rightBBox.Union( binBBox[i] );
+                rightCount += binCount[i];
+            }
+
+            rightCost[i] = rightCount ? rightCount * rightBBox.Perimeter() : 0.0f;
+        }
+
+        // Then from the left, splitting after the bin with the lowest total cost.  In 2D the
+        // perimeter plays the role of the surface area.
+        BBOX_2D leftBBox;
+        int     leftCount = 0;
+        float   bestCost = std::numeric_limits<float>::max();
+        int     bestSplit = -1;
+
+        leftBBox.Reset();
+
+        for( int i = 0; i < BVH_CONTAINER2D_SAH_BINS - 1; ++i )
+        {
+            if( binCount[i] )
+            {
+                leftBBox.Union( binBBox[i] );
+                leftCount += binCount[i];
+            }
+
+            if( leftCount == 0 || leftCount == (int) count )
+                continue;
+
+            const float cost = leftCount * leftBBox.Perimeter() + rightCost[i + 1];
+
+            if( cost < bestCost )
+            {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        if( bestSplit >= 0 )
+        {
+            mid = std::partition( aObjects.begin() + aStart, aObjects.begin() + aEnd,
+                                  [&]( const OBJECT_2D* aObject )
+                                  {
+                                      return binOf( aObject ) <= bestSplit;
+                                  } )
+                  - aObjects.begin();
+        }
+    }
+
+    // All the centroids fall in the same bin: split the objects in half
+    if( mid == aStart || mid == aEnd )
+    {
+        mid = aStart + count / 2;
+
+        std::nth_element( aObjects.begin() + aStart, aObjects.begin() + mid,
+                          aObjects.begin() + aEnd,
+                          [axis]( const OBJECT_2D* a, const OBJECT_2D* b )
+                          {
+                              return a->GetCentroid()[axis] < b->GetCentroid()[axis];
+                          } );
+    }
+
+    BVH_CONTAINER_NODE_2D* leftNode  = new BVH_CONTAINER_NODE_2D;
+    BVH_CONTAINER_NODE_2D* rightNode = new BVH_CONTAINER_NODE_2D;
+    aNodes.push_back( leftNode );
+    aNodes.push_back( rightNode );
+
+    leftNode->m_BBox.Reset();
+    rightNode->m_BBox.Reset();
+
+    for( size_t i = aStart; i < mid; ++i )
+        leftNode->m_BBox.Union( aObjects[i]->GetBBox() );
+
+    for( size_t i = mid; i < aEnd; ++i )
+        rightNode->m_BBox.Union( aObjects[i]->GetBBox() );
+
+    aNode->m_Children[0] = leftNode;
+    aNode->m_Children[1] = rightNode;
+
+    buildSAH( leftNode, aObjects, aStart, mid, aNodes, aDeferred, aGrain );
+    buildSAH( rightNode, aObjects, mid, aEnd, aNodes, aDeferred, aGrain );
 }
 
 
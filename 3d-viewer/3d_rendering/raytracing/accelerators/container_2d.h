@@ -32,6 +32,7 @@
 #include "../shapes2D/object_2d.h"
 #include <list>
 #include <mutex>
+#include <vector>
 
 struct RAYSEG2D;
 
@@ -56,6 +57,13 @@ public:
         }
     }
 
+    /**
+     * Move all the objects of \a aOther to the end of this container.
+     *
+     * This is used to merge the containers filled by different threads.
+     */
+    void Splice( CONTAINER_2D_BASE& aOther );
+
     const BBOX_2D& GetBBox() const
     {
         return m_bbox;
@@ -113,13 +121,20 @@ struct BVH_CONTAINER_NODE_2D
 };
 
 
+enum class BVH_SPLIT_2D
+{
+    MIDDLE,     ///< Split the objects in half along the longest axis
+    SAH         ///< Binned surface area heuristic, subtrees built in parallel
+};
+
+
 class BVH_CONTAINER_2D : public CONTAINER_2D_BASE
 {
 public:
     BVH_CONTAINER_2D();
     ~BVH_CONTAINER_2D();
 
-    void BuildBVH();
+    void BuildBVH( BVH_SPLIT_2D aSplitMethod = BVH_SPLIT_2D::SAH );
 
     void Clear() override;
 
@@ -131,6 +146,27 @@ public:
 private:
     void destroy();
     void recursiveBuild_MIDDLE_SPLIT( BVH_CONTAINER_NODE_2D* aNodeParent );
+
+    ///< A subtree left to be built later by buildSAH().
+    struct SAH_SUBTREE
+    {
+        BVH_CONTAINER_NODE_2D* m_node;
+        size_t                 m_start;
+        size_t                 m_end;
+    };
+
+    /**
+     * Build the node holding the objects [aStart, aEnd) of \a aObjects, whose bounding box
+     * must already be set.
+     *
+     * @param aNodes receives the created nodes, to be deleted with the container.
+     * @param aDeferred if not null, receives the subtrees with at most \a aGrain objects
+     *                  instead of building them.
+     */
+    void buildSAH( BVH_CONTAINER_NODE_2D* aNode, std::vector<const OBJECT_2D*>& aObjects,
+                   size_t aStart, size_t aEnd, std::list<BVH_CONTAINER_NODE_2D*>& aNodes,
+                   std::vector<SAH_SUBTREE>* aDeferred, size_t aGrain );
+
     void recursiveGetListObjectsIntersects( const BVH_CONTAINER_NODE_2D* aNode,
                                             const BBOX_2D& aBBox,
                                             CONST_LIST_OBJECT2D& aOutList ) const;
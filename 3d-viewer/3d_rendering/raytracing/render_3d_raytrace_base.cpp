@@ -22,33 +22,29 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
-#include <gal/opengl/kiglew.h>    // Must be included first
-
 #include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <climits>
+#include <future>
 #include <thread>
 
-#include "render_3d_raytrace.h"
+#include "render_3d_raytrace_base.h"
 #include "mortoncodes.h"
 #include "../color_rgb.h"
 #include "3d_fastmath.h"
 #include "3d_math.h"
-#include "../common_ogl/ogl_utils.h"
 #include <profile.h>        // To use GetRunningMicroSecs or another profiling utility
+#include <thread_pool.h>
 #include <wx/log.h>
 
 
-RENDER_3D_RAYTRACE::RENDER_3D_RAYTRACE( EDA_3D_CANVAS* aCanvas, BOARD_ADAPTER& aAdapter, CAMERA& aCamera ) :
+RENDER_3D_RAYTRACE_BASE::RENDER_3D_RAYTRACE_BASE( EDA_3D_CANVAS* aCanvas, BOARD_ADAPTER& aAdapter, CAMERA& aCamera ) :
     RENDER_3D_BASE( aCanvas, aAdapter, aCamera ),
     m_postShaderSsao( aCamera )
 {
-    wxLogTrace( m_logTrace, wxT( "RENDER_3D_RAYTRACE::RENDER_3D_RAYTRACE" ) );
+    wxLogTrace( m_logTrace, wxT( "RENDER_3D_RAYTRACE_BASE::RENDER_3D_RAYTRACE_BASE" ) );
 
-    m_openglSupportsVertexBufferObjects = false;
-    m_pboId       = GL_NONE;
-    m_pboDataSize = 0;
     m_accelerator = nullptr;
     m_convertedDummyBlockCount = 0;
     m_converted2dRoundSegmentCount = 0;
@@ -67,12 +63,13 @@ RENDER_3D_RAYTRACE::RENDER_3D_RAYTRACE( EDA_3D_CANVAS* aCanvas, BOARD_ADAPTER& a
     m_renderState = RT_RENDER_STATE_MAX; // Set to an initial invalid state
     m_renderStartTime = 0;
     m_blockRenderProgressCount = 0;
+    m_threadCount = 0;
 }
 
 
-RENDER_3D_RAYTRACE::~RENDER_3D_RAYTRACE()
+RENDER_3D_RAYTRACE_BASE::~RENDER_3D_RAYTRACE_BASE()
 {
-    wxLogTrace( m_logTrace, wxT( "RENDER_3D_RAYTRACE::~RENDER_3D_RAYTRACE" ) );
+    wxLogTrace( m_logTrace, wxT( "RENDER_3D_RAYTRACE_BASE::~RENDER_3D_RAYTRACE_BASE" ) );
 
     delete m_accelerator;
     m_accelerator = nullptr;
@@ -85,43 +82,62 @@ RENDER_3D_RAYTRACE::~RENDER_3D_RAYTRACE()
 
     delete[] m_shaderBuffer;
     m_shaderBuffer = nullptr;
-
-    deletePbo();
 }
 
 
-int RENDER_3D_RAYTRACE::GetWaitForEditingTimeOut()
+int RENDER_3D_RAYTRACE_BASE::GetWaitForEditingTimeOut()
 {
     return 1000; // ms
 }
 
 
-void RENDER_3D_RAYTRACE::deletePbo()
+size_t RENDER_3D_RAYTRACE_BASE::threadCount() const
 {
-    // Delete PBO if it was created
-    if( m_openglSupportsVertexBufferObjects )
-    {
-        if( glIsBufferARB( m_pboId ) )
-            glDeleteBuffers( 1, &m_pboId );
+    if( m_threadCount > 0 )
+        return m_threadCount;
 
-        m_pboId = GL_NONE;
-    }
+    return std::max<size_t>( std::thread::hardware_concurrency(), 2 );
 }
 
 
-void RENDER_3D_RAYTRACE::SetCurWindowSize( const wxSize& aSize )
+void RENDER_3D_RAYTRACE_BASE::parallelRun( size_t aCount,
+                                           const std::function<bool( size_t )>& aWork )
 {
-    if( m_windowSize != aSize )
+    thread_pool& tp = GetKiCadThreadPool();
+    const size_t workerCount = std::min( { threadCount(), (size_t) tp.get_thread_count(),
+                                           aCount } );
+
+    if( workerCount == 0 )
+        return;
+
+    m_tileScheduler.Reset( aCount, workerCount );
+
+    std::atomic<bool>              stop( false );
+    std::vector<std::future<void>> results;
+
+    results.reserve( workerCount );
+
+    for( size_t ii = 0; ii < workerCount; ++ii )
     {
-        m_windowSize = aSize;
-        glViewport( 0, 0, m_windowSize.x, m_windowSize.y );
+        results.push_back( tp.submit(
+                [&, ii]()
+                {
+                    size_t index;
 
-        initializeNewWindowSize();
+                    while( !stop && m_tileScheduler.Next( ii, index ) )
+                    {
+                        if( !aWork( index ) )
+                            stop = true;
+                    }
+                } ) );
     }
+
+    for( std::future<void>& ret : results )
+        ret.wait();
 }
 
 
-void RENDER_3D_RAYTRACE::restartRenderState()
+void RENDER_3D_RAYTRACE_BASE::restartRenderState()
 {
     m_renderStartTime = GetRunningMicroSecs();
 
@@ -137,7 +153,7 @@ void RENDER_3D_RAYTRACE::restartRenderState()
 }
 
 
-static inline void SetPixel( GLubyte* p, const COLOR_RGB& v )
+static inline void SetPixel( uint8_t* p, const COLOR_RGB& v )
 {
     p[0] = v.c[0];
     p[1] = v.c[1];
@@ -146,145 +162,7 @@ static inline void SetPixel( GLubyte* p, const COLOR_RGB& v )
 }
 
 
-bool RENDER_3D_RAYTRACE::Redraw( bool aIsMoving, REPORTER* aStatusReporter,
-                                 REPORTER* aWarningReporter )
-{
-    bool requestRedraw = false;
-
-    // Initialize openGL if need
-    if( !m_is_opengl_initialized )
-    {
-        if( !initializeOpenGL() )
-            return false;
-
-        //aIsMoving = true;
-        requestRedraw = true;
-
-        // It will assign the first time the windows size, so it will now
-        // revert to preview mode the first time the Redraw is called
-        m_oldWindowsSize = m_windowSize;
-        initializeBlockPositions();
-    }
-
-    std::unique_ptr<BUSY_INDICATOR> busy = CreateBusyIndicator();
-
-    // Reload board if it was requested
-    if( m_reloadRequested )
-    {
-        if( aStatusReporter )
-            aStatusReporter->Report( _( "Loading..." ) );
-
-        //aIsMoving = true;
-        requestRedraw = true;
-        Reload( aStatusReporter, aWarningReporter, false );
-    }
-
-
-    // Recalculate constants if windows size was changed
-    if( m_windowSize != m_oldWindowsSize )
-    {
-        m_oldWindowsSize = m_windowSize;
-        aIsMoving = true;
-        requestRedraw = true;
-
-        initializeBlockPositions();
-    }
-
-
-    // Clear buffers
-    glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
-    glClearDepth( 1.0f );
-    glClearStencil( 0x00 );
-    glClear( GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT );
-
-    // 4-byte pixel alignment
-    glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
-
-    glDisable( GL_STENCIL_TEST );
-    glDisable( GL_LIGHTING );
-    glDisable( GL_COLOR_MATERIAL );
-    glDisable( GL_DEPTH_TEST );
-    glDisable( GL_TEXTURE_2D );
-    glDisable( GL_BLEND );
-    glDisable( GL_MULTISAMPLE );
-
-    const bool was_camera_changed = m_camera.ParametersChanged();
-
-    if( requestRedraw || aIsMoving || was_camera_changed )
-        m_renderState = RT_RENDER_STATE_MAX; // Set to an invalid state,
-                                             // so it will restart again latter
-
-    // This will only render if need, otherwise it will redraw the PBO on the screen again
-    if( aIsMoving || was_camera_changed )
-    {
-        // Set head light (camera view light) with the opposite direction of the camera
-        if( m_cameraLight )
-            m_cameraLight->SetDirection( -m_camera.GetDir() );
-
-        OglDrawBackground( SFVEC3F( m_boardAdapter.m_BgColorTop),
-                           SFVEC3F( m_boardAdapter.m_BgColorBot) );
-
-        // Bind PBO
-        glBindBufferARB( GL_PIXEL_UNPACK_BUFFER_ARB, m_pboId );
-
-        // Get the PBO pixel pointer to write the data
-        GLubyte* ptrPBO = (GLubyte *)glMapBufferARB( GL_PIXEL_UNPACK_BUFFER_ARB,
-                                                     GL_WRITE_ONLY_ARB );
-
-        if( ptrPBO )
-        {
-            renderPreview( ptrPBO );
-
-            // release pointer to mapping buffer, this initialize the coping to PBO
-            glUnmapBufferARB( GL_PIXEL_UNPACK_BUFFER_ARB );
-        }
-
-        glWindowPos2i( m_xoffset, m_yoffset );
-    }
-    else
-    {
-        // Bind PBO
-        glBindBufferARB( GL_PIXEL_UNPACK_BUFFER_ARB, m_pboId );
-
-        if( m_renderState != RT_RENDER_STATE_FINISH )
-        {
-            // Get the PBO pixel pointer to write the data
-            GLubyte* ptrPBO = (GLubyte *)glMapBufferARB( GL_PIXEL_UNPACK_BUFFER_ARB,
-                                                         GL_WRITE_ONLY_ARB );
-
-            if( ptrPBO )
-            {
-                render( ptrPBO, aStatusReporter );
-
-                if( m_renderState != RT_RENDER_STATE_FINISH )
-                    requestRedraw = true;
-
-                // release pointer to mapping buffer, this initialize the coping to PBO
-                glUnmapBufferARB( GL_PIXEL_UNPACK_BUFFER_ARB );
-            }
-        }
-
-        if( m_renderState == RT_RENDER_STATE_FINISH )
-        {
-            glClear( GL_COLOR_BUFFER_BIT );
-        }
-
-        glWindowPos2i( m_xoffset, m_yoffset );
-    }
-
-    // This way it will blend the progress rendering with the last buffer. eg:
-    // if it was called after a openGL.
-    glEnable( GL_BLEND );
-    glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-    glEnable( GL_ALPHA_TEST );
-    glDrawPixels( m_realBufferSize.x, m_realBufferSize.y, GL_RGBA, GL_UNSIGNED_BYTE, 0 );
-    glBindBufferARB( GL_PIXEL_UNPACK_BUFFER_ARB, 0 );
-
-    return requestRedraw;
-}
-
-
-void RENDER_3D_RAYTRACE::render( GLubyte* ptrPBO, REPORTER* aStatusReporter )
+void RENDER_3D_RAYTRACE_BASE::render( uint8_t* ptrBuffer, REPORTER* aStatusReporter )
 {
     if( ( m_renderState == RT_RENDER_STATE_FINISH ) || ( m_renderState >= RT_RENDER_STATE_MAX ) )
     {
@@ -295,16 +173,16 @@ void RENDER_3D_RAYTRACE::render( GLubyte* ptrPBO, REPORTER* aStatusReporter )
 
         if( m_boardAdapter.m_Cfg->m_Render.engine == RENDER_ENGINE::OPENGL )
         {
-            // Set all pixels of PBO transparent (Alpha to 0)
+            // Set all pixels of the buffer transparent (Alpha to 0)
             // This way it will draw the full buffer but only shows the updated (
             // already calculated) squares
             unsigned int nPixels = m_realBufferSize.x * m_realBufferSize.y;
-            GLubyte* tmp_ptrPBO = ptrPBO + 3;   // PBO is RGBA
+            uint8_t* tmp_ptrBuffer = ptrBuffer + 3;   // buffer is RGBA
 
             for( unsigned int i = 0; i < nPixels; ++i )
             {
-                *tmp_ptrPBO = 0;
-                tmp_ptrPBO += 4;                // PBO is RGBA
+                *tmp_ptrBuffer = 0;
+                tmp_ptrBuffer += 4;                // buffer is RGBA
             }
         }
 
@@ -315,15 +193,15 @@ void RENDER_3D_RAYTRACE::render( GLubyte* ptrPBO, REPORTER* aStatusReporter )
     switch( m_renderState )
     {
     case RT_RENDER_STATE_TRACING:
-        renderTracing( ptrPBO, aStatusReporter );
+        renderTracing( ptrBuffer, aStatusReporter );
         break;
 
     case RT_RENDER_STATE_POST_PROCESS_SHADE:
-        postProcessShading( ptrPBO, aStatusReporter );
+        postProcessShading( ptrBuffer, aStatusReporter );
         break;
 
     case RT_RENDER_STATE_POST_PROCESS_BLUR_AND_FINISH:
-        postProcessBlurFinish( ptrPBO, aStatusReporter );
+        postProcessBlurFinish( ptrBuffer, aStatusReporter );
         break;
 
     default:
@@ -342,51 +220,29 @@ void RENDER_3D_RAYTRACE::render( GLubyte* ptrPBO, REPORTER* aStatusReporter )
 }
 
 
-void RENDER_3D_RAYTRACE::renderTracing( GLubyte* ptrPBO, REPORTER* aStatusReporter )
+void RENDER_3D_RAYTRACE_BASE::renderTracing( uint8_t* ptrBuffer, REPORTER* aStatusReporter )
 {
     m_isPreview = false;
 
     auto startTime = std::chrono::steady_clock::now();
-    bool breakLoop = false;
 
     std::atomic<size_t> numBlocksRendered( 0 );
-    std::atomic<size_t> currentBlock( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
 
-    size_t parallelThreadCount = std::min<size_t>(
-            std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-            m_blockPositions.size() );
-
-    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-    {
-        std::thread t = std::thread( [&]()
-        {
-            for( size_t iBlock = currentBlock.fetch_add( 1 );
-                 iBlock < m_blockPositions.size() && !breakLoop;
-                 iBlock = currentBlock.fetch_add( 1 ) )
+    parallelRun( m_blockPositions.size(),
+            [&]( size_t iBlock ) -> bool
             {
-                if( !m_blockPositionsWasProcessed[iBlock] )
-                {
-                    renderBlockTracing( ptrPBO, iBlock );
-                    numBlocksRendered++;
-                    m_blockPositionsWasProcessed[iBlock] = 1;
-
-                    // Check if it spend already some time render and request to exit
-                    // to display the progress
-                    if( std::chrono::duration_cast<std::chrono::milliseconds>(
-                            std::chrono::steady_clock::now() - startTime ).count() > 150 )
-                        breakLoop = true;
-                }
-            }
+                if( m_blockPositionsWasProcessed[iBlock] )
+                    return true;
 
-            threadsFinished++;
-        } );
+                renderBlockTracing( ptrBuffer, iBlock );
+                numBlocksRendered++;
+                m_blockPositionsWasProcessed[iBlock] = 1;
 
-        t.detach();
-    }
-
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+                // Check if it spend already some time render and request to exit
+                // to display the progress
+                return std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::steady_clock::now() - startTime ).count() <= 150;
+            } );
 
     m_blockRenderProgressCount += numBlocksRendered;
 
@@ -442,7 +298,7 @@ SFVEC3F ConvertSRGBToLinear( const SFVEC3F& aSRGBcolor )
 #endif
 
 
-void RENDER_3D_RAYTRACE::renderFinalColor( GLubyte* ptrPBO, const SFVEC3F& rgbColor,
+void RENDER_3D_RAYTRACE_BASE::renderFinalColor( uint8_t* ptrBuffer, const SFVEC3F& rgbColor,
                                          bool applyColorSpaceConversion )
 {
     SFVEC3F color = rgbColor;
@@ -456,10 +312,10 @@ void RENDER_3D_RAYTRACE::renderFinalColor( GLubyte* ptrPBO, const SFVEC3F& rgbCo
         color = convertLinearToSRGB( rgbColor );
 #endif
 
-    ptrPBO[0] = (unsigned int) glm::clamp( (int) ( color.r * 255 ), 0, 255 );
-    ptrPBO[1] = (unsigned int) glm::clamp( (int) ( color.g * 255 ), 0, 255 );
-    ptrPBO[2] = (unsigned int) glm::clamp( (int) ( color.b * 255 ), 0, 255 );
-    ptrPBO[3] = 255;
+    ptrBuffer[0] = (unsigned int) glm::clamp( (int) ( color.r * 255 ), 0, 255 );
+    ptrBuffer[1] = (unsigned int) glm::clamp( (int) ( color.g * 255 ), 0, 255 );
+    ptrBuffer[2] = (unsigned int) glm::clamp( (int) ( color.b * 255 ), 0, 255 );
+    ptrBuffer[3] = 255;
 }
 
 
@@ -477,9 +333,9 @@ static void HITINFO_PACKET_init( HITINFO_PACKET* aHitPacket )
 }
 
 
-void RENDER_3D_RAYTRACE::renderRayPackets( const SFVEC3F* bgColorY, const RAY* aRayPkt,
-                                           HITINFO_PACKET* aHitPacket, bool is_testShadow,
-                                           SFVEC3F* aOutHitColor )
+void RENDER_3D_RAYTRACE_BASE::renderRayPackets( const SFVEC3F* bgColorY, const RAY* aRayPkt,
+                                                HITINFO_PACKET* aHitPacket, bool is_testShadow,
+                                                SFVEC3F* aOutHitColor )
 {
     for( unsigned int y = 0, i = 0; y < RAYPACKET_DIM; ++y )
     {
@@ -499,10 +355,10 @@ void RENDER_3D_RAYTRACE::renderRayPackets( const SFVEC3F* bgColorY, const RAY* a
 }
 
 
-void RENDER_3D_RAYTRACE::renderAntiAliasPackets( const SFVEC3F* aBgColorY,
-                                                 const HITINFO_PACKET* aHitPck_X0Y0,
-                                                 const HITINFO_PACKET* aHitPck_AA_X1Y1,
-                                                 const RAY* aRayPck, SFVEC3F* aOutHitColor )
+void RENDER_3D_RAYTRACE_BASE::renderAntiAliasPackets( const SFVEC3F* aBgColorY,
+                                                      const HITINFO_PACKET* aHitPck_X0Y0,
+                                                      const HITINFO_PACKET* aHitPck_AA_X1Y1,
+                                                      const RAY* aRayPck, SFVEC3F* aOutHitColor )
 {
     const bool is_testShadow =  m_boardAdapter.m_Cfg->m_Render.raytrace_shadows;
 
@@ -623,7 +479,7 @@ void RENDER_3D_RAYTRACE::renderAntiAliasPackets( const SFVEC3F* aBgColorY,
 #define DISP_FACTOR 0.075f
 
 
-void RENDER_3D_RAYTRACE::renderBlockTracing( GLubyte* ptrPBO, signed int iBlock )
+void RENDER_3D_RAYTRACE_BASE::renderBlockTracing( uint8_t* ptrBuffer, signed int iBlock )
 {
     // Initialize ray packets
     const SFVEC2UI& blockPos = m_blockPositions[iBlock];
@@ -682,7 +538,7 @@ void RENDER_3D_RAYTRACE::renderBlockTracing( GLubyte* ptrPBO, signed int iBlock
 
             for( unsigned int x = 0; x < RAYPACKET_DIM; ++x )
             {
-                GLubyte* ptr = &ptrPBO[( yConst + x ) * 4];
+                uint8_t* ptr = &ptrBuffer[( yConst + x ) * 4];
 
                 renderFinalColor( ptr, outColor, isFinalColor );
             }
@@ -775,7 +631,7 @@ void RENDER_3D_RAYTRACE::renderBlockTracing( GLubyte* ptrPBO, signed int iBlock
     }
 
     // Copy results to the next stage
-    GLubyte* ptr = &ptrPBO[( blockPos.x + ( blockPos.y * m_realBufferSize.x ) ) * 4];
+    uint8_t* ptr = &ptrBuffer[( blockPos.x + ( blockPos.y * m_realBufferSize.x ) ) * 4];
 
     const uint32_t ptrInc = ( m_realBufferSize.x - RAYPACKET_DIM ) * 4;
 
@@ -834,7 +690,7 @@ void RENDER_3D_RAYTRACE::renderBlockTracing( GLubyte* ptrPBO, signed int iBlock
 }
 
 
-void RENDER_3D_RAYTRACE::postProcessShading( GLubyte* /* ptrPBO */, REPORTER* aStatusReporter )
+void RENDER_3D_RAYTRACE_BASE::postProcessShading( uint8_t* /* ptrBuffer */, REPORTER* aStatusReporter )
 {
     if( m_boardAdapter.m_Cfg->m_Render.raytrace_post_processing )
     {
@@ -843,17 +699,8 @@ void RENDER_3D_RAYTRACE::postProcessShading( GLubyte* /* ptrPBO */, REPORTER* aS
 
         m_postShaderSsao.SetShadowsEnabled( m_boardAdapter.m_Cfg->m_Render.raytrace_shadows );
 
-        std::atomic<size_t> nextBlock( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
-
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
-
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-        {
-            std::thread t = std::thread( [&]()
-            {
-                for( size_t y = nextBlock.fetch_add( 1 ); y < m_realBufferSize.y;
-                     y = nextBlock.fetch_add( 1 ) )
+        parallelRun( m_realBufferSize.y,
+                [&]( size_t y ) -> bool
                 {
                     SFVEC3F* ptr = &m_shaderBuffer[ y * m_realBufferSize.x ];
 
@@ -862,16 +709,9 @@ void RENDER_3D_RAYTRACE::postProcessShading( GLubyte* /* ptrPBO */, REPORTER* aS
                         *ptr = m_postShaderSsao.Shade( SFVEC2I( x, y ) );
                         ptr++;
                     }
-                }
-
-                threadsFinished++;
-            } );
-
-            t.detach();
-        }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+                    return true;
+                } );
 
         m_postShaderSsao.SetShadedBuffer( m_shaderBuffer );
 
@@ -886,24 +726,15 @@ void RENDER_3D_RAYTRACE::postProcessShading( GLubyte* /* ptrPBO */, REPORTER* aS
 }
 
 
-void RENDER_3D_RAYTRACE::postProcessBlurFinish( GLubyte* ptrPBO, REPORTER* /* aStatusReporter */ )
+void RENDER_3D_RAYTRACE_BASE::postProcessBlurFinish( uint8_t* ptrBuffer, REPORTER* /* aStatusReporter */ )
 {
     if( m_boardAdapter.m_Cfg->m_Render.raytrace_post_processing )
     {
         // Now blurs the shader result and compute the final color
-        std::atomic<size_t> nextBlock( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
-
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
-
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-        {
-            std::thread t = std::thread( [&]()
-            {
-                for( size_t y = nextBlock.fetch_add( 1 ); y < m_realBufferSize.y;
-                     y = nextBlock.fetch_add( 1 ) )
+        parallelRun( m_realBufferSize.y,
+                [&]( size_t y ) -> bool
                 {
-                    GLubyte* ptr = &ptrPBO[ y * m_realBufferSize.x * 4 ];
+                    uint8_t* ptr = &ptrBuffer[ y * m_realBufferSize.x * 4 ];
 
                     for( signed int x = 0; x < (int)m_realBufferSize.x; ++x )
                     {
@@ -923,16 +754,9 @@ void RENDER_3D_RAYTRACE::postProcessBlurFinish( GLubyte* ptrPBO, REPORTER* /* aS
 
                         ptr += 4;
                     }
-                }
-
-                threadsFinished++;
-            } );
 
-            t.detach();
-        }
-
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+                    return true;
+                } );
 
         // Debug code
         //m_postShaderSsao.DebugBuffersOutputAsImages();
@@ -943,23 +767,12 @@ void RENDER_3D_RAYTRACE::postProcessBlurFinish( GLubyte* ptrPBO, REPORTER* /* aS
 }
 
 
-void RENDER_3D_RAYTRACE::renderPreview( GLubyte* ptrPBO )
+void RENDER_3D_RAYTRACE_BASE::renderPreview( uint8_t* ptrBuffer )
 {
     m_isPreview = true;
 
-    std::atomic<size_t> nextBlock( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
-
-    size_t parallelThreadCount = std::min<size_t>(
-            std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-            m_blockPositions.size() );
-
-    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-    {
-        std::thread t = std::thread( [&]()
-        {
-            for( size_t iBlock = nextBlock.fetch_add( 1 ); iBlock < m_blockPositionsFast.size();
-                 iBlock = nextBlock.fetch_add( 1 ) )
+    parallelRun( m_blockPositionsFast.size(),
+            [&]( size_t iBlock ) -> bool
             {
                 const SFVEC2UI& windowPosUI = m_blockPositionsFast[ iBlock ];
                 const SFVEC2I windowsPos = SFVEC2I( windowPosUI.x + m_xoffset,
@@ -1496,8 +1309,8 @@ void RENDER_3D_RAYTRACE::renderPreview( GLubyte* ptrPBO )
                         }
 
                         // Set pixel colors
-                        GLubyte* ptr =
-                                &ptrPBO[( 4 * x + m_blockPositionsFast[iBlock].x
+                        uint8_t* ptr =
+                                &ptrBuffer[( 4 * x + m_blockPositionsFast[iBlock].x
                                           + m_realBufferSize.x
                                           * ( m_blockPositionsFast[iBlock].y + 4 * y ) ) * 4];
                         SetPixel( ptr + 0, cLT );
@@ -1524,24 +1337,17 @@ void RENDER_3D_RAYTRACE::renderPreview( GLubyte* ptrPBO )
                         SetPixel( ptr + 12, BlendColor( cRBC, BlendColor( cRB , cC ) ) );
                     }
                 }
-            }
-
-            threadsFinished++;
-        } );
-
-        t.detach();
-    }
 
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+                return true;
+            } );
 }
 
 
 #define USE_EXPERIMENTAL_SOFT_SHADOWS 1
 
-SFVEC3F RENDER_3D_RAYTRACE::shadeHit( const SFVEC3F& aBgColor, const RAY& aRay, HITINFO& aHitInfo,
-                                      bool aIsInsideObject, unsigned int aRecursiveLevel,
-                                      bool is_testShadow ) const
+SFVEC3F RENDER_3D_RAYTRACE_BASE::shadeHit( const SFVEC3F& aBgColor, const RAY& aRay, HITINFO& aHitInfo,
+                                           bool aIsInsideObject, unsigned int aRecursiveLevel,
+                                           bool is_testShadow ) const
 {
     const MATERIAL* objMaterial = aHitInfo.pHitObject->GetMaterial();
     wxASSERT( objMaterial != nullptr );
@@ -1800,49 +1606,6 @@ SFVEC3F RENDER_3D_RAYTRACE::shadeHit( const SFVEC3F& aBgColor, const RAY& aRay,
 }
 
 
-void RENDER_3D_RAYTRACE::initializeNewWindowSize()
-{
-    initPbo();
-}
-
-
-void RENDER_3D_RAYTRACE::initPbo()
-{
-    if( GLEW_ARB_pixel_buffer_object )
-    {
-        m_openglSupportsVertexBufferObjects = true;
-
-        // Try to delete vbo if it was already initialized
-        deletePbo();
-
-        // Learn about Pixel buffer objects at:
-        // http://www.songho.ca/opengl/gl_pbo.html
-        // http://web.eecs.umich.edu/~sugih/courses/eecs487/lectures/25-PBO+Mipmapping.pdf
-        // "create 2 pixel buffer objects, you need to delete them when program exits.
-        // glBufferDataARB with NULL pointer reserves only memory space."
-
-        // This sets the number of RGBA pixels
-        m_pboDataSize =  m_realBufferSize.x * m_realBufferSize.y * 4;
-
-        glGenBuffersARB( 1, &m_pboId );
-        glBindBufferARB( GL_PIXEL_UNPACK_BUFFER_ARB, m_pboId );
-        glBufferDataARB( GL_PIXEL_UNPACK_BUFFER_ARB, m_pboDataSize, 0, GL_STREAM_DRAW_ARB );
-        glBindBufferARB( GL_PIXEL_UNPACK_BUFFER_ARB, 0 );
-
-        wxLogTrace( m_logTrace,
-                    wxT( "RENDER_3D_RAYTRACE:: GLEW_ARB_pixel_buffer_object is supported" ) );
-    }
-}
-
-
-bool RENDER_3D_RAYTRACE::initializeOpenGL()
-{
-    m_is_opengl_initialized = true;
-
-    return true;
-}
-
-
 static float distance( const SFVEC2UI& a, const SFVEC2UI& b )
 {
     const float dx = (float) a.x - (float) b.x;
@@ -1851,7 +1614,7 @@ static float distance( const SFVEC2UI& a, const SFVEC2UI& b )
 }
 
 
-void RENDER_3D_RAYTRACE::initializeBlockPositions()
+void RENDER_3D_RAYTRACE_BASE::initializeBlockPositions()
 {
     m_realBufferSize = SFVEC2UI( 0 );
 
@@ -1919,12 +1682,10 @@ void RENDER_3D_RAYTRACE::initializeBlockPositions()
     // Create m_shader buffer
     delete[] m_shaderBuffer;
     m_shaderBuffer = new SFVEC3F[m_realBufferSize.x * m_realBufferSize.y];
-
-    initPbo();
 }
 
 
-BOARD_ITEM* RENDER_3D_RAYTRACE::IntersectBoardItem( const RAY& aRay )
+BOARD_ITEM* RENDER_3D_RAYTRACE_BASE::IntersectBoardItem( const RAY& aRay )
 {
     HITINFO hitInfo;
     hitInfo.m_tHit = std::numeric_limits<float>::infinity();
@@ -22,18 +22,20 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
-#ifndef RENDER_3D_RAYTRACE_H
-#define RENDER_3D_RAYTRACE_H
+#ifndef RENDER_3D_RAYTRACE_BASE_H
+#define RENDER_3D_RAYTRACE_BASE_H
 
-#include "../../common_ogl/openGL_includes.h"
 #include "accelerators/container_3d.h"
 #include "accelerators/accelerator_3d.h"
 #include "../render_3d_base.h"
 #include "light.h"
 #include "../post_shader_ssao.h"
 #include "material.h"
+#include "tile_scheduler.h"
 #include <plugins/3dapi/c3dmodel.h>
 
+#include <cstdint>
+#include <functional>
 #include <map>
 
 /// Vector of materials
@@ -52,19 +54,23 @@ typedef enum
 } RT_RENDER_STATE;
 
 
-class RENDER_3D_RAYTRACE : public RENDER_3D_BASE
+/**
+ * The CPU ray tracer, independent of where the rendered pixels end up.
+ *
+ * Derived classes provide the RGBA frame buffer the tracer writes into (an OpenGL pixel buffer
+ * object for the 3D viewer canvas, or plain memory for headless renders).
+ */
+class RENDER_3D_RAYTRACE_BASE : public RENDER_3D_BASE
 {
 public:
     // TODO: Take into account board thickness so that the camera won't move inside of the board
     // when facing it perpendicularly.
     static constexpr float MIN_DISTANCE_IU = 4 * PCB_IU_PER_MM;
 
-    explicit RENDER_3D_RAYTRACE( EDA_3D_CANVAS* aCanvas, BOARD_ADAPTER& aAdapter, CAMERA& aCamera );
+    explicit RENDER_3D_RAYTRACE_BASE( EDA_3D_CANVAS* aCanvas, BOARD_ADAPTER& aAdapter,
+                                      CAMERA& aCamera );
 
-    ~RENDER_3D_RAYTRACE();
-
-    void SetCurWindowSize( const wxSize& aSize ) override;
-    bool Redraw( bool aIsMoving, REPORTER* aStatusReporter, REPORTER* aWarningReporter ) override;
+    ~RENDER_3D_RAYTRACE_BASE();
 
     int GetWaitForEditingTimeOut() override;
 
@@ -73,21 +79,24 @@ public:
 
     BOARD_ITEM *IntersectBoardItem( const RAY& aRay );
 
-private:
-    bool initializeOpenGL();
-    void initializeNewWindowSize();
-    void initPbo();
-    void deletePbo();
+    /**
+     * Set the number of threads used to trace and post process a frame.
+     *
+     * @param aCount is the number of threads, or 0 to use all the available cores.
+     */
+    void SetThreadCount( size_t aCount ) { m_threadCount = aCount; }
+
+protected:
     void createItemsFromContainer( const BVH_CONTAINER_2D* aContainer2d, PCB_LAYER_ID aLayer_id,
                                    const MATERIAL* aMaterialLayer, const SFVEC3F& aLayerColor,
                                    float aLayerZOffset );
 
     void restartRenderState();
-    void renderTracing( GLubyte* ptrPBO, REPORTER* aStatusReporter );
-    void postProcessShading( GLubyte* ptrPBO, REPORTER* aStatusReporter );
-    void postProcessBlurFinish( GLubyte* ptrPBO, REPORTER* aStatusReporter );
-    void renderBlockTracing( GLubyte* ptrPBO , signed int iBlock );
-    void renderFinalColor( GLubyte* ptrPBO, const SFVEC3F& rgbColor,
+    void renderTracing( uint8_t* ptrBuffer, REPORTER* aStatusReporter );
+    void postProcessShading( uint8_t* ptrBuffer, REPORTER* aStatusReporter );
+    void postProcessBlurFinish( uint8_t* ptrBuffer, REPORTER* aStatusReporter );
+    void renderBlockTracing( uint8_t* ptrBuffer , signed int iBlock );
+    void renderFinalColor( uint8_t* ptrBuffer, const SFVEC3F& rgbColor,
                            bool applyColorSpaceConversion );
 
     void renderRayPackets( const SFVEC3F* bgColorY, const RAY* aRayPkt, HITINFO_PACKET* aHitPacket,
@@ -125,8 +134,19 @@ private:
 
     void initializeBlockPositions();
 
-    void render( GLubyte* ptrPBO, REPORTER* aStatusReporter );
-    void renderPreview( GLubyte* ptrPBO );
+    ///< Return the number of threads to render with.
+    size_t threadCount() const;
+
+    /**
+     * Call \a aWork for every index in [0, aCount) from the thread pool, balancing the load
+     * between the workers with m_tileScheduler.
+     *
+     * @param aWork returns false to stop all the workers before the end of the pass.
+     */
+    void parallelRun( size_t aCount, const std::function<bool( size_t )>& aWork );
+
+    void render( uint8_t* ptrBuffer, REPORTER* aStatusReporter );
+    void renderPreview( uint8_t* ptrBuffer );
 
     struct
     {
@@ -165,11 +185,6 @@ private:
 
     DIRECTIONAL_LIGHT* m_cameraLight;
 
-    bool m_openglSupportsVertexBufferObjects;
-
-    GLuint m_pboId;
-    GLuint m_pboDataSize;
-
     CONTAINER_3D m_objectContainer;
 
     ///< Store the list of created objects special for RT that will be clear in the end.
@@ -209,6 +224,11 @@ private:
     /// Stores materials of the 3D models
     MAP_MODEL_MATERIALS m_modelMaterialMap;
 
+    ///< Number of threads to render with (0 for all the available cores).
+    size_t m_threadCount;
+
+    TILE_SCHEDULER m_tileScheduler;
+
     // Statistics
     unsigned int m_convertedDummyBlockCount;
     unsigned int m_converted2dRoundSegmentCount;
@@ -222,4 +242,4 @@ extern SFVEC3F ConvertSRGBToLinear( const SFVEC3F& aSRGBcolor );
 #define ConvertSRGBToLinear( v ) ( v )
 #endif
 
-#endif // RENDER_3D_RAYTRACE_H
+#endif // RENDER_3D_RAYTRACE_BASE_H
@@ -0,0 +1,159 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+
+#include "render_3d_raytrace_ram.h"
+#include <profile.h>
+#include <reporter.h>
+#include <wx/log.h>
+
+
+RENDER_3D_RAYTRACE_RAM::RENDER_3D_RAYTRACE_RAM( BOARD_ADAPTER& aAdapter, CAMERA& aCamera ) :
+        RENDER_3D_RAYTRACE_BASE( nullptr, aAdapter, aCamera )
+{
+    wxLogTrace( m_logTrace, wxT( "RENDER_3D_RAYTRACE_RAM::RENDER_3D_RAYTRACE_RAM" ) );
+}
+
+
+void RENDER_3D_RAYTRACE_RAM::SetCurWindowSize( const wxSize& aSize )
+{
+    if( m_windowSize != aSize )
+    {
+        m_windowSize = aSize;
+        m_oldWindowsSize = m_windowSize;
+
+        initializeBlockPositions();
+
+        m_buffer.assign( (size_t) m_realBufferSize.x * m_realBufferSize.y * 4, 0 );
+        m_renderState = RT_RENDER_STATE_MAX;
+    }
+}
+
+
+bool RENDER_3D_RAYTRACE_RAM::Redraw( bool aIsMoving, REPORTER* aStatusReporter,
+                                     REPORTER* aWarningReporter )
+{
+    m_timings = TIMINGS();
+
+    if( m_buffer.empty() )
+        return false;
+
+    std::unique_ptr<BUSY_INDICATOR> busy = CreateBusyIndicator();
+
+    if( m_reloadRequested )
+    {
+        if( aStatusReporter )
+            aStatusReporter->Report( _( "Loading..." ) );
+
+        PROF_TIMER timer;
+
+        Reload( aStatusReporter, aWarningReporter, false );
+        m_timings.m_reload = timer.msecs();
+    }
+
+    // Always start a new frame
+    m_renderState = RT_RENDER_STATE_MAX;
+
+    do
+    {
+        // A finished (or invalid) state restarts with the tracing pass
+        RT_RENDER_STATE phase = m_renderState;
+
+        if( phase >= RT_RENDER_STATE_FINISH )
+            phase = RT_RENDER_STATE_TRACING;
+
+        PROF_TIMER timer;
+
+        render( m_buffer.data(), aStatusReporter );
+
+        switch( phase )
+        {
+        case RT_RENDER_STATE_TRACING:
+            m_timings.m_tracing += timer.msecs();
+            break;
+
+        case RT_RENDER_STATE_POST_PROCESS_SHADE:
+            m_timings.m_postProcessShading += timer.msecs();
+            break;
+
+        default:
+            m_timings.m_postProcessBlurFinish += timer.msecs();
+            break;
+        }
+    } while( m_renderState != RT_RENDER_STATE_FINISH );
+
+    return false;
+}
+
+
+wxImage RENDER_3D_RAYTRACE_RAM::GetImage() const
+{
+    wxImage image( m_windowSize.x, m_windowSize.y, false );
+    unsigned char* rgb = image.GetData();
+
+    // Fill with the same vertical gradient the 3D viewer draws behind the traced area
+    for( int y = 0; y < m_windowSize.y; ++y )
+    {
+        const float   f = (float) y / (float) std::max( m_windowSize.y - 1, 1 );
+        const SFVEC4F color = m_boardAdapter.m_BgColorTop * ( 1.0f - f )
+                              + m_boardAdapter.m_BgColorBot * f;
+
+        unsigned char* ptr = &rgb[(size_t) y * m_windowSize.x * 3];
+
+        for( int x = 0; x < m_windowSize.x; ++x )
+        {
+            *ptr++ = (unsigned char) glm::clamp( color.r * 255.0f, 0.0f, 255.0f );
+            *ptr++ = (unsigned char) glm::clamp( color.g * 255.0f, 0.0f, 255.0f );
+            *ptr++ = (unsigned char) glm::clamp( color.b * 255.0f, 0.0f, 255.0f );
+        }
+    }
+
+    if( m_buffer.empty() )
+        return image;
+
+    // The traced buffer is stored bottom row first, as glDrawPixels expects it
+    for( unsigned int y = 0; y < m_realBufferSize.y; ++y )
+    {
+        const int dstY = m_windowSize.y - 1 - (int) ( y + m_yoffset );
+
+        if( dstY < 0 || dstY >= m_windowSize.y )
+            continue;
+
+        const uint8_t* src = &m_buffer[(size_t) y * m_realBufferSize.x * 4];
+        unsigned char* dst = &rgb[( (size_t) dstY * m_windowSize.x + m_xoffset ) * 3];
+
+        const unsigned int width = std::min( m_realBufferSize.x,
+                                             (unsigned int) m_windowSize.x - m_xoffset );
+
+        for( unsigned int x = 0; x < width; ++x )
+        {
+            *dst++ = src[0];
+            *dst++ = src[1];
+            *dst++ = src[2];
+            src += 4;
+        }
+    }
+
+    return image;
+}
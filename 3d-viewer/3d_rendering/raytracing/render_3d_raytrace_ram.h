@@ -0,0 +1,75 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef RENDER_3D_RAYTRACE_RAM_H
+#define RENDER_3D_RAYTRACE_RAM_H
+
+#include "render_3d_raytrace_base.h"
+
+#include <wx/image.h>
+
+
+/**
+ * Ray tracer rendering into memory, for use without an OpenGL context (e.g. from kicad-cli).
+ */
+class RENDER_3D_RAYTRACE_RAM : public RENDER_3D_RAYTRACE_BASE
+{
+public:
+    ///< Time spent in each phase of the last render, in milliseconds.
+    struct TIMINGS
+    {
+        double m_reload = 0.0;
+        double m_tracing = 0.0;
+        double m_postProcessShading = 0.0;
+        double m_postProcessBlurFinish = 0.0;
+    };
+
+    explicit RENDER_3D_RAYTRACE_RAM( BOARD_ADAPTER& aAdapter, CAMERA& aCamera );
+
+    void SetCurWindowSize( const wxSize& aSize ) override;
+
+    /**
+     * Render a full quality frame.
+     *
+     * Unlike the OpenGL renderer this does not return until the frame is finished, so
+     * \a aIsMoving is ignored.
+     *
+     * @return false (a further redraw is never needed).
+     */
+    bool Redraw( bool aIsMoving, REPORTER* aStatusReporter = nullptr,
+                 REPORTER* aWarningReporter = nullptr ) override;
+
+    /**
+     * @return the last rendered frame, the size of the window and with the background
+     *         gradient around the traced area.
+     */
+    wxImage GetImage() const;
+
+    const TIMINGS& GetTimings() const { return m_timings; }
+
+private:
+    std::vector<uint8_t> m_buffer;      ///< RGBA, bottom to top rows like an OpenGL buffer.
+    TIMINGS              m_timings;
+};
+
+#endif // RENDER_3D_RAYTRACE_RAM_H
@@ -0,0 +1,116 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file  tile_scheduler.cpp
+ */
+
+#include "tile_scheduler.h"
+
+#include <algorithm>
+
+
+void TILE_SCHEDULER::Reset( size_t aCount, size_t aWorkerCount )
+{
+    aWorkerCount = std::max<size_t>( aWorkerCount, 1 );
+
+    if( aWorkerCount > m_capacity )
+    {
+        m_ranges.reset( new std::atomic<uint64_t>[aWorkerCount] );
+        m_capacity = aWorkerCount;
+    }
+
+    m_workerCount = aWorkerCount;
+
+    for( size_t ii = 0; ii < m_workerCount; ++ii )
+    {
+        const uint32_t begin = (uint32_t) ( aCount * ii / m_workerCount );
+        const uint32_t end = (uint32_t) ( aCount * ( ii + 1 ) / m_workerCount );
+
+        m_ranges[ii].store( pack( begin, end ), std::memory_order_relaxed );
+    }
+
+    std::atomic_thread_fence( std::memory_order_release );
+}
+
+
+bool TILE_SCHEDULER::Next( size_t aWorker, size_t& aIndex )
+{
+    std::atomic<uint64_t>& range = m_ranges[aWorker];
+
+    while( true )
+    {
+        uint64_t       current = range.load( std::memory_order_acquire );
+        const uint32_t begin = (uint32_t) ( current >> 32 );
+        const uint32_t end = (uint32_t) current;
+
+        if( begin >= end )
+        {
+            if( !steal( aWorker ) )
+                return false;
+
+            continue;
+        }
+
+        // Thieves may shrink the range from the back at the same time, so take from the front
+        // only if it did not change since it was read.
+        if( range.compare_exchange_weak( current, pack( begin + 1, end ),
+                                         std::memory_order_acq_rel ) )
+        {
+            aIndex = begin;
+            return true;
+        }
+    }
+}
+
+
+bool TILE_SCHEDULER::steal( size_t aThief )
+{
+    for( size_t ii = 1; ii < m_workerCount; ++ii )
+    {
+        std::atomic<uint64_t>& victim = m_ranges[( aThief + ii ) % m_workerCount];
+        uint64_t               current = victim.load( std::memory_order_acquire );
+
+        while( true )
+        {
+            const uint32_t begin = (uint32_t) ( current >> 32 );
+            const uint32_t end = (uint32_t) current;
+
+            if( begin >= end )
+                break;
+
+            // Take the back half, or the last tile
+            const uint32_t mid = begin + ( end - begin ) / 2;
+
+            if( victim.compare_exchange_weak( current, pack( begin, mid ),
+                                              std::memory_order_acq_rel ) )
+            {
+                // Nobody else writes to an empty range, so a plain store is enough
+                m_ranges[aThief].store( pack( mid, end ), std::memory_order_release );
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,87 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file  tile_scheduler.h
+ * @brief Distributes the tiles of a render pass between worker threads.
+ */
+
+#ifndef TILE_SCHEDULER_H
+#define TILE_SCHEDULER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+/**
+ * Work stealing scheduler for the indices [0, count) of a render pass.
+ *
+ * Each worker starts with an equal, contiguous share of the indices and takes them one by one
+ * from the front.  A worker that runs out steals the back half of the remaining range of
+ * another worker, so the ranges get subdivided further only where the tiles are expensive.
+ *
+ * The ranges are packed in a single atomic so no locking is needed.
+ */
+class TILE_SCHEDULER
+{
+public:
+    TILE_SCHEDULER() :
+            m_workerCount( 0 ),
+            m_capacity( 0 )
+    {}
+
+    /**
+     * Split the indices [0, aCount) between \a aWorkerCount workers.
+     *
+     * Must not be called while a pass is running.
+     */
+    void Reset( size_t aCount, size_t aWorkerCount );
+
+    /**
+     * Get the next index to process by a worker.
+     *
+     * @param aWorker is the worker asking for work, in [0, worker count).
+     * @param aIndex receives the index to process.
+     * @return false when there is no work left.
+     */
+    bool Next( size_t aWorker, size_t& aIndex );
+
+    size_t GetWorkerCount() const { return m_workerCount; }
+
+private:
+    static uint64_t pack( uint32_t aBegin, uint32_t aEnd )
+    {
+        return ( (uint64_t) aBegin << 32 ) | aEnd;
+    }
+
+    ///< Move part of the remaining work of another worker to \a aThief.
+    bool steal( size_t aThief );
+
+    std::unique_ptr<std::atomic<uint64_t>[]> m_ranges;    ///< [begin, end) of each worker
+    size_t                                   m_workerCount;
+    size_t                                   m_capacity;
+};
+
+#endif // TILE_SCHEDULER_H
@@ -95,6 +95,12 @@ static const wxChar HoleWallThickness[] = wxT( "HoleWallPlatingThickness" );
  */
 static const wxChar RealtimeConnectivity[] = wxT( "RealtimeConnectivity" );
 
+/**
+ * Update only the nets touched by an edit instead of rebuilding the whole schematic
+ * connectivity graph after each change.
+ */
+static const wxChar IncrementalConnectivity[] = wxT( "IncrementalConnectivity" );
+
 /**
  * Configure the coroutine stack size in bytes.  This should be allocated in multiples of
  * the system page size (n*4096 is generally safe)
@@ -198,6 +204,12 @@ static const wxChar V3DRT_BevelHeight_um[] = wxT( "V3DRT_BevelHeight_um" );
 static const wxChar V3DRT_BevelExtentFactor[] = wxT( "V3DRT_BevelExtentFactor" );
 
 static const wxChar UseClipper2[] = wxT( "UseClipper2" );
+
+/**
+ * Maximum memory (in MB) used by the item copies stored in each of the undo and redo lists
+ * (0 for no limit).  The oldest commands are dropped when it is exceeded.
+ */
+static const wxChar MaxUndoMemory[] = wxT( "MaxUndoMemory" );
 } // namespace KEYS
 
 
@@ -285,6 +297,7 @@ ADVANCED_CFG::ADVANCED_CFG()
     // Init defaults - this is done in case the config doesn't exist,
     // then the values will remain as set here.
     m_RealTimeConnectivity      = true;
+    m_IncrementalConnectivity   = true;
     m_CoroutineStackSize        = AC_STACK::default_stack;
     m_ShowRouterDebugGraphics   = false;
     m_DrawArcAccuracy           = 10.0;
@@ -327,6 +340,8 @@ ADVANCED_CFG::ADVANCED_CFG()
 
     m_UseClipper2               = false;
 
+    m_MaxUndoMemory             = 1024;
+
     loadFromConfigFile();
 }
 
@@ -371,6 +386,10 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
     configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::RealtimeConnectivity,
                                                 &m_RealTimeConnectivity, m_RealTimeConnectivity ) );
 
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::IncrementalConnectivity,
+                                                &m_IncrementalConnectivity,
+                                                m_IncrementalConnectivity ) );
+
     configParams.push_back( new PARAM_CFG_DOUBLE( true, AC_KEYS::ExtraFillMargin,
                                                   &m_ExtraClearance, m_ExtraClearance, 0.0, 1.0 ) );
 
@@ -469,6 +488,10 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
     configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::UseClipper2,
                                                 &m_UseClipper2, m_UseClipper2 ) );
 
+    configParams.push_back( new PARAM_CFG_INT( true, AC_KEYS::MaxUndoMemory,
+                                               &m_MaxUndoMemory, m_MaxUndoMemory,
+                                               0, std::numeric_limits<int>::max() ) );
+
 
 
     // Special case for trace mask setting...we just grab them and set them immediately
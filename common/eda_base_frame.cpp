@@ -23,6 +23,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <advanced_config.h>
 #include <bitmaps.h>
 #include <bitmap_store.h>
 #include <dialog_shim.h>
@@ -1294,6 +1295,8 @@ void EDA_BASE_FRAME::PushCommandToUndoList( PICKED_ITEMS_LIST* aNewitem )
         if( extraitems > 0 )
             ClearUndoORRedoList( UNDO_LIST, extraitems );
     }
+
+    trimUndoRedoListMemory( UNDO_LIST );
 }
 
 
@@ -1309,6 +1312,41 @@ void EDA_BASE_FRAME::PushCommandToRedoList( PICKED_ITEMS_LIST* aNewitem )
         if( extraitems > 0 )
             ClearUndoORRedoList( REDO_LIST, extraitems );
     }
+
+    trimUndoRedoListMemory( REDO_LIST );
+}
+
+
+size_t EDA_BASE_FRAME::GetUndoRedoMemoryUsage( UNDO_REDO_LIST aList ) const
+{
+    const UNDO_REDO_CONTAINER& list = aList == UNDO_LIST ? m_undoList : m_redoList;
+
+    return list.GetMemoryUsage( [&]( const EDA_ITEM* aItem )
+                                {
+                                    return GetUndoRedoItemMemoryUsage( aItem );
+                                } );
+}
+
+
+void EDA_BASE_FRAME::trimUndoRedoListMemory( UNDO_REDO_LIST aList )
+{
+    size_t maxMemory = (size_t) ADVANCED_CFG::GetCfg().m_MaxUndoMemory * 1024 * 1024;
+
+    if( maxMemory == 0 )
+        return;
+
+    const UNDO_REDO_CONTAINER& list = aList == UNDO_LIST ? m_undoList : m_redoList;
+
+    auto itemSize =
+            [&]( const EDA_ITEM* aItem )
+            {
+                return GetUndoRedoItemMemoryUsage( aItem );
+            };
+
+    int extraitems = list.GetCommandCountOverMemory( maxMemory, itemSize );
+
+    if( extraitems > 0 )
+        ClearUndoORRedoList( aList, extraitems );
 }
 
 
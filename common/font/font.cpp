@@ -24,6 +24,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <mutex>
+
 #include <wx/font.h>
 #include <string_utils.h>
 #include <gal/graphics_abstraction_layer.h>
@@ -47,6 +49,10 @@ FONT* FONT::s_defaultFont = nullptr;
 
 std::map< std::tuple<wxString, bool, bool>, FONT*> FONT::s_fontMap;
 
+// Fonts are looked up from worker threads too (e.g. when loading schematic sheets in
+// parallel).  This guards s_fontMap and s_defaultFont, and serializes the font loading.
+static std::mutex s_fontMapMutex;
+
 
 FONT::FONT()
 {
@@ -64,6 +70,8 @@ FONT* FONT::getDefaultFont()
 
 FONT* FONT::GetFont( const wxString& aFontName, bool aBold, bool aItalic )
 {
+    std::lock_guard<std::mutex> lock( s_fontMapMutex );
+
     if( aFontName.empty() || aFontName.StartsWith( KICAD_FONT_NAME ) )
         return getDefaultFont();
 
@@ -313,6 +313,96 @@ double OUTLINE_FONT::getOverbarOffset( int ascender, int height, int thickness )
 }
 
 
+std::shared_ptr<const OUTLINE_GLYPH>
+OUTLINE_FONT::getCachedGlyph( unsigned int aGlyphIndex, double aScaler,
+                              TEXT_STYLE_FLAGS aTextStyle ) const
+{
+    int offsetType = 0;
+
+    if( IsSubscript( aTextStyle ) )
+        offsetType = 1;
+    else if( IsSuperscript( aTextStyle ) )
+        offsetType = 2;
+
+    GLYPH_CACHE_KEY key( aGlyphIndex, KiROUND( aScaler ), offsetType );
+
+    std::lock_guard<std::mutex> lock( m_glyphCacheLock );
+
+    auto it = m_glyphCache.find( key );
+
+    if( it != m_glyphCache.end() )
+        return it->second;
+
+    // Other texts may have changed the char size since the glyph was shaped
+    FT_Set_Char_Size( m_face, 0, aScaler, GLYPH_RESOLUTION, 0 );
+    FT_Load_Glyph( m_face, aGlyphIndex, FT_LOAD_NO_BITMAP );
+
+    // contours is a collection of all outlines in the glyph; for example the 'o' glyph
+    // generally contains 2 contours, one for the glyph outline and one for the hole
+    CONTOURS contours;
+
+    OUTLINE_DECOMPOSER decomposer( m_face->glyph->outline );
+    decomposer.OutlineToSegments( &contours );
+
+    std::shared_ptr<OUTLINE_GLYPH> glyph = std::make_shared<OUTLINE_GLYPH>();
+    std::vector<SHAPE_LINE_CHAIN>  holes;
+
+    for( CONTOUR& c : contours )
+    {
+        SHAPE_LINE_CHAIN shape;
+
+        for( const VECTOR2D& v : c.m_Points )
+        {
+            VECTOR2D pt( v );
+
+            if( IsSubscript( aTextStyle ) )
+                pt.y += m_subscriptVerticalOffset * aScaler;
+            else if( IsSuperscript( aTextStyle ) )
+                pt.y += m_superscriptVerticalOffset * aScaler;
+
+            pt *= m_glyphCacheScale;
+
+            shape.Append( KiROUND( pt.x ), KiROUND( pt.y ) );
+        }
+
+        shape.SetClosed( true );
+
+        if( contourIsHole( c ) )
+            holes.push_back( std::move( shape ) );
+        else
+            glyph->AddOutline( std::move( shape ) );
+    }
+
+    for( SHAPE_LINE_CHAIN& hole : holes )
+    {
+        if( hole.PointCount() )
+        {
+            for( int ii = 0; ii < glyph->OutlineCount(); ++ii )
+            {
+                if( glyph->Outline( ii ).PointInside( hole.GetPoint( 0 ) ) )
+                {
+                    glyph->AddHole( std::move( hole ), ii );
+                    break;
+                }
+            }
+        }
+    }
+
+    // FONT TODO we might not want to do Fracture() here;
+    // knockout text (eg. silkscreen labels with a background) will
+    // need to do that after the contours have been turned into holes
+    // and vice versa
+    if( glyph->HasHoles() )
+        glyph->Fracture( SHAPE_POLY_SET::PM_FAST ); // FONT TODO verify aFastMode
+
+    glyph->CacheTriangulation( false );
+
+    m_glyphCache.emplace( key, glyph );
+
+    return glyph;
+}
+
+
 VECTOR2I OUTLINE_FONT::getTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_ptr<GLYPH>>* aGlyphs,
                                         const wxString& aText, const VECTOR2I& aSize,
                                         const VECTOR2I& aPosition, const EDA_ANGLE& aAngle,
@@ -328,9 +418,6 @@ VECTOR2I OUTLINE_FONT::getTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_pt
         scaler = subscriptSize();
     }
 
-    // set glyph resolution so that FT_Load_Glyph() results are good enough for decomposing
-    FT_Set_Char_Size( face, 0, scaler, GLYPH_RESOLUTION, 0 );
-
     hb_buffer_t* buf = hb_buffer_create();
     hb_buffer_add_utf8( buf, aText.c_str(), -1, 0, -1 );
     hb_buffer_guess_segment_properties( buf );  // guess direction, script, and language based on
@@ -340,9 +427,24 @@ VECTOR2I OUTLINE_FONT::getTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_pt
     hb_glyph_info_t*     glyphInfo = hb_buffer_get_glyph_infos( buf, &glyphCount );
     hb_glyph_position_t* glyphPos = hb_buffer_get_glyph_positions( buf, &glyphCount );
 
-    hb_font_t* referencedFont = hb_ft_font_create_referenced( face );
-    hb_ft_font_set_funcs( referencedFont );
-    hb_shape( referencedFont, buf, nullptr, 0 );
+    hb_font_t*      referencedFont;
+    FT_Size_Metrics metrics;
+
+    {
+        // The face is shared by all the threads drawing with this font: the char size must not
+        // change while it is used for shaping
+        std::lock_guard<std::mutex> lock( m_glyphCacheLock );
+
+        // set glyph resolution so that FT_Load_Glyph() results are good enough for decomposing
+        FT_Set_Char_Size( face, 0, scaler, GLYPH_RESOLUTION, 0 );
+
+        // The HarfBuzz font takes its scale from the current char size of the face
+        referencedFont = hb_ft_font_create_referenced( face );
+        hb_ft_font_set_funcs( referencedFont );
+        hb_shape( referencedFont, buf, nullptr, 0 );
+
+        metrics = face->size->metrics;
+    }
 
     VECTOR2D scaleFactor( glyphSize.x / faceSize(), -glyphSize.y / faceSize() );
     scaleFactor = scaleFactor * m_outlineFontSizeCompensation;
@@ -357,73 +459,34 @@ VECTOR2I OUTLINE_FONT::getTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_pt
 
         if( aGlyphs )
         {
-            FT_Load_Glyph( face, glyphInfo[i].codepoint, FT_LOAD_NO_BITMAP );
-
-            // contours is a collection of all outlines in the glyph; for example the 'o' glyph
-            // generally contains 2 contours, one for the glyph outline and one for the hole
-            CONTOURS contours;
+            std::shared_ptr<const OUTLINE_GLYPH> cachedGlyph =
+                    getCachedGlyph( glyphInfo[i].codepoint, scaler, aTextStyle );
 
-            OUTLINE_DECOMPOSER decomposer( face->glyph->outline );
-            decomposer.OutlineToSegments( &contours );
+            // Copying the cached glyph also copies its triangulation, which survives the
+            // (affine) placement below
+            std::unique_ptr<OUTLINE_GLYPH> glyph = std::make_unique<OUTLINE_GLYPH>( *cachedGlyph );
+            VECTOR2D                       glyphScale = scaleFactor * ( 1.0 / m_glyphCacheScale );
+            VECTOR2D                       glyphOffset( cursor );
 
-            std::unique_ptr<OUTLINE_GLYPH> glyph = std::make_unique<OUTLINE_GLYPH>();
-            std::vector<SHAPE_LINE_CHAIN>  holes;
+            glyphOffset *= scaleFactor;
+            glyphOffset += aPosition;
 
-            for( CONTOUR& c : contours )
-            {
-                GLYPH_POINTS     points = c.m_Points;
-                SHAPE_LINE_CHAIN shape;
-
-                for( const VECTOR2D& v : points )
-                {
-                    VECTOR2D pt( v + cursor );
-
-                    if( IsSubscript( aTextStyle ) )
-                        pt.y += m_subscriptVerticalOffset * scaler;
-                    else if( IsSuperscript( aTextStyle ) )
-                        pt.y += m_superscriptVerticalOffset * scaler;
-
-                    pt *= scaleFactor;
-                    pt += aPosition;
-
-                    if( aMirror )
-                        pt.x = aOrigin.x - ( pt.x - aOrigin.x );
-
-                    if( !aAngle.IsZero() )
-                        RotatePoint( pt, aOrigin, aAngle );
-
-                    shape.Append( pt.x, pt.y );
-                }
+            glyph->TransformVertices(
+                    [&]( const VECTOR2I& aPt ) -> VECTOR2I
+                    {
+                        VECTOR2D pt( aPt );
 
-                shape.SetClosed( true );
+                        pt *= glyphScale;
+                        pt += glyphOffset;
 
-                if( contourIsHole( c ) )
-                    holes.push_back( std::move( shape ) );
-                else
-                    glyph->AddOutline( std::move( shape ) );
-            }
+                        if( aMirror )
+                            pt.x = aOrigin.x - ( pt.x - aOrigin.x );
 
-            for( SHAPE_LINE_CHAIN& hole : holes )
-            {
-                if( hole.PointCount() )
-                {
-                    for( int ii = 0; ii < glyph->OutlineCount(); ++ii )
-                    {
-                        if( glyph->Outline( ii ).PointInside( hole.GetPoint( 0 ) ) )
-                        {
-                            glyph->AddHole( std::move( hole ), ii );
-                            break;
-                        }
-                    }
-                }
-            }
+                        if( !aAngle.IsZero() )
+                            RotatePoint( pt, aOrigin, aAngle );
 
-            // FONT TODO we might not want to do Fracture() here;
-            // knockout text (eg. silkscreen labels with a background) will
-            // need to do that after the contours have been turned into holes
-            // and vice versa
-            if( glyph->HasHoles() )
-                glyph->Fracture( SHAPE_POLY_SET::PM_FAST ); // FONT TODO verify aFastMode
+                        return VECTOR2I( KiROUND( pt.x ), KiROUND( pt.y ) );
+                    } );
 
             aGlyphs->push_back( std::move( glyph ) );
         }
@@ -433,9 +496,9 @@ VECTOR2I OUTLINE_FONT::getTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_pt
         cursor.y += ( pos.y_advance * GLYPH_SIZE_SCALER );
     }
 
-    int      ascender = abs( face->size->metrics.ascender * GLYPH_SIZE_SCALER );
-    int      height = abs( face->size->metrics.height * GLYPH_SIZE_SCALER );
-    int      descender = abs( face->size->metrics.descender * GLYPH_SIZE_SCALER );
+    int      ascender = abs( metrics.ascender * GLYPH_SIZE_SCALER );
+    int      height = abs( metrics.height * GLYPH_SIZE_SCALER );
+    int      descender = abs( metrics.descender * GLYPH_SIZE_SCALER );
     VECTOR2I extents( cursor.x * scaleFactor.x, ( ascender + descender ) * abs( scaleFactor.y ) );
 
     // Font metrics don't include all descenders and diacriticals, so beef them up just a little.
@@ -55,15 +55,26 @@ static constexpr double STROKE_FONT_SCALE = 1.0 / 21.0;
 static constexpr int FONT_OFFSET = -10;
 
 
-bool                                g_defaultFontInitialized = false;
-std::vector<std::shared_ptr<GLYPH>> g_defaultFontGlyphs;
-std::vector<BOX2D>*                 g_defaultFontGlyphBoundingBoxes;
-std::mutex                          g_defaultFontLoadMutex;
+/**
+ * A glyph of the default font, decoded from the newstroke data the first time it is used.
+ *
+ * The font has tens of thousands of glyphs and most processes (kicad-cli for instance) only
+ * draw a few of them, if any, so decoding the whole font up-front is a waste of startup time.
+ */
+struct DEFAULT_FONT_GLYPH
+{
+    std::once_flag                m_decoded;
+    std::unique_ptr<STROKE_GLYPH> m_glyph;
+};
+
+
+std::unique_ptr<DEFAULT_FONT_GLYPH[]> g_defaultFontGlyphs;
+std::once_flag                        g_defaultFontInitialized;
 
 
 STROKE_FONT::STROKE_FONT() :
-        m_glyphs( nullptr ),
-        m_glyphBoundingBoxes( nullptr ),
+        m_glyphData( nullptr ),
+        m_glyphCount( 0 ),
         m_maxGlyphWidth( 0.0 )
 {
 }
@@ -85,7 +96,7 @@ STROKE_FONT* STROKE_FONT::LoadFont( const wxString& aFontName )
 }
 
 
-void buildGlyphBoundingBox( std::shared_ptr<STROKE_GLYPH>& aGlyph, double aGlyphWidth )
+void buildGlyphBoundingBox( std::unique_ptr<STROKE_GLYPH>& aGlyph, double aGlyphWidth )
 {
     VECTOR2D min( 0, 0 );
     VECTOR2D max( aGlyphWidth, 0 );
@@ -105,97 +116,112 @@ void buildGlyphBoundingBox( std::shared_ptr<STROKE_GLYPH>& aGlyph, double aGlyph
 
 void STROKE_FONT::loadNewStrokeFont( const char* const aNewStrokeFont[], int aNewStrokeFontSize )
 {
-    // Protect the initialization sequence against multiple entries
-    std::lock_guard<std::mutex> lock( g_defaultFontLoadMutex );
-
-    if( !g_defaultFontInitialized )
+    // Glyphs are decoded on demand by getGlyph(); only allocate their slots here
+    std::call_once( g_defaultFontInitialized,
+                    [&]()
+                    {
+                        g_defaultFontGlyphs.reset( new DEFAULT_FONT_GLYPH[aNewStrokeFontSize] );
+                    } );
+
+    m_glyphData = aNewStrokeFont;
+    m_glyphCount = aNewStrokeFontSize;
+
+    // The first two values of a glyph contain its horizontal extents
+    for( int j = 0; j < aNewStrokeFontSize; j++ )
     {
-        g_defaultFontGlyphs.reserve( aNewStrokeFontSize );
+        double glyphWidth = ( aNewStrokeFont[j][1] - aNewStrokeFont[j][0] ) * STROKE_FONT_SCALE;
+        m_maxGlyphWidth = std::max( m_maxGlyphWidth, glyphWidth );
+    }
 
-        g_defaultFontGlyphBoundingBoxes = new std::vector<BOX2D>;
-        g_defaultFontGlyphBoundingBoxes->reserve( aNewStrokeFontSize );
+    m_fontName = KICAD_FONT_NAME;
+    m_fontFileName = wxEmptyString;
+}
 
-        for( int j = 0; j < aNewStrokeFontSize; j++ )
-        {
-            std::shared_ptr<STROKE_GLYPH> glyph = std::make_shared<STROKE_GLYPH>();
 
-            double glyphStartX = 0.0;
-            double glyphEndX = 0.0;
-            double glyphWidth = 0.0;
-            int    strokes = 0;
-            int    i = 0;
+STROKE_GLYPH* STROKE_FONT::getGlyph( int aIndex ) const
+{
+    DEFAULT_FONT_GLYPH& slot = g_defaultFontGlyphs[aIndex];
 
-            while( aNewStrokeFont[j][i] )
-            {
+    std::call_once( slot.m_decoded,
+                    [&]()
+                    {
+                        slot.m_glyph = decodeGlyph( m_glyphData[aIndex] );
+                    } );
 
-                if( aNewStrokeFont[j][i] == ' ' && aNewStrokeFont[j][i+1] == 'R' )
-                    strokes++;
+    return slot.m_glyph.get();
+}
 
-                i += 2;
-            }
 
-            glyph->reserve( strokes + 1 );
+std::unique_ptr<STROKE_GLYPH> STROKE_FONT::decodeGlyph( const char* aGlyphData )
+{
+    std::unique_ptr<STROKE_GLYPH> glyph = std::make_unique<STROKE_GLYPH>();
 
-            i = 0;
+    double glyphStartX = 0.0;
+    double glyphEndX = 0.0;
+    double glyphWidth = 0.0;
+    int    strokes = 0;
+    int    i = 0;
 
-            while( aNewStrokeFont[j][i] )
-            {
-                VECTOR2D point( 0.0, 0.0 );
-                char     coordinate[2] = { 0, };
-
-                for( int k : { 0, 1 } )
-                    coordinate[k] = aNewStrokeFont[j][i + k];
-
-                if( i < 2 )
-                {
-                    // The first two values contain the width of the char
-                    glyphStartX = ( coordinate[0] - 'R' ) * STROKE_FONT_SCALE;
-                    glyphEndX   = ( coordinate[1] - 'R' ) * STROKE_FONT_SCALE;
-                    glyphWidth  = glyphEndX - glyphStartX;
-                }
-                else if( ( coordinate[0] == ' ' ) && ( coordinate[1] == 'R' ) )
-                {
-                    glyph->RaisePen();
-                }
-                else
-                {
-                    // In stroke font, coordinates values are coded as <value> + 'R', where
-                    // <value> is an ASCII char.
-                    // therefore every coordinate description of the Hershey format has an offset,
-                    // it has to be subtracted
-                    // Note:
-                    //  * the stroke coordinates are stored in reduced form (-1.0 to +1.0),
-                    //    and the actual size is stroke coordinate * glyph size
-                    //  * a few shapes have a height slightly bigger than 1.0 ( like '{' '[' )
-                    point.x = (double) ( coordinate[0] - 'R' ) * STROKE_FONT_SCALE - glyphStartX;
-
-                    // FONT_OFFSET is here for historical reasons, due to the way the stroke font
-                    // was built. It allows shapes coordinates like W M ... to be >= 0
-                    // Only shapes like j y have coordinates < 0
-                    point.y = (double) ( coordinate[1] - 'R' + FONT_OFFSET ) * STROKE_FONT_SCALE;
-
-                    glyph->AddPoint( point );
-                }
-
-                i += 2;
-            }
+    while( aGlyphData[i] )
+    {
+        if( aGlyphData[i] == ' ' && aGlyphData[i+1] == 'R' )
+            strokes++;
+
+        i += 2;
+    }
 
-            glyph->Finalize();
+    glyph->reserve( strokes + 1 );
 
-            // Compute the bounding box of the glyph
-            buildGlyphBoundingBox( glyph, glyphWidth );
-            g_defaultFontGlyphBoundingBoxes->emplace_back( glyph->BoundingBox() );
-            g_defaultFontGlyphs.push_back( glyph );
-            m_maxGlyphWidth = std::max( m_maxGlyphWidth, glyphWidth );
+    i = 0;
+
+    while( aGlyphData[i] )
+    {
+        VECTOR2D point( 0.0, 0.0 );
+        char     coordinate[2] = { 0, };
+
+        for( int k : { 0, 1 } )
+            coordinate[k] = aGlyphData[i + k];
+
+        if( i < 2 )
+        {
+            // The first two values contain the width of the char
+            glyphStartX = ( coordinate[0] - 'R' ) * STROKE_FONT_SCALE;
+            glyphEndX   = ( coordinate[1] - 'R' ) * STROKE_FONT_SCALE;
+            glyphWidth  = glyphEndX - glyphStartX;
+        }
+        else if( ( coordinate[0] == ' ' ) && ( coordinate[1] == 'R' ) )
+        {
+            glyph->RaisePen();
+        }
+        else
+        {
+            // In stroke font, coordinates values are coded as <value> + 'R', where
+            // <value> is an ASCII char.
+            // therefore every coordinate description of the Hershey format has an offset,
+            // it has to be subtracted
+            // Note:
+            //  * the stroke coordinates are stored in reduced form (-1.0 to +1.0),
+            //    and the actual size is stroke coordinate * glyph size
+            //  * a few shapes have a height slightly bigger than 1.0 ( like '{' '[' )
+            point.x = (double) ( coordinate[0] - 'R' ) * STROKE_FONT_SCALE - glyphStartX;
+
+            // FONT_OFFSET is here for historical reasons, due to the way the stroke font
+            // was built. It allows shapes coordinates like W M ... to be >= 0
+            // Only shapes like j y have coordinates < 0
+            point.y = (double) ( coordinate[1] - 'R' + FONT_OFFSET ) * STROKE_FONT_SCALE;
+
+            glyph->AddPoint( point );
         }
 
-        g_defaultFontInitialized = true;
+        i += 2;
     }
 
-    m_glyphs = &g_defaultFontGlyphs;
-    m_glyphBoundingBoxes = g_defaultFontGlyphBoundingBoxes;
-    m_fontName = KICAD_FONT_NAME;
-    m_fontFileName = wxEmptyString;
+    glyph->Finalize();
+
+    // Compute the bounding box of the glyph
+    buildGlyphBoundingBox( glyph, glyphWidth );
+
+    return glyph;
 }
 
 
@@ -269,13 +295,13 @@ VECTOR2I STROKE_FONT::GetTextAsGlyphs( BOX2I* aBBox, std::vector<std::unique_ptr
             int dd = (signed) c - ' ';
 
             // Filtering non existing glyphs and non printable chars
-            if( dd < 0 || dd >= (int) m_glyphBoundingBoxes->size() )
+            if( dd < 0 || dd >= m_glyphCount )
             {
                 c = '?';
                 dd = (signed) c - ' ';
             }
 
-            STROKE_GLYPH* source = static_cast<STROKE_GLYPH*>( m_glyphs->at( dd ).get() );
+            STROKE_GLYPH* source = getGlyph( dd );
 
             if( aGlyphs )
             {
@@ -33,8 +33,25 @@
 #include <gal/cairo/cairo_compositor.h>
 #include <wx/log.h>
 
+#include <algorithm>
+#include <cmath>
+
 using namespace KIGFX;
 
+
+static bool isEmpty( const BOX2I& aRect )
+{
+    return aRect.GetWidth() <= 0 || aRect.GetHeight() <= 0;
+}
+
+
+static void clipToRect( cairo_t* aContext, const BOX2I& aRect )
+{
+    cairo_rectangle( aContext, aRect.GetX(), aRect.GetY(), aRect.GetWidth(), aRect.GetHeight() );
+    cairo_clip( aContext );
+}
+
+
 CAIRO_COMPOSITOR::CAIRO_COMPOSITOR( cairo_t** aMainContext ) :
         m_current( 0 ),
         m_currentContext( aMainContext ),
@@ -87,8 +104,8 @@ void CAIRO_COMPOSITOR::Resize( unsigned int aWidth, unsigned int aHeight )
 
 unsigned int CAIRO_COMPOSITOR::CreateBuffer()
 {
-    // Pixel storage
-    BitmapPtr bitmap = new uint32_t[m_bufferSize]();
+    // Pixel storage (m_bufferSize is in bytes)
+    BitmapPtr bitmap = new uint32_t[m_bufferSize / sizeof( uint32_t )]();
 
     // Create the Cairo surface
     cairo_surface_t* surface = cairo_image_surface_create_for_data(
@@ -137,8 +154,39 @@ void CAIRO_COMPOSITOR::Begin()
 
 void CAIRO_COMPOSITOR::ClearBuffer( const COLOR4D& aColor )
 {
-    // Clear the pixel storage
-    memset( m_buffers[m_current].bitmap, 0x00, m_bufferSize * sizeof( int ) );
+    CAIRO_BUFFER& buffer = m_buffers[m_current];
+
+    if( isEmpty( buffer.dirtyRect ) )
+        return;
+
+    // Clear the pixel storage; everything outside of the dirty rows is already transparent
+    unsigned char* pixels = (unsigned char*) buffer.bitmap;
+
+    memset( pixels + buffer.dirtyRect.GetY() * m_stride, 0x00,
+            buffer.dirtyRect.GetHeight() * m_stride );
+
+    buffer.dirtyRect = BOX2I();
+}
+
+
+void CAIRO_COMPOSITOR::MarkDirty( const BOX2D& aArea )
+{
+    // Round outwards and leave a pixel for the antialiasing
+    const double x1 = std::clamp( std::floor( aArea.GetLeft() ) - 1.0, 0.0, (double) m_width );
+    const double y1 = std::clamp( std::floor( aArea.GetTop() ) - 1.0, 0.0, (double) m_height );
+    const double x2 = std::clamp( std::ceil( aArea.GetRight() ) + 1.0, 0.0, (double) m_width );
+    const double y2 = std::clamp( std::ceil( aArea.GetBottom() ) + 1.0, 0.0, (double) m_height );
+
+    if( x1 >= x2 || y1 >= y2 )
+        return;
+
+    BOX2I area( VECTOR2I( (int) x1, (int) y1 ), VECTOR2I( (int) ( x2 - x1 ), (int) ( y2 - y1 ) ) );
+    BOX2I& dirtyRect = m_buffers[m_current].dirtyRect;
+
+    if( isEmpty( dirtyRect ) )
+        dirtyRect = area;
+    else
+        dirtyRect.Merge( area );
 }
 
 
@@ -148,18 +196,31 @@ void CAIRO_COMPOSITOR::DrawBuffer( unsigned int aSourceHandle, unsigned int aDes
     wxASSERT_MSG( aSourceHandle <= usedBuffers() && aDestHandle <= usedBuffers(),
                   wxT( "Tried to use a not existing buffer" ) );
 
+    const CAIRO_BUFFER& source = m_buffers[aSourceHandle - 1];
+    CAIRO_BUFFER&       dest = m_buffers[aDestHandle - 1];
+
+    // Nothing outside of the dirty area of the source has been drawn to
+    if( isEmpty( source.dirtyRect ) )
+        return;
+
     // Reset the transformation matrix, so it is possible to composite images using
     // screen coordinates instead of world coordinates
     cairo_get_matrix( m_mainContext, &m_matrix );
     cairo_identity_matrix( m_mainContext );
 
     // Draw the selected buffer contents
-    cairo_t* ct = cairo_create( m_buffers[aDestHandle - 1].surface );
+    cairo_t* ct = cairo_create( dest.surface );
+    clipToRect( ct, source.dirtyRect );
     cairo_set_operator( ct, op );
-    cairo_set_source_surface( ct, m_buffers[aSourceHandle - 1].surface, 0.0, 0.0 );
+    cairo_set_source_surface( ct, source.surface, 0.0, 0.0 );
     cairo_paint( ct );
     cairo_destroy( ct );
 
+    if( isEmpty( dest.dirtyRect ) )
+        dest.dirtyRect = source.dirtyRect;
+    else
+        dest.dirtyRect.Merge( source.dirtyRect );
+
     // Restore the transformation matrix
     cairo_set_matrix( m_mainContext, &m_matrix );
 }
@@ -174,9 +235,17 @@ void CAIRO_COMPOSITOR::DrawBuffer( unsigned int aBufferHandle )
     cairo_get_matrix( m_mainContext, &m_matrix );
     cairo_identity_matrix( m_mainContext );
 
-    // Draw the selected buffer contents
-    cairo_set_source_surface( m_mainContext, m_buffers[aBufferHandle - 1].surface, 0.0, 0.0 );
-    cairo_paint( m_mainContext );
+    const CAIRO_BUFFER& buffer = m_buffers[aBufferHandle - 1];
+
+    // Draw the selected buffer contents; outside of its dirty area the buffer is transparent
+    if( !isEmpty( buffer.dirtyRect ) )
+    {
+        cairo_save( m_mainContext );
+        clipToRect( m_mainContext, buffer.dirtyRect );
+        cairo_set_source_surface( m_mainContext, buffer.surface, 0.0, 0.0 );
+        cairo_paint( m_mainContext );
+        cairo_restore( m_mainContext );
+    }
 
     // Restore the transformation matrix
     cairo_set_matrix( m_mainContext, &m_matrix );
@@ -267,6 +267,7 @@ void CAIRO_GAL_BASE::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& a
         cairo_line_to( m_currentContext, p1.x, p1.y );
         cairo_set_source_rgba( m_currentContext, m_fillColor.r, m_fillColor.g, m_fillColor.b,
                                m_fillColor.a );
+        markPathDirty( true );
         cairo_stroke( m_currentContext );
     }
     else
@@ -558,6 +559,7 @@ void CAIRO_GAL_BASE::DrawBitmap( const BITMAP_BASE& aBitmap, double alphaBlend )
 
     cairo_surface_mark_dirty( image );
     cairo_set_source_surface( m_currentContext, image, 0, 0 );
+    markDirty( 0.0, 0.0, w, h );
     cairo_paint_with_alpha( m_currentContext, alphaBlend );
 
     // store the image handle so it can be destroyed later
@@ -585,6 +587,7 @@ void CAIRO_GAL_BASE::ClearScreen()
 {
     cairo_set_source_rgb( m_currentContext, m_clearColor.r, m_clearColor.g, m_clearColor.b );
     cairo_rectangle( m_currentContext, 0.0, 0.0, m_screenSize.x, m_screenSize.y );
+    markPathDirty( false );
     cairo_fill( m_currentContext );
 }
 
@@ -863,6 +866,7 @@ void CAIRO_GAL_BASE::DrawGroup( int aGroupNumber )
             cairo_set_source_rgba( m_currentContext, m_strokeColor.r, m_strokeColor.g,
                                    m_strokeColor.b, m_strokeColor.a );
             cairo_append_path( m_currentContext, it->m_CairoPath );
+            markPathDirty( true );
             cairo_stroke( m_currentContext );
             break;
 
@@ -870,6 +874,7 @@ void CAIRO_GAL_BASE::DrawGroup( int aGroupNumber )
             cairo_set_source_rgba( m_currentContext, m_fillColor.r, m_fillColor.g, m_fillColor.b,
                                    m_strokeColor.a );
             cairo_append_path( m_currentContext, it->m_CairoPath );
+            markPathDirty( false );
             cairo_fill( m_currentContext );
             break;
 
@@ -966,32 +971,6 @@ void CAIRO_GAL_BASE::SetNegativeDrawMode( bool aSetting )
 }
 
 
-void CAIRO_GAL::StartDiffLayer()
-{
-    SetTarget( TARGET_TEMP );
-    ClearTarget( TARGET_TEMP );
-}
-
-
-void CAIRO_GAL::EndDiffLayer()
-{
-    m_compositor->DrawBuffer( m_tempBuffer, m_mainBuffer, CAIRO_OPERATOR_ADD );
-}
-
-
-void CAIRO_GAL::StartNegativesLayer()
-{
-    SetTarget( TARGET_TEMP );
-    ClearTarget( TARGET_TEMP );
-}
-
-
-void CAIRO_GAL::EndNegativesLayer()
-{
-    m_compositor->DrawBuffer( m_tempBuffer, m_mainBuffer, CAIRO_OPERATOR_OVER );
-}
-
-
 void CAIRO_GAL_BASE::DrawCursor( const VECTOR2D& aCursorPosition )
 {
     m_cursorPosition = aCursorPosition;
@@ -1049,6 +1028,7 @@ void CAIRO_GAL_BASE::drawAxes( const VECTOR2D& aStartPoint, const VECTOR2D& aEnd
     cairo_line_to( m_currentContext, p1.x, org.y );
     cairo_move_to( m_currentContext, org.x, p0.y );
     cairo_line_to( m_currentContext, org.x, p1.y );
+    markPathDirty( true );
     cairo_stroke( m_currentContext );
 }
 
@@ -1063,6 +1043,7 @@ void CAIRO_GAL_BASE::drawGridLine( const VECTOR2D& aStartPoint, const VECTOR2D&
                            m_gridColor.a );
     cairo_move_to( m_currentContext, p0.x, p0.y );
     cairo_line_to( m_currentContext, p1.x, p1.y );
+    markPathDirty( true );
     cairo_stroke( m_currentContext );
 }
 
@@ -1084,6 +1065,7 @@ void CAIRO_GAL_BASE::drawGridCross( const VECTOR2D& aPoint )
     cairo_line_to( m_currentContext, p1.x, p1.y );
     cairo_move_to( m_currentContext, p2.x, p2.y );
     cairo_line_to( m_currentContext, p3.x, p3.y );
+    markPathDirty( true );
     cairo_stroke( m_currentContext );
 }
 
@@ -1100,12 +1082,21 @@ void CAIRO_GAL_BASE::drawGridPoint( const VECTOR2D& aPoint, double aWidth, doubl
     cairo_rectangle( m_currentContext, p.x - std::floor( sw / 2 ) - 0.5,
                      p.y - std::floor( sh / 2 ) - 0.5, sw, sh );
 
+    markPathDirty( false );
     cairo_fill( m_currentContext );
 }
 
 
 void CAIRO_GAL_BASE::flushPath()
 {
+    if( m_isFillEnabled || m_isStrokeEnabled )
+    {
+        if( m_isStrokeEnabled )
+            cairo_set_line_width( m_currentContext, m_lineWidthInPixels );
+
+        markPathDirty( m_isStrokeEnabled );
+    }
+
     if( m_isFillEnabled )
     {
         cairo_set_source_rgba( m_currentContext, m_fillColor.r, m_fillColor.g, m_fillColor.b,
@@ -1132,6 +1123,34 @@ void CAIRO_GAL_BASE::flushPath()
 }
 
 
+void CAIRO_GAL_BASE::markPathDirty( bool aStroke )
+{
+    double x1, y1, x2, y2;
+    cairo_path_extents( m_currentContext, &x1, &y1, &x2, &y2 );
+
+    if( aStroke )
+    {
+        // Half of the line width on each side, more for the miter joins of thin lines
+        double pad = cairo_get_line_width( m_currentContext ) / 2.0;
+
+        if( cairo_get_line_join( m_currentContext ) == CAIRO_LINE_JOIN_MITER )
+            pad *= std::max( 1.0, cairo_get_miter_limit( m_currentContext ) );
+
+        x1 -= pad;
+        y1 -= pad;
+        x2 += pad;
+        y2 += pad;
+    }
+    else if( x1 >= x2 || y1 >= y2 )
+    {
+        // Filling an empty path does not draw anything
+        return;
+    }
+
+    markDirty( x1, y1, x2, y2 );
+}
+
+
 void CAIRO_GAL_BASE::storePath()
 {
     if( m_isElementAdded )
@@ -1140,6 +1159,9 @@ void CAIRO_GAL_BASE::storePath()
 
         if( !m_isGrouping )
         {
+            if( m_isFillEnabled || m_isStrokeEnabled )
+                markPathDirty( m_isStrokeEnabled );
+
             if( m_isFillEnabled )
             {
                 cairo_set_source_rgba( m_currentContext, m_fillColor.r, m_fillColor.g,
@@ -1311,11 +1333,8 @@ unsigned int CAIRO_GAL_BASE::getNewGroupNumber()
 }
 
 
-CAIRO_GAL::CAIRO_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions, wxWindow* aParent,
-                      wxEvtHandler* aMouseListener, wxEvtHandler* aPaintListener,
-                      const wxString& aName ) :
-        CAIRO_GAL_BASE( aDisplayOptions ),
-        wxWindow( aParent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxEXPAND, aName )
+CAIRO_COMPOSITING_GAL::CAIRO_COMPOSITING_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions ) :
+        CAIRO_GAL_BASE( aDisplayOptions )
 {
     // Initialise compositing state
     m_mainBuffer = 0;
@@ -1324,8 +1343,144 @@ CAIRO_GAL::CAIRO_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions, wxWindow* aParent,
     m_savedBuffer = 0;
     m_validCompositor = false;
     m_currentTarget = TARGET_NONCACHED;
-    SetTarget( TARGET_NONCACHED );
+}
+
+
+void CAIRO_COMPOSITING_GAL::markDirty( double aX1, double aY1, double aX2, double aY2 )
+{
+    // Nothing to track when drawing straight to the output surface
+    if( !m_validCompositor || m_currentContext == m_context )
+        return;
+
+    // The compositor works in buffer pixels, so transform all the corners to device space
+    double xs[4] = { aX1, aX2, aX2, aX1 };
+    double ys[4] = { aY1, aY1, aY2, aY2 };
+    BOX2D  area;
+
+    for( int i = 0; i < 4; i++ )
+    {
+        cairo_user_to_device( m_currentContext, &xs[i], &ys[i] );
+        area.Merge( VECTOR2D( xs[i], ys[i] ) );
+    }
+
+    m_compositor->MarkDirty( area );
+}
+
+
+void CAIRO_COMPOSITING_GAL::StartDiffLayer()
+{
+    SetTarget( TARGET_TEMP );
+    ClearTarget( TARGET_TEMP );
+}
+
+
+void CAIRO_COMPOSITING_GAL::EndDiffLayer()
+{
+    m_compositor->DrawBuffer( m_tempBuffer, m_mainBuffer, CAIRO_OPERATOR_ADD );
+}
+
+
+void CAIRO_COMPOSITING_GAL::StartNegativesLayer()
+{
+    SetTarget( TARGET_TEMP );
+    ClearTarget( TARGET_TEMP );
+}
+
+
+void CAIRO_COMPOSITING_GAL::EndNegativesLayer()
+{
+    m_compositor->DrawBuffer( m_tempBuffer, m_mainBuffer, CAIRO_OPERATOR_OVER );
+}
+
+
+void CAIRO_COMPOSITING_GAL::SetTarget( RENDER_TARGET aTarget )
+{
+    // If the compositor is not set, that means that there is a recaching process going on
+    // and we do not need the compositor now
+    if( !m_validCompositor )
+        return;
+
+    // Cairo grouping prevents display of overlapping items on the same layer in the lighter color
+    if( m_context )
+        storePath();
+
+    m_compositor->SetBuffer( getTargetBuffer( aTarget ) );
+    m_currentTarget = aTarget;
+}
+
+
+RENDER_TARGET CAIRO_COMPOSITING_GAL::GetTarget() const
+{
+    return m_currentTarget;
+}
+
+
+void CAIRO_COMPOSITING_GAL::ClearTarget( RENDER_TARGET aTarget )
+{
+    // Save the current state
+    unsigned int currentBuffer = m_compositor->GetBuffer();
+
+    m_compositor->SetBuffer( getTargetBuffer( aTarget ) );
+    m_compositor->ClearBuffer( COLOR4D::BLACK );
+
+    // Restore the previous state
+    m_compositor->SetBuffer( currentBuffer );
+}
+
 
+unsigned int CAIRO_COMPOSITING_GAL::getTargetBuffer( RENDER_TARGET aTarget ) const
+{
+    switch( aTarget )
+    {
+    // Cached and noncached items are rendered to the same buffer
+    default:
+    case TARGET_CACHED:
+    case TARGET_NONCACHED: return m_mainBuffer;
+    case TARGET_OVERLAY:   return m_overlayBuffer;
+    case TARGET_TEMP:      return m_tempBuffer;
+    }
+}
+
+
+void CAIRO_COMPOSITING_GAL::setCompositor()
+{
+    // Recreate the compositor with the new Cairo context
+    m_compositor.reset( new CAIRO_COMPOSITOR( &m_currentContext ) );
+    m_compositor->Resize( m_screenSize.x, m_screenSize.y );
+    m_compositor->SetAntialiasingMode( m_options.cairo_antialiasing_mode );
+
+    // Prepare buffers
+    m_mainBuffer = m_compositor->CreateBuffer();
+    m_overlayBuffer = m_compositor->CreateBuffer();
+    m_tempBuffer = m_compositor->CreateBuffer();
+
+    m_validCompositor = true;
+}
+
+
+void CAIRO_COMPOSITING_GAL::beginCompositing()
+{
+    if( !m_validCompositor )
+        setCompositor();
+
+    m_compositor->SetMainContext( m_context );
+    m_compositor->SetBuffer( m_mainBuffer );
+}
+
+
+void CAIRO_COMPOSITING_GAL::endCompositing()
+{
+    m_compositor->DrawBuffer( m_mainBuffer );
+    m_compositor->DrawBuffer( m_overlayBuffer );
+}
+
+
+CAIRO_GAL::CAIRO_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions, wxWindow* aParent,
+                      wxEvtHandler* aMouseListener, wxEvtHandler* aPaintListener,
+                      const wxString& aName ) :
+        CAIRO_COMPOSITING_GAL( aDisplayOptions ),
+        wxWindow( aParent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxEXPAND, aName )
+{
     m_bitmapBuffer = nullptr;
     m_wxOutput = nullptr;
 
@@ -1384,11 +1539,7 @@ void CAIRO_GAL::BeginDrawing()
 
     CAIRO_GAL_BASE::BeginDrawing();
 
-    if( !m_validCompositor )
-        setCompositor();
-
-    m_compositor->SetMainContext( m_context );
-    m_compositor->SetBuffer( m_mainBuffer );
+    beginCompositing();
 }
 
 
@@ -1397,8 +1548,7 @@ void CAIRO_GAL::EndDrawing()
     CAIRO_GAL_BASE::EndDrawing();
 
     // Merge buffers on the screen
-    m_compositor->DrawBuffer( m_mainBuffer );
-    m_compositor->DrawBuffer( m_overlayBuffer );
+    endCompositing();
 
     // Now translate the raw context data from the format stored
     // by cairo into a format understood by wxImage.
@@ -1480,58 +1630,6 @@ void CAIRO_GAL::EndGroup()
 }
 
 
-void CAIRO_GAL::SetTarget( RENDER_TARGET aTarget )
-{
-    // If the compositor is not set, that means that there is a recaching process going on
-    // and we do not need the compositor now
-    if( !m_validCompositor )
-        return;
-
-    // Cairo grouping prevents display of overlapping items on the same layer in the lighter color
-    if( m_isInitialized )
-        storePath();
-
-    switch( aTarget )
-    {
-    default:
-    case TARGET_CACHED:
-    case TARGET_NONCACHED: m_compositor->SetBuffer( m_mainBuffer );    break;
-    case TARGET_OVERLAY:   m_compositor->SetBuffer( m_overlayBuffer ); break;
-    case TARGET_TEMP:      m_compositor->SetBuffer( m_tempBuffer );    break;
-    }
-
-    m_currentTarget = aTarget;
-}
-
-
-RENDER_TARGET CAIRO_GAL::GetTarget() const
-{
-    return m_currentTarget;
-}
-
-
-void CAIRO_GAL::ClearTarget( RENDER_TARGET aTarget )
-{
-    // Save the current state
-    unsigned int currentBuffer = m_compositor->GetBuffer();
-
-    switch( aTarget )
-    {
-    // Cached and noncached items are rendered to the same buffer
-    default:
-    case TARGET_CACHED:
-    case TARGET_NONCACHED: m_compositor->SetBuffer( m_mainBuffer );    break;
-    case TARGET_OVERLAY:   m_compositor->SetBuffer( m_overlayBuffer ); break;
-    case TARGET_TEMP:      m_compositor->SetBuffer( m_tempBuffer );    break;
-    }
-
-    m_compositor->ClearBuffer( COLOR4D::BLACK );
-
-    // Restore the previous state
-    m_compositor->SetBuffer( currentBuffer );
-}
-
-
 void CAIRO_GAL::initSurface()
 {
     if( m_isInitialized )
@@ -1596,22 +1694,6 @@ void CAIRO_GAL::deleteBitmaps()
 }
 
 
-void CAIRO_GAL::setCompositor()
-{
-    // Recreate the compositor with the new Cairo context
-    m_compositor.reset( new CAIRO_COMPOSITOR( &m_currentContext ) );
-    m_compositor->Resize( m_screenSize.x, m_screenSize.y );
-    m_compositor->SetAntialiasingMode( m_options.cairo_antialiasing_mode );
-
-    // Prepare buffers
-    m_mainBuffer = m_compositor->CreateBuffer();
-    m_overlayBuffer = m_compositor->CreateBuffer();
-    m_tempBuffer = m_compositor->CreateBuffer();
-
-    m_validCompositor = true;
-}
-
-
 void CAIRO_GAL::onPaint( wxPaintEvent& aEvent )
 {
     PostPaint( aEvent );
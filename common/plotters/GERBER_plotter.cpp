@@ -25,6 +25,7 @@
 
 #include <string_utils.h>
 #include <convert_basic_shapes_to_polygon.h>
+#include <hash.h>
 #include <macros.h>
 #include <math/util.h>      // for KiROUND
 #include <trigo.h>
@@ -88,6 +89,45 @@ static bool polyCompare( const std::vector<VECTOR2I>& aPolygon,
 }
 
 
+// Hash of the parameters identifying an aperture, used to index m_apertureIndex
+static size_t apertureHash( APERTURE::APERTURE_TYPE aType, const VECTOR2I& aSize, int aRadius,
+                            const EDA_ANGLE& aRotation, int aApertureAttribute,
+                            size_t aCornerCount )
+{
+    // Adding 0.0 turns -0.0 into 0.0, which compare equal but could hash differently
+    return hash_val( static_cast<int>( aType ), aSize.x, aSize.y, aRadius,
+                     aRotation.AsDegrees() + 0.0, aApertureAttribute, aCornerCount );
+}
+
+
+/**
+ * Write the decimal representation of \a aValue to \a aBuffer, which is much cheaper than
+ * going through printf for the coordinates of each item.
+ *
+ * @return the position following the last char written.
+ */
+static char* formatInt( char* aBuffer, int aValue )
+{
+    char     digits[12];
+    int      count = 0;
+    unsigned value = aValue < 0 ? 0u - (unsigned) aValue : (unsigned) aValue;
+
+    if( aValue < 0 )
+        *aBuffer++ = '-';
+
+    do
+    {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while( value );
+
+    while( count )
+        *aBuffer++ = digits[--count];
+
+    return aBuffer;
+}
+
+
 GERBER_PLOTTER::GERBER_PLOTTER()
 {
     workFile  = nullptr;
@@ -154,8 +194,46 @@ void GERBER_PLOTTER::SetGerberCoordinatesFormat( int aResolution, bool aUseInche
 
 void GERBER_PLOTTER::emitDcode( const VECTOR2D& pt, int dcode )
 {
+    // Equivalent to "X%dY%dD%02d*\n"
+    char  buffer[48];
+    char* ptr = buffer;
+
+    *ptr++ = 'X';
+    ptr = formatInt( ptr, KiROUND( pt.x ) );
+    *ptr++ = 'Y';
+    ptr = formatInt( ptr, KiROUND( pt.y ) );
+    *ptr++ = 'D';
+
+    if( dcode < 10 )
+        *ptr++ = '0';
+
+    ptr = formatInt( ptr, dcode );
+    *ptr++ = '*';
+    *ptr++ = '\n';
 
-    fprintf( m_outputFile, "X%dY%dD%02d*\n", KiROUND( pt.x ), KiROUND( pt.y ), dcode );
+    fwrite( buffer, 1, ptr - buffer, m_outputFile );
+}
+
+
+void GERBER_PLOTTER::emitArcDcode( const VECTOR2D& aEnd, const VECTOR2D& aCenterOffset )
+{
+    // Equivalent to "X%dY%dI%dJ%dD01*\n"
+    char  buffer[64];
+    char* ptr = buffer;
+
+    *ptr++ = 'X';
+    ptr = formatInt( ptr, KiROUND( aEnd.x ) );
+    *ptr++ = 'Y';
+    ptr = formatInt( ptr, KiROUND( aEnd.y ) );
+    *ptr++ = 'I';
+    ptr = formatInt( ptr, KiROUND( aCenterOffset.x ) );
+    *ptr++ = 'J';
+    ptr = formatInt( ptr, KiROUND( aCenterOffset.y ) );
+
+    memcpy( ptr, "D01*\n", 5 );
+    ptr += 5;
+
+    fwrite( buffer, 1, ptr - buffer, m_outputFile );
 }
 
 void GERBER_PLOTTER::ClearAllAttributes()
@@ -258,6 +336,9 @@ bool GERBER_PLOTTER::StartPlot( const wxString& aPageNumber )
     if( m_outputFile == nullptr )
         return false;
 
+    // Items are written a few bytes at a time: use a larger buffer than the default one
+    setvbuf( m_outputFile, nullptr, _IOFBF, 256 * 1024 );
+
     for( unsigned ii = 0; ii < m_headerExtraLines.GetCount(); ii++ )
     {
         if( ! m_headerExtraLines[ii].IsEmpty() )
@@ -416,13 +497,13 @@ int GERBER_PLOTTER::GetOrCreateAperture( const VECTOR2I& aSize, int aRadius,
                                          const EDA_ANGLE& aRotation, APERTURE::APERTURE_TYPE aType,
                                          int aApertureAttribute )
 {
-    int last_D_code = 9;
+    std::vector<int>& candidates = m_apertureIndex[apertureHash( aType, aSize, aRadius, aRotation,
+                                                                 aApertureAttribute, 0 )];
 
     // Search an existing aperture
-    for( int idx = 0; idx < (int)m_apertures.size(); ++idx )
+    for( int idx : candidates )
     {
         APERTURE* tool = &m_apertures[idx];
-        last_D_code = tool->m_DCode;
 
         if( (tool->m_Type == aType) && (tool->m_Size == aSize) &&
             (tool->m_Radius == aRadius) && (tool->m_Rotation == aRotation) &&
@@ -436,10 +517,12 @@ int GERBER_PLOTTER::GetOrCreateAperture( const VECTOR2I& aSize, int aRadius,
     new_tool.m_Type     = aType;
     new_tool.m_Radius   = aRadius;
     new_tool.m_Rotation = aRotation;
-    new_tool.m_DCode    = last_D_code + 1;
+    new_tool.m_DCode    = m_apertures.empty() ? FIRST_DCODE_VALUE
+                                              : m_apertures.back().m_DCode + 1;
     new_tool.m_ApertureAttribute = aApertureAttribute;
 
     m_apertures.push_back( new_tool );
+    candidates.push_back( m_apertures.size() - 1 );
 
     return m_apertures.size() - 1;
 }
@@ -449,8 +532,6 @@ int GERBER_PLOTTER::GetOrCreateAperture( const std::vector<VECTOR2I>& aCorners,
                                          const EDA_ANGLE& aRotation, APERTURE::APERTURE_TYPE aType,
                                          int aApertureAttribute )
 {
-    int last_D_code = 9;
-
     // For APERTURE::AM_FREE_POLYGON aperture macros, we need to create the macro
     // on the fly, because due to the fact the vertex count is not a constant we
     // cannot create a static definition.
@@ -462,13 +543,15 @@ int GERBER_PLOTTER::GetOrCreateAperture( const std::vector<VECTOR2I>& aCorners,
             m_am_freepoly_list.Append( aCorners );
     }
 
+    std::vector<int>& candidates = m_apertureIndex[apertureHash( aType, VECTOR2I( 0, 0 ), 0,
+                                                                 aRotation, aApertureAttribute,
+                                                                 aCorners.size() )];
+
     // Search an existing aperture
-    for( int idx = 0; idx < (int)m_apertures.size(); ++idx )
+    for( int idx : candidates )
     {
         APERTURE* tool = &m_apertures[idx];
 
-       last_D_code = tool->m_DCode;
-
         if( (tool->m_Type == aType) &&
             (tool->m_Corners.size() == aCorners.size() ) &&
             (tool->m_Rotation == aRotation) &&
@@ -490,10 +573,12 @@ int GERBER_PLOTTER::GetOrCreateAperture( const std::vector<VECTOR2I>& aCorners,
     new_tool.m_Type     = aType;
     new_tool.m_Radius   = 0;             // Not used
     new_tool.m_Rotation = aRotation;
-    new_tool.m_DCode    = last_D_code + 1;
+    new_tool.m_DCode    = m_apertures.empty() ? FIRST_DCODE_VALUE
+                                              : m_apertures.back().m_DCode + 1;
     new_tool.m_ApertureAttribute = aApertureAttribute;
 
     m_apertures.push_back( new_tool );
+    candidates.push_back( m_apertures.size() - 1 );
 
     return m_apertures.size() - 1;
 }
@@ -862,9 +947,7 @@ void GERBER_PLOTTER::plotArc( const SHAPE_ARC& aArc, bool aPlotInRegion )
     else
         fprintf( m_outputFile, "G03*\n" );    // Active circular interpolation, CCW
 
-    fprintf( m_outputFile, "X%dY%dI%dJ%dD01*\n",
-             KiROUND( devEnd.x ), KiROUND( devEnd.y ),
-             KiROUND( devCenter.x ), KiROUND( devCenter.y ) );
+    emitArcDcode( devEnd, devCenter );
 
     fprintf( m_outputFile, "G01*\n" ); // Back to linear interpolate (perhaps useless here).
 }
@@ -894,9 +977,7 @@ void GERBER_PLOTTER::plotArc( const VECTOR2I& aCenter, const EDA_ANGLE& aStartAn
     else
         fprintf( m_outputFile, "G02*\n" );    // Active circular interpolation, CW
 
-    fprintf( m_outputFile, "X%dY%dI%dJ%dD01*\n",
-             KiROUND( devEnd.x ), KiROUND( devEnd.y ),
-             KiROUND( devCenter.x ), KiROUND( devCenter.y ) );
+    emitArcDcode( devEnd, devCenter );
 
     fprintf( m_outputFile, "G01*\n" ); // Back to linear interpolate (perhaps useless here).
 }
@@ -2051,13 +2132,19 @@ void APER_MACRO_FREEPOLY_LIST::Format( FILE * aOutput, double aIu2GbrMacroUnit )
 
 void APER_MACRO_FREEPOLY_LIST::Append( const std::vector<VECTOR2I>& aPolygon )
 {
+    m_AMByCornerCount[(int) aPolygon.size()].push_back( AmCount() );
     m_AMList.emplace_back( aPolygon, AmCount() );
 }
 
 
 int APER_MACRO_FREEPOLY_LIST::FindAm( const std::vector<VECTOR2I>& aPolygon ) const
 {
-    for( int idx = 0; idx < AmCount(); idx++ )
+    auto it = m_AMByCornerCount.find( (int) aPolygon.size() );
+
+    if( it == m_AMByCornerCount.end() )
+        return -1;
+
+    for( int idx : it->second )
     {
         if( m_AMList[idx].IsSamePoly( aPolygon ) )
             return idx;
@@ -28,21 +28,100 @@
  */
 
 #include <algorithm>
+#include <cstring>
 
 #include <wx/filename.h>
+#include <wx/log.h>
 #include <wx/mstream.h>
 #include <wx/zstream.h>
 
+#include <fmt/format.h>
+
 #include <advanced_config.h>
 #include <eda_text.h> // for IsGotoPageHref
-#include <ignore.h>
 #include <macros.h>
+#include <md5_hash.h>
+#include <trace_helpers.h>
 #include <trigo.h>
 #include <string_utils.h>
 
+#include <plotters/pdf_content_stream.h>
 #include <plotters/plotters_pslike.h>
 
 
+size_t PDF_FILE_OUTPUT_STREAM::OnSysWrite( const void* aBuffer, size_t aSize )
+{
+    size_t written = fwrite( aBuffer, 1, aSize, m_file );
+
+    if( written != aSize )
+        m_lasterror = wxSTREAM_WRITE_ERROR;
+
+    m_written += written;
+    return written;
+}
+
+
+PDF_CONTENT_STREAM::PDF_CONTENT_STREAM( FILE* aOutputFile, bool aCompress ) :
+        m_output( aOutputFile ),
+        m_rawSize( 0 )
+{
+    /* Somewhat standard parameters to compress in DEFLATE. The PDF spec is
+     * misleading, it says it wants a DEFLATE stream but it really want a ZLIB
+     * stream! (a DEFLATE stream would be generated with -15 instead of 15)
+     * rc = deflateInit2( &zstrm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15,
+     *                    8, Z_DEFAULT_STRATEGY );
+     */
+    if( aCompress )
+    {
+        m_compressor = std::make_unique<wxZlibOutputStream>( m_output, wxZ_DEFAULT_COMPRESSION,
+                                                             wxZLIB_ZLIB );
+    }
+}
+
+
+PDF_CONTENT_STREAM::~PDF_CONTENT_STREAM()
+{
+}
+
+
+void PDF_CONTENT_STREAM::Write( const char* aText )
+{
+    m_buffer.append( aText, aText + strlen( aText ) );
+
+    if( m_buffer.size() >= BUFFER_SIZE )
+        flush();
+}
+
+
+size_t PDF_CONTENT_STREAM::Finish()
+{
+    flush();
+
+    // Ends the deflate stream, writing what zlib still holds
+    if( m_compressor )
+        m_compressor->Close();
+
+    return m_output.Written();
+}
+
+
+void PDF_CONTENT_STREAM::flush()
+{
+    if( m_compressor )
+        m_compressor->Write( m_buffer.data(), m_buffer.size() );
+    else
+        m_output.Write( m_buffer.data(), m_buffer.size() );
+
+    m_rawSize += m_buffer.size();
+    m_buffer.clear();
+}
+
+
+PDF_PLOTTER::~PDF_PLOTTER()
+{
+}
+
+
 std::string PDF_PLOTTER::encodeStringForPlotter( const wxString& aText )
 {
     // returns a string compatible with PDF string convention from a unicode string.
@@ -142,7 +221,7 @@ void PDF_PLOTTER::SetViewport( const VECTOR2I& aOffset, double aIusPerDecimil,
 
 void PDF_PLOTTER::SetCurrentLineWidth( int aWidth, void* aData )
 {
-    wxASSERT( m_workFile );
+    wxASSERT( m_contentStream );
 
     if( aWidth == DO_NOT_SET_LINE_WIDTH )
         return;
@@ -155,7 +234,7 @@ void PDF_PLOTTER::SetCurrentLineWidth( int aWidth, void* aData )
     wxASSERT_MSG( aWidth > 0, "Plotter called to set negative pen width" );
 
     if( aWidth != m_currentPenWidth )
-        fprintf( m_workFile, "%g w\n", userToDeviceSize( aWidth ) );
+        m_contentStream->Print( "{:g} w\n", userToDeviceSize( aWidth ) );
 
     m_currentPenWidth = aWidth;
 }
@@ -163,7 +242,7 @@ void PDF_PLOTTER::SetCurrentLineWidth( int aWidth, void* aData )
 
 void PDF_PLOTTER::emitSetRGBColor( double r, double g, double b, double a )
 {
-    wxASSERT( m_workFile );
+    wxASSERT( m_contentStream );
 
     // PDF treats all colors as opaque, so the best we can do with alpha is generate an
     // appropriate blended color assuming white paper.
@@ -174,60 +253,61 @@ void PDF_PLOTTER::emitSetRGBColor( double r, double g, double b, double a )
         b = ( b * a ) + ( 1 - a );
     }
 
-    fprintf( m_workFile, "%g %g %g rg %g %g %g RG\n", r, g, b, r, g, b );
+    m_contentStream->Print( "{:g} {:g} {:g} rg {:g} {:g} {:g} RG\n", r, g, b, r, g, b );
 }
 
 
 void PDF_PLOTTER::SetDash( int aLineWidth, PLOT_DASH_TYPE aLineStyle )
 {
-    wxASSERT( m_workFile );
+    wxASSERT( m_contentStream );
 
     switch( aLineStyle )
     {
     case PLOT_DASH_TYPE::DASH:
-        fprintf( m_workFile, "[%d %d] 0 d\n",
+        m_contentStream->Print( "[{} {}] 0 d\n",
                 (int) GetDashMarkLenIU( aLineWidth ), (int) GetDashGapLenIU( aLineWidth ) );
         break;
 
     case PLOT_DASH_TYPE::DOT:
-        fprintf( m_workFile, "[%d %d] 0 d\n",
+        m_contentStream->Print( "[{} {}] 0 d\n",
                 (int) GetDotMarkLenIU( aLineWidth ), (int) GetDashGapLenIU( aLineWidth ) );
         break;
 
     case PLOT_DASH_TYPE::DASHDOT:
-        fprintf( m_workFile, "[%d %d %d %d] 0 d\n",
+        m_contentStream->Print( "[{} {} {} {}] 0 d\n",
                 (int) GetDashMarkLenIU( aLineWidth ), (int) GetDashGapLenIU( aLineWidth ),
                 (int) GetDotMarkLenIU( aLineWidth ), (int) GetDashGapLenIU( aLineWidth ) );
         break;
 
     case PLOT_DASH_TYPE::DASHDOTDOT:
-        fprintf( m_workFile, "[%d %d %d %d %d %d] 0 d\n",
+        m_contentStream->Print( "[{} {} {} {} {} {}] 0 d\n",
                 (int) GetDashMarkLenIU( aLineWidth ), (int) GetDashGapLenIU( aLineWidth ),
                 (int) GetDotMarkLenIU( aLineWidth ), (int) GetDashGapLenIU( aLineWidth ),
                 (int) GetDotMarkLenIU( aLineWidth ), (int) GetDashGapLenIU( aLineWidth ) );
         break;
 
     default:
-        fputs( "[] 0 d\n", m_workFile );
+        m_contentStream->Write( "[] 0 d\n" );
     }
 }
 
 
 void PDF_PLOTTER::Rect( const VECTOR2I& p1, const VECTOR2I& p2, FILL_T fill, int width )
 {
-    wxASSERT( m_workFile );
+    wxASSERT( m_contentStream );
     VECTOR2D p1_dev = userToDeviceCoordinates( p1 );
     VECTOR2D p2_dev = userToDeviceCoordinates( p2 );
 
     SetCurrentLineWidth( width );
-    fprintf( m_workFile, "%g %g %g %g re %c\n", p1_dev.x, p1_dev.y,
-             p2_dev.x - p1_dev.x, p2_dev.y - p1_dev.y, fill == FILL_T::NO_FILL ? 'S' : 'B' );
+    m_contentStream->Print( "{:g} {:g} {:g} {:g} re {}\n", p1_dev.x, p1_dev.y,
+                            p2_dev.x - p1_dev.x, p2_dev.y - p1_dev.y,
+                            fill == FILL_T::NO_FILL ? 'S' : 'B' );
 }
 
 
 void PDF_PLOTTER::Circle( const VECTOR2I& pos, int diametre, FILL_T aFill, int width )
 {
-    wxASSERT( m_workFile );
+    wxASSERT( m_contentStream );
     VECTOR2D pos_dev = userToDeviceCoordinates( pos );
     double   radius = userToDeviceSize( diametre / 2.0 );
 
@@ -251,12 +331,12 @@ void PDF_PLOTTER::Circle( const VECTOR2I& pos, int diametre, FILL_T aFill, int w
     double magic = radius * 0.551784; // You don't want to know where this come from
 
     // This is the convex hull for the bezier approximated circle
-    fprintf( m_workFile,
-             "%g %g m "
-             "%g %g %g %g %g %g c "
-             "%g %g %g %g %g %g c "
-             "%g %g %g %g %g %g c "
-             "%g %g %g %g %g %g c %c\n",
+    m_contentStream->Print(
+             "{:g} {:g} m "
+             "{:g} {:g} {:g} {:g} {:g} {:g} c "
+             "{:g} {:g} {:g} {:g} {:g} {:g} c "
+             "{:g} {:g} {:g} {:g} {:g} {:g} c "
+             "{:g} {:g} {:g} {:g} {:g} {:g} c {}\n",
              pos_dev.x - radius, pos_dev.y,
 
              pos_dev.x - radius, pos_dev.y + magic,
@@ -282,7 +362,7 @@ void PDF_PLOTTER::Circle( const VECTOR2I& pos, int diametre, FILL_T aFill, int w
 void PDF_PLOTTER::Arc( const VECTOR2I& aCenter, const VECTOR2I& aStart, const VECTOR2I& aEnd,
                        FILL_T aFill, int aWidth, int aMaxError )
 {
-    wxASSERT( m_workFile );
+    wxASSERT( m_contentStream );
 
     /*
      * Arcs are not so easily approximated by beziers (in the general case), so we approximate
@@ -307,7 +387,7 @@ void PDF_PLOTTER::Arc( const VECTOR2I& aCenter, const VECTOR2I& aStart, const VE
 
     SetCurrentLineWidth( aWidth );
     VECTOR2D pos_dev = userToDeviceCoordinates( start );
-    fprintf( m_workFile, "%g %g m ", pos_dev.x, pos_dev.y );
+    m_contentStream->Print( "{:g} {:g} m ", pos_dev.x, pos_dev.y );
 
     for( EDA_ANGLE ii = delta; startAngle + ii < endAngle; ii += delta )
     {
@@ -315,22 +395,22 @@ void PDF_PLOTTER::Arc( const VECTOR2I& aCenter, const VECTOR2I& aStart, const VE
         RotatePoint( pt, aCenter, -ii );
 
         pos_dev = userToDeviceCoordinates( pt );
-        fprintf( m_workFile, "%g %g l ", pos_dev.x, pos_dev.y );
+        m_contentStream->Print( "{:g} {:g} l ", pos_dev.x, pos_dev.y );
     }
 
     pos_dev = userToDeviceCoordinates( end );
-    fprintf( m_workFile, "%g %g l ", pos_dev.x, pos_dev.y );
+    m_contentStream->Print( "{:g} {:g} l ", pos_dev.x, pos_dev.y );
 
     // The arc is drawn... if not filled we stroke it, otherwise we finish
     // closing the pie at the center
     if( aFill == FILL_T::NO_FILL )
     {
-        fputs( "S\n", m_workFile );
+        m_contentStream->Write( "S\n" );
     }
     else
     {
         pos_dev = userToDeviceCoordinates( aCenter );
-        fprintf( m_workFile, "%g %g l b\n", pos_dev.x, pos_dev.y );
+        m_contentStream->Print( "{:g} {:g} l b\n", pos_dev.x, pos_dev.y );
     }
 }
 
@@ -338,7 +418,7 @@ void PDF_PLOTTER::Arc( const VECTOR2I& aCenter, const VECTOR2I& aStart, const VE
 void PDF_PLOTTER::Arc( const VECTOR2I& aCenter, const EDA_ANGLE& aStartAngle,
                        const EDA_ANGLE& aEndAngle, int aRadius, FILL_T aFill, int aWidth )
 {
-    wxASSERT( m_workFile );
+    wxASSERT( m_contentStream );
 
     if( aRadius <= 0 )
     {
@@ -368,31 +448,31 @@ void PDF_PLOTTER::Arc( const VECTOR2I& aCenter, const EDA_ANGLE& aStartAngle,
     start.x = aCenter.x + KiROUND( aRadius * (-startAngle).Cos() );
     start.y = aCenter.y + KiROUND( aRadius * (-startAngle).Sin() );
     VECTOR2D pos_dev = userToDeviceCoordinates( start );
-    fprintf( m_workFile, "%g %g m ", pos_dev.x, pos_dev.y );
+    m_contentStream->Print( "{:g} {:g} m ", pos_dev.x, pos_dev.y );
 
     for( EDA_ANGLE ii = startAngle + delta; ii < endAngle; ii += delta )
     {
         end.x = aCenter.x + KiROUND( aRadius * (-ii).Cos() );
         end.y = aCenter.y + KiROUND( aRadius * (-ii).Sin() );
         pos_dev = userToDeviceCoordinates( end );
-        fprintf( m_workFile, "%g %g l ", pos_dev.x, pos_dev.y );
+        m_contentStream->Print( "{:g} {:g} l ", pos_dev.x, pos_dev.y );
     }
 
     end.x = aCenter.x + KiROUND( aRadius * (-endAngle).Cos() );
     end.y = aCenter.y + KiROUND( aRadius * (-endAngle).Sin() );
     pos_dev = userToDeviceCoordinates( end );
-    fprintf( m_workFile, "%g %g l ", pos_dev.x, pos_dev.y );
+    m_contentStream->Print( "{:g} {:g} l ", pos_dev.x, pos_dev.y );
 
     // The arc is drawn... if not filled we stroke it, otherwise we finish
     // closing the pie at the center
     if( aFill == FILL_T::NO_FILL )
     {
-        fputs( "S\n", m_workFile );
+        m_contentStream->Write( "S\n" );
     }
     else
     {
         pos_dev = userToDeviceCoordinates( aCenter );
-        fprintf( m_workFile, "%g %g l b\n", pos_dev.x, pos_dev.y );
+        m_contentStream->Print( "{:g} {:g} l b\n", pos_dev.x, pos_dev.y );
     }
 }
 
@@ -400,7 +480,7 @@ void PDF_PLOTTER::Arc( const VECTOR2I& aCenter, const EDA_ANGLE& aStartAngle,
 void PDF_PLOTTER::PlotPoly( const std::vector<VECTOR2I>& aCornerList, FILL_T aFill, int aWidth,
                             void* aData )
 {
-    wxASSERT( m_workFile );
+    wxASSERT( m_contentStream );
 
     if( aCornerList.size() <= 1 )
         return;
@@ -408,33 +488,33 @@ void PDF_PLOTTER::PlotPoly( const std::vector<VECTOR2I>& aCornerList, FILL_T aFi
     SetCurrentLineWidth( aWidth );
 
     VECTOR2D pos = userToDeviceCoordinates( aCornerList[0] );
-    fprintf( m_workFile, "%g %g m\n", pos.x, pos.y );
+    m_contentStream->Print( "{:g} {:g} m\n", pos.x, pos.y );
 
     for( unsigned ii = 1; ii < aCornerList.size(); ii++ )
     {
         pos = userToDeviceCoordinates( aCornerList[ii] );
-        fprintf( m_workFile, "%g %g l\n", pos.x, pos.y );
+        m_contentStream->Print( "{:g} {:g} l\n", pos.x, pos.y );
     }
 
     // Close path and stroke and/or fill
     if( aFill == FILL_T::NO_FILL )
-        fputs( "S\n", m_workFile );
+        m_contentStream->Write( "S\n" );
     else if( aWidth == 0 )
-        fputs( "f\n", m_workFile );
+        m_contentStream->Write( "f\n" );
     else
-        fputs( "b\n", m_workFile );
+        m_contentStream->Write( "b\n" );
 }
 
 
 void PDF_PLOTTER::PenTo( const VECTOR2I& pos, char plume )
 {
-    wxASSERT( m_workFile );
+    wxASSERT( m_contentStream );
 
     if( plume == 'Z' )
     {
         if( m_penState != 'Z' )
         {
-            fputs( "S\n", m_workFile );
+            m_contentStream->Write( "S\n" );
             m_penState     = 'Z';
             m_penLastpos.x = -1;
             m_penLastpos.y = -1;
@@ -446,9 +526,9 @@ void PDF_PLOTTER::PenTo( const VECTOR2I& pos, char plume )
     if( m_penState != plume || pos != m_penLastpos )
     {
         VECTOR2D pos_dev = userToDeviceCoordinates( pos );
-        fprintf( m_workFile, "%g %g %c\n",
-                 pos_dev.x, pos_dev.y,
-                 ( plume=='D' ) ? 'l' : 'm' );
+        m_contentStream->Print( "{:g} {:g} {}\n",
+                                pos_dev.x, pos_dev.y,
+                                ( plume=='D' ) ? 'l' : 'm' );
     }
 
     m_penState   = plume;
@@ -458,7 +538,7 @@ void PDF_PLOTTER::PenTo( const VECTOR2I& pos, char plume )
 
 void PDF_PLOTTER::PlotImage( const wxImage& aImage, const VECTOR2I& aPos, double aScaleFactor )
 {
-    wxASSERT( m_workFile );
+    wxASSERT( m_contentStream );
     VECTOR2I pix_size( aImage.GetWidth(), aImage.GetHeight() );
 
     // Requested size (in IUs)
@@ -468,35 +548,14 @@ void PDF_PLOTTER::PlotImage( const wxImage& aImage, const VECTOR2I& aPos, double
     VECTOR2I start( aPos.x - drawsize.x / 2, aPos.y + drawsize.y / 2 );
     VECTOR2D dev_start = userToDeviceCoordinates( start );
 
-    /* PDF has an uhm... simplified coordinate system handling. There is
-       *one* operator to do everything (the PS concat equivalent). At least
-       they kept the matrix stack to save restore environments. Also images
-       are always emitted at the origin with a size of 1x1 user units.
-       What we need to do is:
-       1) save the CTM end establish the new one
-       2) plot the image
-       3) restore the CTM
-       4) profit
-     */
-    fprintf( m_workFile, "q %g 0 0 %g %g %g cm\n", // Step 1
-             userToDeviceSize( drawsize.x ),
-             userToDeviceSize( drawsize.y ),
-             dev_start.x, dev_start.y );
-
-    /* An inline image is a cross between a dictionary and a stream.
-       A real ugly construct (compared with the elegance of the PDF
-       format). Also it accepts some 'abbreviations', which is stupid
-       since the content stream is usually compressed anyway... */
-    fprintf( m_workFile,
-             "BI\n"
-             "  /BPC 8\n"
-             "  /CS %s\n"
-             "  /W %d\n"
-             "  /H %d\n"
-             "ID\n", m_colorMode ? "/RGB" : "/G", pix_size.x, pix_size.y );
-
-    /* Here comes the stream (in binary!). I *could* have hex or ascii84
-       encoded it, but who cares? I'll go through zlib anyway */
+    /* Images are written as image XObjects, out of the content stream.  Identical images
+       (the logo of a title block repeated on every sheet, for instance) are only written once
+       and shared by all their placements.  PDF images don't support alpha or masks, so these
+       are flattened against a white background first. */
+    std::string samples;
+
+    samples.reserve( (size_t) pix_size.x * pix_size.y * ( m_colorMode ? 3 : 1 ) );
+
     for( int y = 0; y < pix_size.y; y++ )
     {
         for( int x = 0; x < pix_size.x; x++ )
@@ -505,7 +564,7 @@ void PDF_PLOTTER::PlotImage( const wxImage& aImage, const VECTOR2I& aPos, double
             unsigned char g = aImage.GetGreen( x, y ) & 0xFF;
             unsigned char b = aImage.GetBlue( x, y ) & 0xFF;
 
-            // PDF inline images don't support alpha, so premultiply against white background
+            // premultiply against white background
             if( aImage.HasAlpha() )
             {
                 unsigned char alpha = aImage.GetAlpha( x, y ) & 0xFF;
@@ -530,23 +589,108 @@ void PDF_PLOTTER::PlotImage( const wxImage& aImage, const VECTOR2I& aPos, double
                 }
             }
 
-            // As usual these days, stdio buffering has to suffeeeeerrrr
             if( m_colorMode )
             {
-                putc( r, m_workFile );
-                putc( g, m_workFile );
-                putc( b, m_workFile );
+                samples.push_back( r );
+                samples.push_back( g );
+                samples.push_back( b );
             }
             else
             {
                 // Greyscale conversion (CIE 1931)
                 unsigned char grey = KiROUND( r * 0.2126 + g * 0.7152 + b * 0.0722 );
-                putc( grey, m_workFile );
+                samples.push_back( grey );
             }
         }
     }
 
-    fputs( "EI Q\n", m_workFile ); // Finish step 2 and do step 3
+    MD5_HASH hash;
+
+    hash.Hash( pix_size.x );
+    hash.Hash( pix_size.y );
+    hash.Hash( m_colorMode ? 1 : 0 );
+    hash.Hash( reinterpret_cast<uint8_t*>( samples.data() ), samples.size() );
+    hash.Finalize();
+
+    auto it = m_imageHandles.find( hash.Format( true ) );
+
+    if( it == m_imageHandles.end() )
+    {
+        PENDING_IMAGE image;
+
+        image.handle = allocPdfObject();
+        image.width = pix_size.x;
+        image.height = pix_size.y;
+        image.color = m_colorMode;
+
+        if( ADVANCED_CFG::GetCfg().m_DebugPDFWriter )
+        {
+            image.data = std::move( samples );
+        }
+        else
+        {
+            wxMemoryOutputStream memos( nullptr, std::max<size_t>( 2000, samples.size() / 4 ) );
+
+            {
+                wxZlibOutputStream zos( memos, wxZ_DEFAULT_COMPRESSION, wxZLIB_ZLIB );
+                zos.Write( samples.data(), samples.size() );
+            }   // flush the zip stream using zos destructor
+
+            wxStreamBuffer* sb = memos.GetOutputStreamBuffer();
+            image.data.assign( static_cast<const char*>( sb->GetBufferStart() ), sb->Tell() );
+        }
+
+        it = m_imageHandles.emplace( hash.Format( true ), image.handle ).first;
+        m_pendingImages.push_back( std::move( image ) );
+    }
+
+    /* PDF has an uhm... simplified coordinate system handling. There is
+       *one* operator to do everything (the PS concat equivalent). At least
+       they kept the matrix stack to save restore environments. Also images
+       are always emitted at the origin with a size of 1x1 user units.
+       What we need to do is:
+       1) save the CTM end establish the new one
+       2) plot the image
+       3) restore the CTM
+       4) profit
+     */
+    m_contentStream->Print( "q {:g} 0 0 {:g} {:g} {:g} cm /Im{} Do Q\n",
+                            userToDeviceSize( drawsize.x ),
+                            userToDeviceSize( drawsize.y ),
+                            dev_start.x, dev_start.y, it->second );
+
+    m_imagePlacements++;
+}
+
+
+void PDF_PLOTTER::emitPendingImages()
+{
+    for( const PENDING_IMAGE& image : m_pendingImages )
+    {
+        startPdfObject( image.handle );
+        fprintf( m_outputFile,
+                 "<< /Type /XObject\n"
+                 "   /Subtype /Image\n"
+                 "   /Width %d\n"
+                 "   /Height %d\n"
+                 "   /ColorSpace %s\n"
+                 "   /BitsPerComponent 8\n"
+                 "   /Length %u\n",
+                 image.width,
+                 image.height,
+                 image.color ? "/DeviceRGB" : "/DeviceGray",
+                 (unsigned) image.data.size() );
+
+        if( !ADVANCED_CFG::GetCfg().m_DebugPDFWriter )
+            fputs( "   /Filter /FlateDecode\n", m_outputFile );
+
+        fputs( ">>\nstream\n", m_outputFile );
+        fwrite( image.data.data(), 1, image.data.size(), m_outputFile );
+        fputs( "\nendstream\n", m_outputFile );
+        closePdfObject();
+    }
+
+    m_pendingImages.clear();
 }
 
 
@@ -560,7 +704,7 @@ int PDF_PLOTTER::allocPdfObject()
 int PDF_PLOTTER::startPdfObject(int handle)
 {
     wxASSERT( m_outputFile );
-    wxASSERT( !m_workFile );
+    wxASSERT( !m_contentStream );
 
     if( handle < 0)
         handle = allocPdfObject();
@@ -574,7 +718,7 @@ int PDF_PLOTTER::startPdfObject(int handle)
 void PDF_PLOTTER::closePdfObject()
 {
     wxASSERT( m_outputFile );
-    wxASSERT( !m_workFile );
+    wxASSERT( !m_contentStream );
     fputs( "endobj\n", m_outputFile );
 }
 
@@ -582,7 +726,7 @@ void PDF_PLOTTER::closePdfObject()
 int PDF_PLOTTER::startPdfStream( int handle )
 {
     wxASSERT( m_outputFile );
-    wxASSERT( !m_workFile );
+    wxASSERT( !m_contentStream );
     handle = startPdfObject( handle );
 
     // This is guaranteed to be handle+1 but needs to be allocated since
@@ -602,71 +746,24 @@ int PDF_PLOTTER::startPdfStream( int handle )
                  "stream\n", handle + 1 );
     }
 
-    // Open a temporary file to accumulate the stream
-    m_workFilename = wxFileName::CreateTempFileName( "" );
-    m_workFile = wxFopen( m_workFilename, wxT( "w+b" ) );
-    wxASSERT( m_workFile );
+    // The content is compressed and written as it comes
+    bool compress = !ADVANCED_CFG::GetCfg().m_DebugPDFWriter;
+
+    m_contentStream = std::make_unique<PDF_CONTENT_STREAM>( m_outputFile, compress );
     return handle;
 }
 
 
 void PDF_PLOTTER::closePdfStream()
 {
-    wxASSERT( m_workFile );
-
-    long stream_len = ftell( m_workFile );
-
-    if( stream_len < 0 )
-    {
-        wxASSERT( false );
-        return;
-    }
-
-    // Rewind the file, read in the page stream and DEFLATE it
-    fseek( m_workFile, 0, SEEK_SET );
-    unsigned char *inbuf = new unsigned char[stream_len];
-
-    int rc = fread( inbuf, 1, stream_len, m_workFile );
-    wxASSERT( rc == stream_len );
-    ignore_unused( rc );
+    wxASSERT( m_contentStream );
 
-    // We are done with the temporary file, junk it
-    fclose( m_workFile );
-    m_workFile = nullptr;
-    ::wxRemoveFile( m_workFilename );
+    unsigned out_count = m_contentStream->Finish();
 
-    unsigned out_count;
+    m_contentRawSize += m_contentStream->GetRawSize();
+    m_contentSize += out_count;
+    m_contentStream.reset();
 
-    if( ADVANCED_CFG::GetCfg().m_DebugPDFWriter )
-    {
-        out_count = stream_len;
-        fwrite( inbuf, out_count, 1, m_outputFile );
-    }
-    else
-    {
-        // NULL means memos owns the memory, but provide a hint on optimum size needed.
-        wxMemoryOutputStream    memos( nullptr, std::max( 2000l, stream_len ) ) ;
-
-        {
-            /* Somewhat standard parameters to compress in DEFLATE. The PDF spec is
-             * misleading, it says it wants a DEFLATE stream but it really want a ZLIB
-             * stream! (a DEFLATE stream would be generated with -15 instead of 15)
-             * rc = deflateInit2( &zstrm, Z_BEST_COMPRESSION, Z_DEFLATED, 15,
-             *                    8, Z_DEFAULT_STRATEGY );
-             */
-
-            wxZlibOutputStream      zos( memos, wxZ_BEST_COMPRESSION, wxZLIB_ZLIB );
-
-            zos.Write( inbuf, stream_len );
-        }   // flush the zip stream using zos destructor
-
-        wxStreamBuffer* sb = memos.GetOutputStreamBuffer();
-
-        out_count = sb->Tell();
-        fwrite( sb->GetBufferStart(), 1, out_count, m_outputFile );
-    }
-
-    delete[] inbuf;
     fputs( "\nendstream\n", m_outputFile );
     closePdfObject();
 
@@ -680,7 +777,7 @@ void PDF_PLOTTER::closePdfStream()
 void PDF_PLOTTER::StartPage( const wxString& aPageNumber, const wxString& aPageName )
 {
     wxASSERT( m_outputFile );
-    wxASSERT( !m_workFile );
+    wxASSERT( !m_contentStream );
 
     m_pageNumbers.push_back( aPageNumber );
     m_pageName = aPageName;
@@ -693,23 +790,23 @@ void PDF_PLOTTER::StartPage( const wxString& aPageNumber, const wxString& aPageN
     // Open the content stream; the page object will go later
     m_pageStreamHandle = startPdfStream();
 
-    /* Now, until ClosePage *everything* must be wrote in workFile, to be
-       compressed later in closePdfStream */
+    /* Now, until ClosePage *everything* must be wrote in the content stream, which is
+       compressed on the fly */
 
     // Default graphic settings (coordinate system, default color and line style)
-    fprintf( m_workFile,
-             "%g 0 0 %g 0 0 cm 1 J 1 j 0 0 0 rg 0 0 0 RG %g w\n",
-             0.0072 * plotScaleAdjX, 0.0072 * plotScaleAdjY,
-             userToDeviceSize( m_renderSettings->GetDefaultPenWidth() ) );
+    m_contentStream->Print( "{:g} 0 0 {:g} 0 0 cm 1 J 1 j 0 0 0 rg 0 0 0 RG {:g} w\n",
+                            0.0072 * plotScaleAdjX, 0.0072 * plotScaleAdjY,
+                            userToDeviceSize( m_renderSettings->GetDefaultPenWidth() ) );
 }
 
 
 void PDF_PLOTTER::ClosePage()
 {
-    wxASSERT( m_workFile );
+    wxASSERT( m_contentStream );
 
-    // Close the page stream (and compress it)
+    // Close the page stream, then write the images it was the first to use
     closePdfStream();
+    emitPendingImages();
 
     // Page size is in 1/72 of inch (default user space units).  Works like the bbox in postscript
     // but there is no need for swapping the sizes, since PDF doesn't require a portrait page.
@@ -799,11 +896,13 @@ void PDF_PLOTTER::ClosePage()
              "/Parent %d 0 R\n"
              "/Resources <<\n"
              "    /ProcSet [/PDF /Text /ImageC /ImageB]\n"
-             "    /Font %d 0 R >>\n"
+             "    /Font %d 0 R\n"
+             "    /XObject %d 0 R >>\n"
              "/MediaBox [0 0 %g %g]\n"
              "/Contents %d 0 R\n",
              m_pageTreeHandle,
              m_fontResDictHandle,
+             m_imageResDictHandle,
              psPaperSize.x,
              psPaperSize.y,
              m_pageStreamHandle );
@@ -886,6 +985,12 @@ bool PDF_PLOTTER::StartPlot( const wxString& aPageNumber, const wxString& aPageN
     m_hyperlinkMenuHandles.clear();
     m_bookmarksInPage.clear();
     m_totalOutlineNodes = 0;
+    m_imageHandles.clear();
+    m_pendingImages.clear();
+    m_imagePlacements = 0;
+    m_contentRawSize = 0;
+    m_contentSize = 0;
+    m_plotTimer.Start();
 
     m_outlineRoot = std::make_unique<OUTLINE_NODE>();
 
@@ -901,6 +1006,9 @@ bool PDF_PLOTTER::StartPlot( const wxString& aPageNumber, const wxString& aPageN
        (it *could* be inherited via the Pages tree */
     m_fontResDictHandle = allocPdfObject();
 
+    /* And the image XObjects, which are shared by the pages using them */
+    m_imageResDictHandle = allocPdfObject();
+
     /* Now, the PDF is read from the end, (more or less)... so we start
        with the page stream for page 1. Other more important stuff is written
        at the end */
@@ -1098,6 +1206,16 @@ bool PDF_PLOTTER::EndPlot()
     fputs( ">>\n", m_outputFile );
     closePdfObject();
 
+    // Named image dictionary, the images themselves went with the pages using them
+    startPdfObject( m_imageResDictHandle );
+    fputs( "<<\n", m_outputFile );
+
+    for( const auto& [ key, imageHandle ] : m_imageHandles )
+        fprintf( m_outputFile, "    /Im%d %d 0 R\n", imageHandle, imageHandle );
+
+    fputs( ">>\n", m_outputFile );
+    closePdfObject();
+
     for( const auto& [ linkHandle, linkPair ] : m_hyperlinkHandles )
     {
         const BOX2D&    box = linkPair.first;
@@ -1338,6 +1456,13 @@ bool PDF_PLOTTER::EndPlot()
              "%%%%EOF\n",
              (unsigned long) m_xrefTable.size(), catalogHandle, infoDictHandle, xref_start );
 
+    wxLogTrace( tracePdfPlotter,
+                wxT( "PDF plotted in %.1f ms: %d pages, %ld bytes, content streams %llu bytes "
+                     "(%llu uncompressed), %d images for %d placements" ),
+                m_plotTimer.msecs(), (int) m_pageHandles.size(), ftell( m_outputFile ),
+                (unsigned long long) m_contentSize, (unsigned long long) m_contentRawSize,
+                (int) m_imageHandles.size(), (int) m_imagePlacements );
+
     fclose( m_outputFile );
     m_outputFile = nullptr;
 
@@ -1385,16 +1510,16 @@ void PDF_PLOTTER::Text( const VECTOR2I&             aPos,
        coordinate system will be used for the overlining. Also the %f
        for the trig part of the matrix to avoid %g going in exponential
        format (which is not supported) */
-    fprintf( m_workFile, "q %f %f %f %f %g %g cm BT %s %g Tf %d Tr %g Tz ",
+    m_contentStream->Print( "q {:f} {:f} {:f} {:f} {:g} {:g} cm BT {} {:g} Tf {} Tr {:g} Tz ",
              ctm_a, ctm_b, ctm_c, ctm_d, ctm_e, ctm_f,
              fontname, heightFactor, render_mode, wideningFactor * 100 );
 
     // The text must be escaped correctly
     std:: string txt_pdf = encodeStringForPlotter( aText );
-    fprintf( m_workFile, "%s Tj ET\n", txt_pdf.c_str() );
+    m_contentStream->Print( "{} Tj ET\n", txt_pdf );
 
     // Restore the CTM
-    fputs( "Q\n", m_workFile );
+    m_contentStream->Write( "Q\n" );
 
     // Plot the stroked text (if requested)
     PLOTTER::Text( aPos, aColor, aText, aOrient, aSize, aH_justify, aV_justify, aWidth, aItalic,
@@ -141,6 +141,29 @@ void PICKED_ITEMS_LIST::ClearListAndDeleteItems( std::function<void(EDA_ITEM*)>
 }
 
 
+size_t PICKED_ITEMS_LIST::GetMemoryUsage(
+        const std::function<size_t( const EDA_ITEM* )>& aItemSize ) const
+{
+    size_t size = sizeof( PICKED_ITEMS_LIST ) + m_ItemsList.capacity() * sizeof( ITEM_PICKER );
+
+    // Same ownership rules as ClearListAndDeleteItems()
+    for( const ITEM_PICKER& wrapper : m_ItemsList )
+    {
+        if( wrapper.GetLink() )
+            size += aItemSize( wrapper.GetLink() );
+
+        if( wrapper.GetItem()
+                && ( ( wrapper.GetFlags() & UR_TRANSIENT )
+                        || wrapper.GetStatus() == UNDO_REDO::DELETED ) )
+        {
+            size += aItemSize( wrapper.GetItem() );
+        }
+    }
+
+    return size;
+}
+
+
 ITEM_PICKER PICKED_ITEMS_LIST::GetItemWrapper( unsigned int aIdx ) const
 {
     ITEM_PICKER picker;
@@ -314,6 +337,35 @@ void UNDO_REDO_CONTAINER::PushCommand( PICKED_ITEMS_LIST* aItem )
 }
 
 
+size_t UNDO_REDO_CONTAINER::GetMemoryUsage(
+        const std::function<size_t( const EDA_ITEM* )>& aItemSize ) const
+{
+    size_t size = 0;
+
+    for( const PICKED_ITEMS_LIST* command : m_CommandsList )
+        size += command->GetMemoryUsage( aItemSize );
+
+    return size;
+}
+
+
+int UNDO_REDO_CONTAINER::GetCommandCountOverMemory(
+        size_t aMaxMemory, const std::function<size_t( const EDA_ITEM* )>& aItemSize ) const
+{
+    size_t usage = GetMemoryUsage( aItemSize );
+    int    count = 0;
+
+    // Commands are stored from the oldest to the last one
+    for( size_t ii = 0; usage > aMaxMemory && ii + 1 < m_CommandsList.size(); ii++ )
+    {
+        usage -= m_CommandsList[ii]->GetMemoryUsage( aItemSize );
+        count++;
+    }
+
+    return count;
+}
+
+
 PICKED_ITEMS_LIST* UNDO_REDO_CONTAINER::PopCommand()
 {
     if( m_CommandsList.size() != 0 )
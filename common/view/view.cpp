@@ -263,7 +263,8 @@ VIEW::VIEW( bool aIsDynamic ) :
     m_dynamic( aIsDynamic ),
     m_useDrawPriority( false ),
     m_nextDrawPriority( 0 ),
-    m_reverseDrawOrder( false )
+    m_reverseDrawOrder( false ),
+    m_bulkAdd( false )
 {
     // Set m_boundary to define the max area size. The default area size
     // is defined here as the max value of a int.
@@ -334,7 +335,10 @@ void VIEW::Add( VIEW_ITEM* aItem, int aDrawPriority )
     for( int i = 0; i < layers_count; ++i )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
-        l.items->Insert( aItem );
+
+        if( !m_bulkAdd )
+            l.items->Insert( aItem );
+
         MarkTargetDirty( l.target );
     }
 
@@ -343,6 +347,40 @@ void VIEW::Add( VIEW_ITEM* aItem, int aDrawPriority )
 }
 
 
+void VIEW::BeginBulkAdd()
+{
+    m_bulkAdd = true;
+}
+
+
+void VIEW::EndBulkAdd()
+{
+    m_bulkAdd = false;
+    rebuildRTrees();
+}
+
+
+void VIEW::rebuildRTrees()
+{
+    std::vector<std::vector<VIEW_ITEM*>> layerItems( m_layers.size() );
+    int                                  layers[VIEW_MAX_LAYERS], layers_count;
+
+    for( VIEW_ITEM* item : *m_allItems )
+    {
+        item->viewPrivData()->getLayers( layers, layers_count );
+
+        for( int i = 0; i < layers_count; ++i )
+            layerItems[layers[i]].push_back( item );
+    }
+
+    for( size_t i = 0; i < m_layers.size(); ++i )
+    {
+        m_layers[i].items->BulkLoad( layerItems[i] );
+        MarkTargetDirty( m_layers[i].target );
+    }
+}
+
+
 void VIEW::Remove( VIEW_ITEM* aItem )
 {
     if( !aItem )
@@ -1433,28 +1471,17 @@ void VIEW::UpdateItems()
 
     if( ratio > 0.3 )
     {
-        auto allItems = *m_allItems;
-        int  layers[VIEW_MAX_LAYERS], layers_count;
-
-        // kill all Rtrees
-        for( VIEW_LAYER& layer : m_layers )
-            layer.items->RemoveAll();
+        int layers[VIEW_MAX_LAYERS], layers_count;
 
-        // and re-insert items from scratch
-        for( VIEW_ITEM* item : allItems )
+        for( VIEW_ITEM* item : *m_allItems )
         {
             item->ViewGetLayers( layers, layers_count );
             item->viewPrivData()->saveLayers( layers, layers_count );
-
-            for( int i = 0; i < layers_count; ++i )
-            {
-                VIEW_LAYER& l = m_layers[layers[i]];
-                l.items->Insert( item );
-                MarkTargetDirty( l.target );
-            }
-
             item->viewPrivData()->m_requiredUpdate &= ~( LAYERS | GEOMETRY );
         }
+
+        // and rebuild all the R-trees from scratch
+        rebuildRTrees();
     }
 
     if( anyUpdated )
@@ -20,6 +20,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <array>
+#include <atomic>
 #include <list>
 #include <future>
 #include <vector>
@@ -46,6 +48,7 @@
 #include <widgets/ui_common.h>
 #include <string_utils.h>
 #include <thread_pool.h>
+#include <trace_helpers.h>
 #include <wx/log.h>
 
 #include <advanced_config.h> // for realtime connectivity switch in release builds
@@ -465,6 +468,7 @@ void CONNECTION_GRAPH::Reset()
     m_item_to_subgraph_map.clear();
     m_local_label_cache.clear();
     m_global_label_cache.clear();
+    m_bus_netclass_members.clear();
     m_last_net_code = 1;
     m_last_bus_code = 1;
     m_last_subgraph_code = 1;
@@ -541,6 +545,39 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
     if( wxLog::IsAllowedTraceMask( ConnProfileMask ) )
         recalc_time.Show();
 
+#ifndef DEBUG
+    // Pressure relief valve for release builds.  When incremental updates are enabled, only
+    // the time taken by the updates themselves matters for real-time connectivity.
+    const double max_recalc_time_msecs = 250.;
+
+    if( m_allowRealTime && ADVANCED_CFG::GetCfg().m_RealTimeConnectivity
+            && !ADVANCED_CFG::GetCfg().m_IncrementalConnectivity
+            && recalc_time.msecs() > max_recalc_time_msecs )
+    {
+        m_allowRealTime = false;
+    }
+#endif
+}
+
+
+bool CONNECTION_GRAPH::RecalculateIncremental( const SCH_SHEET_LIST& aSheetList,
+                                               std::function<void( SCH_ITEM* )>* aChangedItemHandler )
+{
+    PROF_TIMER recalc_time( "CONNECTION_GRAPH::RecalculateIncremental" );
+
+    if( !updateIncremental( aSheetList, aChangedItemHandler ) )
+    {
+        wxLogTrace( ConnTrace, "Edit can't be handled incrementally; recalculating all nets" );
+
+        Recalculate( aSheetList, true, aChangedItemHandler );
+        return false;
+    }
+
+    recalc_time.Stop();
+
+    if( wxLog::IsAllowedTraceMask( ConnProfileMask ) )
+        recalc_time.Show();
+
 #ifndef DEBUG
     // Pressure relief valve for release builds
     const double max_recalc_time_msecs = 250.;
@@ -551,6 +588,648 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
         m_allowRealTime = false;
     }
 #endif
+
+    return true;
+}
+
+
+/**
+ * Return the name an item gives to the nets it drives by name (labels, sheet pins and power
+ * pins), or an empty string for other items.
+ */
+static wxString incrementalDriverName( SCH_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case SCH_LABEL_T:
+    case SCH_GLOBAL_LABEL_T:
+    case SCH_HIER_LABEL_T:
+    case SCH_SHEET_PIN_T:
+        return EscapeString( static_cast<SCH_TEXT*>( aItem )->GetShownText(), CTX_NETNAME );
+
+    case SCH_PIN_T:
+    {
+        SCH_PIN* pin = static_cast<SCH_PIN*>( aItem );
+
+        if( pin->IsPowerConnection() )
+            return EscapeString( pin->GetName(), CTX_NETNAME );
+
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    return wxEmptyString;
+}
+
+
+bool CONNECTION_GRAPH::updateIncremental( const SCH_SHEET_LIST& aSheetList,
+                                          std::function<void( SCH_ITEM* )>* aChangedItemHandler )
+{
+    // Sheets being added, removed or reordered change the hierarchy itself
+    if( m_subgraphs.empty() || m_sheetList.size() != aSheetList.size() )
+        return false;
+
+    for( size_t ii = 0; ii < aSheetList.size(); ++ii )
+    {
+        if( m_sheetList[ii] != aSheetList[ii] )
+            return false;
+    }
+
+    auto isBusItem =
+            []( const SCH_ITEM* aItem ) -> bool
+            {
+                return aItem->Type() == SCH_BUS_WIRE_ENTRY_T
+                        || aItem->Type() == SCH_BUS_BUS_ENTRY_T
+                        || aItem->GetLayer() == LAYER_BUS;
+            };
+
+    // Collect the dirty items of every sheet before touching anything: a screen can be shared
+    // by several sheet paths, and the dirty flags are cleared as soon as an item is processed.
+    // Symbols are handled at the pin level so that a single pin can be reconnected without
+    // rebuilding every net of the symbol.
+    std::unordered_set<SCH_ITEM*>                              liveItems;
+    std::unordered_set<SCH_SCREEN*>                            seenScreens;
+    std::unordered_set<SCH_SYMBOL*>                            dirtySymbols;
+    std::unordered_map<SCH_SHEET_PATH, std::vector<SCH_ITEM*>> dirtyItems;
+
+    for( const SCH_SHEET_PATH& sheet : aSheetList )
+    {
+        SCH_SCREEN* screen    = sheet.LastScreen();
+        bool        firstSeen = seenScreens.insert( screen ).second;
+
+        for( SCH_ITEM* item : screen->Items() )
+        {
+            if( !item->IsConnectable() )
+                continue;
+
+            if( item->Type() == SCH_SHEET_T )
+            {
+                if( item->IsConnectivityDirty() )
+                    return false;
+
+                if( firstSeen )
+                {
+                    for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( item )->GetPins() )
+                        liveItems.insert( pin );
+                }
+            }
+            else if( item->Type() == SCH_SYMBOL_T )
+            {
+                SCH_SYMBOL* symbol = static_cast<SCH_SYMBOL*>( item );
+
+                if( firstSeen )
+                {
+                    for( const std::unique_ptr<SCH_PIN>& pin : symbol->GetRawPins() )
+                        liveItems.insert( pin.get() );
+                }
+
+                if( symbol->IsConnectivityDirty() )
+                {
+                    dirtySymbols.insert( symbol );
+
+                    for( SCH_PIN* pin : symbol->GetPins( &sheet ) )
+                        dirtyItems[ sheet ].push_back( pin );
+                }
+            }
+            else
+            {
+                if( firstSeen )
+                    liveItems.insert( item );
+
+                if( item->IsConnectivityDirty() )
+                {
+                    if( isBusItem( item ) )
+                        return false;
+
+                    dirtyItems[ sheet ].push_back( item );
+                }
+            }
+        }
+    }
+
+    // Deleted items are only known by their address; they must never be dereferenced
+    std::unordered_set<SCH_ITEM*> deletedItems;
+
+    for( SCH_ITEM* item : m_items )
+    {
+        if( !liveItems.count( item ) )
+            deletedItems.insert( item );
+    }
+
+    if( dirtyItems.empty() && deletedItems.empty() && dirtySymbols.empty() )
+    {
+        m_sheetList = aSheetList;
+        return true;
+    }
+
+    // Invisible power pins of the same net are gathered in a single subgraph, even across
+    // sheets, so they can't be matched to a subgraph by sheet
+    std::unordered_set<SCH_ITEM*> invisiblePins;
+
+    for( const auto& [ sheet, pin ] : m_invisible_power_pins )
+        invisiblePins.insert( pin );
+
+    std::unordered_map<SCH_ITEM*, std::vector<CONNECTION_SUBGRAPH*>> itemSubgraphs;
+
+    for( CONNECTION_SUBGRAPH* subgraph : m_subgraphs )
+    {
+        if( subgraph->m_absorbed )
+            continue;
+
+        for( SCH_ITEM* item : subgraph->m_items )
+            itemSubgraphs[ item ].push_back( subgraph );
+    }
+
+    std::unordered_set<CONNECTION_SUBGRAPH*> seeds;
+    std::unordered_set<SCH_SHEET_PATH>       changedSheets;
+
+    auto addSubgraphsOf =
+            [&]( SCH_ITEM* aItem, const SCH_SHEET_PATH* aSheet )
+            {
+                auto it = itemSubgraphs.find( aItem );
+
+                if( it == itemSubgraphs.end() )
+                    return;
+
+                for( CONNECTION_SUBGRAPH* subgraph : it->second )
+                {
+                    if( !aSheet || subgraph->m_sheet == *aSheet || invisiblePins.count( aItem ) )
+                        seeds.insert( subgraph );
+                }
+            };
+
+    for( SCH_ITEM* item : deletedItems )
+    {
+        auto it = itemSubgraphs.find( item );
+
+        if( it == itemSubgraphs.end() )
+            continue;
+
+        for( CONNECTION_SUBGRAPH* subgraph : it->second )
+        {
+            seeds.insert( subgraph );
+            changedSheets.insert( subgraph->m_sheet );
+        }
+    }
+
+    std::unordered_set<wxString> names;
+
+    for( const auto& [ sheet, items ] : dirtyItems )
+    {
+        SCH_SCREEN* screen = sheet.LastScreen();
+
+        changedSheets.insert( sheet );
+
+        for( SCH_ITEM* item : items )
+        {
+            addSubgraphsOf( item, &sheet );
+
+            wxString name = incrementalDriverName( item );
+
+            if( !name.IsEmpty() )
+            {
+                if( item->Type() != SCH_PIN_T
+                        && SCH_CONNECTION::IsBusLabel( static_cast<SCH_TEXT*>( item )->GetShownText() ) )
+                {
+                    return false;
+                }
+
+                names.insert( name );
+            }
+
+            // Labels connect anywhere along a wire, so everything under the item is a possible
+            // new neighbor, not just what sits on its connection points
+            BOX2I bbox;
+
+            if( item->Type() == SCH_PIN_T )
+                bbox = BOX2I( static_cast<SCH_PIN*>( item )->GetPosition(), VECTOR2I( 0, 0 ) );
+            else
+                bbox = item->GetBoundingBox();
+
+            bbox.Inflate( 1 );
+
+            for( SCH_ITEM* neighbor : screen->Items().Overlapping( bbox ) )
+            {
+                if( neighbor == item || !neighbor->IsConnectable() )
+                    continue;
+
+                if( isBusItem( neighbor ) )
+                    return false;
+
+                if( neighbor->Type() == SCH_SYMBOL_T )
+                {
+                    for( SCH_PIN* pin : static_cast<SCH_SYMBOL*>( neighbor )->GetPins( &sheet ) )
+                    {
+                        if( bbox.Contains( pin->GetPosition() ) )
+                            addSubgraphsOf( pin, &sheet );
+                    }
+                }
+                else if( neighbor->Type() == SCH_SHEET_T )
+                {
+                    for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( neighbor )->GetPins() )
+                    {
+                        if( bbox.Contains( pin->GetTextPos() ) )
+                            addSubgraphsOf( pin, &sheet );
+                    }
+                }
+                else
+                {
+                    addSubgraphsOf( neighbor, &sheet );
+                }
+            }
+        }
+    }
+
+    // Dirty pins of the symbols whose unit changed aren't in the list above
+    for( SCH_SYMBOL* symbol : dirtySymbols )
+    {
+        for( const std::unique_ptr<SCH_PIN>& pin : symbol->GetRawPins() )
+            addSubgraphsOf( pin.get(), nullptr );
+    }
+
+    // Anything connected by name to a changed label or power pin, anywhere in the hierarchy
+    if( !names.empty() )
+    {
+        for( CONNECTION_SUBGRAPH* subgraph : m_driver_subgraphs )
+        {
+            for( SCH_ITEM* item : subgraph->m_items )
+            {
+                if( !deletedItems.count( item ) && names.count( incrementalDriverName( item ) ) )
+                {
+                    seeds.insert( subgraph );
+                    break;
+                }
+            }
+        }
+    }
+
+    // Extend the seeds to their whole nets.  The net maps are used to look up the old net of
+    // each subgraph as the driver of an old subgraph may be gone.
+    std::unordered_map<CONNECTION_SUBGRAPH*, const NET_NAME_CODE_CACHE_KEY*> subgraphNets;
+    std::unordered_map<CONNECTION_SUBGRAPH*, const wxString*>                subgraphNames;
+
+    for( const auto& [ key, subgraphs ] : m_net_code_to_subgraphs_map )
+    {
+        for( CONNECTION_SUBGRAPH* subgraph : subgraphs )
+            subgraphNets[ subgraph ] = &key;
+    }
+
+    for( const auto& [ name, subgraphs ] : m_net_name_to_subgraphs_map )
+    {
+        for( CONNECTION_SUBGRAPH* subgraph : subgraphs )
+            subgraphNames[ subgraph ] = &name;
+    }
+
+    std::unordered_set<CONNECTION_SUBGRAPH*> affected = seeds;
+
+    for( CONNECTION_SUBGRAPH* subgraph : seeds )
+    {
+        auto it = subgraphNets.find( subgraph );
+
+        if( it == subgraphNets.end() )
+            continue;
+
+        for( CONNECTION_SUBGRAPH* member : m_net_code_to_subgraphs_map.at( *it->second ) )
+            affected.insert( member );
+    }
+
+    std::unordered_set<wxString> oldNetNames;
+    size_t                       affectedItemCount = 0;
+
+    for( CONNECTION_SUBGRAPH* subgraph : affected )
+    {
+        if( subgraph->m_bus_entry || !subgraph->m_bus_neighbors.empty()
+                || !subgraph->m_bus_parents.empty() )
+        {
+            return false;
+        }
+
+        affectedItemCount += subgraph->m_items.size();
+
+        auto it = subgraphNames.find( subgraph );
+
+        if( it == subgraphNames.end() )
+            continue;
+
+        const wxString& name = *it->second;
+
+        if( m_bus_name_to_code_map.count( name ) )
+            return false;
+
+        // Weakly driven nets get a suffix when their name conflicts with another net, which
+        // depends on every net sharing the name
+        if( !subgraph->m_strong_driver
+                && ( m_net_name_to_subgraphs_map.count( name + wxT( "_1" ) )
+                     || ( name.Contains( '_' ) && name.AfterLast( '_' ).IsNumber() ) ) )
+        {
+            return false;
+        }
+
+        oldNetNames.insert( name );
+    }
+
+    // Past this point a full recalculation is cheaper
+    if( affectedItemCount * 2 > m_items.size() )
+        return false;
+
+    // Gather the items to rebuild, sheet by sheet
+    std::unordered_set<long> affectedCodes;
+
+    for( CONNECTION_SUBGRAPH* subgraph : affected )
+        affectedCodes.insert( subgraph->m_code );
+
+    std::unordered_map<SCH_SHEET_PATH, std::vector<SCH_ITEM*>>        affectedItems;
+    std::unordered_map<SCH_SHEET_PATH, std::unordered_set<SCH_ITEM*>> affectedItemSets;
+
+    auto addAffectedItem =
+            [&]( const SCH_SHEET_PATH& aSheet, SCH_ITEM* aItem )
+            {
+                if( affectedItemSets[ aSheet ].insert( aItem ).second )
+                    affectedItems[ aSheet ].push_back( aItem );
+            };
+
+    auto isStalePin =
+            [&]( SCH_ITEM* aItem ) -> bool
+            {
+                // Pins of changed symbols are in the dirty list already, for the unit used
+                // on each sheet
+                return aItem->Type() == SCH_PIN_T
+                        && dirtySymbols.count( static_cast<SCH_PIN*>( aItem )->GetParentSymbol() );
+            };
+
+    for( const auto& [ sheet, items ] : dirtyItems )
+    {
+        for( SCH_ITEM* item : items )
+            addAffectedItem( sheet, item );
+    }
+
+    for( CONNECTION_SUBGRAPH* subgraph : affected )
+    {
+        for( SCH_ITEM* item : subgraph->m_items )
+        {
+            if( deletedItems.count( item ) || invisiblePins.count( item ) || isStalePin( item ) )
+                continue;
+
+            addAffectedItem( subgraph->m_sheet, item );
+        }
+    }
+
+    for( const auto& [ sheet, pin ] : m_invisible_power_pins )
+    {
+        if( deletedItems.count( pin ) || isStalePin( pin ) )
+            continue;
+
+        SCH_CONNECTION* connection = pin->Connection( &sheet );
+
+        if( connection && affectedCodes.count( connection->SubgraphCode() ) )
+            addAffectedItem( sheet, pin );
+    }
+
+    wxLogTrace( ConnTrace, "Incremental update of %zu subgraphs", affected.size() );
+
+    // Rebuild the affected nets in a scratch graph, sharing the net codes of this one
+    CONNECTION_GRAPH update( m_schematic );
+
+    update.m_sheetList = aSheetList;
+    update.m_net_name_to_code_map = m_net_name_to_code_map;
+    update.m_bus_name_to_code_map = m_bus_name_to_code_map;
+    update.m_last_net_code = m_last_net_code;
+    update.m_last_bus_code = m_last_bus_code;
+    update.m_last_subgraph_code = m_last_subgraph_code;
+
+    for( const SCH_SHEET_PATH& sheet : aSheetList )
+    {
+        auto itemsIt = affectedItems.find( sheet );
+        bool changed = changedSheets.count( sheet ) > 0;
+
+        if( itemsIt == affectedItems.end() && !changed )
+            continue;
+
+        std::vector<std::pair<SCH_SYMBOL*, int>> symbolsChanged;
+
+        for( SCH_ITEM* item : sheet.LastScreen()->Items().OfType( SCH_SYMBOL_T ) )
+        {
+            SCH_SYMBOL* symbol = static_cast<SCH_SYMBOL*>( item );
+            int new_unit = symbol->GetUnitSelection( &sheet );
+
+            if( symbol->GetUnit() != new_unit )
+                symbolsChanged.push_back( { symbol, symbol->GetUnit() } );
+
+            symbol->UpdateUnit( new_unit );
+        }
+
+        if( itemsIt != affectedItems.end() )
+            update.updateItemConnectivity( sheet, itemsIt->second );
+
+        if( changed )
+        {
+            const std::unordered_set<SCH_ITEM*>& rebuilt = affectedItemSets[ sheet ];
+
+            sheet.LastScreen()->TestDanglingEnds( &sheet, aChangedItemHandler );
+
+            // Labels also link themselves to the wires they sit on when testing dangling
+            // ends; don't let those links pile up on items that weren't reset
+            for( SCH_ITEM* item : sheet.LastScreen()->Items() )
+            {
+                if( !item->IsConnectable() || item->Type() == SCH_SYMBOL_T
+                        || item->Type() == SCH_SHEET_T || rebuilt.count( item ) )
+                {
+                    continue;
+                }
+
+                SCH_ITEM_SET& connected = item->ConnectedItems( sheet );
+
+                std::sort( connected.begin(), connected.end() );
+                connected.erase( std::unique( connected.begin(), connected.end() ),
+                                 connected.end() );
+            }
+        }
+
+        for( auto& item : symbolsChanged )
+            item.first->UpdateUnit( item.second );
+    }
+
+    // The dirty symbols were not passed to updateItemConnectivity(), only their pins
+    for( SCH_SYMBOL* symbol : dirtySymbols )
+        symbol->SetConnectivityDirty( false );
+
+    update.buildConnectionGraph( aChangedItemHandler, false );
+
+    // Make sure the rebuilt nets don't depend on the nets that were left alone
+    for( CONNECTION_SUBGRAPH* subgraph : update.m_driver_subgraphs )
+    {
+        SCH_CONNECTION* connection = subgraph->m_driver_connection;
+
+        if( connection->IsBus() || !connection->Suffix().IsEmpty() || subgraph->m_bus_entry
+                || !subgraph->m_bus_neighbors.empty() || !subgraph->m_bus_parents.empty() )
+        {
+            return false;
+        }
+
+        if( subgraph->m_strong_driver )
+            continue;
+
+        auto it = m_net_name_to_subgraphs_map.find( connection->Name() );
+
+        if( it != m_net_name_to_subgraphs_map.end()
+                && std::any_of( it->second.begin(), it->second.end(),
+                                [&]( CONNECTION_SUBGRAPH* aOther )
+                                {
+                                    return !affected.count( aOther );
+                                } ) )
+        {
+            return false;
+        }
+    }
+
+    // Swap the rebuilt nets in
+    std::unordered_set<const CONNECTION_SUBGRAPH*> stale( affected.begin(), affected.end() );
+
+    for( CONNECTION_SUBGRAPH* subgraph : m_subgraphs )
+    {
+        CONNECTION_SUBGRAPH* root = subgraph;
+
+        while( root->m_absorbed )
+            root = root->m_absorbed_by;
+
+        if( root != subgraph && affected.count( root ) )
+            stale.insert( subgraph );
+    }
+
+    auto isStale =
+            [&]( const CONNECTION_SUBGRAPH* aSubgraph ) -> bool
+            {
+                return stale.count( aSubgraph ) > 0;
+            };
+
+    alg::delete_if( m_subgraphs, isStale );
+    alg::delete_if( m_driver_subgraphs, isStale );
+
+    for( auto& [ sheet, subgraphs ] : m_sheet_to_subgraphs_map )
+        alg::delete_if( subgraphs, isStale );
+
+    for( auto it = m_net_code_to_subgraphs_map.begin(); it != m_net_code_to_subgraphs_map.end(); )
+    {
+        alg::delete_if( it->second, isStale );
+        it = it->second.empty() ? m_net_code_to_subgraphs_map.erase( it ) : std::next( it );
+    }
+
+    for( auto it = m_net_name_to_subgraphs_map.begin(); it != m_net_name_to_subgraphs_map.end(); )
+    {
+        alg::delete_if( it->second, isStale );
+        it = it->second.empty() ? m_net_name_to_subgraphs_map.erase( it ) : std::next( it );
+    }
+
+    for( auto it = m_global_label_cache.begin(); it != m_global_label_cache.end(); )
+    {
+        alg::delete_if( it->second, isStale );
+        it = it->second.empty() ? m_global_label_cache.erase( it ) : std::next( it );
+    }
+
+    for( auto it = m_local_label_cache.begin(); it != m_local_label_cache.end(); )
+    {
+        alg::delete_if( it->second, isStale );
+        it = it->second.empty() ? m_local_label_cache.erase( it ) : std::next( it );
+    }
+
+    for( auto it = m_item_to_subgraph_map.begin(); it != m_item_to_subgraph_map.end(); )
+        it = isStale( it->second ) ? m_item_to_subgraph_map.erase( it ) : std::next( it );
+
+    alg::delete_if( m_invisible_power_pins,
+                    [&]( const std::pair<SCH_SHEET_PATH, SCH_PIN*>& aEntry ) -> bool
+                    {
+                        if( deletedItems.count( aEntry.second ) )
+                            return true;
+
+                        auto it = affectedItemSets.find( aEntry.first );
+
+                        return ( it != affectedItemSets.end() && it->second.count( aEntry.second ) )
+                                || isStalePin( aEntry.second );
+                    } );
+
+    alg::delete_if( m_items,
+                    [&]( SCH_ITEM* aItem ) -> bool
+                    {
+                        return deletedItems.count( aItem ) > 0;
+                    } );
+
+    for( const CONNECTION_SUBGRAPH* subgraph : stale )
+        delete subgraph;
+
+    std::unordered_set<SCH_ITEM*> knownItems( m_items.begin(), m_items.end() );
+
+    for( SCH_ITEM* item : update.m_items )
+    {
+        for( const auto& [ sheet, connection ] : item->m_connection_map )
+            connection->SetGraph( this );
+
+        if( knownItems.insert( item ).second )
+            m_items.push_back( item );
+    }
+
+    for( CONNECTION_SUBGRAPH* subgraph : update.m_subgraphs )
+    {
+        subgraph->m_graph = this;
+        m_subgraphs.push_back( subgraph );
+    }
+
+    for( CONNECTION_SUBGRAPH* subgraph : update.m_driver_subgraphs )
+    {
+        m_driver_subgraphs.push_back( subgraph );
+        m_sheet_to_subgraphs_map[ subgraph->m_sheet ].push_back( subgraph );
+    }
+
+    std::unordered_set<wxString> netNames = oldNetNames;
+
+    for( auto& [ key, subgraphs ] : update.m_net_code_to_subgraphs_map )
+    {
+        std::vector<CONNECTION_SUBGRAPH*>& net = m_net_code_to_subgraphs_map[ key ];
+        net.insert( net.end(), subgraphs.begin(), subgraphs.end() );
+    }
+
+    for( auto& [ name, subgraphs ] : update.m_net_name_to_subgraphs_map )
+    {
+        std::vector<CONNECTION_SUBGRAPH*>& net = m_net_name_to_subgraphs_map[ name ];
+        net.insert( net.end(), subgraphs.begin(), subgraphs.end() );
+        netNames.insert( name );
+    }
+
+    for( auto& [ name, subgraphs ] : update.m_global_label_cache )
+    {
+        std::vector<const CONNECTION_SUBGRAPH*>& cache = m_global_label_cache[ name ];
+        cache.insert( cache.end(), subgraphs.begin(), subgraphs.end() );
+    }
+
+    for( auto& [ key, subgraphs ] : update.m_local_label_cache )
+    {
+        std::vector<const CONNECTION_SUBGRAPH*>& cache = m_local_label_cache[ key ];
+        cache.insert( cache.end(), subgraphs.begin(), subgraphs.end() );
+    }
+
+    for( const auto& [ item, subgraph ] : update.m_item_to_subgraph_map )
+        m_item_to_subgraph_map[ item ] = subgraph;
+
+    m_invisible_power_pins.insert( m_invisible_power_pins.end(),
+                                   update.m_invisible_power_pins.begin(),
+                                   update.m_invisible_power_pins.end() );
+
+    m_bus_alias_cache = std::move( update.m_bus_alias_cache );
+    m_net_name_to_code_map = std::move( update.m_net_name_to_code_map );
+    m_bus_name_to_code_map = std::move( update.m_bus_name_to_code_map );
+    m_last_net_code = update.m_last_net_code;
+    m_last_bus_code = update.m_last_bus_code;
+    m_last_subgraph_code = update.m_last_subgraph_code;
+    m_sheetList = aSheetList;
+
+    // The subgraphs belong to this graph now
+    update.m_subgraphs.clear();
+
+    updateNetclassAssignments( &netNames, aChangedItemHandler );
+
+    return true;
 }
 
 
@@ -620,8 +1299,22 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
                 break;
 
             case SCH_PIN_T:
+            {
+                // Pins are only passed on their own (without their symbol) by incremental
+                // updates, when just some of the pins of a symbol are affected
+                SCH_PIN* pin = static_cast<SCH_PIN*>( item );
+
                 conn->SetType( CONNECTION_TYPE::NET );
+
+                // because calling the first time is not thread-safe
+                pin->GetDefaultNetName( aSheet );
+
+                if( pin->IsPowerConnection() && !pin->IsVisible() )
+                    m_invisible_power_pins.emplace_back( std::make_pair( aSheet, pin ) );
+
+                points.push_back( pin->GetPosition() );
                 break;
+            }
 
             case SCH_BUS_WIRE_ENTRY_T:
                 conn->SetType( CONNECTION_TYPE::NET );
@@ -1411,7 +2104,8 @@ void CONNECTION_GRAPH::processSubGraphs()
 //     on some portion of the items.
 
 
-void CONNECTION_GRAPH::buildConnectionGraph( std::function<void( SCH_ITEM* )>* aChangedItemHandler )
+void CONNECTION_GRAPH::buildConnectionGraph( std::function<void( SCH_ITEM* )>* aChangedItemHandler,
+                                             bool aUpdateNetclasses )
 {
     // Recache all bus aliases for later use
     wxCHECK_RET( m_schematic, wxT( "Connection graph cannot be built without schematic pointer" ) );
@@ -1685,10 +2379,30 @@ void CONNECTION_GRAPH::buildConnectionGraph( std::function<void( SCH_ITEM* )>* a
         m_net_name_to_subgraphs_map[subgraph->m_driver_connection->Name()].push_back( subgraph );
     }
 
+    if( aUpdateNetclasses )
+        updateNetclassAssignments( nullptr, aChangedItemHandler );
+}
+
+
+void CONNECTION_GRAPH::updateNetclassAssignments( const std::unordered_set<wxString>* aNetNames,
+                                                  std::function<void( SCH_ITEM* )>* aChangedItemHandler )
+{
     std::shared_ptr<NET_SETTINGS>& netSettings = m_schematic->Prj().GetProjectFile().m_NetSettings;
     std::map<wxString, wxString>   oldAssignments = netSettings->m_NetClassLabelAssignments;
 
-    netSettings->m_NetClassLabelAssignments.clear();
+    if( aNetNames )
+    {
+        for( const wxString& netname : *aNetNames )
+        {
+            if( !m_bus_netclass_members.count( netname ) )
+                netSettings->m_NetClassLabelAssignments.erase( netname );
+        }
+    }
+    else
+    {
+        netSettings->m_NetClassLabelAssignments.clear();
+        m_bus_netclass_members.clear();
+    }
 
     auto dirtySubgraphs =
             [&]( const std::vector<CONNECTION_SUBGRAPH*>& subgraphs )
@@ -1736,6 +2450,7 @@ void CONNECTION_GRAPH::buildConnectionGraph( std::function<void( SCH_ITEM* )>* a
                     for( const auto& member : driverSubgraph->m_driver_connection->Members() )
                     {
                         netSettings->m_NetClassLabelAssignments[ member->Name() ] = netclass;
+                        m_bus_netclass_members.insert( member->Name() );
 
                         auto ii = m_net_name_to_subgraphs_map.find( member->Name() );
 
@@ -1750,8 +2465,21 @@ void CONNECTION_GRAPH::buildConnectionGraph( std::function<void( SCH_ITEM* )>* a
                     dirtySubgraphs( subgraphs );
             };
 
-    for( const auto& [ netname, subgraphs ] : m_net_name_to_subgraphs_map )
-        checkNetclassDrivers( subgraphs );
+    if( aNetNames )
+    {
+        for( const wxString& netname : *aNetNames )
+        {
+            auto it = m_net_name_to_subgraphs_map.find( netname );
+
+            if( it != m_net_name_to_subgraphs_map.end() )
+                checkNetclassDrivers( it->second );
+        }
+    }
+    else
+    {
+        for( const auto& [ netname, subgraphs ] : m_net_name_to_subgraphs_map )
+            checkNetclassDrivers( subgraphs );
+    }
 }
 
 
@@ -2333,10 +3061,12 @@ int CONNECTION_GRAPH::RunERC()
     wxCHECK_MSG( m_schematic, true, "Null m_schematic in CONNECTION_GRAPH::RunERC" );
 
     ERC_SETTINGS& settings = m_schematic->ErcSettings();
+    const bool    profile = wxLog::IsAllowedTraceMask( traceErcProfile );
 
     // We don't want to run many ERC checks more than once on a given screen even though it may
     // represent multiple sheets with multiple subgraphs.  We can tell these apart by drivers.
-    std::set<SCH_ITEM*> seenDriverInstances;
+    std::set<SCH_ITEM*>               seenDriverInstances;
+    std::vector<CONNECTION_SUBGRAPH*> checkedSubgraphs;
 
     for( CONNECTION_SUBGRAPH* subgraph : m_subgraphs )
     {
@@ -2355,64 +3085,140 @@ int CONNECTION_GRAPH::RunERC()
         if( subgraph->m_driver )
             seenDriverInstances.insert( subgraph->m_driver );
 
-        /**
-         * NOTE:
-         *
-         * We could check that labels attached to bus subgraphs follow the
-         * proper format (i.e. actually define a bus).
-         *
-         * This check doesn't need to be here right now because labels
-         * won't actually be connected to bus wires if they aren't in the right
-         * format due to their TestDanglingEnds() implementation.
-         */
-        if( settings.IsTestEnabled( ERCE_DRIVER_CONFLICT ) )
-        {
-            if( !ercCheckMultipleDrivers( subgraph ) )
-                error_count++;
-        }
+        checkedSubgraphs.push_back( subgraph );
+    }
 
-        subgraph->ResolveDrivers( false );
+    enum SUBGRAPH_CHECK
+    {
+        CHECK_DRIVERS,
+        CHECK_BUS_TO_NET,
+        CHECK_BUS_ENTRIES,
+        CHECK_BUS_TO_BUS,
+        CHECK_FLOATING_WIRES,
+        CHECK_NO_CONNECTS,
+        CHECK_LABELS,
+        CHECK_COUNT
+    };
 
-        if( settings.IsTestEnabled( ERCE_BUS_TO_NET_CONFLICT ) )
-        {
-            if( !ercCheckBusToNetConflicts( subgraph ) )
-                error_count++;
-        }
+    using CHECK_TIMES = std::array<double, CHECK_COUNT>;
 
-        if( settings.IsTestEnabled( ERCE_BUS_ENTRY_CONFLICT ) )
-        {
-            if( !ercCheckBusToBusEntryConflicts( subgraph ) )
-                error_count++;
-        }
+    // The per-subgraph checks only read the graph, so they run in parallel.  Each subgraph
+    // gets its own marker list; the lists are added to the screens afterwards in subgraph
+    // order so that the results don't depend on the thread scheduling.
+    std::vector<std::vector<SCH_MARKER*>> markers( checkedSubgraphs.size() );
+    CHECK_TIMES                           checkTimes = {};
+    std::atomic<int>                      subgraphErrors( 0 );
+    std::mutex                            timesLock;
 
-        if( settings.IsTestEnabled( ERCE_BUS_TO_BUS_CONFLICT ) )
-        {
-            if( !ercCheckBusToBusConflicts( subgraph ) )
-                error_count++;
-        }
+    auto runChecks =
+            [&]( CONNECTION_SUBGRAPH* aSubgraph, std::vector<SCH_MARKER*>& aMarkers,
+                 CHECK_TIMES& aTimes )
+            {
+                auto runCheck =
+                        [&]( SUBGRAPH_CHECK aCheck, const std::function<bool()>& aTest )
+                        {
+                            PROF_TIMER timer( "", profile );
 
-        if( settings.IsTestEnabled( ERCE_WIRE_DANGLING ) )
-        {
-            if( !ercCheckFloatingWires( subgraph ) )
-                error_count++;
-        }
+                            if( !aTest() )
+                                subgraphErrors++;
 
-        if( settings.IsTestEnabled( ERCE_NOCONNECT_CONNECTED )
-                || settings.IsTestEnabled( ERCE_NOCONNECT_NOT_CONNECTED )
-                || settings.IsTestEnabled( ERCE_PIN_NOT_CONNECTED ) )
-        {
-            if( !ercCheckNoConnects( subgraph ) )
-                error_count++;
-        }
+                            if( profile )
+                                aTimes[aCheck] += timer.msecs();
+                        };
 
-        if( settings.IsTestEnabled( ERCE_LABEL_NOT_CONNECTED )
-                || settings.IsTestEnabled( ERCE_GLOBLABEL ) )
-        {
-            if( !ercCheckLabels( subgraph ) )
-                error_count++;
-        }
+                /**
+                 * NOTE:
+                 *
+                 * We could check that labels attached to bus subgraphs follow the
+                 * proper format (i.e. actually define a bus).
+                 *
+                 * This check doesn't need to be here right now because labels
+                 * won't actually be connected to bus wires if they aren't in the right
+                 * format due to their TestDanglingEnds() implementation.
+                 */
+                if( settings.IsTestEnabled( ERCE_DRIVER_CONFLICT ) )
+                {
+                    runCheck( CHECK_DRIVERS,
+                              [&]() { return ercCheckMultipleDrivers( aSubgraph, aMarkers ); } );
+                }
+
+                aSubgraph->ResolveDrivers( false );
+
+                if( settings.IsTestEnabled( ERCE_BUS_TO_NET_CONFLICT ) )
+                {
+                    runCheck( CHECK_BUS_TO_NET,
+                              [&]() { return ercCheckBusToNetConflicts( aSubgraph, aMarkers ); } );
+                }
+
+                if( settings.IsTestEnabled( ERCE_BUS_ENTRY_CONFLICT ) )
+                {
+                    runCheck( CHECK_BUS_ENTRIES,
+                              [&]()
+                              {
+                                  return ercCheckBusToBusEntryConflicts( aSubgraph, aMarkers );
+                              } );
+                }
+
+                if( settings.IsTestEnabled( ERCE_BUS_TO_BUS_CONFLICT ) )
+                {
+                    runCheck( CHECK_BUS_TO_BUS,
+                              [&]() { return ercCheckBusToBusConflicts( aSubgraph, aMarkers ); } );
+                }
+
+                if( settings.IsTestEnabled( ERCE_WIRE_DANGLING ) )
+                {
+                    runCheck( CHECK_FLOATING_WIRES,
+                              [&]() { return ercCheckFloatingWires( aSubgraph, aMarkers ); } );
+                }
+
+                if( settings.IsTestEnabled( ERCE_NOCONNECT_CONNECTED )
+                        || settings.IsTestEnabled( ERCE_NOCONNECT_NOT_CONNECTED )
+                        || settings.IsTestEnabled( ERCE_PIN_NOT_CONNECTED ) )
+                {
+                    runCheck( CHECK_NO_CONNECTS,
+                              [&]() { return ercCheckNoConnects( aSubgraph, aMarkers ); } );
+                }
+
+                if( settings.IsTestEnabled( ERCE_LABEL_NOT_CONNECTED )
+                        || settings.IsTestEnabled( ERCE_GLOBLABEL ) )
+                {
+                    runCheck( CHECK_LABELS,
+                              [&]() { return ercCheckLabels( aSubgraph, aMarkers ); } );
+                }
+            };
+
+    PROF_TIMER subgraph_time( "ERC subgraph checks" );
+
+    thread_pool& tp = GetKiCadThreadPool();
+
+    tp.push_loop( checkedSubgraphs.size(),
+            [&]( const int a, const int b)
+            {
+                CHECK_TIMES times = {};
+
+                for( int ii = a; ii < b; ++ii )
+                    runChecks( checkedSubgraphs[ii], markers[ii], times );
+
+                std::lock_guard<std::mutex> lock( timesLock );
+
+                for( size_t jj = 0; jj < CHECK_COUNT; ++jj )
+                    checkTimes[jj] += times[jj];
+            });
+    tp.wait_for_tasks();
+
+    for( size_t ii = 0; ii < checkedSubgraphs.size(); ++ii )
+    {
+        SCH_SCREEN* screen = checkedSubgraphs[ii]->m_sheet.LastScreen();
+
+        for( SCH_MARKER* marker : markers[ii] )
+            screen->Append( marker );
     }
 
+    error_count += subgraphErrors;
+    subgraph_time.Stop();
+
+    PROF_TIMER hier_time( "ERC hierarchical sheets" );
+
     // Hierarchical sheet checking is done at the schematic level
     if( settings.IsTestEnabled( ERCE_HIERACHICAL_LABEL )
             || settings.IsTestEnabled( ERCE_PIN_NOT_CONNECTED ) )
@@ -2420,6 +3226,10 @@ int CONNECTION_GRAPH::RunERC()
         error_count += ercCheckHierSheets();
     }
 
+    hier_time.Stop();
+
+    PROF_TIMER netclass_time( "ERC netclass conflicts" );
+
     if( settings.IsTestEnabled( ERCE_NETCLASS_CONFLICT ) )
     {
         for( const auto& [ netname, subgraphs ] : m_net_name_to_subgraphs_map )
@@ -2429,11 +3239,36 @@ int CONNECTION_GRAPH::RunERC()
         }
     }
 
+    netclass_time.Stop();
+
+    if( profile )
+    {
+        // Per-check times are summed over all the threads, so they can add up to more than
+        // the wall-clock time of the subgraph checks
+        static const char* checkNames[CHECK_COUNT] = { "multiple drivers", "bus to net",
+                                                       "bus entries", "bus to bus",
+                                                       "floating wires", "no connects",
+                                                       "labels" };
+
+        wxLogTrace( traceErcProfile, "%s (%zu subgraphs)", subgraph_time.to_string(),
+                    checkedSubgraphs.size() );
+
+        for( size_t ii = 0; ii < CHECK_COUNT; ++ii )
+        {
+            if( checkTimes[ii] > 0.0 )
+                wxLogTrace( traceErcProfile, "    %s: %0.1f ms", checkNames[ii], checkTimes[ii] );
+        }
+
+        wxLogTrace( traceErcProfile, "%s", hier_time.to_string() );
+        wxLogTrace( traceErcProfile, "%s", netclass_time.to_string() );
+    }
+
     return error_count;
 }
 
 
-bool CONNECTION_GRAPH::ercCheckMultipleDrivers( const CONNECTION_SUBGRAPH* aSubgraph )
+bool CONNECTION_GRAPH::ercCheckMultipleDrivers( const CONNECTION_SUBGRAPH* aSubgraph,
+                                                std::vector<SCH_MARKER*>& aMarkers )
 {
     wxCHECK( aSubgraph, false );
     /*
@@ -2463,7 +3298,7 @@ bool CONNECTION_GRAPH::ercCheckMultipleDrivers( const CONNECTION_SUBGRAPH* aSubg
         ercItem->SetErrorMessage( msg );
 
         SCH_MARKER* marker = new SCH_MARKER( ercItem, pos );
-        aSubgraph->m_sheet.LastScreen()->Append( marker );
+        aMarkers.push_back( marker );
 
         return false;
     }
@@ -2496,7 +3331,7 @@ bool CONNECTION_GRAPH::ercCheckMultipleDrivers( const CONNECTION_SUBGRAPH* aSubg
                 ercItem->SetErrorMessage( msg );
 
                 SCH_MARKER* marker = new SCH_MARKER( ercItem, driver->GetPosition() );
-                aSubgraph->m_sheet.LastScreen()->Append( marker );
+                aMarkers.push_back( marker );
 
                 return false;
             }
@@ -2546,11 +3381,9 @@ bool CONNECTION_GRAPH::ercCheckNetclassConflicts( const std::vector<CONNECTION_S
 }
 
 
-bool CONNECTION_GRAPH::ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSubgraph )
+bool CONNECTION_GRAPH::ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSubgraph,
+                                                  std::vector<SCH_MARKER*>& aMarkers )
 {
-    const SCH_SHEET_PATH& sheet = aSubgraph->m_sheet;
-    SCH_SCREEN* screen = sheet.LastScreen();
-
     SCH_ITEM* net_item = nullptr;
     SCH_ITEM* bus_item = nullptr;
     SCH_CONNECTION conn( this );
@@ -2594,7 +3427,7 @@ bool CONNECTION_GRAPH::ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSu
         ercItem->SetItems( net_item, bus_item );
 
         SCH_MARKER* marker = new SCH_MARKER( ercItem, net_item->GetPosition() );
-        screen->Append( marker );
+        aMarkers.push_back( marker );
 
         return false;
     }
@@ -2603,10 +3436,10 @@ bool CONNECTION_GRAPH::ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSu
 }
 
 
-bool CONNECTION_GRAPH::ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSubgraph )
+bool CONNECTION_GRAPH::ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSubgraph,
+                                                  std::vector<SCH_MARKER*>& aMarkers )
 {
     const SCH_SHEET_PATH& sheet = aSubgraph->m_sheet;
-    SCH_SCREEN* screen = sheet.LastScreen();
 
     SCH_ITEM* label = nullptr;
     SCH_ITEM* port = nullptr;
@@ -2661,7 +3494,7 @@ bool CONNECTION_GRAPH::ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSu
             ercItem->SetItems( label, port );
 
             SCH_MARKER* marker = new SCH_MARKER( ercItem, label->GetPosition() );
-            screen->Append( marker );
+            aMarkers.push_back( marker );
 
             return false;
         }
@@ -2671,11 +3504,11 @@ bool CONNECTION_GRAPH::ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSu
 }
 
 
-bool CONNECTION_GRAPH::ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH* aSubgraph )
+bool CONNECTION_GRAPH::ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH* aSubgraph,
+                                                       std::vector<SCH_MARKER*>& aMarkers )
 {
     bool conflict = false;
     const SCH_SHEET_PATH& sheet = aSubgraph->m_sheet;
-    SCH_SCREEN* screen = sheet.LastScreen();
 
     SCH_BUS_WIRE_ENTRY* bus_entry = nullptr;
     SCH_ITEM* bus_wire = nullptr;
@@ -2765,7 +3598,7 @@ bool CONNECTION_GRAPH::ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH
         ercItem->SetErrorMessage( msg );
 
         SCH_MARKER* marker = new SCH_MARKER( ercItem, bus_entry->GetPosition() );
-        screen->Append( marker );
+        aMarkers.push_back( marker );
 
         return false;
     }
@@ -2775,11 +3608,11 @@ bool CONNECTION_GRAPH::ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH
 
 
 // TODO(JE) Check sheet pins here too?
-bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph )
+bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph,
+                                           std::vector<SCH_MARKER*>& aMarkers )
 {
     ERC_SETTINGS&         settings = m_schematic->ErcSettings();
     const SCH_SHEET_PATH& sheet  = aSubgraph->m_sheet;
-    SCH_SCREEN*           screen = sheet.LastScreen();
     bool                  ok     = true;
 
     if( aSubgraph->m_no_connect != nullptr )
@@ -2830,7 +3663,7 @@ bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph
             ercItem->SetItems( pin );
 
             SCH_MARKER* marker = new SCH_MARKER( ercItem, pin->GetTransformedPosition() );
-            screen->Append( marker );
+            aMarkers.push_back( marker );
 
             ok = false;
         }
@@ -2841,7 +3674,7 @@ bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph
             ercItem->SetItems( aSubgraph->m_no_connect );
 
             SCH_MARKER* marker = new SCH_MARKER( ercItem, aSubgraph->m_no_connect->GetPosition() );
-            screen->Append( marker );
+            aMarkers.push_back( marker );
 
             ok = false;
         }
@@ -2921,7 +3754,7 @@ bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph
             ercItem->SetItems( pin );
 
             SCH_MARKER* marker = new SCH_MARKER( ercItem, pin->GetTransformedPosition() );
-            screen->Append( marker );
+            aMarkers.push_back( marker );
 
             ok = false;
         }
@@ -2945,7 +3778,7 @@ bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph
 
                     SCH_MARKER* marker = new SCH_MARKER( ercItem,
                                                          testPin->GetTransformedPosition() );
-                    screen->Append( marker );
+                    aMarkers.push_back( marker );
 
                     ok = false;
                 }
@@ -2957,7 +3790,8 @@ bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph
 }
 
 
-bool CONNECTION_GRAPH::ercCheckFloatingWires( const CONNECTION_SUBGRAPH* aSubgraph )
+bool CONNECTION_GRAPH::ercCheckFloatingWires( const CONNECTION_SUBGRAPH* aSubgraph,
+                                              std::vector<SCH_MARKER*>& aMarkers )
 {
     if( aSubgraph->m_driver )
         return true;
@@ -2977,8 +3811,6 @@ bool CONNECTION_GRAPH::ercCheckFloatingWires( const CONNECTION_SUBGRAPH* aSubgra
 
     if( !wires.empty() )
     {
-        SCH_SCREEN* screen = aSubgraph->m_sheet.LastScreen();
-
         std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_WIRE_DANGLING );
         ercItem->SetItems( wires[0],
                            wires.size() > 1 ? wires[1] : nullptr,
@@ -2986,7 +3818,7 @@ bool CONNECTION_GRAPH::ercCheckFloatingWires( const CONNECTION_SUBGRAPH* aSubgra
                            wires.size() > 3 ? wires[3] : nullptr );
 
         SCH_MARKER* marker = new SCH_MARKER( ercItem, wires[0]->GetPosition() );
-        screen->Append( marker );
+        aMarkers.push_back( marker );
 
         return false;
     }
@@ -2995,7 +3827,8 @@ bool CONNECTION_GRAPH::ercCheckFloatingWires( const CONNECTION_SUBGRAPH* aSubgra
 }
 
 
-bool CONNECTION_GRAPH::ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph )
+bool CONNECTION_GRAPH::ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph,
+                                       std::vector<SCH_MARKER*>& aMarkers )
 {
     // Label connection rules:
     // Any label without a no-connect needs to have at least 2 pins, otherwise it is invalid
@@ -3047,7 +3880,7 @@ bool CONNECTION_GRAPH::ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph )
             ercItem->SetItems( aText );
 
             SCH_MARKER* marker = new SCH_MARKER( ercItem, aText->GetPosition() );
-            aSubgraph->m_sheet.LastScreen()->Append( marker );
+            aMarkers.push_back( marker );
         }
     };
 
@@ -301,6 +301,22 @@ public:
     void Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnconditional = false,
                       std::function<void( SCH_ITEM* )>* aChangedItemHandler = nullptr );
 
+    /**
+     * Updates the connection graph for the items whose connectivity is dirty.
+     *
+     * Only the nets containing dirty or deleted items, the nets they now touch and the nets
+     * sharing a label or power name with them are rebuilt; everything else is kept from the
+     * previous calculation.  Edits that involve sheets or buses, or whose result could depend
+     * on the rest of the schematic (such as weak net name conflicts), fall back to a full
+     * Recalculate().
+     *
+     * @param aSheetList is the list of all sheets in the schematic
+     * @param aChangedItemHandler an optional handler to receive any changed items
+     * @return true if the graph was updated incrementally, false if it was fully rebuilt
+     */
+    bool RecalculateIncremental( const SCH_SHEET_LIST& aSheetList,
+                                 std::function<void( SCH_ITEM* )>* aChangedItemHandler = nullptr );
+
     /**
      * Returns a bus alias pointer for the given name if it exists (from cache)
      *
@@ -392,7 +408,27 @@ private:
      * and then the connection for the chosen driver is propagated to all the
      * other items in the subgraph.
      */
-    void buildConnectionGraph( std::function<void( SCH_ITEM* )>* aChangedItemHandler );
+    void buildConnectionGraph( std::function<void( SCH_ITEM* )>* aChangedItemHandler,
+                               bool aUpdateNetclasses = true );
+
+    /**
+     * Tries to update the graph from the dirty items without rebuilding everything.
+     *
+     * The affected nets are rebuilt in a scratch graph and then swapped into this one.
+     *
+     * @return false if the edit can't be handled incrementally; the graph then needs a full
+     *         recalculation as item connections may already have been reset
+     */
+    bool updateIncremental( const SCH_SHEET_LIST& aSheetList,
+                            std::function<void( SCH_ITEM* )>* aChangedItemHandler );
+
+    /**
+     * Rebuilds the project netclass label assignments from the net map.
+     *
+     * @param aNetNames is the set of nets to update, or nullptr to rebuild all assignments
+     */
+    void updateNetclassAssignments( const std::unordered_set<wxString>* aNetNames,
+                                    std::function<void( SCH_ITEM* )>* aChangedItemHandler );
 
     /**
      * Generates individual item subgraphs on a per-sheet basis
@@ -473,9 +509,11 @@ private:
      * ResolveDrivers() will have stored the second driver for use by this function, which actually
      * creates the markers
      * @param aSubgraph is the subgraph to examine
+     * @param aMarkers receives the markers to add to the subgraph's screen
      * @return  true for no errors, false for errors
      */
-    bool ercCheckMultipleDrivers( const CONNECTION_SUBGRAPH* aSubgraph );
+    bool ercCheckMultipleDrivers( const CONNECTION_SUBGRAPH* aSubgraph,
+                                  std::vector<SCH_MARKER*>& aMarkers );
 
     bool ercCheckNetclassConflicts( const std::vector<CONNECTION_SUBGRAPH*>& subgraphs );
 
@@ -485,9 +523,11 @@ private:
      * For example, a net wire connected to a bus port/pin, or vice versa
      *
      * @param  aSubgraph      is the subgraph to examine
+     * @param  aMarkers       receives the markers to add to the subgraph's screen
      * @return                true for no errors, false for errors
      */
-    bool ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSubgraph );
+    bool ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSubgraph,
+                                    std::vector<SCH_MARKER*>& aMarkers );
 
     /**
      * Checks one subgraph for conflicting connections between two bus items
@@ -497,9 +537,11 @@ private:
      * sheet pin
      *
      * @param  aSubgraph      is the subgraph to examine
+     * @param  aMarkers       receives the markers to add to the subgraph's screen
      * @return                true for no errors, false for errors
      */
-    bool ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSubgraph );
+    bool ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSubgraph,
+                                    std::vector<SCH_MARKER*>& aMarkers );
 
     /**
      * Checks one subgraph for conflicting bus entry to bus connections
@@ -511,9 +553,11 @@ private:
      * "USB.DP" but someone might accidentally just enter "DP"
      *
      * @param  aSubgraph      is the subgraph to examine
+     * @param  aMarkers       receives the markers to add to the subgraph's screen
      * @return                true for no errors, false for errors
      */
-    bool ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH* aSubgraph );
+    bool ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH* aSubgraph,
+                                         std::vector<SCH_MARKER*>& aMarkers );
 
     /**
      * Checks one subgraph for proper presence or absence of no-connect symbols
@@ -522,9 +566,11 @@ private:
      * A pin without a no-connect symbol should have at least one connection
      *
      * @param  aSubgraph      is the subgraph to examine
+     * @param  aMarkers       receives the markers to add to the subgraph's screen
      * @return                true for no errors, false for errors
      */
-    bool ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph );
+    bool ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph,
+                             std::vector<SCH_MARKER*>& aMarkers );
 
     /**
      * Checks one subgraph for floating wires
@@ -532,9 +578,11 @@ private:
      * Will throw an error for any subgraph that consists of just wires with no driver
      *
      * @param  aSubgraph      is the subgraph to examine
+     * @param  aMarkers       receives the markers to add to the subgraph's screen
      * @return                true for no errors, false for errors
      */
-    bool ercCheckFloatingWires( const CONNECTION_SUBGRAPH* aSubgraph );
+    bool ercCheckFloatingWires( const CONNECTION_SUBGRAPH* aSubgraph,
+                                std::vector<SCH_MARKER*>& aMarkers );
 
     /**
      * Checks one subgraph for proper connection of labels
@@ -542,10 +590,11 @@ private:
      * Labels should be connected to something
      *
      * @param  aSubgraph      is the subgraph to examine
-     * @param  aCheckGlobalLabels is true if global labels should be checked for loneliness
+     * @param  aMarkers       receives the markers to add to the subgraph's screen
      * @return                true for no errors, false for errors
      */
-    bool ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph );
+    bool ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph,
+                         std::vector<SCH_MARKER*>& aMarkers );
 
     /**
      * Checks that a hierarchical sheet has at least one matching label inside the sheet for each
@@ -595,6 +644,9 @@ private:
 
     NET_MAP m_net_code_to_subgraphs_map;
 
+    // Nets whose netclass assignment comes from a bus label rather than from their own drivers
+    std::unordered_set<wxString> m_bus_netclass_members;
+
     int m_last_net_code;
 
     int m_last_bus_code;
@@ -47,6 +47,8 @@
 #include <eeschema_settings.h>
 #include <string_utils.h>
 #include <kiplatform/ui.h>
+#include <profile.h>
+#include <trace_helpers.h>
 
 // wxWidgets spends *far* too long calcuating column widths (most of it, believe it or
 // not, in repeatedly creating/destroying a wxDC to do the measurement in).
@@ -465,25 +467,40 @@ void DIALOG_ERC::testErc()
     SCH_SCREENS screens( sch->Root() );
     ERC_SETTINGS& settings = sch->ErcSettings();
     ERC_TESTER tester( sch );
+    PROF_TIMER timer;
+
+    // Reports the time taken by a test; the timer is restarted right before each test so that
+    // the progress reporting and the connectivity update are not counted
+    auto traceTime =
+            [&]( const char* aTest )
+            {
+                wxLogTrace( traceErcProfile, "%s: %0.1f ms", aTest, timer.msecs() );
+            };
 
     // Test duplicate sheet names inside a given sheet.  While one can have multiple references
     // to the same file, each must have a unique name.
     if( settings.IsTestEnabled( ERCE_DUPLICATE_SHEET_NAME ) )
     {
         AdvancePhase( _( "Checking sheet names..." ) );
+        timer.Start();
         tester.TestDuplicateSheetNames( true );
+        traceTime( "sheet names" );
     }
 
     if( settings.IsTestEnabled( ERCE_BUS_ALIAS_CONFLICT ) )
     {
         AdvancePhase( _( "Checking bus conflicts..." ) );
+        timer.Start();
         tester.TestConflictingBusAliases();
+        traceTime( "bus aliases" );
     }
 
     // The connection graph has a whole set of ERC checks it can run
     AdvancePhase( _( "Checking conflicts..." ) );
     m_parent->RecalculateConnections( NO_CLEANUP );
+    timer.Start();
     sch->ConnectionGraph()->RunERC();
+    traceTime( "connection graph" );
 
     AdvancePhase( _( "Checking units..." ) );
 
@@ -491,7 +508,9 @@ void DIALOG_ERC::testErc()
     if( settings.IsTestEnabled( ERCE_DIFFERENT_UNIT_FP ) )
     {
         AdvancePhase( _( "Checking footprints..." ) );
+        timer.Start();
         tester.TestMultiunitFootprints();
+        traceTime( "unit footprints" );
     }
 
     if( settings.IsTestEnabled( ERCE_MISSING_UNIT )
@@ -499,20 +518,28 @@ void DIALOG_ERC::testErc()
             || settings.IsTestEnabled( ERCE_MISSING_POWER_INPUT_PIN )
             || settings.IsTestEnabled( ERCE_MISSING_BIDI_PIN ) )
     {
+        timer.Start();
         tester.TestMissingUnits();
+        traceTime( "missing units" );
     }
 
     AdvancePhase( _( "Checking pins..." ) );
 
     if( settings.IsTestEnabled( ERCE_DIFFERENT_UNIT_NET ) )
+    {
+        timer.Start();
         tester.TestMultUnitPinConflicts();
+        traceTime( "unit nets" );
+    }
 
     // Test pins on each net against the pin connection table
     if( settings.IsTestEnabled( ERCE_PIN_TO_PIN_ERROR )
             || settings.IsTestEnabled( ERCE_POWERPIN_NOT_DRIVEN )
             || settings.IsTestEnabled( ERCE_PIN_NOT_DRIVEN ) )
     {
+         timer.Start();
          tester.TestPinToPin();
+         traceTime( "pin to pin" );
     }
 
     // Test similar labels (i;e. labels which are identical when
@@ -520,37 +547,49 @@ void DIALOG_ERC::testErc()
     if( settings.IsTestEnabled( ERCE_SIMILAR_LABELS ) )
     {
         AdvancePhase( _( "Checking labels..." ) );
+        timer.Start();
         tester.TestSimilarLabels();
+        traceTime( "similar labels" );
     }
 
     if( settings.IsTestEnabled( ERCE_UNRESOLVED_VARIABLE ) )
     {
         AdvancePhase( _( "Checking for unresolved variables..." ) );
+        timer.Start();
         tester.TestTextVars( m_parent->GetCanvas()->GetView()->GetDrawingSheet() );
+        traceTime( "text variables" );
     }
 
     if( settings.IsTestEnabled( ERCE_SIMULATION_MODEL ) )
     {
         AdvancePhase( _( "Checking SPICE models..." ) );
+        timer.Start();
         tester.TestSimModelIssues();
+        traceTime( "simulation models" );
     }
 
     if( settings.IsTestEnabled( ERCE_NOCONNECT_CONNECTED ) )
     {
         AdvancePhase( _( "Checking no connect pins for connections..." ) );
+        timer.Start();
         tester.TestNoConnectPins();
+        traceTime( "no connect pins" );
     }
 
     if( settings.IsTestEnabled( ERCE_LIB_SYMBOL_ISSUES ) )
     {
         AdvancePhase( _( "Checking for library symbol issues..." ) );
+        timer.Start();
         tester.TestLibSymbolIssues();
+        traceTime( "library symbols" );
     }
 
     if( settings.IsTestEnabled( ERCE_ENDPOINT_OFF_GRID ) )
     {
         AdvancePhase( _( "Checking for off grid pins and wires..." ) );
+        timer.Start();
         tester.TestOffGridEndpoints( m_parent->GetCanvas()->GetView()->GetGAL()->GetGridSize().x );
+        traceTime( "off grid endpoints" );
     }
 
     m_parent->ResolveERCExclusions();
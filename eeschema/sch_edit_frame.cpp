@@ -1468,7 +1468,11 @@ void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags )
                 GetCanvas()->GetView()->Update( aChangedItem, KIGFX::REPAINT );
             };
 
-    Schematic().ConnectionGraph()->Recalculate( list, true, &changeHandler );
+    // A global cleanup can touch every sheet, so don't bother trying to be incremental
+    if( aCleanupFlags != GLOBAL_CLEANUP && ADVANCED_CFG::GetCfg().m_IncrementalConnectivity )
+        Schematic().ConnectionGraph()->RecalculateIncremental( list, &changeHandler );
+    else
+        Schematic().ConnectionGraph()->Recalculate( list, true, &changeHandler );
 
     GetCanvas()->GetView()->UpdateAllItemsConditionally( KIGFX::REPAINT,
             []( KIGFX::VIEW_ITEM* aItem )
@@ -27,6 +27,7 @@
 #include <lib_textbox.h>
 #include <locale_io.h>
 #include <macros.h>
+#include <paths.h>
 #include <richio.h>
 #include "sch_sexpr_lib_plugin_cache.h"
 #include "sch_sexpr_plugin_common.h"
@@ -34,11 +35,21 @@
 #include <string_utils.h>
 #include <trace_helpers.h>
 
+#include <wx/ffile.h>
+#include <wx/textfile.h>
+#include <wx/txtstrm.h>
+#include <wx/wfstream.h>
+
+
+/// Bump this whenever the layout of the persisted symbol index changes.
+static const int SYMBOL_INDEX_CACHE_VERSION = 2;
+
 
 SCH_SEXPR_PLUGIN_CACHE::SCH_SEXPR_PLUGIN_CACHE( const wxString& aFullPathAndFileName ) :
     SCH_LIB_PLUGIN_CACHE( aFullPathAndFileName )
 {
     m_fileFormatVersionAtLoad = 0;
+    m_indexOnly = false;
 }
 
 
@@ -63,9 +74,27 @@ void SCH_SEXPR_PLUGIN_CACHE::Load()
     // Yes, we did this earlier, but it's sadly not thread-safe.
     LOCALE_IO toggle;
 
+    // Symbols already handed out from the index must remain valid so only parse the ones
+    // that have not been loaded yet.
+    if( m_indexOnly && !m_symbols.empty() )
+    {
+        wxLogTrace( traceSchLegacyPlugin, "Completing indexed sexpr symbol library file '%s'",
+                    m_libFileName.GetFullPath() );
+
+        for( const std::pair<const wxString, SYMBOL_INDEX_ENTRY>& entry : m_index )
+            LoadIndexedSymbol( entry.first );
+
+        m_indexOnly = false;
+        ++m_modHash;
+        return;
+    }
+
     wxLogTrace( traceSchLegacyPlugin, "Loading sexpr symbol library file '%s'",
                 m_libFileName.GetFullPath() );
 
+    m_indexOnly = false;
+    m_index.clear();
+
     FILE_LINE_READER reader( m_libFileName.GetFullPath() );
 
     SCH_SEXPR_PARSER parser( &reader );
@@ -80,6 +109,385 @@ void SCH_SEXPR_PLUGIN_CACHE::Load()
 }
 
 
+/**
+ * Skip the white space in \a aBuf starting at \a aPos.
+ */
+static void skipSpace( const std::string& aBuf, size_t& aPos )
+{
+    while( aPos < aBuf.size() && isspace( static_cast<unsigned char>( aBuf[aPos] ) ) )
+        ++aPos;
+}
+
+
+/**
+ * Read the symbol or quoted string starting at \a aPos in \a aBuf.
+ *
+ * @return the unescaped UTF8 token text.  \a aPos is left at the first character after
+ *         the token.
+ */
+static std::string readToken( const std::string& aBuf, size_t& aPos )
+{
+    std::string token;
+
+    skipSpace( aBuf, aPos );
+
+    if( aPos < aBuf.size() && aBuf[aPos] == '"' )
+    {
+        for( ++aPos; aPos < aBuf.size() && aBuf[aPos] != '"'; ++aPos )
+        {
+            if( aBuf[aPos] == '\\' && aPos + 1 < aBuf.size() )
+                ++aPos;
+
+            token += aBuf[aPos];
+        }
+
+        ++aPos;     // Closing quote.
+    }
+    else
+    {
+        while( aPos < aBuf.size() && !isspace( static_cast<unsigned char>( aBuf[aPos] ) )
+               && aBuf[aPos] != '(' && aBuf[aPos] != ')' && aBuf[aPos] != '"' )
+        {
+            token += aBuf[aPos++];
+        }
+    }
+
+    return token;
+}
+
+
+bool SCH_SEXPR_PLUGIN_CACHE::LoadIndex()
+{
+    if( !m_libFileName.FileExists() || !m_libFileName.IsAbsolute() )
+        return false;
+
+    m_index.clear();
+    m_fileModTime = GetLibModificationTime();
+    m_fileSize = GetRealFile().GetSize();
+
+    wxFileName cacheFile = GetIndexCacheFile();
+
+    if( !readIndexCache( cacheFile ) )
+    {
+        m_index.clear();
+
+        if( !buildIndex() )
+        {
+            m_index.clear();
+            return false;
+        }
+
+        writeIndexCache( cacheFile );
+    }
+
+    m_indexOnly = true;
+    return true;
+}
+
+
+bool SCH_SEXPR_PLUGIN_CACHE::buildIndex()
+{
+    wxFFile file( m_libFileName.GetFullPath(), wxT( "rb" ) );
+
+    if( !file.IsOpened() )
+        return false;
+
+    std::string buf;
+    buf.resize( file.Length() );
+
+    if( file.Read( &buf[0], buf.size() ) != buf.size() )
+        return false;
+
+    wxLogTrace( traceSchLegacyPlugin, "Indexing sexpr symbol library file '%s'",
+                m_libFileName.GetFullPath() );
+
+    int                depth = 0;
+    bool               inSymbol = false;
+    wxString           symbolName;
+    SYMBOL_INDEX_ENTRY entry = { 0, 0, wxEmptyString, false };
+
+    for( size_t pos = 0; pos < buf.size(); )
+    {
+        char c = buf[pos];
+
+        if( c == '"' )
+        {
+            readToken( buf, pos );
+        }
+        else if( c == '(' )
+        {
+            size_t start = pos++;
+
+            ++depth;
+
+            if( depth == 1 )
+            {
+                if( readToken( buf, pos ) != "kicad_symbol_lib" )
+                    return false;
+            }
+            else if( depth == 2 )
+            {
+                std::string token = readToken( buf, pos );
+
+                if( token == "symbol" )
+                {
+                    LIB_ID id;
+
+                    if( id.Parse( wxString::FromUTF8( readToken( buf, pos ) ) ) >= 0 )
+                        return false;
+
+                    symbolName = id.GetLibItemName().wx_str();
+                    entry = { start, 0, wxEmptyString, false };
+                    inSymbol = true;
+                }
+                else if( token == "version" )
+                {
+                    m_fileFormatVersionAtLoad = atoi( readToken( buf, pos ).c_str() );
+                }
+            }
+            else if( depth == 3 && inSymbol )
+            {
+                std::string token = readToken( buf, pos );
+
+                if( token == "extends" )
+                    entry.m_Parent = wxString::FromUTF8( readToken( buf, pos ) );
+                else if( token == "power" )
+                    entry.m_IsPower = true;
+            }
+        }
+        else if( c == ')' )
+        {
+            if( depth == 2 && inSymbol )
+            {
+                entry.m_Length = pos + 1 - entry.m_Offset;
+                m_index[symbolName] = entry;
+                inSymbol = false;
+            }
+
+            --depth;
+            ++pos;
+        }
+        else
+        {
+            ++pos;
+        }
+    }
+
+    // Anything unbalanced is left for the real parser to report.
+    return depth == 0;
+}
+
+
+wxFileName SCH_SEXPR_PLUGIN_CACHE::GetIndexCacheFile() const
+{
+    wxFileName cacheFile;
+    std::string path = TO_UTF8( GetRealFile().GetFullPath() );
+
+    cacheFile.AssignDir( PATHS::GetUserCachePath() );
+    cacheFile.AppendDir( wxT( "symbol_index" ) );
+    cacheFile.SetName( wxString::Format( wxT( "%016llx" ),
+                                         (unsigned long long) std::hash<std::string>{}( path ) ) );
+    cacheFile.SetExt( wxT( "idx" ) );
+
+    return cacheFile;
+}
+
+
+bool SCH_SEXPR_PLUGIN_CACHE::readIndexCache( const wxFileName& aCacheFile )
+{
+    wxTextFile cacheFile( aCacheFile.GetFullPath() );
+
+    if( !cacheFile.Exists() || !cacheFile.Open() )
+        return false;
+
+    // The header records what the index was built from.  Any mismatch means the library
+    // file was changed or moved and the index has to be rebuilt.
+    long long version = 0;
+    long long timestamp = 0;
+    unsigned long long size = 0;
+    long long fileVersion = 0;
+    unsigned long long entryCount = 0;
+
+    if( cacheFile.GetLineCount() < 6
+            || !cacheFile.GetFirstLine().ToLongLong( &version )
+            || version != SYMBOL_INDEX_CACHE_VERSION
+            || cacheFile.GetNextLine() != GetRealFile().GetFullPath()
+            || !cacheFile.GetNextLine().ToLongLong( &timestamp )
+            || timestamp != m_fileModTime.GetValue().GetValue()
+            || !cacheFile.GetNextLine().ToULongLong( &size )
+            || size != m_fileSize.GetValue()
+            || !cacheFile.GetNextLine().ToLongLong( &fileVersion )
+            || !cacheFile.GetNextLine().ToULongLong( &entryCount ) )
+    {
+        return false;
+    }
+
+    m_fileFormatVersionAtLoad = static_cast<int>( fileVersion );
+
+    // Each entry takes 5 lines
+    while( cacheFile.GetCurrentLine() + 5 < cacheFile.GetLineCount() )
+    {
+        wxString           name = UnescapeString( cacheFile.GetNextLine() );
+        SYMBOL_INDEX_ENTRY entry;
+        unsigned long long offset = 0;
+        unsigned long long length = 0;
+
+        if( !cacheFile.GetNextLine().ToULongLong( &offset )
+                || !cacheFile.GetNextLine().ToULongLong( &length ) )
+        {
+            return false;
+        }
+
+        entry.m_Offset = static_cast<size_t>( offset );
+        entry.m_Length = static_cast<size_t>( length );
+        entry.m_Parent = UnescapeString( cacheFile.GetNextLine() );
+        entry.m_IsPower = cacheFile.GetNextLine() == wxT( "1" );
+
+        m_index[name] = entry;
+    }
+
+    // A truncated file would otherwise silently drop the symbols it is missing
+    if( m_index.size() != entryCount || cacheFile.GetCurrentLine() + 1 != cacheFile.GetLineCount() )
+        return false;
+
+    wxLogTrace( traceSchLegacyPlugin, "Read %zu symbol index entries for '%s' from '%s'",
+                m_index.size(), m_libFileName.GetFullPath(), aCacheFile.GetFullPath() );
+
+    return !m_index.empty();
+}
+
+
+void SCH_SEXPR_PLUGIN_CACHE::writeIndexCache( const wxFileName& aCacheFile ) const
+{
+    if( !aCacheFile.DirExists() && !aCacheFile.Mkdir( wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL ) )
+        return;
+
+    wxFileName          tmpFileName = wxFileName::CreateTempFileName( aCacheFile.GetFullPath() );
+    wxFFileOutputStream outStream( tmpFileName.GetFullPath() );
+    wxTextOutputStream  txtStream( outStream );
+
+    if( !outStream.IsOk() )
+        return;
+
+    txtStream << wxString::Format( wxT( "%d" ), SYMBOL_INDEX_CACHE_VERSION ) << endl;
+    txtStream << GetRealFile().GetFullPath() << endl;
+    txtStream << wxString::Format( wxT( "%lld" ), m_fileModTime.GetValue().GetValue() ) << endl;
+    txtStream << wxString::Format( wxT( "%llu" ), m_fileSize.GetValue() ) << endl;
+    txtStream << wxString::Format( wxT( "%d" ), m_fileFormatVersionAtLoad ) << endl;
+    txtStream << wxString::Format( wxT( "%zu" ), m_index.size() ) << endl;
+
+    for( const std::pair<const wxString, SYMBOL_INDEX_ENTRY>& entry : m_index )
+    {
+        txtStream << EscapeString( entry.first, CTX_LINE ) << endl;
+        txtStream << wxString::Format( wxT( "%llu" ),
+                                       (unsigned long long) entry.second.m_Offset ) << endl;
+        txtStream << wxString::Format( wxT( "%llu" ),
+                                       (unsigned long long) entry.second.m_Length ) << endl;
+        txtStream << EscapeString( entry.second.m_Parent, CTX_LINE ) << endl;
+        txtStream << ( entry.second.m_IsPower ? wxT( "1" ) : wxT( "0" ) ) << endl;
+    }
+
+    txtStream.Flush();
+    outStream.Close();
+
+    if( !wxRenameFile( tmpFileName.GetFullPath(), aCacheFile.GetFullPath(), true ) )
+    {
+        // Not fatal, the index will just be rebuilt next time.
+        wxRemoveFile( tmpFileName.GetFullPath() );
+    }
+}
+
+
+LIB_SYMBOL* SCH_SEXPR_PLUGIN_CACHE::LoadIndexedSymbol( const wxString& aName )
+{
+    return loadIndexedSymbol( aName, 0 );
+}
+
+
+LIB_SYMBOL* SCH_SEXPR_PLUGIN_CACHE::loadIndexedSymbol( const wxString& aName, int aDepth )
+{
+    LIB_SYMBOL_MAP::iterator it = m_symbols.find( aName );
+
+    if( it != m_symbols.end() )
+        return it->second;
+
+    std::map<wxString, SYMBOL_INDEX_ENTRY>::const_iterator entry = m_index.find( aName );
+
+    if( entry == m_index.end() )
+        return nullptr;
+
+    // Guard against circular inheritance in a damaged library file.
+    if( aDepth > static_cast<int>( m_index.size() ) )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Circular inheritance of symbol '%s' in library "
+                                             "'%s'." ),
+                                          aName, m_libFileName.GetFullPath() ) );
+    }
+
+    // The parent must be in the symbol map before parsing so the extends token can be resolved.
+    if( !entry->second.m_Parent.IsEmpty() )
+        loadIndexedSymbol( entry->second.m_Parent, aDepth + 1 );
+
+    wxFFile     file( m_libFileName.GetFullPath(), wxT( "rb" ) );
+    std::string text;
+
+    text.resize( entry->second.m_Length );
+
+    if( !file.IsOpened()
+            || !file.Seek( static_cast<wxFileOffset>( entry->second.m_Offset ) )
+            || file.Read( &text[0], text.size() ) != text.size() )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Cannot read symbol '%s' from library '%s'." ),
+                                          aName, m_libFileName.GetFullPath() ) );
+    }
+
+    LOCALE_IO          toggle;
+    STRING_LINE_READER reader( text, m_libFileName.GetFullPath() );
+    SCH_SEXPR_PARSER   parser( &reader );
+
+    parser.NeedLEFT();
+    parser.NextTok();
+
+    LIB_SYMBOL* symbol = parser.ParseSymbol( m_symbols, m_fileFormatVersionAtLoad );
+
+    m_symbols[symbol->GetName()] = symbol;
+
+    wxLogTrace( traceSchLegacyPlugin, "Loaded indexed symbol '%s' from '%s'", aName,
+                m_libFileName.GetFullPath() );
+
+    return symbol;
+}
+
+
+void SCH_SEXPR_PLUGIN_CACHE::GetIndexedSymbolNames( wxArrayString& aSymbolNameList,
+                                                    bool aPowerSymbolsOnly ) const
+{
+    for( const std::pair<const wxString, SYMBOL_INDEX_ENTRY>& entry : m_index )
+    {
+        if( aPowerSymbolsOnly )
+        {
+            // Derived symbols inherit the power flag of their root symbol.
+            const SYMBOL_INDEX_ENTRY* root = &entry.second;
+
+            for( size_t ii = 0; ii < m_index.size() && !root->m_Parent.IsEmpty(); ++ii )
+            {
+                auto parent = m_index.find( root->m_Parent );
+
+                if( parent == m_index.end() )
+                    break;
+
+                root = &parent->second;
+            }
+
+            if( !root->m_IsPower )
+                continue;
+        }
+
+        aSymbolNameList.Add( entry.first );
+    }
+}
+
+
 void SCH_SEXPR_PLUGIN_CACHE::Save( const std::optional<bool>& aOpt )
 {
     if( !m_isModified )
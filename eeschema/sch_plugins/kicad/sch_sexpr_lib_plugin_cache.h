@@ -22,6 +22,8 @@
 #ifndef _SCH_SEXPR_LIB_PLUGIN_CACHE_
 #define _SCH_SEXPR_LIB_PLUGIN_CACHE_
 
+#include <map>
+
 #include "../sch_lib_plugin_cache.h"
 
 class FILE_LINE_READER;
@@ -53,6 +55,40 @@ public:
 
     void DeleteSymbol( const wxString& aName ) override;
 
+    /**
+     * Prepare the cache for on demand symbol loading.
+     *
+     * The symbol offset index is read from the user cache directory when it is still valid
+     * for the library file.  Otherwise it is rebuilt by a lexical pre-scan of the library
+     * file which does not create any #LIB_SYMBOL objects and then saved for the next session.
+     *
+     * @return true if the index is usable, false if the library must be loaded with Load().
+     */
+    bool LoadIndex();
+
+    /**
+     * @return true if only the symbol index and the symbols requested so far are loaded.
+     */
+    bool IsIndexOnly() const { return m_indexOnly; }
+
+    /**
+     * Parse \a aName (and the symbols it extends) from the library file using the index.
+     *
+     * @return the cached symbol or nullptr if \a aName is not in the library.
+     * @throw IO_ERROR if the symbol could not be read or parsed.
+     */
+    LIB_SYMBOL* LoadIndexedSymbol( const wxString& aName );
+
+    /**
+     * Fetch the names of all of the symbols in the index without parsing them.
+     */
+    void GetIndexedSymbolNames( wxArrayString& aSymbolNameList, bool aPowerSymbolsOnly ) const;
+
+    /**
+     * @return the file the symbol index of this library is saved to, in the user cache directory.
+     */
+    wxFileName GetIndexCacheFile() const;
+
     static void SaveSymbol( LIB_SYMBOL* aSymbol, OUTPUTFORMATTER& aFormatter,
                             int aNestLevel = 0, const wxString& aLibName = wxEmptyString );
 
@@ -64,6 +100,27 @@ private:
 
     int m_fileFormatVersionAtLoad;
 
+    /**
+     * Location of a top level symbol definition in the library file.
+     */
+    struct SYMBOL_INDEX_ENTRY
+    {
+        size_t   m_Offset;      ///< Byte offset of the opening parenthesis of the symbol.
+        size_t   m_Length;      ///< Byte length of the symbol s-expression.
+        wxString m_Parent;      ///< Name of the extended symbol or empty for root symbols.
+        bool     m_IsPower;
+    };
+
+    bool buildIndex();
+    bool readIndexCache( const wxFileName& aCacheFile );
+    void writeIndexCache( const wxFileName& aCacheFile ) const;
+
+    LIB_SYMBOL* loadIndexedSymbol( const wxString& aName, int aDepth );
+
+    std::map<wxString, SYMBOL_INDEX_ENTRY> m_index;
+    wxULongLong                            m_fileSize;   ///< Library file size at index time.
+    bool                                   m_indexOnly;
+
     static void saveSymbolDrawItem( LIB_ITEM* aItem, OUTPUTFORMATTER& aFormatter,
                                     int aNestLevel );
     static void saveField( LIB_FIELD* aField, OUTPUTFORMATTER& aFormatter, int aNestLevel );
@@ -30,6 +30,7 @@
 #include <wx/mstream.h>
 #include <advanced_config.h>
 #include <base_units.h>
+#include <core/kicad_algo.h>
 #include <trace_helpers.h>
 #include <locale_io.h>
 #include <sch_bitmap.h>
@@ -62,6 +63,8 @@
 #include <string_utils.h>
 #include <wx_filename.h>       // for ::ResolvePossibleSymlinks()
 #include <progress_reporter.h>
+#include <profile.h>
+#include <thread_pool.h>
 #include <boost/algorithm/string/join.hpp>
 
 using namespace TSCHEMATIC_T;
@@ -94,6 +97,7 @@ void SCH_SEXPR_PLUGIN::init( SCHEMATIC* aSchematic, const STRING_UTF8_MAP* aProp
     m_cache           = nullptr;
     m_out             = nullptr;
     m_nextFreeFieldId = 100; // number arbitrarily > MANDATORY_FIELDS or SHEET_MANDATORY_FIELDS
+    m_preloadedSheets.clear();
 }
 
 
@@ -139,6 +143,8 @@ SCH_SHEET* SCH_SEXPR_PLUGIN::Load( const wxString& aFileName, SCHEMATIC* aSchema
     m_currentPath.push( m_path );
     init( aSchematic, aProperties );
 
+    PROF_TIMER timer;
+
     if( aAppendToMe == nullptr )
     {
         // Clean up any allocated memory if an exception occurs loading the schematic.
@@ -166,6 +172,12 @@ SCH_SHEET* SCH_SEXPR_PLUGIN::Load( const wxString& aFileName, SCHEMATIC* aSchema
         loadHierarchy( SCH_SHEET_PATH(), sheet );
     }
 
+    // Anything left over was never reached by the hierarchy traversal.
+    m_preloadedSheets.clear();
+
+    wxLogTrace( traceSchLegacyPlugin, "Loaded schematic hierarchy '%s' in %0.1f ms.",
+                aFileName, timer.msecs() );
+
     wxASSERT( m_currentPath.size() == 1 );  // only the project path should remain
 
     m_currentPath.pop(); // Clear the path stack for next call to Load
@@ -231,24 +243,55 @@ void SCH_SEXPR_PLUGIN::loadHierarchy( const SCH_SHEET_PATH& aParentSheetPath, SC
         }
         else
         {
-            aSheet->SetScreen( new SCH_SCREEN( m_schematic ) );
-            aSheet->GetScreen()->SetFileName( fileName.GetFullPath() );
+            auto preloaded = m_preloadedSheets.find( fileName.GetFullPath() );
 
-            try
+            if( preloaded != m_preloadedSheets.end() )
             {
-                loadFile( fileName.GetFullPath(), aSheet );
+                SCH_SCREEN* preloadedScreen = preloaded->second.m_Holder->GetScreen();
+
+                if( m_progressReporter )
+                {
+                    m_progressReporter->Report( wxString::Format( _( "Loading %s..." ),
+                                                                  fileName.GetFullPath() ) );
+                }
+
+                aSheet->SetScreen( preloadedScreen );
+
+                // The parser parented the child sheets to the temporary holder.
+                for( SCH_ITEM* aItem : preloadedScreen->Items().OfType( SCH_SHEET_T ) )
+                    aItem->SetParent( aSheet );
+
+                if( !preloaded->second.m_Error.IsEmpty() )
+                {
+                    if( !m_error.IsEmpty() )
+                        m_error += "\n";
+
+                    m_error += preloaded->second.m_Error;
+                }
+
+                m_preloadedSheets.erase( preloaded );
             }
-            catch( const IO_ERROR& ioe )
+            else
             {
-                // If there is a problem loading the root sheet, there is no recovery.
-                if( aSheet == m_rootSheet )
-                    throw;
+                aSheet->SetScreen( new SCH_SCREEN( m_schematic ) );
+                aSheet->GetScreen()->SetFileName( fileName.GetFullPath() );
 
-                // For all subsheets, queue up the error message for the caller.
-                if( !m_error.IsEmpty() )
-                    m_error += "\n";
+                try
+                {
+                    loadFile( fileName.GetFullPath(), aSheet );
+                }
+                catch( const IO_ERROR& ioe )
+                {
+                    // If there is a problem loading the root sheet, there is no recovery.
+                    if( aSheet == m_rootSheet )
+                        throw;
+
+                    // For all subsheets, queue up the error message for the caller.
+                    if( !m_error.IsEmpty() )
+                        m_error += "\n";
 
-                m_error += ioe.What();
+                    m_error += ioe.What();
+                }
             }
 
             if( fileName.FileExists() )
@@ -265,6 +308,8 @@ void SCH_SEXPR_PLUGIN::loadHierarchy( const SCH_SHEET_PATH& aParentSheetPath, SC
             SCH_SHEET_PATH currentSheetPath = aParentSheetPath;
             currentSheetPath.push_back( aSheet );
 
+            preloadSheets( currentSheetPath, aSheet->GetScreen() );
+
             // This was moved out of the try{} block so that any sheet definitions that
             // the plugin fully parsed before the exception was raised will be loaded.
             for( SCH_ITEM* aItem : aSheet->GetScreen()->Items().OfType( SCH_SHEET_T ) )
@@ -283,6 +328,114 @@ void SCH_SEXPR_PLUGIN::loadHierarchy( const SCH_SHEET_PATH& aParentSheetPath, SC
 }
 
 
+void SCH_SEXPR_PLUGIN::preloadSheets( const SCH_SHEET_PATH& aSheetPath, SCH_SCREEN* aScreen )
+{
+    std::vector<wxString> fileNames;
+
+    // Apply the same tests as loadHierarchy() so that only the files it would parse are
+    // parsed here.
+    for( SCH_ITEM* aItem : aScreen->Items().OfType( SCH_SHEET_T ) )
+    {
+        SCH_SHEET* sheet = static_cast<SCH_SHEET*>( aItem );
+
+        if( sheet->GetScreen() )
+            continue;
+
+        wxFileName fileName = sheet->GetFileName();
+
+        if( !fileName.IsAbsolute() )
+            fileName.MakeAbsolute( m_currentPath.top() );
+
+        wxString fullPath = fileName.GetFullPath();
+
+        // Missing files are left to loadHierarchy() to report.
+        if( !fileName.FileExists() || m_preloadedSheets.count( fullPath )
+                || alg::contains( fileNames, fullPath ) )
+        {
+            continue;
+        }
+
+        bool isAncestor = false;
+
+        for( size_t ii = 0; ii < aSheetPath.size() && !isAncestor; ++ii )
+            isAncestor = aSheetPath.at( ii )->GetScreen()->GetFileName() == fullPath;
+
+        if( isAncestor )
+            continue;
+
+        SCH_SCREEN* screen = nullptr;
+        m_rootSheet->SearchHierarchy( fullPath, &screen );
+
+        if( !screen )
+            fileNames.push_back( fullPath );
+    }
+
+    // A single file gains nothing from the thread pool.
+    if( fileNames.size() < 2 )
+        return;
+
+    PROF_TIMER                   timer;
+    thread_pool&                 tp = GetKiCadThreadPool();
+    std::vector<PRELOADED_SHEET> results( fileNames.size() );
+    std::vector<std::future<void>> returns( fileNames.size() );
+
+    for( size_t ii = 0; ii < fileNames.size(); ++ii )
+    {
+        SCH_SCREEN* screen = new SCH_SCREEN( m_schematic );
+
+        screen->SetFileName( fileNames[ii] );
+        results[ii].m_Holder = std::make_unique<SCH_SHEET>();
+        results[ii].m_Holder->SetScreen( screen );
+
+        // The parsers must not touch the progress reporter from the worker threads.  The
+        // LOCALE_IO set by Load() stays in effect as this thread blocks until they finish.
+        returns[ii] = tp.submit(
+                [this, &results, &fileNames, ii]()
+                {
+                    try
+                    {
+                        FILE_LINE_READER reader( fileNames[ii] );
+                        SCH_SEXPR_PARSER parser( &reader, nullptr, 0, m_rootSheet, m_appending );
+
+                        parser.ParseSchematic( results[ii].m_Holder.get() );
+                    }
+                    catch( const IO_ERROR& ioe )
+                    {
+                        results[ii].m_Error = ioe.What();
+                    }
+                } );
+    }
+
+    bool cancelled = false;
+
+    for( const std::future<void>& ret : returns )
+    {
+        std::future_status status = ret.wait_for( std::chrono::milliseconds( 250 ) );
+
+        while( status != std::future_status::ready )
+        {
+            if( m_progressReporter && !m_progressReporter->KeepRefreshing() )
+                cancelled = true;
+
+            status = ret.wait_for( std::chrono::milliseconds( 250 ) );
+        }
+    }
+
+    // Rethrow anything other than an IO_ERROR from the workers.
+    for( std::future<void>& ret : returns )
+        ret.get();
+
+    if( cancelled )
+        THROW_IO_ERROR( ( "Open cancelled by user." ) );
+
+    for( size_t ii = 0; ii < fileNames.size(); ++ii )
+        m_preloadedSheets[fileNames[ii]] = std::move( results[ii] );
+
+    wxLogTrace( traceSchLegacyPlugin, "Parsed %zu sheet files of '%s' in parallel in %0.1f ms.",
+                fileNames.size(), aScreen->GetFileName(), timer.msecs() );
+}
+
+
 void SCH_SEXPR_PLUGIN::loadFile( const wxString& aFileName, SCH_SHEET* aSheet )
 {
     FILE_LINE_READER reader( aFileName );
@@ -1381,6 +1534,30 @@ void SCH_SEXPR_PLUGIN::cacheLib( const wxString& aLibraryFileName, const STRING_
         if( !isBuffering( aProperties ) )
             m_cache->Load();
     }
+    else if( m_cache->IsIndexOnly() && !isBuffering( aProperties ) )
+    {
+        m_cache->Load();
+    }
+}
+
+
+void SCH_SEXPR_PLUGIN::indexLib( const wxString& aLibraryFileName,
+                                 const STRING_UTF8_MAP* aProperties )
+{
+    if( isBuffering( aProperties ) )
+    {
+        cacheLib( aLibraryFileName, aProperties );
+        return;
+    }
+
+    if( !m_cache || !m_cache->IsFile( aLibraryFileName ) || m_cache->IsFileChanged() )
+    {
+        delete m_cache;
+        m_cache = new SCH_SEXPR_PLUGIN_CACHE( aLibraryFileName );
+
+        if( !m_cache->LoadIndex() )
+            m_cache->Load();
+    }
 }
 
 
@@ -1409,7 +1586,13 @@ void SCH_SEXPR_PLUGIN::EnumerateSymbolLib( wxArrayString&    aSymbolNameList,
     bool powerSymbolsOnly = ( aProperties &&
                               aProperties->find( SYMBOL_LIB_TABLE::PropPowerSymsOnly ) != aProperties->end() );
 
-    cacheLib( aLibraryPath, aProperties );
+    indexLib( aLibraryPath, aProperties );
+
+    if( m_cache->IsIndexOnly() )
+    {
+        m_cache->GetIndexedSymbolNames( aSymbolNameList, powerSymbolsOnly );
+        return;
+    }
 
     const LIB_SYMBOL_MAP& symbols = m_cache->m_symbols;
 
@@ -1447,7 +1630,10 @@ LIB_SYMBOL* SCH_SEXPR_PLUGIN::LoadSymbol( const wxString& aLibraryPath, const wx
 {
     LOCALE_IO toggle;     // toggles on, then off, the C locale.
 
-    cacheLib( aLibraryPath, aProperties );
+    indexLib( aLibraryPath, aProperties );
+
+    if( m_cache->IsIndexOnly() )
+        return m_cache->LoadIndexedSymbol( aSymbolName );
 
     LIB_SYMBOL_MAP::const_iterator it = m_cache->m_symbols.find( aSymbolName );
 
@@ -1536,6 +1722,10 @@ void SCH_SEXPR_PLUGIN::SaveLibrary( const wxString& aLibraryPath, const STRING_U
     if( !m_cache )
         m_cache = new SCH_SEXPR_PLUGIN_CACHE( aLibraryPath );
 
+    // Never write out a partially loaded library.
+    if( m_cache->IsIndexOnly() )
+        m_cache->Load();
+
     wxString oldFileName = m_cache->GetFileName();
 
     if( !m_cache->IsFile( aLibraryPath ) )
@@ -1578,6 +1768,9 @@ void SCH_SEXPR_PLUGIN::GetAvailableSymbolFields( std::vector<wxString>& aNames )
     if( !m_cache )
         return;
 
+    if( m_cache->IsIndexOnly() )
+        m_cache->Load();
+
     const LIB_SYMBOL_MAP& symbols = m_cache->m_symbols;
 
     std::set<wxString> fieldNames;
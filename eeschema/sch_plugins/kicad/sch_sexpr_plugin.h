@@ -23,6 +23,7 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <map>
 #include <memory>
 #include <sch_io_mgr.h>
 #include <sch_file_versions.h>
@@ -145,6 +146,15 @@ private:
     void loadHierarchy( const SCH_SHEET_PATH& aParentSheetPath, SCH_SHEET* aSheet );
     void loadFile( const wxString& aFileName, SCH_SHEET* aSheet );
 
+    /**
+     * Parse the files of the child sheets of \a aScreen which have not been loaded yet
+     * concurrently on the thread pool.
+     *
+     * The parsed screens are held in #m_preloadedSheets until loadHierarchy() reaches the
+     * first sheet using the file so the resulting hierarchy is the same as a serial load.
+     */
+    void preloadSheets( const SCH_SHEET_PATH& aSheetPath, SCH_SCREEN* aScreen );
+
     void saveSymbol( SCH_SYMBOL* aSymbol, const SCHEMATIC& aSchematic, int aNestLevel,
                      bool aForClipboard );
     void saveField( SCH_FIELD* aField, int aNestLevel );
@@ -161,6 +171,12 @@ private:
     void saveInstances( const std::vector<SCH_SHEET_INSTANCE>& aSheets, int aNestLevel );
 
     void cacheLib( const wxString& aLibraryFileName, const STRING_UTF8_MAP* aProperties );
+
+    /**
+     * Like cacheLib() but only builds the symbol index so that single symbols can be loaded
+     * on demand.  Falls back to a full load when the library cannot be indexed.
+     */
+    void indexLib( const wxString& aLibraryFileName, const STRING_UTF8_MAP* aProperties );
     bool isBuffering( const STRING_UTF8_MAP* aProperties );
 
 protected:
@@ -178,6 +194,17 @@ protected:
     OUTPUTFORMATTER*        m_out;              ///< The formatter for saving SCH_SCREEN objects.
     SCH_SEXPR_PLUGIN_CACHE* m_cache;
 
+    /**
+     * A sheet file parsed ahead of the hierarchy traversal.
+     */
+    struct PRELOADED_SHEET
+    {
+        std::unique_ptr<SCH_SHEET> m_Holder;    ///< Temporary owner of the parsed screen.
+        wxString                   m_Error;     ///< Parse error message, if any.
+    };
+
+    std::map<wxString, PRELOADED_SHEET> m_preloadedSheets;  ///< Keyed by full file name.
+
     /// initialize PLUGIN like a constructor would.
     void init( SCHEMATIC* aSchematic, const STRING_UTF8_MAP* aProperties = nullptr );
 };
@@ -36,6 +36,9 @@
 
 #define DCODE_DEFAULT_SIZE gerbIUScale.mmToIU( 0.1 )
 
+// Length of the reference vectors used to compare the layer transforms of flashed items
+#define FLASH_TRANSFORM_REF_LEN 1000000
+
 /* Format Gerber: NOTES:
  * Tools and D_CODES
  *   tool number (identification of shapes)
@@ -80,6 +83,8 @@ void D_CODE::Clear_D_CODE_Data()
     m_Rotation   = ANGLE_0;
     m_EdgesCount = 0;
     m_Polygon.RemoveAllContours();
+    m_flashedShape.RemoveAllContours();
+    m_flashedShapeValid = false;
 }
 
 
@@ -410,6 +415,59 @@ void D_CODE::ConvertShapeToPolygon( const GERBER_DRAW_ITEM* aParent )
 }
 
 
+SHAPE_POLY_SET& D_CODE::GetFlashedShape( const GERBER_DRAW_ITEM* aParent )
+{
+    // The AB transform is affine: the images of two reference vectors are enough to know if
+    // aParent uses the same rotation, mirror, scale and axis swap as the cached shape.
+    const VECTOR2I origin = aParent->GetABPosition( VECTOR2I( 0, 0 ) );
+    const VECTOR2I axisX = aParent->GetABPosition( VECTOR2I( FLASH_TRANSFORM_REF_LEN, 0 ) )
+                           - origin;
+    const VECTOR2I axisY = aParent->GetABPosition( VECTOR2I( 0, FLASH_TRANSFORM_REF_LEN ) )
+                           - origin;
+
+    if( m_flashedShapeValid && axisX == m_flashedShapeAxisX && axisY == m_flashedShapeAxisY )
+        return m_flashedShape;
+
+    if( m_Shape == APT_MACRO && GetMacro() )
+    {
+        // Aperture macro shapes are already in AB coordinates
+        m_flashedShape = *GetMacro()->GetApertureMacroShape( aParent, VECTOR2I( 0, 0 ) );
+        m_flashedShape.Move( -origin );
+    }
+    else
+    {
+        if( m_Polygon.OutlineCount() == 0 )
+            ConvertShapeToPolygon( aParent );
+
+        m_flashedShape = m_Polygon;
+
+        auto toAB =
+                [&]( SHAPE_LINE_CHAIN& aChain )
+                {
+                    for( int ii = 0; ii < aChain.PointCount(); ii++ )
+                    {
+                        VECTOR2I pt = aParent->GetABPosition( aChain.CPoint( ii ) );
+                        aChain.SetPoint( ii, pt - origin );
+                    }
+                };
+
+        for( int ii = 0; ii < m_flashedShape.OutlineCount(); ii++ )
+        {
+            toAB( m_flashedShape.Outline( ii ) );
+
+            for( int jj = 0; jj < m_flashedShape.HoleCount( ii ); jj++ )
+                toAB( m_flashedShape.Hole( ii, jj ) );
+        }
+    }
+
+    m_flashedShapeValid = true;
+    m_flashedShapeAxisX = axisX;
+    m_flashedShapeAxisY = axisY;
+
+    return m_flashedShape;
+}
+
+
 // The helper function for D_CODE::ConvertShapeToPolygon().
 // Add a hole to a polygon
 static void addHoleToPolygon( SHAPE_POLY_SET* aPolygon, APERTURE_DEF_HOLETYPE aHoleShape,
@@ -185,6 +185,20 @@ public:
      */
     int GetShapeDim( GERBER_DRAW_ITEM* aParent );
 
+    /**
+     * Return the shape of a flashed item using this D_CODE, in AB coordinates and relative to
+     * the AB position of the flash.
+     *
+     * All the flashes of a D_CODE are translated copies of the same shape, so it is built (and
+     * on OpenGL triangulated) only once and shared by all of them.  It is rebuilt only when the
+     * layer transform (rotation, mirror, scale, axis swap) of \a aParent differs from the one of
+     * the item it was built for.
+     *
+     * @param aParent is the flashed #GERBER_DRAW_ITEM.
+     * @return the shared shape, to be moved to GetABPosition( aParent->m_Start ).
+     */
+    SHAPE_POLY_SET& GetFlashedShape( const GERBER_DRAW_ITEM* aParent );
+
 public:
     wxSize                m_Size;           ///< Horizontal and vertical dimensions.
     APERTURE_T            m_Shape;          ///< shape ( Line, rectangle, circle , oval .. )
@@ -214,6 +228,11 @@ private:
      * macro, and these parameters would customize the macro.
      */
     std::vector<double>   m_am_params;
+
+    SHAPE_POLY_SET        m_flashedShape;       ///< Shape shared by the flashes of this D_CODE
+    bool                  m_flashedShapeValid;
+    VECTOR2I              m_flashedShapeAxisX;  ///< Layer transform m_flashedShape was built for
+    VECTOR2I              m_flashedShapeAxisY;
 };
 
 
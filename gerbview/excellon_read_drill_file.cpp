@@ -245,6 +245,24 @@ static EXCELLON_CMD excellon_G_CmdList[] =
 
 
 bool GERBVIEW_FRAME::Read_EXCELLON_File( const wxString& aFullFileName )
+{
+    std::unique_ptr<EXCELLON_IMAGE> drill_layer_uptr =
+            std::make_unique<EXCELLON_IMAGE>( GetActiveLayer() );
+
+    EXCELLON_DEFAULTS nc_defaults;
+    GERBVIEW_SETTINGS* cfg = static_cast<GERBVIEW_SETTINGS*>( config() );
+    cfg->GetExcellonDefaults( nc_defaults );
+
+    // Read the Excellon drill file:
+    if( !drill_layer_uptr->LoadFile( aFullFileName, &nc_defaults ) )
+        drill_layer_uptr.reset();
+
+    return addExcellonImage( std::move( drill_layer_uptr ), aFullFileName );
+}
+
+
+bool GERBVIEW_FRAME::addExcellonImage( std::unique_ptr<EXCELLON_IMAGE> aDrill,
+                                       const wxString& aFullFileName )
 {
     wxString msg;
     int layerId = GetActiveLayer();      // current layer used in GerbView
@@ -255,24 +273,15 @@ bool GERBVIEW_FRAME::Read_EXCELLON_File( const wxString& aFullFileName )
     if( gerber_layer )
         Erase_Current_DrawLayer( false );
 
-    std::unique_ptr<EXCELLON_IMAGE> drill_layer_uptr = std::make_unique<EXCELLON_IMAGE>( layerId );
-
-    EXCELLON_DEFAULTS nc_defaults;
-    GERBVIEW_SETTINGS* cfg = static_cast<GERBVIEW_SETTINGS*>( config() );
-    cfg->GetExcellonDefaults( nc_defaults );
-
-    // Read the Excellon drill file:
-    bool success = drill_layer_uptr->LoadFile( aFullFileName, &nc_defaults );
-
-    if( !success )
+    if( !aDrill )
     {
-        drill_layer_uptr.reset();
         msg.Printf( _( "File %s not found." ), aFullFileName );
         ShowInfoBarError( msg );
         return false;
     }
 
-    EXCELLON_IMAGE* drill_layer = drill_layer_uptr.release();
+    EXCELLON_IMAGE* drill_layer = aDrill.release();
+    drill_layer->m_GraphicLayer = layerId;
 
     layerId = images->AddGbrImage( drill_layer, layerId );
 
@@ -297,7 +306,7 @@ bool GERBVIEW_FRAME::Read_EXCELLON_File( const wxString& aFullFileName )
             GetCanvas()->GetView()->Add( (KIGFX::VIEW_ITEM*) item );
     }
 
-    return success;
+    return true;
 }
 
 
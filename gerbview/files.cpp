@@ -22,17 +22,23 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <chrono>
+#include <future>
 #include <wx/debug.h>
 #include <wx/filedlg.h>
 #include <wx/wfstream.h>
 #include <wx/zipstrm.h>
+#include <locale_io.h>
 #include <reporter.h>
+#include <thread_pool.h>
 #include <dialogs/html_message_box.h>
 #include <gerbview_frame.h>
 #include <gerbview_id.h>
 #include <gerber_file_image.h>
 #include <gerber_file_image_list.h>
 #include <excellon_image.h>
+#include <excellon_defaults.h>
+#include <gerbview_settings.h>
 #include <wildcards_and_files_ext.h>
 #include <view/view.h>
 #include <widgets/wx_progress_reporters.h>
@@ -237,6 +243,68 @@ bool GERBVIEW_FRAME::LoadExcellonFiles( const wxString& aFileName )
 }
 
 
+/**
+ * A gerber or drill file read on the thread pool, waiting to be added to a GerbView layer.
+ */
+struct READ_GERBER_FILE
+{
+    int                                fileType = 2;    // 0 = gerber, 1 = drill, 2 = unknown
+    std::unique_ptr<GERBER_FILE_IMAGE> gerber;          // nullptr if not a readable gerber file
+    std::unique_ptr<EXCELLON_IMAGE>    drill;           // nullptr if not a readable drill file
+    bool                               outOfMemory = false;
+};
+
+
+/**
+ * Read a gerber or drill file.  Its type is autodetected if \a aFileType is 2.
+ *
+ * Only the returned images are modified, so that several files can be read at the same time.
+ * The caller must switch to the C locale (#LOCALE_IO) before starting the readers.
+ */
+static READ_GERBER_FILE readGerberFile( const wxString& aFullFileName, int aFileType,
+                                        const EXCELLON_DEFAULTS& aDrillDefaults )
+{
+    READ_GERBER_FILE result;
+    result.fileType = aFileType;
+
+    try
+    {
+        if( result.fileType == 2 )
+        {
+            if( EXCELLON_IMAGE::TestFileIsExcellon( aFullFileName ) )
+                result.fileType = 1;
+            else if( GERBER_FILE_IMAGE::TestFileIsRS274( aFullFileName ) )
+                result.fileType = 0;
+        }
+
+        // The graphic layer is set when the image is added to the frame
+        if( result.fileType == 0 )
+        {
+            result.gerber = std::make_unique<GERBER_FILE_IMAGE>( 0 );
+
+            if( !result.gerber->LoadGerberFile( aFullFileName ) )
+                result.gerber.reset();
+        }
+        else if( result.fileType == 1 )
+        {
+            EXCELLON_DEFAULTS drillDefaults = aDrillDefaults;
+            result.drill = std::make_unique<EXCELLON_IMAGE>( 0 );
+
+            if( !result.drill->LoadFile( aFullFileName, &drillDefaults ) )
+                result.drill.reset();
+        }
+    }
+    catch( const std::bad_alloc& )
+    {
+        result.gerber.reset();
+        result.drill.reset();
+        result.outOfMemory = true;
+    }
+
+    return result;
+}
+
+
 bool GERBVIEW_FRAME::LoadListOfGerberAndDrillFiles( const wxString&      aPath,
                                                     const wxArrayString& aFilenameList,
                                                     std::vector<int>*    aFileType )
@@ -259,59 +327,106 @@ bool GERBVIEW_FRAME::LoadListOfGerberAndDrillFiles( const wxString&      aPath,
     // Create progress dialog (only used if more than 1 file to load
     std::unique_ptr<WX_PROGRESS_REPORTER> progress = nullptr;
 
-    for( unsigned ii = 0; ii < aFilenameList.GetCount(); ii++ )
-    {
-        filename = aFilenameList[ii];
+    EXCELLON_DEFAULTS nc_defaults;
+    static_cast<GERBVIEW_SETTINGS*>( config() )->GetExcellonDefaults( nc_defaults );
 
-        if( !filename.IsAbsolute() )
-            filename.SetPath( aPath );
+    // The files are independent, so they are all read on the thread pool.  They are added to
+    // the layers afterwards, in the list order, which gives the same layers as reading them
+    // one after the other.
+    thread_pool&                               tp = GetKiCadThreadPool();
+    std::vector<wxString>                      fullFileNames( aFilenameList.GetCount() );
+    std::vector<std::future<READ_GERBER_FILE>> readFiles( aFilenameList.GetCount() );
 
-        // Check for non existing files, to avoid creating broken or useless data
-        // and report all in one error list:
-        if( !filename.FileExists() )
-        {
-            wxString warning;
-            warning << wxT( "<b>" ) << _( "File not found:" ) << wxT( "</b><br>" )
-                    << filename.GetFullPath() << wxT( "<br>" );
-            reporter.Report( warning, RPT_SEVERITY_WARNING );
-            success = false;
-            continue;
-        }
+    {
+        // setlocale() is not thread safe: switch to the C locale once for all the readers
+        LOCALE_IO toggleIo;
 
-        if( filename.GetExt() == GerberJobFileExtension.c_str() )
+        for( unsigned ii = 0; ii < aFilenameList.GetCount(); ii++ )
         {
-            //We cannot read a gerber job file as a gerber plot file: skip it
-            wxString txt;
-            txt.Printf( _( "<b>A gerber job file cannot be loaded as a plot file</b> "
-                           "<i>%s</i>" ),
-                        filename.GetFullName() );
-            success = false;
-            reporter.Report( txt, RPT_SEVERITY_ERROR );
-            continue;
-        }
+            filename = aFilenameList[ii];
 
+            if( !filename.IsAbsolute() )
+                filename.SetPath( aPath );
 
-        m_lastFileName = filename.GetFullPath();
+            // Check for non existing files, to avoid creating broken or useless data
+            // and report all in one error list:
+            if( !filename.FileExists() )
+            {
+                wxString warning;
+                warning << wxT( "<b>" ) << _( "File not found:" ) << wxT( "</b><br>" )
+                        << filename.GetFullPath() << wxT( "<br>" );
+                reporter.Report( warning, RPT_SEVERITY_WARNING );
+                success = false;
+                continue;
+            }
 
-        if( !progress && ( aFilenameList.GetCount() > 1 ) )
-        {
-            progress = std::make_unique<WX_PROGRESS_REPORTER>( this, _( "Loading files..." ), 1,
-                                                               false );
-            progress->SetMaxProgress( aFilenameList.GetCount() - 1 );
-            progress->Report( wxString::Format( _("Loading %u/%zu %s..." ),
-                                                ii+1,
-                                                aFilenameList.GetCount(),
-                                                m_lastFileName ) );
+            if( filename.GetExt() == GerberJobFileExtension.c_str() )
+            {
+                //We cannot read a gerber job file as a gerber plot file: skip it
+                wxString txt;
+                txt.Printf( _( "<b>A gerber job file cannot be loaded as a plot file</b> "
+                               "<i>%s</i>" ),
+                            filename.GetFullName() );
+                success = false;
+                reporter.Report( txt, RPT_SEVERITY_ERROR );
+                continue;
+            }
+
+            fullFileNames[ii] = filename.GetFullPath();
+            readFiles[ii] = tp.submit(
+                    [&, ii]() -> READ_GERBER_FILE
+                    {
+                        return readGerberFile( fullFileNames[ii], ( *aFileType )[ii],
+                                               nc_defaults );
+                    } );
         }
-        else if( progress )
+
+        for( unsigned ii = 0; ii < readFiles.size(); ii++ )
         {
-            progress->Report( wxString::Format( _("Loading %u/%zu %s..." ),
-                                                ii+1,
-                                                aFilenameList.GetCount(),
-                                                m_lastFileName ) );
-            progress->KeepRefreshing();
+            if( !readFiles[ii].valid() )
+                continue;
+
+            m_lastFileName = fullFileNames[ii];
+
+            if( !progress && ( aFilenameList.GetCount() > 1 ) )
+            {
+                progress = std::make_unique<WX_PROGRESS_REPORTER>( this, _( "Loading files..." ),
+                                                                   1, false );
+                progress->SetMaxProgress( aFilenameList.GetCount() - 1 );
+                progress->Report( wxString::Format( _("Loading %u/%zu %s..." ),
+                                                    ii+1,
+                                                    aFilenameList.GetCount(),
+                                                    m_lastFileName ) );
+            }
+            else if( progress )
+            {
+                progress->Report( wxString::Format( _("Loading %u/%zu %s..." ),
+                                                    ii+1,
+                                                    aFilenameList.GetCount(),
+                                                    m_lastFileName ) );
+                progress->KeepRefreshing();
+            }
+
+            while( readFiles[ii].wait_for( std::chrono::milliseconds( 100 ) )
+                   != std::future_status::ready )
+            {
+                if( progress )
+                    progress->KeepRefreshing();
+            }
+
+            if( progress )
+                progress->AdvanceProgress();
         }
+    }
 
+    for( unsigned ii = 0; ii < readFiles.size(); ii++ )
+    {
+        if( !readFiles[ii].valid() )
+            continue;
+
+        READ_GERBER_FILE readFile = readFiles[ii].get();
+
+        filename = fullFileNames[ii];
 
         // Make sure we have a layer available to load into
         layer = getNextAvailableLayer();
@@ -334,22 +449,23 @@ bool GERBVIEW_FRAME::LoadListOfGerberAndDrillFiles( const wxString&      aPath,
         SetActiveLayer( layer, false );
         visibility[ layer ] = true;
 
-        try
+        ( *aFileType )[ii] = readFile.fileType;
+
+        if( readFile.outOfMemory )
         {
-            // 2 = Autodetect
-            if( ( *aFileType )[ii] == 2 )
-            {
-                if( EXCELLON_IMAGE::TestFileIsExcellon( filename.GetFullPath() ) )
-                    ( *aFileType )[ii] = 1;
-                else if( GERBER_FILE_IMAGE::TestFileIsRS274( filename.GetFullPath() ) )
-                    ( *aFileType )[ii] = 0;
-            }
+            wxString txt = wxString::Format( MSG_OOM, filename.GetFullName() );
+            reporter.Report( txt, RPT_SEVERITY_ERROR );
+            success = false;
+            continue;
+        }
 
-            switch( ( *aFileType )[ii] )
+        try
+        {
+            switch( readFile.fileType )
             {
             case 0:
 
-                if( Read_GERBER_File( filename.GetFullPath() ) )
+                if( addGerberImage( std::move( readFile.gerber ), filename.GetFullPath() ) )
                 {
                     UpdateFileHistory( filename.GetFullPath() );
 
@@ -363,7 +479,7 @@ bool GERBVIEW_FRAME::LoadListOfGerberAndDrillFiles( const wxString&      aPath,
 
             case 1:
 
-                if( Read_EXCELLON_File( filename.GetFullPath() ) )
+                if( addExcellonImage( std::move( readFile.drill ), filename.GetFullPath() ) )
                 {
                     UpdateFileHistory( filename.GetFullPath(), &m_drillFileHistory );
 
@@ -387,9 +503,6 @@ bool GERBVIEW_FRAME::LoadListOfGerberAndDrillFiles( const wxString&      aPath,
             success = false;
             continue;
         }
-
-        if( progress )
-            progress->AdvanceProgress();
     }
 
     if( !success )
@@ -446,20 +559,21 @@ bool GERBVIEW_FRAME::unarchiveFiles( const wxString& aFullFileName, REPORTER* aR
     // Update the list of recent zip files.
     UpdateFileHistory( aFullFileName, &m_zipFileHistory );
 
-    // The unzipped file in only a temporary file. Give it a filename
-    // which cannot conflict with an usual filename.
-    // TODO: make Read_GERBER_File() and Read_EXCELLON_File() able to
-    // accept a stream, and avoid using a temp file.
-    wxFileName temp_fn( "$tempfile.tmp" );
-    temp_fn.MakeAbsolute( unzipDir );
-    wxString unzipped_tempfile = temp_fn.GetFullPath();
-
+    /// A file of the archive, extracted to a temporary file
+    struct UNZIPPED_FILE
+    {
+        wxString               name;        // the name of the file in the archive
+        wxString               tempFile;
+        enum GERBER_ORDER_ENUM order;
+        bool                   extracted;
+    };
 
-    bool             success = true;
-    wxZipInputStream zipArchive( zipFile );
-    wxZipEntry*      entry;
-    bool             reported_no_more_layer = false;
-    KIGFX::VIEW*     view = GetCanvas()->GetView();
+    bool                       success = true;
+    wxZipInputStream           zipArchive( zipFile );
+    wxZipEntry*                entry;
+    bool                       reported_no_more_layer = false;
+    KIGFX::VIEW*               view = GetCanvas()->GetView();
+    std::vector<UNZIPPED_FILE> unzippedFiles;
 
     while( ( entry = zipArchive.GetNextEntry() ) )
     {
@@ -485,9 +599,96 @@ bool GERBVIEW_FRAME::unarchiveFiles( const wxString& aFullFileName, REPORTER* aR
             continue;
         }
 
-        wxString               matchedExt;
-        enum GERBER_ORDER_ENUM order;
-        GERBER_FILE_IMAGE_LIST::GetGerberLayerFromFilename( fname, order, matchedExt );
+        UNZIPPED_FILE unzipped;
+        wxString      matchedExt;
+
+        unzipped.name = fname;
+        GERBER_FILE_IMAGE_LIST::GetGerberLayerFromFilename( fname, unzipped.order, matchedExt );
+
+        // The unzipped files are only temporary files.  Give them filenames which cannot
+        // conflict with an usual filename.
+        // TODO: make Read_GERBER_File() and Read_EXCELLON_File() able to
+        // accept a stream, and avoid using a temp file.
+        wxFileName temp_fn( wxString::Format( wxT( "$tempfile%zu.tmp" ), unzippedFiles.size() ) );
+        temp_fn.MakeAbsolute( unzipDir );
+        unzipped.tempFile = temp_fn.GetFullPath();
+
+        // Create the unzipped temporary file:
+        {
+            wxFFileOutputStream temporary_ofile( unzipped.tempFile );
+
+            unzipped.extracted = temporary_ofile.Ok();
+
+            if( temporary_ofile.Ok() )
+                temporary_ofile.Write( zipArchive );
+            else
+            {
+                success = false;
+
+                if( aReporter )
+                {
+                    msg.Printf( _( "<b>Unable to create temporary file '%s'.</b>" ),
+                                unzipped.tempFile );
+                    aReporter->Report( msg, RPT_SEVERITY_ERROR );
+                }
+            }
+        }
+
+        unzippedFiles.push_back( unzipped );
+        delete entry;
+    }
+
+    // Read all the files on the thread pool, then add them to the layers in the archive order
+    EXCELLON_DEFAULTS nc_defaults;
+    static_cast<GERBVIEW_SETTINGS*>( config() )->GetExcellonDefaults( nc_defaults );
+
+    thread_pool&                               tp = GetKiCadThreadPool();
+    std::vector<std::future<READ_GERBER_FILE>> readFiles( unzippedFiles.size() );
+
+    {
+        // setlocale() is not thread safe: switch to the C locale once for all the readers
+        LOCALE_IO toggleIo;
+
+        for( size_t ii = 0; ii < unzippedFiles.size(); ii++ )
+        {
+            const UNZIPPED_FILE& unzipped = unzippedFiles[ii];
+
+            if( !unzipped.extracted )
+                continue;
+
+            // Try to parse files if we can't tell from file extension
+            int fileType = 0;
+
+            if( unzipped.order == GERBER_ORDER_ENUM::GERBER_DRILL )
+                fileType = 1;
+            else if( unzipped.order == GERBER_ORDER_ENUM::GERBER_LAYER_UNKNOWN )
+                fileType = 2;
+
+            readFiles[ii] = tp.submit(
+                    [&, ii, fileType]() -> READ_GERBER_FILE
+                    {
+                        return readGerberFile( unzippedFiles[ii].tempFile, fileType,
+                                               nc_defaults );
+                    } );
+        }
+
+        for( std::future<READ_GERBER_FILE>& readFile : readFiles )
+        {
+            if( readFile.valid() )
+                readFile.wait();
+        }
+    }
+
+    for( size_t ii = 0; ii < unzippedFiles.size(); ii++ )
+    {
+        UNZIPPED_FILE&   unzipped = unzippedFiles[ii];
+        READ_GERBER_FILE readFile;
+
+        if( readFiles[ii].valid() )
+            readFile = readFiles[ii].get();
+
+        // The unzipped file is only a temporary file, delete it.
+        wxRemoveFile( unzipped.tempFile );
 
         int layer = GetActiveLayer();
 
@@ -503,65 +704,48 @@ bool GERBVIEW_FRAME::unarchiveFiles( const wxString& aFullFileName, REPORTER* aR
                 reported_no_more_layer = true;
 
                 // Report the name of not loaded files:
-                msg.Printf( MSG_NOT_LOADED, entry->GetName() );
+                msg.Printf( MSG_NOT_LOADED, unzipped.name );
                 aReporter->Report( msg, RPT_SEVERITY_ERROR );
             }
 
-            delete entry;
             continue;
         }
 
-        // Create the unzipped temporary file:
-        {
-            wxFFileOutputStream temporary_ofile( unzipped_tempfile );
-
-            if( temporary_ofile.Ok() )
-                temporary_ofile.Write( zipArchive );
-            else
-            {
-                success = false;
-
-                if( aReporter )
-                {
-                    msg.Printf( _( "<b>Unable to create temporary file '%s'.</b>" ),
-                                unzipped_tempfile );
-                    aReporter->Report( msg, RPT_SEVERITY_ERROR );
-                }
-            }
-        }
-
-        bool read_ok = true;
+        bool read_ok = unzipped.extracted && !readFile.outOfMemory;
 
-        // Try to parse files if we can't tell from file extension
-        if( order == GERBER_ORDER_ENUM::GERBER_LAYER_UNKNOWN )
+        if( read_ok && unzipped.order == GERBER_ORDER_ENUM::GERBER_LAYER_UNKNOWN )
         {
-            if( EXCELLON_IMAGE::TestFileIsExcellon( unzipped_tempfile ) )
+            if( readFile.fileType == 1 )
             {
-                order = GERBER_ORDER_ENUM::GERBER_DRILL;
+                unzipped.order = GERBER_ORDER_ENUM::GERBER_DRILL;
             }
-            else if( GERBER_FILE_IMAGE::TestFileIsRS274( unzipped_tempfile ) )
+            else if( readFile.fileType == 0 )
             {
                 // If we have no way to know what layer it is, just guess
-                order = GERBER_ORDER_ENUM::GERBER_TOP_COPPER;
+                unzipped.order = GERBER_ORDER_ENUM::GERBER_TOP_COPPER;
             }
             else
             {
                 if( aReporter )
                 {
-                    msg.Printf( _( "Skipped file '%s' (unknown type)." ), entry->GetName() );
+                    msg.Printf( _( "Skipped file '%s' (unknown type)." ), unzipped.name );
                     aReporter->Report( msg, RPT_SEVERITY_WARNING );
                 }
             }
         }
 
-        if( order == GERBER_ORDER_ENUM::GERBER_DRILL )
+        if( !read_ok )
+        {
+            // Nothing was read
+        }
+        else if( unzipped.order == GERBER_ORDER_ENUM::GERBER_DRILL )
         {
-            read_ok = Read_EXCELLON_File( unzipped_tempfile );
+            read_ok = addExcellonImage( std::move( readFile.drill ), unzipped.tempFile );
         }
-        else if( order != GERBER_ORDER_ENUM::GERBER_LAYER_UNKNOWN )
+        else if( unzipped.order != GERBER_ORDER_ENUM::GERBER_LAYER_UNKNOWN )
         {
             // Read gerber files: each file is loaded on a new GerbView layer
-            read_ok = Read_GERBER_File( unzipped_tempfile );
+            read_ok = addGerberImage( std::move( readFile.gerber ), unzipped.tempFile );
 
             if( read_ok )
             {
@@ -576,18 +760,13 @@ bool GERBVIEW_FRAME::unarchiveFiles( const wxString& aFullFileName, REPORTER* aR
             firstLoadedLayer = layer;
         }
 
-        delete entry;
-
-        // The unzipped file is only a temporary file, delete it.
-        wxRemoveFile( unzipped_tempfile );
-
         if( !read_ok )
         {
             success = false;
 
             if( aReporter )
             {
-                msg.Printf( _( "<b>unzipped file %s read error</b>" ), unzipped_tempfile );
+                msg.Printf( _( "<b>unzipped file %s read error</b>" ), unzipped.tempFile );
                 aReporter->Report( msg, RPT_SEVERITY_ERROR );
             }
         }
@@ -597,7 +776,7 @@ bool GERBVIEW_FRAME::unarchiveFiles( const wxString& aFullFileName, REPORTER* aR
 
             if( gerber_image )
             {
-                gerber_image->m_FileName = fname;
+                gerber_image->m_FileName = unzipped.name;
                 if( gerber_image->m_IsX2_file )
                     foundX2Gerbers = true;
             }
@@ -335,11 +335,12 @@ const BOX2I GERBER_DRAW_ITEM::GetBoundingBox() const
     {
         if( code )
         {
-            // Update the shape drawings and the bounding box coordinates:
-            code->GetMacro()->GetApertureMacroShape( this, m_Start );
+            // The flashed shape is shared by all the flashes of the D_CODE, and is already
+            // in AB coordinates
+            bbox = code->GetFlashedShape( this ).BBox();
+            bbox.Move( GetABPosition( m_Start ) );
 
-            // now the bounding box is valid:
-            bbox = code->GetMacro()->GetBoundingBox();
+            return bbox;
         }
 
         break;
@@ -873,9 +874,11 @@ bool GERBER_DRAW_ITEM::HitTest( const VECTOR2I& aRefPos, int aAccuracy ) const
     }
 
     case GBR_SPOT_MACRO:
-        // Aperture macro polygons are already in absolute coordinates
-        auto p = GetDcodeDescr()->GetMacro()->GetApertureMacroShape( this, m_Start );
-        return p->Contains( VECTOR2I( aRefPos ), -1, aAccuracy );
+    {
+        // Aperture macro shapes are in AB coordinates, relative to the flash position
+        const SHAPE_POLY_SET& shape = GetDcodeDescr()->GetFlashedShape( this );
+        return shape.Contains( aRefPos - GetABPosition( m_Start ), -1, aAccuracy );
+    }
     }
 
     // TODO: a better analyze of the shape (perhaps create a D_CODE::HitTest for flashed items)
@@ -955,7 +958,7 @@ double GERBER_DRAW_ITEM::ViewGetLOD( int aLayer, KIGFX::VIEW* aView ) const
         switch( m_Shape )
         {
         case GBR_SPOT_MACRO:
-            size = GetDcodeDescr()->GetMacro()->GetBoundingBox().GetWidth();
+            size = GetDcodeDescr()->GetFlashedShape( this ).BBox().GetWidth();
             break;
 
         case GBR_ARC:
@@ -34,6 +34,7 @@
 #define NO_AVAILABLE_LAYERS UNDEFINED_LAYER
 
 class DCODE_SELECTION_BOX;
+class EXCELLON_IMAGE;
 class GERBER_LAYER_WIDGET;
 class GBR_LAYER_BOX_SELECTOR;
 class GERBER_DRAW_ITEM;
@@ -502,6 +503,25 @@ private:
     bool LoadFileOrShowDialog( const wxString& aFileName, const wxString& dialogFiletypes,
                                const wxString& dialogTitle, const int filetype );
 
+    /**
+     * Put a gerber image on the active layer, show its messages and add its items to the view.
+     *
+     * The image is read by GERBER_FILE_IMAGE::LoadGerberFile(), which does not touch the frame
+     * and can be run on a worker thread.  This function must be called from the main thread.
+     *
+     * @param aGerber is the image, or nullptr if the file could not be read.
+     * @param aFullFileName is the name of the file the image was read from.
+     * @return true if the image was added.
+     */
+    bool addGerberImage( std::unique_ptr<GERBER_FILE_IMAGE> aGerber,
+                         const wxString& aFullFileName );
+
+    /**
+     * Same as addGerberImage(), for a drill image read by EXCELLON_IMAGE::LoadFile().
+     */
+    bool addExcellonImage( std::unique_ptr<EXCELLON_IMAGE> aDrill,
+                           const wxString& aFullFileName );
+
     // The Tool Framework initialization
     void setupTools();
 
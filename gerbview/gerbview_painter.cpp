@@ -421,7 +421,7 @@ void GERBVIEW_PAINTER::draw( /*const*/ GERBER_DRAW_ITEM* aItem, int aLayer )
 
 
 void GERBVIEW_PAINTER::drawPolygon( GERBER_DRAW_ITEM* aParent, const SHAPE_POLY_SET& aPolygon,
-                                    bool aFilled, bool aShift )
+                                    bool aFilled )
 {
     wxASSERT( aPolygon.OutlineCount() == 1 );
 
@@ -431,10 +431,9 @@ void GERBVIEW_PAINTER::drawPolygon( GERBER_DRAW_ITEM* aParent, const SHAPE_POLY_
     SHAPE_POLY_SET poly;
     poly.NewOutline();
     const std::vector<VECTOR2I> pts = aPolygon.COutline( 0 ).CPoints();
-    VECTOR2I offset = aShift ? VECTOR2I( aParent->m_Start ) : VECTOR2I( 0, 0 );
 
     for( const VECTOR2I& pt : pts )
-        poly.Append( aParent->GetABPosition( pt + offset ) );
+        poly.Append( aParent->GetABPosition( pt ) );
 
     if( !gvconfig()->m_Display.m_DisplayPolygonsFill )
         m_gal->SetLineWidth( m_gerbviewSettings.m_outlineWidth );
@@ -472,10 +471,7 @@ void GERBVIEW_PAINTER::drawFlashedShape( GERBER_DRAW_ITEM* aItem, bool aFilled )
         }
         else    // rectangular hole
         {
-            if( code->m_Polygon.OutlineCount() == 0 )
-                code->ConvertShapeToPolygon( aItem );
-
-            drawPolygon( aItem, code->m_Polygon, aFilled, true );
+            drawFlashedPolygon( aItem, aFilled );
         }
 
         break;
@@ -497,10 +493,7 @@ void GERBVIEW_PAINTER::drawFlashedShape( GERBER_DRAW_ITEM* aItem, bool aFilled )
         }
         else
         {
-            if( code->m_Polygon.OutlineCount() == 0 )
-                code->ConvertShapeToPolygon( aItem );
-
-            drawPolygon( aItem, code->m_Polygon, aFilled, true );
+            drawFlashedPolygon( aItem, aFilled );
         }
         break;
     }
@@ -536,23 +529,17 @@ void GERBVIEW_PAINTER::drawFlashedShape( GERBER_DRAW_ITEM* aItem, bool aFilled )
         }
         else
         {
-            if( code->m_Polygon.OutlineCount() == 0 )
-                code->ConvertShapeToPolygon( aItem );
-
-            drawPolygon( aItem, code->m_Polygon, aFilled, true );
+            drawFlashedPolygon( aItem, aFilled );
         }
         break;
     }
 
     case GBR_SPOT_POLY:
-        if( code->m_Polygon.OutlineCount() == 0 )
-            code->ConvertShapeToPolygon( aItem );
-
-        drawPolygon( aItem, code->m_Polygon, aFilled, true );
+        drawFlashedPolygon( aItem, aFilled );
         break;
 
     case GBR_SPOT_MACRO:
-        drawApertureMacro( aItem, aFilled );
+        drawFlashedPolygon( aItem, aFilled );
         break;
 
     default:
@@ -562,24 +549,35 @@ void GERBVIEW_PAINTER::drawFlashedShape( GERBER_DRAW_ITEM* aItem, bool aFilled )
 }
 
 
-void GERBVIEW_PAINTER::drawApertureMacro( GERBER_DRAW_ITEM* aParent, bool aFilled )
+void GERBVIEW_PAINTER::drawFlashedPolygon( GERBER_DRAW_ITEM* aItem, bool aFilled )
 {
-    D_CODE*         code = aParent->GetDcodeDescr();
-    APERTURE_MACRO* macro = code->GetMacro();
-    SHAPE_POLY_SET* macroShape = macro->GetApertureMacroShape( aParent, aParent->m_Start );
+    // The shape is shared by all the flashes of the D_CODE, so it is drawn moved to the flash
+    // position instead of being rebuilt (and triangulated) for each flash.
+    SHAPE_POLY_SET& shape = aItem->GetDcodeDescr()->GetFlashedShape( aItem );
+
+    if( shape.OutlineCount() == 0 )
+        return;
 
     if( !gvconfig()->m_Display.m_DisplayPolygonsFill )
         m_gal->SetLineWidth( m_gerbviewSettings.m_outlineWidth );
 
+    m_gal->Save();
+    m_gal->Translate( VECTOR2D( aItem->GetABPosition( aItem->m_Start ) ) );
+
     if( !aFilled )
     {
-        for( int i = 0; i < macroShape->OutlineCount(); i++ )
-            m_gal->DrawPolyline( macroShape->COutline( i ) );
+        for( int i = 0; i < shape.OutlineCount(); i++ )
+            m_gal->DrawPolyline( shape.COutline( i ) );
     }
     else
     {
-        m_gal->DrawPolygon( *macroShape );
+        if( m_gal->IsOpenGlEngine() && !shape.IsTriangulationUpToDate() )
+            shape.CacheTriangulation( false /* fastest triangulation calculation mode */ );
+
+        m_gal->DrawPolygon( shape );
     }
+
+    m_gal->Restore();
 }
 
 
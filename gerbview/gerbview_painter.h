@@ -145,16 +145,15 @@ protected:
      * @param aParent Pointer to the draw item for AB Position calculation.
      * @param aPolygon the polygon to draw.
      * @param aFilled If true, draw the polygon as filled, otherwise only outline.
-     * @param aShift If true, draw the polygon relative to the parent item position.
      */
-    void drawPolygon( GERBER_DRAW_ITEM* aParent, const SHAPE_POLY_SET& aPolygon,
-                      bool aFilled, bool aShift = false );
+    void drawPolygon( GERBER_DRAW_ITEM* aParent, const SHAPE_POLY_SET& aPolygon, bool aFilled );
 
     /// Helper to draw a flashed shape (aka spot)
     void drawFlashedShape( GERBER_DRAW_ITEM* aItem, bool aFilled );
 
-    /// Helper to draw an aperture macro shape
-    void drawApertureMacro( GERBER_DRAW_ITEM* aParent, bool aFilled );
+    /// Helper to draw the D_CODE shape shared by flashed items (aperture macros, polygons and
+    /// apertures with holes)
+    void drawFlashedPolygon( GERBER_DRAW_ITEM* aItem, bool aFilled );
 
     /**
      * Get the thickness to draw for a line (e.g. 0 thickness lines get a minimum value).
@@ -39,6 +39,22 @@
 /* Read a gerber file, RS274D, RS274X or RS274X2 format.
  */
 bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName )
+{
+    // use an unique ptr while we load to free on exception properly
+    std::unique_ptr<GERBER_FILE_IMAGE> gerber_uptr =
+            std::make_unique<GERBER_FILE_IMAGE>( GetActiveLayer() );
+
+    // Read the gerber file. The image will be added only if it can be read
+    // to avoid broken data.
+    if( !gerber_uptr->LoadGerberFile( GERBER_FullFileName ) )
+        gerber_uptr.reset();
+
+    return addGerberImage( std::move( gerber_uptr ), GERBER_FullFileName );
+}
+
+
+bool GERBVIEW_FRAME::addGerberImage( std::unique_ptr<GERBER_FILE_IMAGE> aGerber,
+                                     const wxString& aFullFileName )
 {
     wxString msg;
 
@@ -51,22 +67,15 @@ bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName )
         Erase_Current_DrawLayer( false );
     }
 
-    // use an unique ptr while we load to free on exception properly
-    std::unique_ptr<GERBER_FILE_IMAGE> gerber_uptr = std::make_unique<GERBER_FILE_IMAGE>( layer );
-
-    // Read the gerber file. The image will be added only if it can be read
-    // to avoid broken data.
-    bool success = gerber_uptr->LoadGerberFile( GERBER_FullFileName );
-
-    if( !success )
+    if( !aGerber )
     {
-        gerber_uptr.reset();
-        msg.Printf( _( "File '%s' not found" ), GERBER_FullFileName );
+        msg.Printf( _( "File '%s' not found" ), aFullFileName );
         ShowInfoBarError( msg );
         return false;
     }
 
-    gerber = gerber_uptr.release();
+    gerber = aGerber.release();
+    gerber->m_GraphicLayer = layer;
     wxASSERT( gerber != nullptr );
     images->AddGbrImage( gerber, layer );
 
@@ -226,8 +235,6 @@ bool GERBER_FILE_IMAGE::TestFileIsRS274( const wxString& aFullFileName )
 // size of a single line of text from a gerber file.
 // warning: some files can have *very long* lines, so the buffer must be large.
 #define GERBER_BUFZ 1000000
-// A large buffer to store one line
-static char lineBuffer[GERBER_BUFZ+1];
 
 bool GERBER_FILE_IMAGE::LoadGerberFile( const wxString& aFullFileName )
 {
@@ -235,6 +242,10 @@ bool GERBER_FILE_IMAGE::LoadGerberFile( const wxString& aFullFileName )
     int      D_commande = 0;       // command number for D commands like D02
     char*    text;
 
+    // A large buffer to store one line.  Not static, so that several files can be read at
+    // the same time.
+    std::vector<char> lineBuffer( GERBER_BUFZ + 1 );
+
     ClearMessageList( );
     ResetDefaultValues();
 
@@ -252,11 +263,11 @@ bool GERBER_FILE_IMAGE::LoadGerberFile( const wxString& aFullFileName )
 
     while( true )
     {
-        if( fgets( lineBuffer, GERBER_BUFZ, m_Current_File ) == nullptr )
+        if( fgets( lineBuffer.data(), GERBER_BUFZ, m_Current_File ) == nullptr )
             break;
 
         m_LineNum++;
-        text = StrPurge( lineBuffer );
+        text = StrPurge( lineBuffer.data() );
 
         while( text && *text )
         {
@@ -313,7 +324,7 @@ bool GERBER_FILE_IMAGE::LoadGerberFile( const wxString& aFullFileName )
                 if( m_CommandState != ENTER_RS274X_CMD )
                 {
                     m_CommandState = ENTER_RS274X_CMD;
-                    ReadRS274XCommand( lineBuffer, GERBER_BUFZ, text );
+                    ReadRS274XCommand( lineBuffer.data(), GERBER_BUFZ, text );
                 }
                 else        //Error
                 {
@@ -133,8 +133,8 @@ void fillFlashedGBRITEM(  GERBER_DRAW_ITEM* aGbrItem,
     case APT_MACRO:
         aGbrItem->m_Shape = GBR_SPOT_MACRO;
 
-        // Cache the bounding box for aperture macros
-        aGbrItem->GetDcodeDescr()->GetMacro()->GetApertureMacroShape( aGbrItem, aPos );
+        // Build the shape shared by the flashes of this aperture macro
+        aGbrItem->GetDcodeDescr()->GetFlashedShape( aGbrItem );
         break;
     }
 }
@@ -331,8 +331,9 @@ static void fillArcPOLY( GERBER_DRAW_ITEM* aGbrItem, const VECTOR2I& aStart, con
 {
     /* in order to calculate arc parameters, we use fillArcGBRITEM
      * so we muse create a dummy track and use its geometric parameters
+     * (not static: several files can be read at the same time)
      */
-    static GERBER_DRAW_ITEM dummyGbrItem( nullptr );
+    GERBER_DRAW_ITEM dummyGbrItem( nullptr );
 
     aGbrItem->SetLayerPolarity( aLayerNegative );
 
@@ -118,6 +118,11 @@ public:
      */
     bool m_RealTimeConnectivity;
 
+    /**
+     * Only rebuild the schematic nets affected by an edit
+     */
+    bool m_IncrementalConnectivity;
+
     /**
      * Set the stack size for coroutines
      */
@@ -243,6 +248,11 @@ public:
      */
     bool m_UseClipper2;
 
+    /**
+     * Maximum memory, in MB, used by each of the undo and redo lists.  0 for no limit.
+     */
+    int m_MaxUndoMemory;
+
 
 private:
     ADVANCED_CFG();
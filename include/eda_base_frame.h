@@ -565,6 +565,18 @@ public:
      */
     virtual PICKED_ITEMS_LIST* PopCommandFromRedoList();
 
+    /**
+     * Return an estimate of the memory used by an item stored in the undo or redo lists.
+     *
+     * The lists of frames which return 0 (the default) are only bounded by their command count.
+     */
+    virtual size_t GetUndoRedoItemMemoryUsage( const EDA_ITEM* aItem ) const { return 0; }
+
+    /**
+     * Return an estimate of the memory used by the items stored in the undo or redo list.
+     */
+    size_t GetUndoRedoMemoryUsage( UNDO_REDO_LIST aList ) const;
+
     virtual int GetUndoCommandCount() const { return m_undoList.m_CommandsList.size(); }
     virtual int GetRedoCommandCount() const { return m_redoList.m_CommandsList.size(); }
 
@@ -656,6 +668,12 @@ protected:
 
     void ensureWindowIsOnScreen();
 
+    /**
+     * Delete the oldest commands of \a aList until the memory it uses is below the
+     * MaxUndoMemory advanced setting.  The last command is always kept.
+     */
+    void trimUndoRedoListMemory( UNDO_REDO_LIST aList );
+
     /**
      * Handles event fired when a file is dropped to the window.
      * In this base class, stores the path of files accepted.
@@ -41,6 +41,9 @@
 #include <font/glyph.h>
 #include <font/outline_decomposer.h>
 
+#include <mutex>
+#include <tuple>
+
 namespace KIFONT
 {
 /**
@@ -123,15 +126,30 @@ protected:
                               const VECTOR2I& aPosition, const EDA_ANGLE& aAngle, bool aMirror,
                               const VECTOR2I& aOrigin, TEXT_STYLE_FLAGS aTextStyle ) const;
 
+    /**
+     * Return the glyph \a aGlyphIndex of the face, decomposed, triangulated and expressed in
+     * 1/m_glyphCacheScale face units, for a face char size of \a aScaler.
+     */
+    std::shared_ptr<const OUTLINE_GLYPH> getCachedGlyph( unsigned int aGlyphIndex, double aScaler,
+                                                         TEXT_STYLE_FLAGS aTextStyle ) const;
+
 private:
     // FreeType variables
     static FT_Library m_freeType;
     FT_Face           m_face;
     const int         m_faceSize;
 
-    // cache for glyphs converted to straight segments
-    // key is glyph index (FT_GlyphSlot field glyph_index)
-    std::map<unsigned int, GLYPH_POINTS_LIST> m_contourCache;
+    // Cache of the glyphs converted to triangulated polygons, shared by all the texts using
+    // this font (fonts are themselves shared, see FONT::GetFont()).  Key is glyph index
+    // (FT_GlyphSlot field glyph_index), char size and subscript/superscript offset.
+    // The lock also guards the face, whose char size is set for each text.
+    typedef std::tuple<unsigned int, int, int> GLYPH_CACHE_KEY;
+
+    mutable std::mutex                                                     m_glyphCacheLock;
+    mutable std::map<GLYPH_CACHE_KEY, std::shared_ptr<const OUTLINE_GLYPH>> m_glyphCache;
+
+    // Resolution of the cached glyphs; face units are too coarse to be stored as integers
+    static constexpr double m_glyphCacheScale = 1024.0;
 
     // The height of the KiCad stroke font is the distance between stroke endpoints for a vertical
     // line of cap-height.  So the cap-height of the font is actually stroke-width taller than its
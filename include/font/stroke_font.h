@@ -96,10 +96,17 @@ private:
      */
     void loadNewStrokeFont( const char* const aNewStrokeFont[], int aNewStrokeFontSize );
 
+    /**
+     * Return the glyph at \a aIndex in the font data, decoding it on first use.
+     */
+    STROKE_GLYPH* getGlyph( int aIndex ) const;
+
+    static std::unique_ptr<STROKE_GLYPH> decodeGlyph( const char* aGlyphData );
+
 private:
-    const std::vector<std::shared_ptr<GLYPH>>* m_glyphs;
-    const GLYPH_BOUNDING_BOX_LIST*             m_glyphBoundingBoxes;
-    double                                     m_maxGlyphWidth;
+    const char* const* m_glyphData;
+    int                m_glyphCount;
+    double             m_maxGlyphWidth;
 };
 
 } //namespace KIFONT
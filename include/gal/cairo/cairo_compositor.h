@@ -34,6 +34,7 @@
 
 #include <gal/compositor.h>
 #include <gal/gal_display_options.h>
+#include <math/box2.h>
 #include <cairo.h>
 
 #include <cstdint>
@@ -71,9 +72,22 @@ public:
     /// @copydoc COMPOSITOR::ClearBuffer()
     virtual void ClearBuffer( const COLOR4D& aColor ) override;
 
+    /**
+     * Mark an area of the current buffer as drawn to.
+     *
+     * Only the dirty area of a buffer is cleared and composited, so everything drawn to a
+     * buffer has to be covered by the areas marked here.
+     *
+     * @param aArea is the area in device (i.e. buffer pixel) coordinates.
+     */
+    void MarkDirty( const BOX2D& aArea );
+
     /**
      * Paints source to destination using the cairo operator. Useful for differential mode.
      *
+     * Only the dirty area of the source is painted, so the operator has to leave the destination
+     * untouched where the source is transparent (e.g. CAIRO_OPERATOR_OVER or CAIRO_OPERATOR_ADD).
+     *
      * @param aSourceHandle Source buffer to paint
      * @param aDestHandle Destination buffer to paint on to
      * @param op Painting operation
@@ -132,6 +146,7 @@ protected:
         cairo_t*            context;        ///< Main texture handle
         cairo_surface_t*    surface;        ///< Point to which an image from texture is attached
         BitmapPtr           bitmap;         ///< Pixel storage
+        BOX2I               dirtyRect;      ///< Area drawn to since the last clear
     };
 
     unsigned int            m_current;      ///< Currently used buffer handle
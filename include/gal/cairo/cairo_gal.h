@@ -286,6 +286,22 @@ protected:
     void flushPath();
     void storePath();                           ///< Store the actual path
 
+    /**
+     * Mark the area covered by the current path as drawn to.
+     *
+     * @param aStroke tells if the path is going to be stroked (rather than only filled).
+     */
+    void markPathDirty( bool aStroke );
+
+    /**
+     * Mark an area of the current target as drawn to.  Only needed by the GALs that composite
+     * their targets.
+     *
+     * @param aX1, aY1, aX2, aY2 are the corners of the area, in user coordinates of the current
+     *                           context.
+     */
+    virtual void markDirty( double aX1, double aY1, double aX2, double aY2 ) {}
+
     /**
      * Blit cursor into the current screen.
      */
@@ -373,7 +389,62 @@ protected:
 };
 
 
-class CAIRO_GAL : public CAIRO_GAL_BASE, public wxWindow
+/**
+ * Cairo GAL drawing its targets to the buffers of a #CAIRO_COMPOSITOR, which are merged onto
+ * the output surface at the end of each frame.  Where the output surface comes from is left
+ * to the derived classes.
+ */
+class CAIRO_COMPOSITING_GAL : public CAIRO_GAL_BASE
+{
+public:
+    CAIRO_COMPOSITING_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions );
+
+    void SetTarget( RENDER_TARGET aTarget ) override;
+
+    RENDER_TARGET GetTarget() const override;
+
+    void ClearTarget( RENDER_TARGET aTarget ) override;
+
+    /// @copydoc GAL::StartDiffLayer()
+    void StartDiffLayer() override;
+
+    /// @copydoc GAL::EndDiffLayer()
+    void EndDiffLayer() override;
+
+    /// @copydoc GAL::StartNegativesLayer()
+    void StartNegativesLayer() override;
+
+    /// @copydoc GAL::EndNegativesLayer()
+    void EndNegativesLayer() override;
+
+protected:
+    /// @copydoc CAIRO_GAL_BASE::markDirty()
+    void markDirty( double aX1, double aY1, double aX2, double aY2 ) override;
+
+    /// Prepare the compositor
+    void setCompositor();
+
+    /// Set the compositor up for a new frame drawn to m_context
+    void beginCompositing();
+
+    /// Merge the buffers onto m_context
+    void endCompositing();
+
+    /// Return the compositor buffer \a aTarget is rendered to
+    unsigned int getTargetBuffer( RENDER_TARGET aTarget ) const;
+
+    // Compositor related variables
+    std::shared_ptr<CAIRO_COMPOSITOR> m_compositor;  ///< Object for layers compositing
+    unsigned int        m_mainBuffer;          ///< Handle to the main buffer
+    unsigned int        m_overlayBuffer;       ///< Handle to the overlay buffer
+    unsigned int        m_tempBuffer;          ///< Handle to the temp buffer
+    unsigned int        m_savedBuffer;         ///< Handle to buffer to restore after rendering to temp buffer
+    RENDER_TARGET       m_currentTarget;       ///< Current rendering target
+    bool                m_validCompositor;     ///< Compositor initialization flag
+};
+
+
+class CAIRO_GAL : public CAIRO_COMPOSITING_GAL, public wxWindow
 {
 public:
     /**
@@ -407,24 +478,6 @@ public:
 
     void EndGroup() override;
 
-    void SetTarget( RENDER_TARGET aTarget ) override;
-
-    RENDER_TARGET GetTarget() const override;
-
-    void ClearTarget( RENDER_TARGET aTarget ) override;
-
-    /// @copydoc GAL::StartDiffLayer()
-    void StartDiffLayer() override;
-
-    /// @copydoc GAL::EndDiffLayer()
-    void EndDiffLayer() override;
-
-    /// @copydoc GAL::StartNegativesLayer()
-    void StartNegativesLayer() override;
-
-    /// @copydoc GAL::EndNegativesLayer()
-    void EndNegativesLayer() override;
-
     /**
      * Post an event to m_paint_listener.
      *
@@ -464,9 +517,6 @@ public:
     /// Allocate the bitmaps for drawing
     void deleteBitmaps();
 
-    /// Prepare the compositor
-    void setCompositor();
-
     // Event handlers
     /**
      * Paint event handler.
@@ -493,15 +543,6 @@ public:
     bool updatedGalDisplayOptions( const GAL_DISPLAY_OPTIONS& aOptions ) override;
 
 protected:
-    // Compositor related variables
-    std::shared_ptr<CAIRO_COMPOSITOR> m_compositor;  ///< Object for layers compositing
-    unsigned int        m_mainBuffer;          ///< Handle to the main buffer
-    unsigned int        m_overlayBuffer;       ///< Handle to the overlay buffer
-    unsigned int        m_tempBuffer;          ///< Handle to the temp buffer
-    unsigned int        m_savedBuffer;         ///< Handle to buffer to restore after rendering to temp buffer
-    RENDER_TARGET       m_currentTarget;       ///< Current rendering target
-    bool                m_validCompositor;     ///< Compositor initialization flag
-
     // Variables related to wxWidgets
     wxWindow*           m_parentWindow;        ///< Parent window
     wxEvtHandler*       m_mouseListener;       ///< Mouse listener
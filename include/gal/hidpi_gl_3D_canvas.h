@@ -33,7 +33,7 @@
 #include <wx/timer.h>
 
 
-class RENDER_3D_RAYTRACE;
+class RENDER_3D_RAYTRACE_GL;
 class RENDER_3D_OPENGL;
 
 
@@ -26,6 +26,9 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
 
 /* Class to handle a D_CODE when plotting a board using Standard Aperture Templates
  * (complex apertures need aperture macros to be flashed)
@@ -183,7 +186,11 @@ class APER_MACRO_FREEPOLY_LIST
 public:
     APER_MACRO_FREEPOLY_LIST() {}
 
-    void ClearList() { m_AMList.clear(); }
+    void ClearList()
+    {
+        m_AMList.clear();
+        m_AMByCornerCount.clear();
+    }
 
     int AmCount() const { return (int)m_AMList.size(); }
 
@@ -208,4 +215,8 @@ public:
     void Format( FILE * aOutput, double aIu2GbrMacroUnit );
 
     std::vector<APER_MACRO_FREEPOLY> m_AMList;
+
+    // Indices in m_AMList, by corner count. Polygons are compared with a tolerance, so
+    // only the polygons having the same corner count are compared
+    std::unordered_map<int, std::vector<int>> m_AMByCornerCount;
 };
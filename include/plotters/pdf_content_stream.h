@@ -0,0 +1,110 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pdf_content_stream.h
+ * @brief PDF page content stream writer
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <memory>
+
+#include <fmt/format.h>
+#include <wx/stream.h>
+
+class wxZlibOutputStream;
+
+
+/**
+ * wxOutputStream writing to a stdio file, keeping count of the bytes written.
+ */
+class PDF_FILE_OUTPUT_STREAM : public wxOutputStream
+{
+public:
+    PDF_FILE_OUTPUT_STREAM( FILE* aFile ) :
+            m_file( aFile ),
+            m_written( 0 )
+    {
+    }
+
+    size_t Written() const { return m_written; }
+
+protected:
+    size_t OnSysWrite( const void* aBuffer, size_t aSize ) override;
+
+private:
+    FILE*  m_file;
+    size_t m_written;
+};
+
+
+/**
+ * A page content stream being emitted.
+ *
+ * The operators are formatted into a fixed size memory buffer, which is deflated (unless
+ * \a aCompress is false) and written to the output file each time it fills up.  The content
+ * of a page is therefore never held entirely in memory or in a temporary file.
+ */
+class PDF_CONTENT_STREAM
+{
+public:
+    PDF_CONTENT_STREAM( FILE* aOutputFile, bool aCompress );
+    ~PDF_CONTENT_STREAM();
+
+    /**
+     * Append formatted text to the stream.  The floating point values are formatted like
+     * printf's %g and %f do in the C locale, just faster.
+     */
+    template <typename... Args>
+    void Print( fmt::format_string<Args...> aFormat, Args&&... aArgs )
+    {
+        fmt::format_to( fmt::appender( m_buffer ), aFormat, std::forward<Args>( aArgs )... );
+
+        if( m_buffer.size() >= BUFFER_SIZE )
+            flush();
+    }
+
+    void Write( const char* aText );
+
+    /**
+     * Write out what is left of the stream and end the deflate stream.
+     *
+     * @return the number of bytes written to the output file for the whole stream, i.e. the
+     *         compressed size when compressing.
+     */
+    size_t Finish();
+
+    /// Size of the stream before compression
+    size_t GetRawSize() const { return m_rawSize; }
+
+private:
+    void flush();
+
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    // Some room after BUFFER_SIZE, so that the line completing the buffer doesn't need an
+    // allocation
+    fmt::basic_memory_buffer<char, BUFFER_SIZE + 1024> m_buffer;
+
+    PDF_FILE_OUTPUT_STREAM              m_output;
+    std::unique_ptr<wxZlibOutputStream> m_compressor;   ///< Deflate state, if compressing
+    size_t                              m_rawSize;
+};
@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include "plotter.h"
 #include "gbr_plotter_apertures.h"
 
@@ -327,6 +329,12 @@ protected:
      */
     void emitDcode( const VECTOR2D& pt, int dcode );
 
+    /**
+     * Emit the D01 record of a circular interpolation, ending at \a aEnd, with the center
+     * at \a aCenterOffset from the start point.
+     */
+    void emitArcDcode( const VECTOR2D& aEnd, const VECTOR2D& aCenterOffset );
+
     /**
      * Print a Gerber net attribute object record.
      *
@@ -367,6 +375,12 @@ protected:
     void writeApertureList();
 
     std::vector<APERTURE> m_apertures;  // The list of available apertures
+
+    // Indices in m_apertures, by hash of the aperture parameters (only the corner count is
+    // hashed for polygons, which are compared with a tolerance), to find the aperture of an
+    // item without searching the whole list
+    std::unordered_map<size_t, std::vector<int>> m_apertureIndex;
+
     int     m_currentApertureIdx;       // The index of the current aperture in m_apertures
     bool    m_hasApertureRoundRect;     // true is at least one round rect aperture is in use
     bool    m_hasApertureRotOval;       // true is at least one oval rotated aperture is in use
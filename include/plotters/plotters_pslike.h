@@ -27,6 +27,8 @@
 
 #include "plotter.h"
 
+#include <profile.h>
+
 
 /**
  * The PSLIKE_PLOTTER class is an intermediate class to handle common routines for engines
@@ -236,18 +238,26 @@ protected:
 };
 
 
+class PDF_CONTENT_STREAM;
+
+
 class PDF_PLOTTER : public PSLIKE_PLOTTER
 {
 public:
     PDF_PLOTTER() :
             m_pageTreeHandle( 0 ),
             m_fontResDictHandle( 0 ),
+            m_imageResDictHandle( 0 ),
             m_pageStreamHandle( 0 ),
             m_streamLengthHandle( 0 ),
-            m_workFile( nullptr )
+            m_imagePlacements( 0 ),
+            m_contentRawSize( 0 ),
+            m_contentSize( 0 )
     {
     }
 
+    ~PDF_PLOTTER();
+
     virtual PLOT_FORMAT GetPlotterType() const override
     {
         return PLOT_FORMAT::PDF;
@@ -359,7 +369,8 @@ public:
     void Bookmark( const BOX2I& aBox, const wxString& aName, const wxString& aGroupName = wxEmptyString ) override;
 
     /**
-     * PDF images are handles as inline, not XObject streams...
+     * PDF images are emitted as image XObjects, shared by all the placements of the same image
+     * in the document.
      */
     void PlotImage( const wxImage& aImage, const VECTOR2I& aPos, double aScaleFactor ) override;
 
@@ -449,6 +460,9 @@ protected:
      * Pass -1 (default) for a fresh object. Especially from PDF 1.5 streams
      * can contain a lot of things, but for the moment we only handle page
      * content.
+     *
+     * The stream content is compressed and written to the output file as it is emitted, so
+     * no other object can be written until the stream is closed.
      */
     int startPdfStream(int handle = -1);
 
@@ -457,6 +471,11 @@ protected:
      */
     void closePdfStream();
 
+    /**
+     * Write the image XObjects first used in the page just closed.
+     */
+    void emitPendingImages();
+
     /**
      * Starts emitting the outline object
      */
@@ -475,16 +494,39 @@ protected:
     int emitGoToAction( int aPageHandle, const VECTOR2I& aBottomLeft, const VECTOR2I& aTopRight );
     int emitGoToAction( int aPageHandle );
 
+    struct PENDING_IMAGE
+    {
+        int         handle;         ///< Handle of the image XObject
+        int         width;
+        int         height;
+        bool        color;          ///< RGB or greyscale samples
+        std::string data;           ///< Samples, compressed unless debugging the writer
+    };
+
     int m_pageTreeHandle;           ///< Handle to the root of the page tree object
     int m_fontResDictHandle;        ///< Font resource dictionary
+    int m_imageResDictHandle;       ///< Image XObject resource dictionary
     std::vector<int> m_pageHandles; ///< Handles to the page objects
     int m_pageStreamHandle;         ///< Handle of the page content object
     int m_streamLengthHandle;       ///< Handle to the deferred stream length
-    wxString m_workFilename;
     wxString m_pageName;
-    FILE* m_workFile;               ///< Temporary file to construct the stream before zipping
     std::vector<long> m_xrefTable;  ///< The PDF xref offset table
 
+    ///< Page content stream being emitted, compressed on the fly
+    std::unique_ptr<PDF_CONTENT_STREAM> m_contentStream;
+
+    ///< Image XObject handles, by hash of the image samples
+    std::map<std::string, int>  m_imageHandles;
+
+    ///< Image XObjects to write once the current page stream is closed
+    std::vector<PENDING_IMAGE>  m_pendingImages;
+
+    // Statistics, traced at the end of the plot
+    PROF_TIMER m_plotTimer;
+    size_t     m_imagePlacements;   ///< Number of PlotImage() calls
+    uint64_t   m_contentRawSize;    ///< Size of the page content streams before compression
+    uint64_t   m_contentSize;       ///< Size of the page content streams in the file
+
     ///< List of user-space page numbers for resolving internal hyperlinks
     std::vector<wxString>                                  m_pageNumbers;
 
@@ -113,6 +113,13 @@ extern const wxChar* const traceSchLibMem;
  */
 extern const wxChar* const traceSchLegacyPlugin;
 
+/**
+ * Flag to enable electrical rules checker profiling output.
+ *
+ * Use "KICAD_ERC_PROFILE" to enable.
+ */
+extern const wxChar* const traceErcProfile;
+
 /**
  * Flag to enable GEDA PCB plugin debug output.
  *
@@ -212,6 +219,13 @@ extern const wxChar* const traceGalProfile;
  */
 extern const wxChar* const traceKiCad2Step;
 
+/**
+ * Flag to enable debug output of the PDF plotter statistics (time, file and stream sizes).
+ *
+ * Use "KICAD_PDF_PLOTTER" to enable.
+ */
+extern const wxChar* const tracePdfPlotter;
+
 ///@}
 
 /**
@@ -173,6 +173,14 @@ public:
      */
     void ClearListAndDeleteItems( std::function<void(EDA_ITEM*)> aItemDeleter );
 
+    /**
+     * Return an estimate of the memory owned by this list, i.e. used by the items that
+     * ClearListAndDeleteItems() would delete.
+     *
+     * @param aItemSize returns the memory used by an item.
+     */
+    size_t GetMemoryUsage( const std::function<size_t( const EDA_ITEM* )>& aItemSize ) const;
+
     /**
      * @return The count of pickers stored in this list.
      */
@@ -306,6 +314,22 @@ public:
 
     void ClearCommandList();
 
+    /**
+     * Return an estimate of the memory owned by all the commands of the list.
+     *
+     * @param aItemSize returns the memory used by an item.
+     */
+    size_t GetMemoryUsage( const std::function<size_t( const EDA_ITEM* )>& aItemSize ) const;
+
+    /**
+     * Return the count of the oldest commands to delete for the list to use less than
+     * \a aMaxMemory.  The last command is never counted, whatever its size.
+     *
+     * @param aItemSize returns the memory used by an item.
+     */
+    int GetCommandCountOverMemory( size_t aMaxMemory,
+                                   const std::function<size_t( const EDA_ITEM* )>& aItemSize ) const;
+
     std::vector <PICKED_ITEMS_LIST*> m_CommandsList;   // the list of possible undo/redo commands
 };
 
@@ -105,6 +105,19 @@ public:
      */
     virtual void Remove( VIEW_ITEM* aItem );
 
+    /**
+     * Defer the spatial indexing of the items added to the view until EndBulkAdd().
+     *
+     * The R-trees are then packed in one go, which is much faster than inserting the items one
+     * by one when loading a whole document.  The view must not be queried in between.
+     */
+    void BeginBulkAdd();
+
+    /**
+     * Index all the items added since BeginBulkAdd().
+     */
+    void EndBulkAdd();
+
 
     /**
      * Find all visible items that touch or are within the rectangle \a aRect.
@@ -808,6 +821,9 @@ protected:
     ///< Update set of layers that an item occupies
     void updateLayers( VIEW_ITEM* aItem );
 
+    ///< Rebuild the R-trees of all the layers from the cached item layers
+    void rebuildRTrees();
+
     ///< Determine rendering order of layers. Used in display order sorting function.
     static bool compareRenderingOrder( VIEW_LAYER* aI, VIEW_LAYER* aJ )
     {
@@ -874,6 +890,9 @@ protected:
 
     ///< Flag to reverse the draw order when using draw priority.
     bool m_reverseDrawOrder;
+
+    ///< Items are added without being indexed, see BeginBulkAdd().
+    bool m_bulkAdd;
 };
 } // namespace KIGFX
 
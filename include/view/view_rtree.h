@@ -55,6 +55,28 @@ public:
         VIEW_RTREE_BASE::Insert( mmin, mmax, aItem );
     }
 
+    /**
+     * Replace the content of the tree by \a aItems, packing the tree in one go.
+     *
+     * This is much faster than inserting the items one by one when (re)building the tree.
+     */
+    void BulkLoad( const std::vector<VIEW_ITEM*>& aItems )
+    {
+        std::vector<std::pair<Rect, VIEW_ITEM*>> entries;
+        entries.reserve( aItems.size() );
+
+        for( VIEW_ITEM* item : aItems )
+        {
+            const BOX2I& bbox = item->ViewBBox();
+            Rect         rect = { { bbox.GetX(), bbox.GetY() },
+                                  { bbox.GetRight(), bbox.GetBottom() } };
+
+            entries.emplace_back( rect, item );
+        }
+
+        VIEW_RTREE_BASE::BulkLoad( entries );
+    }
+
     /**
      * Remove an item from the tree.
      *
@@ -0,0 +1,110 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 1992-2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "command_pcb_render.h"
+#include <cli/exit_codes.h>
+#include "jobs/job_pcb_render.h"
+#include <kiface_base.h>
+#include <wx/crt.h>
+
+#include <macros.h>
+
+#define ARG_OUTPUT "--output"
+#define ARG_INPUT "input"
+#define ARG_WIDTH "--width"
+#define ARG_HEIGHT "--height"
+#define ARG_SIDE "--side"
+#define ARG_THREADS "--threads"
+
+CLI::PCB_RENDER_COMMAND::PCB_RENDER_COMMAND() : COMMAND( "render" )
+{
+    m_argParser.add_argument( "-o", ARG_OUTPUT )
+            .default_value( std::string() )
+            .help( UTF8STDSTR( _( "Output PNG file name" ) ) );
+
+    m_argParser.add_argument( ARG_WIDTH )
+            .help( UTF8STDSTR( _( "Image width in pixels" ) ) )
+            .scan<'i', int>()
+            .default_value( 1600 );
+
+    m_argParser.add_argument( ARG_HEIGHT )
+            .help( UTF8STDSTR( _( "Image height in pixels" ) ) )
+            .scan<'i', int>()
+            .default_value( 900 );
+
+    m_argParser.add_argument( ARG_SIDE )
+            .default_value( std::string( "top" ) )
+            .help( UTF8STDSTR( _( "View the board from this side, valid options: top, bottom, "
+                                  "left, right, front, back" ) ) );
+
+    m_argParser.add_argument( ARG_THREADS )
+            .help( UTF8STDSTR( _( "Number of rendering threads (0 = all cores)" ) ) )
+            .scan<'i', int>()
+            .default_value( 0 );
+
+    m_argParser.add_argument( ARG_INPUT ).help( UTF8STDSTR( _( "Input file" ) ) );
+}
+
+
+int CLI::PCB_RENDER_COMMAND::Perform( KIWAY& aKiway )
+{
+    std::unique_ptr<JOB_PCB_RENDER> renderJob = std::make_unique<JOB_PCB_RENDER>( true );
+
+    renderJob->m_filename = FROM_UTF8( m_argParser.get<std::string>( ARG_INPUT ).c_str() );
+    renderJob->m_outputFile = FROM_UTF8( m_argParser.get<std::string>( ARG_OUTPUT ).c_str() );
+    renderJob->m_width = m_argParser.get<int>( ARG_WIDTH );
+    renderJob->m_height = m_argParser.get<int>( ARG_HEIGHT );
+    renderJob->m_threads = m_argParser.get<int>( ARG_THREADS );
+
+    if( renderJob->m_width <= 0 || renderJob->m_height <= 0 )
+    {
+        wxFprintf( stderr, _( "Image width and height must be positive\n" ) );
+        return EXIT_CODES::ERR_ARGS;
+    }
+
+    if( renderJob->m_threads < 0 )
+    {
+        wxFprintf( stderr, _( "Thread count cannot be negative\n" ) );
+        return EXIT_CODES::ERR_ARGS;
+    }
+
+    wxString side = FROM_UTF8( m_argParser.get<std::string>( ARG_SIDE ).c_str() ).Lower();
+
+    if( side == wxS( "top" ) )
+        renderJob->m_side = JOB_PCB_RENDER::SIDE::TOP;
+    else if( side == wxS( "bottom" ) )
+        renderJob->m_side = JOB_PCB_RENDER::SIDE::BOTTOM;
+    else if( side == wxS( "left" ) )
+        renderJob->m_side = JOB_PCB_RENDER::SIDE::LEFT;
+    else if( side == wxS( "right" ) )
+        renderJob->m_side = JOB_PCB_RENDER::SIDE::RIGHT;
+    else if( side == wxS( "front" ) )
+        renderJob->m_side = JOB_PCB_RENDER::SIDE::FRONT;
+    else if( side == wxS( "back" ) )
+        renderJob->m_side = JOB_PCB_RENDER::SIDE::BACK;
+    else
+    {
+        wxFprintf( stderr, _( "Invalid side \"%s\"\n" ), side );
+        return EXIT_CODES::ERR_ARGS;
+    }
+
+    int exitCode = aKiway.ProcessJob( KIWAY::FACE_PCB, renderJob.get() );
+
+    return exitCode;
+}
@@ -56,6 +56,7 @@
 #include "cli/command_export_pcb_pos.h"
 #include "cli/command_export_pcb_svg.h"
 #include "cli/command_export_pcb_step.h"
+#include "cli/command_pcb_render.h"
 #include "cli/command_export_sch_pythonbom.h"
 #include "cli/command_export_sch_netlist.h"
 #include "cli/command_export_sch_pdf.h"
@@ -122,6 +123,7 @@ static CLI::EXPORT_PCB_POS_COMMAND       exportPcbPosCmd{};
 static CLI::EXPORT_PCB_GERBER_COMMAND    exportPcbGerberCmd{};
 static CLI::EXPORT_PCB_COMMAND           exportPcbCmd{};
 static CLI::PCB_COMMAND                  pcbCmd{};
+static CLI::PCB_RENDER_COMMAND           pcbRenderCmd{};
 static CLI::EXPORT_SCH_COMMAND           exportSchCmd{};
 static CLI::SCH_COMMAND                  schCmd{};
 static CLI::EXPORT_SCH_PYTHONBOM_COMMAND exportSchPythonBomCmd{};
@@ -155,6 +157,9 @@ static std::vector<COMMAND_ENTRY> commandStack = {
                     &exportPcbStepCmd,
                     &exportPcbSvgCmd
                 }
+            },
+            {
+                &pcbRenderCmd
             }
         }
     },
@@ -30,6 +30,7 @@
 
 #include <cstdio>
 #include <deque>                        // for deque
+#include <functional>
 #include <vector>                       // for vector
 #include <iosfwd>                       // for string, stringstream
 #include <memory>
@@ -172,6 +173,12 @@ public:
                 vertex += aVec;
         }
 
+        void TransformVertices( const std::function<VECTOR2I( const VECTOR2I& )>& aTransform )
+        {
+            for( VECTOR2I& vertex : m_vertices )
+                vertex = aTransform( vertex );
+        }
+
     private:
         int                  m_sourceOutline;
         std::deque<TRI>      m_triangles;
@@ -1080,6 +1087,14 @@ public:
      */
     void Rotate( const EDA_ANGLE& aAngle, const VECTOR2I& aCenter = { 0, 0 } ) override;
 
+    /**
+     * Replace every vertex by its image through \a aTransform.
+     *
+     * The cached triangulation (if any) is transformed the same way and stays valid, so the
+     * transform must be affine (scaling, mirroring, rotation, translation...).
+     */
+    void TransformVertices( const std::function<VECTOR2I( const VECTOR2I& )>& aTransform );
+
     /// @copydoc SHAPE::IsSolid()
     bool IsSolid() const override
     {
@@ -129,7 +129,8 @@ bool DRC_TEST_PROVIDER_SLIVER_CHECKER::Run()
                             {
                                 if( !zone->GetIsRuleArea() )
                                 {
-                                    fill = zone->GetFill( layer )->CloneDropTriangulation();
+                                    fill = zone->GetFilledPolysList( layer )
+                                                   ->CloneDropTriangulation();
                                     fill.Unfracture( SHAPE_POLY_SET::PM_FAST );
                                     poly.Append( fill );
 
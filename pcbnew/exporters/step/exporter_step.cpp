@@ -32,6 +32,7 @@
 #include <pgm_base.h>
 #include <base_units.h>
 #include <filename_resolver.h>
+#include <profile.h>
 
 #include <Message.hxx>                // OpenCascade messenger
 #include <Message_PrinterOStream.hxx> // OpenCascade output messenger
@@ -260,9 +261,14 @@ bool EXPORTER_STEP::composePCB()
 
     m_pcbModel->SetMaxError( m_board->GetDesignSettings().m_MaxError );
 
+    PROF_TIMER timer;
+
     for( FOOTPRINT* i : m_board->Footprints() )
         composePCB( i, origin );
 
+    ReportMessage( wxString::Format( wxT( "Footprints and 3D models added in %.3f s\n" ),
+                                     timer.msecs( true ) / 1000.0 ) );
+
     ReportMessage( wxT( "Create PCB solid model\n" ) );
 
     if( !m_pcbModel->CreatePCB( pcbOutlines, origin ) )
@@ -271,6 +277,9 @@ bool EXPORTER_STEP::composePCB()
         return false;
     }
 
+    ReportMessage( wxString::Format( wxT( "PCB solid model created in %.3f s\n" ),
+                                     timer.msecs( true ) / 1000.0 ) );
+
     return true;
 }
 
@@ -318,6 +327,8 @@ bool EXPORTER_STEP::Export()
     ReportMessage( _( "Determining PCB data\n" ) );
     determinePcbThickness();
 
+    PROF_TIMER timer;
+
     try
     {
         ReportMessage( _( "Build STEP data\n" ) );
@@ -330,6 +341,8 @@ bool EXPORTER_STEP::Export()
 
         ReportMessage( _( "Writing STEP file\n" ) );
 
+        PROF_TIMER writeTimer;
+
         if( !m_pcbModel->WriteSTEP( m_outputFile ) )
         {
             ReportMessage( _( "\n** Error writing STEP file. **\n" ) );
@@ -337,6 +350,10 @@ bool EXPORTER_STEP::Export()
         }
         else
         {
+            ReportMessage( wxString::Format( wxT( "STEP file written in %.3f s\n" ),
+                                             writeTimer.msecs() / 1000.0 ) );
+            ReportMessage( wxString::Format( wxT( "Export done in %.3f s\n" ),
+                                             timer.msecs() / 1000.0 ) );
             ReportMessage( wxString::Format( _( "\nSTEP file '%s' created.\n" ), m_outputFile ) );
         }
     }
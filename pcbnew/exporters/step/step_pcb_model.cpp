@@ -24,7 +24,9 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <future>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -38,6 +40,7 @@
 
 #include <footprint.h>
 #include <pad.h>
+#include <thread_pool.h>
 
 #include "step_pcb_model.h"
 #include "streamwrapper.h"
@@ -72,7 +75,13 @@
 #include <BRepBuilderAPI_MakeFace.hxx>
 #include <BRepPrimAPI_MakePrism.hxx>
 #include <BRepPrimAPI_MakeCylinder.hxx>
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepAlgoAPI_Common.hxx>
 #include <BRepAlgoAPI_Cut.hxx>
+#include <BRepAlgoAPI_Fuse.hxx>
+#include <BRepBndLib.hxx>
+#include <Bnd_Box.hxx>
+#include <ShapeUpgrade_UnifySameDomain.hxx>
 
 #include <TopoDS.hxx>
 #include <TopoDS_Wire.hxx>
@@ -105,6 +114,12 @@ static constexpr double BOARD_OFFSET = 0.05;
 // min. length**2 below which 2 points are considered coincident
 static constexpr double MIN_LENGTH2 = STEPEXPORT_MIN_DISTANCE * STEPEXPORT_MIN_DISTANCE;
 
+// boards with less holes than this are cut in one pass
+static constexpr size_t TILED_CUT_MIN_HOLES = 500;
+
+// average number of holes in a tile of a tiled cut
+static constexpr size_t TILED_CUT_HOLES_PER_TILE = 150;
+
 
 // supported file types
 enum FormatType
@@ -205,6 +220,9 @@ STEP_PCB_MODEL::STEP_PCB_MODEL( const wxString& aPcbName )
 
 STEP_PCB_MODEL::~STEP_PCB_MODEL()
 {
+    for( MODEL_DOC_MAP::value_type& modelDoc : m_modelDocs )
+        modelDoc.second->Close();
+
     m_doc->Close();
 }
 
@@ -495,26 +513,9 @@ bool STEP_PCB_MODEL::CreatePCB( SHAPE_POLY_SET& aOutline, VECTOR2D aOrigin )
         ReportMessage( wxString::Format( wxT( "Build board cutouts and holes (%d hole(s)).\n" ),
                                          (int) m_cutouts.size() ) );
 
-        TopTools_ListOfShape holelist;
-
-        for( TopoDS_Shape& hole : m_cutouts )
-            holelist.Append( hole );
-
         // Remove holes for each board (usually there is only one board
         for( TopoDS_Shape& board: board_outlines )
-        {
-            BRepAlgoAPI_Cut      Cut;
-            TopTools_ListOfShape mainbrd;
-
-            mainbrd.Append( board );
-
-            Cut.SetArguments( mainbrd );
-
-            Cut.SetTools( holelist );
-            Cut.Build();
-
-            board = Cut.Shape();
-        }
+            board = cutHoles( board );
     }
 
     // push the board to the data structure
@@ -587,6 +588,187 @@ bool STEP_PCB_MODEL::CreatePCB( SHAPE_POLY_SET& aOutline, VECTOR2D aOrigin )
 }
 
 
+/**
+ * Subtract \a aTools from \a aShape.
+ *
+ * The input shapes are left untouched, so that the same holes can be cut from several shapes
+ * at the same time.
+ */
+static TopoDS_Shape cutShapes( const TopoDS_Shape& aShape, const TopTools_ListOfShape& aTools )
+{
+    BRepAlgoAPI_Cut      cut;
+    TopTools_ListOfShape arguments;
+
+    arguments.Append( aShape );
+
+    cut.SetArguments( arguments );
+    cut.SetTools( aTools );
+    cut.SetNonDestructive( Standard_True );
+    cut.SetRunParallel( Standard_True );
+    cut.Build();
+
+    return cut.Shape();
+}
+
+
+TopoDS_Shape STEP_PCB_MODEL::cutHoles( const TopoDS_Shape& aBoard )
+{
+    if( m_cutouts.size() < TILED_CUT_MIN_HOLES )
+    {
+        TopTools_ListOfShape holelist;
+
+        for( TopoDS_Shape& hole : m_cutouts )
+            holelist.Append( hole );
+
+        return cutShapes( aBoard, holelist );
+    }
+
+    // A single boolean operation with thousands of tools spends most of its time intersecting
+    // every hole with every face of the board.  Split the board in a grid of tiles holding a
+    // few hundred holes each, cut them in parallel and glue the tiles back together.
+    std::vector<Bnd_Box> holeBoxes( m_cutouts.size() );
+
+    for( size_t ii = 0; ii < m_cutouts.size(); ++ii )
+        BRepBndLib::Add( m_cutouts[ii], holeBoxes[ii] );
+
+    Bnd_Box boardBox;
+    BRepBndLib::Add( aBoard, boardBox );
+
+    double xmin, ymin, zmin, xmax, ymax, zmax;
+    boardBox.Get( xmin, ymin, zmin, xmax, ymax, zmax );
+
+    // Make the tiles a bit thicker than the board, so that their faces are not coplanar
+    // with the board faces
+    zmin -= m_thickness;
+    zmax += m_thickness;
+
+    int    tilesPerSide = (int) std::ceil( std::sqrt( (double) m_cutouts.size()
+                                                      / TILED_CUT_HOLES_PER_TILE ) );
+    double tileWidth = ( xmax - xmin ) / tilesPerSide;
+    double tileHeight = ( ymax - ymin ) / tilesPerSide;
+
+    auto cutTile =
+            [&]( double x0, double y0, double x1, double y1 ) -> TopoDS_Shape
+            {
+                TopoDS_Shape tileBox = BRepPrimAPI_MakeBox( gp_Pnt( x0, y0, zmin ),
+                                                            gp_Pnt( x1, y1, zmax ) );
+
+                BRepAlgoAPI_Common common;
+                TopTools_ListOfShape arguments;
+                TopTools_ListOfShape tools;
+
+                arguments.Append( aBoard );
+                tools.Append( tileBox );
+
+                common.SetArguments( arguments );
+                common.SetTools( tools );
+                common.SetNonDestructive( Standard_True );
+                common.Build();
+
+                TopoDS_Shape tile = common.Shape();
+
+                if( !TopExp_Explorer( tile, TopAbs_SOLID ).More() )
+                    return TopoDS_Shape();
+
+                Bnd_Box tileBounds;
+                tileBounds.Update( x0, y0, zmin, x1, y1, zmax );
+
+                TopTools_ListOfShape holelist;
+
+                for( size_t ii = 0; ii < m_cutouts.size(); ++ii )
+                {
+                    if( !holeBoxes[ii].IsOut( tileBounds ) )
+                        holelist.Append( m_cutouts[ii] );
+                }
+
+                if( holelist.IsEmpty() )
+                    return tile;
+
+                return cutShapes( tile, holelist );
+            };
+
+    thread_pool&                           tp = GetKiCadThreadPool();
+    std::vector<std::future<TopoDS_Shape>> tiles;
+    std::atomic<bool>                      tileFailed( false );
+
+    for( int row = 0; row < tilesPerSide; ++row )
+    {
+        for( int col = 0; col < tilesPerSide; ++col )
+        {
+            double x0 = xmin + col * tileWidth;
+            double y0 = ymin + row * tileHeight;
+            double x1 = col == tilesPerSide - 1 ? xmax : x0 + tileWidth;
+            double y1 = row == tilesPerSide - 1 ? ymax : y0 + tileHeight;
+
+            tiles.push_back( tp.submit(
+                    [&, x0, y0, x1, y1]() -> TopoDS_Shape
+                    {
+                        try
+                        {
+                            return cutTile( x0, y0, x1, y1 );
+                        }
+                        catch( const Standard_Failure& )
+                        {
+                            tileFailed = true;
+                            return TopoDS_Shape();
+                        }
+                    } ) );
+        }
+    }
+
+    // The tasks use the locals of this function: all of them must be finished before leaving
+    // it, even through an exception
+    for( std::future<TopoDS_Shape>& tile : tiles )
+        tile.wait();
+
+    if( tileFailed )
+    {
+        ReportMessage( wxT( "Failed to cut the holes by tiles, cutting the whole board.\n" ) );
+
+        TopTools_ListOfShape holelist;
+
+        for( TopoDS_Shape& hole : m_cutouts )
+            holelist.Append( hole );
+
+        return cutShapes( aBoard, holelist );
+    }
+
+    TopTools_ListOfShape arguments;
+    TopTools_ListOfShape tools;
+
+    for( std::future<TopoDS_Shape>& tile : tiles )
+    {
+        TopoDS_Shape shape = tile.get();
+
+        if( shape.IsNull() )
+            continue;
+
+        if( arguments.IsEmpty() )
+            arguments.Append( shape );
+        else
+            tools.Append( shape );
+    }
+
+    if( tools.IsEmpty() )
+        return arguments.IsEmpty() ? aBoard : arguments.First();
+
+    // The tiles only touch each other on their common faces
+    BRepAlgoAPI_Fuse fuse;
+    fuse.SetArguments( arguments );
+    fuse.SetTools( tools );
+    fuse.SetGlue( BOPAlgo_GlueShift );
+    fuse.SetRunParallel( Standard_True );
+    fuse.Build();
+
+    // Remove the seams left between the tiles
+    ShapeUpgrade_UnifySameDomain unify( fuse.Shape(), Standard_True, Standard_True,
+                                        Standard_False );
+    unify.Build();
+
+    return unify.Shape();
+}
+
+
 #ifdef SUPPORTS_IGES
 // write the assembly model in IGES format
 bool STEP_PCB_MODEL::WriteIGES( const wxString& aFileName )
@@ -707,10 +889,17 @@ bool STEP_PCB_MODEL::getModelLabel( const std::string& aFileNameUTF8, VECTOR3D a
 
     aLabel.Nullify();
 
+    wxString fileName( wxString::FromUTF8( aFileNameUTF8.c_str() ) );
+
+    // The same file can be placed with several scale factors: only read it once
+    MODEL_DOC_MAP::iterator md = m_modelDocs.find( aFileNameUTF8 );
+
+    if( md != m_modelDocs.end() )
+        return addModelLabel( md->second, fileName, model_key, aScale, aLabel );
+
     Handle( TDocStd_Document )  doc;
     m_app->NewDocument( "MDTV-XCAF", doc );
 
-    wxString fileName( wxString::FromUTF8( aFileNameUTF8.c_str() ) );
     FormatType modelFmt = fileType( aFileNameUTF8.c_str() );
 
     switch( modelFmt )
@@ -891,23 +1080,33 @@ bool STEP_PCB_MODEL::getModelLabel( const std::string& aFileNameUTF8, VECTOR3D a
         return false;
     }
 
-    aLabel = transferModel( doc, m_doc, aScale );
+    m_modelDocs.emplace( aFileNameUTF8, doc );
+
+    return addModelLabel( doc, fileName, model_key, aScale, aLabel );
+}
+
+
+bool STEP_PCB_MODEL::addModelLabel( Handle( TDocStd_Document )& aDoc, const wxString& aFileName,
+                                    const std::string& aModelKey, VECTOR3D aScale,
+                                    TDF_Label& aLabel )
+{
+    aLabel = transferModel( aDoc, m_doc, aScale );
 
     if( aLabel.IsNull() )
     {
         ReportMessage( wxString::Format( wxT( "Could not transfer model data from file '%s'.\n" ),
-                                         fileName  ) );
+                                         aFileName ) );
         return false;
     }
 
     // attach the PART NAME ( base filename: note that in principle
     // different models may have the same base filename )
-    wxFileName afile( fileName );
+    wxFileName afile( aFileName );
     std::string pname( afile.GetName().ToUTF8() );
     TCollection_ExtendedString partname( pname.c_str() );
     TDataStd_Name::Set( aLabel, partname );
 
-    m_models.insert( MODEL_DATUM( model_key, aLabel ) );
+    m_models.insert( MODEL_DATUM( aModelKey, aLabel ) );
     ++m_components;
     return true;
 }
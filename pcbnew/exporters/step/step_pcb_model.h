@@ -50,6 +50,7 @@ class PAD;
 
 typedef std::pair< std::string, TDF_Label > MODEL_DATUM;
 typedef std::map< std::string, TDF_Label > MODEL_MAP;
+typedef std::map< std::string, Handle( TDocStd_Document ) > MODEL_DOC_MAP;
 
 extern void ReportMessage( const wxString& aMessage );
 
@@ -107,6 +108,17 @@ private:
      */
     bool createOneBoard( int aIdx, SHAPE_POLY_SET& aOutline, VECTOR2D aOrigin );
 
+    /**
+     * Subtract the cutouts and holes from a board body.
+     *
+     * Large boards are split in tiles.  The holes of each tile are cut on the thread pool, and
+     * the tiles are fused back to a single solid.
+     *
+     * @param aBoard is the board body.
+     * @return the board body with all its holes.
+     */
+    TopoDS_Shape cutHoles( const TopoDS_Shape& aBoard );
+
     /**
      * Load a 3D model data.
      *
@@ -122,6 +134,13 @@ private:
     bool getModelLabel( const std::string& aFileNameUTF8, VECTOR3D aScale, TDF_Label& aLabel,
                         bool aSubstituteModels, wxString* aErrorMessage = nullptr );
 
+    /**
+     * Transfer the model read from \a aFileName in \a aDoc to the assembly, and cache its label
+     * under \a aModelKey.
+     */
+    bool addModelLabel( Handle( TDocStd_Document )& aDoc, const wxString& aFileName,
+                        const std::string& aModelKey, VECTOR3D aScale, TDF_Label& aLabel );
+
     bool getModelLocation( bool aBottom, VECTOR2D aPosition, double aRotation, VECTOR3D aOffset,
                            VECTOR3D aOrientation, TopLoc_Location& aLocation );
 
@@ -138,6 +157,7 @@ private:
     bool                            m_hasPCB;       // set true if CreatePCB() has been invoked
     std::vector<TDF_Label>          m_pcb_labels;   // labels for the PCB model (one by main outline)
     MODEL_MAP                       m_models;       // map of file names to model labels
+    MODEL_DOC_MAP                   m_modelDocs;    // map of file names to read model documents
     int                             m_components;   // number of successfully loaded components;
     double                          m_precision;    // model (length unit) numeric precision
     double                          m_angleprec;    // angle numeric precision
@@ -22,6 +22,7 @@
 
 #include <footprint_info_impl.h>
 
+#include <core/kicad_algo.h>
 #include <dialogs/html_message_box.h>
 #include <footprint.h>
 #include <footprint_info.h>
@@ -34,9 +35,9 @@
 #include <thread_pool.h>
 #include <wildcards_and_files_ext.h>
 
-#include <wx/textfile.h>
-#include <wx/txtstrm.h>
-#include <wx/wfstream.h>
+#include <set>
+
+#include <wx/ffile.h>
 
 
 void FOOTPRINT_INFO_IMPL::load()
@@ -115,32 +116,71 @@ bool FOOTPRINT_LIST_IMPL::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxStri
     KIID_NIL_SET_RESET reset_kiid;
 
     m_progress_reporter = aProgressReporter;
-
-    if( m_progress_reporter )
-    {
-        m_progress_reporter->SetMaxProgress( m_queue_in.size() );
-        m_progress_reporter->Report( _( "Fetching footprint libraries..." ) );
-    }
-
     m_cancelled = false;
     m_lib_table = aTable;
 
     // Clear data before reading files
     m_errors.clear();
-    m_list.clear();
     m_queue_in.clear();
     m_queue_out.clear();
+    m_queue_done.clear();
+
+    std::vector<wxString> nicknames;
 
     if( aNickname )
-    {
-        m_queue_in.push( *aNickname );
-    }
+        nicknames.push_back( *aNickname );
     else
+        nicknames = aTable->GetLogicalLibs();
+
+    // Libraries whose timestamp hasn't changed since they were last enumerated (possibly in a
+    // previous session, via the cache file) are kept as-is; only the others are re-read.
+    std::map<wxString, long long> libTimestamps;
+    std::set<wxString>            staleLibs;
+
+    for( const wxString& nickname : nicknames )
     {
-        for( const wxString& nickname : aTable->GetLogicalLibs() )
+        long long libTimestamp = 0;
+
+        if( !CatchErrors( [&]()
+                          {
+                              libTimestamp = aTable->GenerateTimestamp( &nickname );
+                          } ) )
+        {
+            return false;
+        }
+
+        libTimestamps[ nickname ] = libTimestamp;
+
+        auto it = m_lib_timestamps.find( nickname );
+
+        if( it == m_lib_timestamps.end() || it->second != libTimestamp )
+        {
+            staleLibs.insert( nickname );
             m_queue_in.push( nickname );
+        }
     }
 
+    alg::delete_if( m_list,
+                    [&]( const std::unique_ptr<FOOTPRINT_INFO>& aFpInfo )
+                    {
+                        const wxString& nickname = aFpInfo->GetLibNickname();
+
+                        return !libTimestamps.count( nickname ) || staleLibs.count( nickname );
+                    } );
+
+    for( auto it = m_lib_timestamps.begin(); it != m_lib_timestamps.end(); )
+    {
+        if( !libTimestamps.count( it->first ) || staleLibs.count( it->first ) )
+            it = m_lib_timestamps.erase( it );
+        else
+            ++it;
+    }
+
+    if( m_progress_reporter )
+    {
+        m_progress_reporter->SetMaxProgress( m_queue_in.size() );
+        m_progress_reporter->Report( _( "Fetching footprint libraries..." ) );
+    }
 
     loadLibs();
 
@@ -159,6 +199,13 @@ bool FOOTPRINT_LIST_IMPL::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxStri
             m_progress_reporter->AdvancePhase();
     }
 
+    // Only libraries which were fully enumerated are considered up to date; anything else will
+    // be picked up again on the next call.
+    wxString nickname;
+
+    while( m_queue_done.pop( nickname ) )
+        m_lib_timestamps[ nickname ] = libTimestamps[ nickname ];
+
     if( m_cancelled )
         m_list_timestamp = 0;       // God knows what we got before we were canceled
     else
@@ -241,7 +288,7 @@ void FOOTPRINT_LIST_IMPL::loadFootprints()
 
                 wxArrayString fpnames;
 
-                CatchErrors(
+                bool enumerated = CatchErrors(
                         [&]()
                         {
                             m_lib_table->FootprintEnumerate( fpnames, nickname, false );
@@ -249,7 +296,7 @@ void FOOTPRINT_LIST_IMPL::loadFootprints()
 
                 for( wxString fpname : fpnames )
                 {
-                    CatchErrors(
+                    enumerated &= CatchErrors(
                             [&]()
                             {
                                 auto* fpinfo = new FOOTPRINT_INFO_IMPL( this, nickname, fpname );
@@ -260,6 +307,10 @@ void FOOTPRINT_LIST_IMPL::loadFootprints()
                         return 0;
                 }
 
+                // A library which failed to load isn't up to date: it is read again next time
+                if( enumerated )
+                    m_queue_done.push( nickname );
+
                 if( m_progress_reporter )
                     m_progress_reporter->AdvanceProgress();
 
@@ -304,34 +355,135 @@ FOOTPRINT_LIST_IMPL::FOOTPRINT_LIST_IMPL() :
 }
 
 
-void FOOTPRINT_LIST_IMPL::WriteCacheToFile( const wxString& aFilePath )
+// The cache file is a flat little-endian image: a header, followed by one section per library
+// carrying the library's own timestamp and its footprint entries.  It is read back with a single
+// read into memory and decoded in place, which is considerably faster than the line-oriented
+// text format it replaces.
+static const char    FP_CACHE_MAGIC[8] = { 'K', 'I', 'F', 'P', 'I', 'N', 'F', 'O' };
+static const int32_t FP_CACHE_VERSION = 1;
+
+
+static void writeCacheInt( std::vector<char>& aBuf, int64_t aValue, size_t aSize )
+{
+    for( size_t ii = 0; ii < aSize; ++ii )
+        aBuf.push_back( static_cast<char>( ( aValue >> ( 8 * ii ) ) & 0xFF ) );
+}
+
+
+static void writeCacheString( std::vector<char>& aBuf, const wxString& aValue )
 {
-    wxFileName          tmpFileName = wxFileName::CreateTempFileName( aFilePath );
-    wxFFileOutputStream outStream( tmpFileName.GetFullPath() );
-    wxTextOutputStream  txtStream( outStream );
+    wxScopedCharBuffer utf8 = aValue.utf8_str();
 
-    if( !outStream.IsOk() )
+    writeCacheInt( aBuf, utf8.length(), sizeof( uint32_t ) );
+    aBuf.insert( aBuf.end(), utf8.data(), utf8.data() + utf8.length() );
+}
+
+
+/**
+ * Bounds-checked cursor over a cache file image.  Any attempt to read past the end throws,
+ * which invalidates the whole cache.
+ */
+class FP_CACHE_READER
+{
+public:
+    FP_CACHE_READER( const std::vector<char>& aBuf ) :
+            m_buf( aBuf ),
+            m_pos( 0 )
+    {}
+
+    int64_t ReadInt( size_t aSize )
     {
-        return;
+        require( aSize );
+
+        uint64_t value = 0;
+
+        for( size_t ii = 0; ii < aSize; ++ii )
+            value |= static_cast<uint64_t>( static_cast<uint8_t>( m_buf[m_pos++] ) ) << ( 8 * ii );
+
+        // Sign-extend narrower values
+        if( aSize < sizeof( uint64_t ) && ( value & ( 1ULL << ( 8 * aSize - 1 ) ) ) )
+            value |= ~0ULL << ( 8 * aSize );
+
+        return static_cast<int64_t>( value );
+    }
+
+    void Skip( size_t aSize )
+    {
+        require( aSize );
+        m_pos += aSize;
+    }
+
+    wxString ReadString()
+    {
+        size_t len = static_cast<uint32_t>( ReadInt( sizeof( uint32_t ) ) );
+
+        require( len );
+
+        wxString str = wxString::FromUTF8( m_buf.data() + m_pos, len );
+        m_pos += len;
+        return str;
+    }
+
+    bool AtEnd() const { return m_pos == m_buf.size(); }
+
+private:
+    void require( size_t aSize )
+    {
+        if( aSize > m_buf.size() - m_pos )
+            throw std::out_of_range( "truncated footprint info cache" );
     }
 
-    txtStream << wxString::Format( wxT( "%lld" ), m_list_timestamp ) << endl;
+    const std::vector<char>& m_buf;
+    size_t                   m_pos;
+};
+
+
+void FOOTPRINT_LIST_IMPL::WriteCacheToFile( const wxString& aFilePath )
+{
+    std::map<wxString, std::vector<FOOTPRINT_INFO*>> libs;
 
     for( std::unique_ptr<FOOTPRINT_INFO>& fpinfo : m_list )
     {
-        txtStream << fpinfo->GetLibNickname() << endl;
-        txtStream << fpinfo->GetName() << endl;
-        txtStream << EscapeString( fpinfo->GetDescription(), CTX_LINE ) << endl;
-        txtStream << EscapeString( fpinfo->GetKeywords(), CTX_LINE ) << endl;
-        txtStream << wxString::Format( wxT( "%d" ), fpinfo->GetOrderNum() ) << endl;
-        txtStream << wxString::Format( wxT( "%u" ), fpinfo->GetPadCount() ) << endl;
-        txtStream << wxString::Format( wxT( "%u" ), fpinfo->GetUniquePadCount() ) << endl;
+        // Entries from partially-read libraries have no timestamp; leave them out so the
+        // library gets enumerated again next time.
+        if( m_lib_timestamps.count( fpinfo->GetLibNickname() ) )
+            libs[ fpinfo->GetLibNickname() ].push_back( fpinfo.get() );
     }
 
-    txtStream.Flush();
-    outStream.Close();
+    std::vector<char> buf;
+
+    buf.insert( buf.end(), FP_CACHE_MAGIC, FP_CACHE_MAGIC + sizeof( FP_CACHE_MAGIC ) );
+    writeCacheInt( buf, FP_CACHE_VERSION, sizeof( int32_t ) );
+    writeCacheInt( buf, m_list_timestamp, sizeof( int64_t ) );
+    writeCacheInt( buf, libs.size(), sizeof( uint32_t ) );
+
+    for( const auto& [ nickname, fpinfos ] : libs )
+    {
+        writeCacheString( buf, nickname );
+        writeCacheInt( buf, m_lib_timestamps.at( nickname ), sizeof( int64_t ) );
+        writeCacheInt( buf, fpinfos.size(), sizeof( uint32_t ) );
+
+        for( FOOTPRINT_INFO* fpinfo : fpinfos )
+        {
+            writeCacheString( buf, fpinfo->GetName() );
+            writeCacheString( buf, fpinfo->GetDescription() );
+            writeCacheString( buf, fpinfo->GetKeywords() );
+            writeCacheInt( buf, fpinfo->GetOrderNum(), sizeof( int32_t ) );
+            writeCacheInt( buf, fpinfo->GetPadCount(), sizeof( uint32_t ) );
+            writeCacheInt( buf, fpinfo->GetUniquePadCount(), sizeof( uint32_t ) );
+        }
+    }
+
+    wxFileName tmpFileName = wxFileName::CreateTempFileName( aFilePath );
+    wxFFile    outFile( tmpFileName.GetFullPath(), wxT( "wb" ) );
+
+    if( !outFile.IsOpened() )
+        return;
+
+    bool ok = outFile.Write( buf.data(), buf.size() ) == buf.size();
+    ok &= outFile.Close();
 
-    if( !wxRenameFile( tmpFileName.GetFullPath(), aFilePath, true ) )
+    if( !ok || !wxRenameFile( tmpFileName.GetFullPath(), aFilePath, true ) )
     {
         // cleanup in case rename failed
         // its also not the end of the world since this is just a cache file
@@ -342,45 +494,88 @@ void FOOTPRINT_LIST_IMPL::WriteCacheToFile( const wxString& aFilePath )
 
 void FOOTPRINT_LIST_IMPL::ReadCacheFromFile( const wxString& aFilePath )
 {
-    wxTextFile cacheFile( aFilePath );
-
     m_list_timestamp = 0;
+    m_lib_timestamps.clear();
     m_list.clear();
 
+    if( !wxFileExists( aFilePath ) )
+        return;
+
+    wxFFile           cacheFile( aFilePath, wxT( "rb" ) );
+    std::vector<char> buf;
+
+    if( !cacheFile.IsOpened() )
+        return;
+
+    buf.resize( cacheFile.Length() );
+
+    if( cacheFile.Read( buf.data(), buf.size() ) != buf.size() )
+        return;
+
+    cacheFile.Close();
+
+    // A cache written in the old text format (or by a different version) simply fails this
+    // check and gets rebuilt.
+    if( buf.size() < sizeof( FP_CACHE_MAGIC )
+            || !std::equal( FP_CACHE_MAGIC, FP_CACHE_MAGIC + sizeof( FP_CACHE_MAGIC ), buf.begin() ) )
+    {
+        return;
+    }
+
+    FP_CACHE_READER reader( buf );
+
     try
     {
-        if( cacheFile.Exists() && cacheFile.Open() )
+        reader.Skip( sizeof( FP_CACHE_MAGIC ) );
+
+        if( reader.ReadInt( sizeof( int32_t ) ) != FP_CACHE_VERSION )
+            return;
+
+        long long listTimestamp = reader.ReadInt( sizeof( int64_t ) );
+        size_t    libCount = static_cast<uint32_t>( reader.ReadInt( sizeof( uint32_t ) ) );
+
+        for( size_t ii = 0; ii < libCount; ++ii )
         {
-            cacheFile.GetFirstLine().ToLongLong( &m_list_timestamp );
+            wxString  libNickname = reader.ReadString();
+            long long libTimestamp = reader.ReadInt( sizeof( int64_t ) );
+            size_t    fpCount = static_cast<uint32_t>( reader.ReadInt( sizeof( uint32_t ) ) );
 
-            while( cacheFile.GetCurrentLine() + 6 < cacheFile.GetLineCount() )
+            for( size_t jj = 0; jj < fpCount; ++jj )
             {
-                wxString             libNickname    = cacheFile.GetNextLine();
-                wxString             name           = cacheFile.GetNextLine();
-                wxString             desc           = UnescapeString( cacheFile.GetNextLine() );
-                wxString             keywords       = UnescapeString( cacheFile.GetNextLine() );
-                int                  orderNum       = wxAtoi( cacheFile.GetNextLine() );
-                unsigned int         padCount       = (unsigned) wxAtoi( cacheFile.GetNextLine() );
-                unsigned int         uniquePadCount = (unsigned) wxAtoi( cacheFile.GetNextLine() );
+                wxString     name           = reader.ReadString();
+                wxString     desc           = reader.ReadString();
+                wxString     keywords       = reader.ReadString();
+                int          orderNum       = (int) reader.ReadInt( sizeof( int32_t ) );
+                unsigned int padCount       = (unsigned) reader.ReadInt( sizeof( uint32_t ) );
+                unsigned int uniquePadCount = (unsigned) reader.ReadInt( sizeof( uint32_t ) );
 
                 FOOTPRINT_INFO_IMPL* fpinfo = new FOOTPRINT_INFO_IMPL( libNickname, name, desc,
                                                                        keywords, orderNum,
-                                                                       padCount,  uniquePadCount );
+                                                                       padCount, uniquePadCount );
 
                 m_list.emplace_back( std::unique_ptr<FOOTPRINT_INFO>( fpinfo ) );
             }
+
+            m_lib_timestamps[ libNickname ] = libTimestamp;
         }
+
+        if( !reader.AtEnd() )
+            throw std::out_of_range( "trailing data in footprint info cache" );
+
+        m_list_timestamp = listTimestamp;
     }
     catch( ... )
     {
         // whatever went wrong, invalidate the cache
         m_list_timestamp = 0;
+        m_lib_timestamps.clear();
+        m_list.clear();
     }
 
     // Sanity check: an empty list is very unlikely to be correct.
     if( m_list.size() == 0 )
+    {
         m_list_timestamp = 0;
-
-    if( cacheFile.IsOpened() )
-        cacheFile.Close();
+        m_lib_timestamps.clear();
+    }
 }
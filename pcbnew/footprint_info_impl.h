@@ -22,6 +22,7 @@
 
 #include <atomic>
 #include <functional>
+#include <map>
 #include <memory>
 #include <thread>
 #include <vector>
@@ -87,6 +88,13 @@ public:
     FOOTPRINT_LIST_IMPL();
     virtual ~FOOTPRINT_LIST_IMPL() {};
 
+    /**
+     * Write the footprint list to a binary cache file.
+     *
+     * The cache is split into one section per library, each tagged with the timestamp of the
+     * library it was enumerated from, so that a later ReadFootprintFiles() only needs to
+     * re-enumerate the libraries which have actually changed.
+     */
     void WriteCacheToFile( const wxString& aFilePath ) override;
     void ReadCacheFromFile( const wxString& aFilePath ) override;
 
@@ -107,10 +115,15 @@ private:
 
     SYNC_QUEUE<wxString>     m_queue_in;
     SYNC_QUEUE<wxString>     m_queue_out;
+    SYNC_QUEUE<wxString>     m_queue_done;
     long long                m_list_timestamp;
+
     PROGRESS_REPORTER*       m_progress_reporter;
     std::atomic_bool         m_cancelled;
     std::mutex               m_join;
+
+    /// Timestamp of each library at the time its entries in m_list were enumerated.
+    std::map<wxString, long long> m_lib_timestamps;
 };
 
 extern FOOTPRINT_LIST_IMPL GFootprintList;        // KIFACE scope.
@@ -50,6 +50,9 @@
 #include <pcb_painter.h>
 #include <wx/log.h>
 
+#include <cstring>
+#include <limits>
+#include <map>
 #include <memory>
 #include <macros.h>
 #include "kiface_base.h"
@@ -350,6 +353,15 @@ const std::shared_ptr<SHAPE_POLY_SET>& PAD::GetEffectivePolygon() const
     if( m_polyDirty )
         BuildEffectivePolygon();
 
+    // The board polygon is only made from the shared pad-local one when it is asked for
+    std::lock_guard<std::mutex> RAII_lock( m_polyBuildingLock );
+
+    if( !m_effectivePolygon )
+    {
+        m_effectivePolygon = std::make_shared<SHAPE_POLY_SET>( *m_localPolygon );
+        m_effectivePolygon->Move( m_localPolygonOffset );
+    }
+
     return m_effectivePolygon;
 }
 
@@ -593,23 +605,29 @@ void PAD::BuildEffectivePolygon() const
     const BOARD* board = GetBoard();
     int          maxError = board ? board->GetDesignSettings().m_MaxError : ARC_HIGH_DEF;
 
-    // Polygon
-    m_effectivePolygon = std::make_shared<SHAPE_POLY_SET>();
-    TransformShapeToPolygon( *m_effectivePolygon, UNDEFINED_LAYER, 0, maxError, ERROR_INSIDE );
+    // Polygon: the one shared by the pads having the same geometry and orientation, built at
+    // the origin.  The shape builders add the position last, so moving it to the pad gives the
+    // same vertices as building it there.  Custom shapes are relative to the pad position, the
+    // others to the shape position.
+    m_localPolygon = getLocalPolygon( maxError );
+    m_localPolygonOffset = GetShape() == PAD_SHAPE::CUSTOM ? m_pos : ShapePos();
+    m_effectivePolygon.reset();
 
     // Bounding radius
     //
     // PADSTACKS TODO: these will both need to cycle through all layers to get the largest
     // values....
+    VECTOR2I localPos = m_pos - m_localPolygonOffset;
+
     m_effectiveBoundingRadius = 0;
 
-    for( int cnt = 0; cnt < m_effectivePolygon->OutlineCount(); ++cnt )
+    for( int cnt = 0; cnt < m_localPolygon->OutlineCount(); ++cnt )
     {
-        const SHAPE_LINE_CHAIN& poly = m_effectivePolygon->COutline( cnt );
+        const SHAPE_LINE_CHAIN& poly = m_localPolygon->COutline( cnt );
 
         for( int ii = 0; ii < poly.PointCount(); ++ii )
         {
-            int dist = KiROUND( ( poly.CPoint( ii ) - m_pos ).EuclideanNorm() );
+            int dist = KiROUND( ( poly.CPoint( ii ) - localPos ).EuclideanNorm() );
             m_effectiveBoundingRadius = std::max( m_effectiveBoundingRadius, dist );
         }
     }
@@ -619,6 +637,139 @@ void PAD::BuildEffectivePolygon() const
 }
 
 
+/**
+ * The pad-local polygons, by everything they depend on.  They are held by the pads, so there is
+ * only one of them per distinct pad definition, however many footprints use it.
+ */
+static std::mutex s_localPolygonsLock;
+static size_t     s_localPolygonsPruneSize = 1024;
+
+static std::map<std::vector<int64_t>, std::weak_ptr<const SHAPE_POLY_SET>> s_localPolygons;
+
+
+static void appendKey( std::vector<int64_t>& aKey, const VECTOR2I& aPt )
+{
+    aKey.push_back( aPt.x );
+    aKey.push_back( aPt.y );
+}
+
+
+static void appendKey( std::vector<int64_t>& aKey, double aValue )
+{
+    int64_t bits;
+
+    static_assert( sizeof( bits ) == sizeof( aValue ) );
+    std::memcpy( &bits, &aValue, sizeof( bits ) );
+    aKey.push_back( bits );
+}
+
+
+std::shared_ptr<const SHAPE_POLY_SET> PAD::getLocalPolygon( int aMaxError ) const
+{
+    std::vector<int64_t> key = { static_cast<int64_t>( GetShape() ), aMaxError };
+
+    appendKey( key, m_size );
+    appendKey( key, m_orient.AsDegrees() );
+
+    switch( GetShape() )
+    {
+    case PAD_SHAPE::TRAPEZOID:
+        appendKey( key, m_deltaSize );
+        break;
+
+    case PAD_SHAPE::CHAMFERED_RECT:
+        appendKey( key, GetChamferRectRatio() );
+        key.push_back( GetChamferPositions() );
+        KI_FALLTHROUGH;
+
+    case PAD_SHAPE::ROUNDRECT:
+        key.push_back( GetRoundRectCornerRadius() );
+        break;
+
+    case PAD_SHAPE::CUSTOM:
+        key.push_back( static_cast<int64_t>( GetAnchorPadShape() ) );
+
+        for( const std::shared_ptr<PCB_SHAPE>& primitive : m_editPrimitives )
+        {
+            key.push_back( static_cast<int64_t>( primitive->GetShape() ) );
+            key.push_back( primitive->GetWidth() );
+            key.push_back( primitive->IsFilled() );
+            key.push_back( primitive->IsAnnotationProxy() );
+            appendKey( key, primitive->GetStart() );
+            appendKey( key, primitive->GetEnd() );
+
+            if( primitive->GetShape() == SHAPE_T::ARC )
+            {
+                appendKey( key, primitive->GetCenter() );
+            }
+            else if( primitive->GetShape() == SHAPE_T::BEZIER )
+            {
+                appendKey( key, primitive->GetBezierC1() );
+                appendKey( key, primitive->GetBezierC2() );
+            }
+            else if( primitive->GetShape() == SHAPE_T::POLY )
+            {
+                const SHAPE_POLY_SET& poly = primitive->GetPolyShape();
+
+                for( auto it = poly.CIterateWithHoles(); it; it++ )
+                {
+                    if( it.IsEndContour() )
+                        key.push_back( std::numeric_limits<int64_t>::min() );
+
+                    appendKey( key, *it );
+                }
+            }
+        }
+
+        break;
+
+    default:
+        break;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( s_localPolygonsLock );
+        auto                        it = s_localPolygons.find( key );
+
+        if( it != s_localPolygons.end() )
+        {
+            if( std::shared_ptr<const SHAPE_POLY_SET> polygon = it->second.lock() )
+                return polygon;
+        }
+    }
+
+    // Build it outside of the lock, other threads are probably building other pads
+    auto polygon = std::make_shared<SHAPE_POLY_SET>();
+    transformShapeToPolygon( *polygon, VECTOR2I( 0, 0 ), VECTOR2I( 0, 0 ), 0, aMaxError,
+                             ERROR_INSIDE );
+
+    std::lock_guard<std::mutex> lock( s_localPolygonsLock );
+    std::weak_ptr<const SHAPE_POLY_SET>& entry = s_localPolygons[ key ];
+
+    // Another pad may have built it in the meantime
+    if( std::shared_ptr<const SHAPE_POLY_SET> existing = entry.lock() )
+        return existing;
+
+    entry = polygon;
+
+    // Forget the polygons no pad uses any more once the map has doubled
+    if( s_localPolygons.size() > s_localPolygonsPruneSize )
+    {
+        for( auto it = s_localPolygons.begin(); it != s_localPolygons.end(); )
+        {
+            if( it->second.expired() )
+                it = s_localPolygons.erase( it );
+            else
+                ++it;
+        }
+
+        s_localPolygonsPruneSize = std::max<size_t>( 1024, 2 * s_localPolygons.size() );
+    }
+
+    return polygon;
+}
+
+
 const BOX2I PAD::GetBoundingBox() const
 {
     if( m_shapesDirty )
@@ -1062,7 +1213,8 @@ bool PAD::HitTest( const VECTOR2I& aPosition, int aAccuracy ) const
     if( delta.SquaredEuclideanNorm() > SEG::Square( boundingRadius ) )
         return false;
 
-    return GetEffectivePolygon()->Contains( aPosition, -1, aAccuracy );
+    // The shared pad-local polygon is enough, no need to make the board one
+    return m_localPolygon->Contains( aPosition - m_localPolygonOffset, -1, aAccuracy );
 }
 
 
@@ -1085,14 +1237,18 @@ bool PAD::HitTest( const BOX2I& aRect, bool aContained, int aAccuracy ) const
         if( !arect.Intersects( bbox ) )
             return false;
 
-        const std::shared_ptr<SHAPE_POLY_SET>& poly = GetEffectivePolygon();
+        if( m_polyDirty )
+            BuildEffectivePolygon();
 
-        int count = poly->TotalVertices();
+        // Use the shared pad-local polygon, moved to the pad
+        const SHAPE_POLY_SET& poly = *m_localPolygon;
+
+        int count = poly.TotalVertices();
 
         for( int ii = 0; ii < count; ii++ )
         {
-            VECTOR2I vertex = poly->CVertex( ii );
-            VECTOR2I vertexNext = poly->CVertex( ( ii + 1 ) % count );
+            VECTOR2I vertex = poly.CVertex( ii ) + m_localPolygonOffset;
+            VECTOR2I vertexNext = poly.CVertex( ( ii + 1 ) % count ) + m_localPolygonOffset;
 
             // Test if the point is within aRect
             if( arect.Contains( vertex ) )
@@ -1575,6 +1731,15 @@ void PAD::TransformShapeToPolygon( SHAPE_POLY_SET& aBuffer, PCB_LAYER_ID aLayer,
 {
     wxASSERT_MSG( !ignoreLineWidth, wxT( "IgnoreLineWidth has no meaning for pads." ) );
 
+    // Note: for pad having a shape offset, the pad position is NOT the shape position
+    transformShapeToPolygon( aBuffer, ShapePos(), m_pos, aClearance, aError, aErrorLoc );
+}
+
+
+void PAD::transformShapeToPolygon( SHAPE_POLY_SET& aBuffer, const VECTOR2I& aShapePos,
+                                   const VECTOR2I& aPadPos, int aClearance, int aError,
+                                   ERROR_LOC aErrorLoc ) const
+{
     // minimal segment count to approximate a circle to create the polygonal pad shape
     // This minimal value is mainly for very small pads, like SM0402.
     // Most of time pads are using the segment count given by aError value.
@@ -1582,9 +1747,6 @@ void PAD::TransformShapeToPolygon( SHAPE_POLY_SET& aBuffer, PCB_LAYER_ID aLayer,
     int       dx = m_size.x / 2;
     int       dy = m_size.y / 2;
 
-    VECTOR2I padShapePos = ShapePos();    // Note: for pad having a shape offset, the pad
-                                          //   position is NOT the shape position
-
     switch( GetShape() )
     {
     case PAD_SHAPE::CIRCLE:
@@ -1592,7 +1754,7 @@ void PAD::TransformShapeToPolygon( SHAPE_POLY_SET& aBuffer, PCB_LAYER_ID aLayer,
         // Note: dx == dy is not guaranteed for circle pads in legacy boards
         if( dx == dy || ( GetShape() == PAD_SHAPE::CIRCLE ) )
         {
-            TransformCircleToPolygon( aBuffer, padShapePos, dx + aClearance, aError, aErrorLoc,
+            TransformCircleToPolygon( aBuffer, aShapePos, dx + aClearance, aError, aErrorLoc,
                                       pad_min_seg_per_circle_count );
         }
         else
@@ -1602,7 +1764,7 @@ void PAD::TransformShapeToPolygon( SHAPE_POLY_SET& aBuffer, PCB_LAYER_ID aLayer,
 
             RotatePoint( delta, m_orient );
 
-            TransformOvalToPolygon( aBuffer, padShapePos - delta, padShapePos + delta,
+            TransformOvalToPolygon( aBuffer, aShapePos - delta, aShapePos + delta,
                                     ( half_width + aClearance ) * 2, aError, aErrorLoc,
                                     pad_min_seg_per_circle_count );
         }
@@ -1616,7 +1778,7 @@ void PAD::TransformShapeToPolygon( SHAPE_POLY_SET& aBuffer, PCB_LAYER_ID aLayer,
         int  ddy = GetShape() == PAD_SHAPE::TRAPEZOID ? m_deltaSize.y / 2 : 0;
 
         SHAPE_POLY_SET outline;
-        TransformTrapezoidToPolygon( outline, padShapePos, m_size, m_orient, ddx, ddy, aClearance,
+        TransformTrapezoidToPolygon( outline, aShapePos, m_size, m_orient, ddx, ddy, aClearance,
                                      aError, aErrorLoc );
         aBuffer.Append( outline );
         break;
@@ -1628,7 +1790,7 @@ void PAD::TransformShapeToPolygon( SHAPE_POLY_SET& aBuffer, PCB_LAYER_ID aLayer,
         bool doChamfer = GetShape() == PAD_SHAPE::CHAMFERED_RECT;
 
         SHAPE_POLY_SET outline;
-        TransformRoundChamferedRectToPolygon( outline, padShapePos, m_size, m_orient,
+        TransformRoundChamferedRectToPolygon( outline, aShapePos, m_size, m_orient,
                                               GetRoundRectCornerRadius(),
                                               doChamfer ? GetChamferRectRatio() : 0,
                                               doChamfer ? GetChamferPositions() : 0,
@@ -1642,7 +1804,7 @@ void PAD::TransformShapeToPolygon( SHAPE_POLY_SET& aBuffer, PCB_LAYER_ID aLayer,
         SHAPE_POLY_SET outline;
         MergePrimitivesAsPolygon( &outline, aErrorLoc );
         outline.Rotate( m_orient );
-        outline.Move( VECTOR2I( m_pos ) );
+        outline.Move( aPadPos );
 
         if( aClearance )
         {
@@ -749,6 +749,21 @@ private:
     void addPadPrimitivesToPolygon( SHAPE_POLY_SET* aMergedPolygon, int aError,
                                     ERROR_LOC aErrorLoc ) const;
 
+    /**
+     * Convert the pad shape to a polygon placed at \a aShapePos (\a aPadPos for custom pads).
+     */
+    void transformShapeToPolygon( SHAPE_POLY_SET& aBuffer, const VECTOR2I& aShapePos,
+                                  const VECTOR2I& aPadPos, int aClearance, int aError,
+                                  ERROR_LOC aErrorLoc ) const;
+
+    /**
+     * Return the effective polygon of the pad built at the origin, with the pad orientation.
+     *
+     * The polygon is shared by all the pads having the same geometry and orientation (usually
+     * the pads of the instances of a footprint), so it is built and stored only once for them.
+     */
+    std::shared_ptr<const SHAPE_POLY_SET> getLocalPolygon( int aMaxError ) const;
+
 private:
     wxString      m_number;             // Pad name (pin number in schematic)
     wxString      m_pinFunction;        // Pin name in schematic
@@ -774,7 +789,9 @@ private:
 
     mutable bool                              m_polyDirty;
     mutable std::mutex                        m_polyBuildingLock;
-    mutable std::shared_ptr<SHAPE_POLY_SET>   m_effectivePolygon;
+    mutable std::shared_ptr<const SHAPE_POLY_SET> m_localPolygon;     // Shared, at the origin
+    mutable VECTOR2I                          m_localPolygonOffset;  // Moves it to the pad
+    mutable std::shared_ptr<SHAPE_POLY_SET>   m_effectivePolygon;    // Made on first use
     mutable int                               m_effectiveBoundingRadius;
 
     /*
@@ -207,6 +207,20 @@ public:
 
     void ClearListAndDeleteItems( PICKED_ITEMS_LIST* aList );
 
+    /**
+     * Return an estimate of the memory used by a copy of a board item stored in the undo or
+     * redo list.
+     *
+     * Zone fills are shared between the copies of a zone, so each copy only accounts for its
+     * share of them.
+     */
+    static size_t GetBoardItemMemoryUsage( const EDA_ITEM* aItem );
+
+    size_t GetUndoRedoItemMemoryUsage( const EDA_ITEM* aItem ) const override
+    {
+        return GetBoardItemMemoryUsage( aItem );
+    }
+
     /**
      * Return the absolute path to the design rules file for the currently-loaded board.
      *
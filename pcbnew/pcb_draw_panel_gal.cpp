@@ -258,6 +258,9 @@ void PCB_DRAW_PANEL_GAL::DisplayBoard( BOARD* aBoard, PROGRESS_REPORTER* aReport
     if( m_drawingSheet )
         m_drawingSheet->SetFileName( TO_UTF8( aBoard->GetFileName() ) );
 
+    // Index all the board items at once, packing the R-trees is much faster than filling them
+    m_view->BeginBulkAdd();
+
     // Load drawings
     for( BOARD_ITEM* drawing : aBoard->Drawings() )
         m_view->Add( drawing );
@@ -281,6 +284,8 @@ void PCB_DRAW_PANEL_GAL::DisplayBoard( BOARD* aBoard, PROGRESS_REPORTER* aReport
     // Ratsnest
     m_ratsnest = std::make_unique<RATSNEST_VIEW_ITEM>( aBoard->GetConnectivity() );
     m_view->Add( m_ratsnest.get() );
+
+    m_view->EndBulkAdd();
 }
 
 
@@ -27,6 +27,7 @@
 #include <jobs/job_export_pcb_pos.h>
 #include <jobs/job_export_pcb_svg.h>
 #include <jobs/job_export_pcb_step.h>
+#include <jobs/job_pcb_render.h>
 #include <cli/exit_codes.h>
 #include <plotters/plotter_dxf.h>
 #include <plotters/plotter_gerber.h>
@@ -44,6 +45,13 @@
 #include <gendrill_gerber_writer.h>
 #include <wildcards_and_files_ext.h>
 #include <plugins/kicad/pcb_plugin.h>
+#include <project.h>
+#include <settings/settings_manager.h>
+#include <3d_canvas/board_adapter.h>
+#include <3d_rendering/track_ball.h>
+#include <3d_rendering/raytracing/render_3d_raytrace_ram.h>
+#include "../3d-viewer/3d_viewer/eda_3d_viewer_settings.h"
+#include <wx/image.h>
 
 #include "pcbnew_scripting_helpers.h"
 
@@ -60,6 +68,7 @@ PCBNEW_JOBS_HANDLER::PCBNEW_JOBS_HANDLER()
               std::bind( &PCBNEW_JOBS_HANDLER::JobExportDrill, this, std::placeholders::_1 ) );
     Register( "pos", std::bind( &PCBNEW_JOBS_HANDLER::JobExportPos, this, std::placeholders::_1 ) );
     Register( "fpupgrade", std::bind( &PCBNEW_JOBS_HANDLER::JobExportFpUpgrade, this, std::placeholders::_1 ) );
+    Register( "render", std::bind( &PCBNEW_JOBS_HANDLER::JobRender, this, std::placeholders::_1 ) );
 }
 
 
@@ -523,4 +532,104 @@ int PCBNEW_JOBS_HANDLER::JobExportFpUpgrade( JOB* aJob )
     }
 
     return CLI::EXIT_CODES::OK;
-}
\ No newline at end of file
+}
+
+
+int PCBNEW_JOBS_HANDLER::JobRender( JOB* aJob )
+{
+    JOB_PCB_RENDER* aRenderJob = dynamic_cast<JOB_PCB_RENDER*>( aJob );
+
+    if( aRenderJob == nullptr )
+        return CLI::EXIT_CODES::ERR_UNKNOWN;
+
+    if( aJob->IsCli() )
+        wxPrintf( _( "Loading board\n" ) );
+
+    BOARD* brd = LoadBoard( aRenderJob->m_filename );
+
+    if( !brd )
+        return CLI::EXIT_CODES::ERR_INVALID_INPUT_FILE;
+
+    if( aRenderJob->m_outputFile.IsEmpty() )
+    {
+        wxFileName fn = brd->GetFileName();
+        fn.SetExt( wxS( "png" ) );
+
+        aRenderJob->m_outputFile = fn.GetFullPath();
+    }
+
+    BOARD_ADAPTER boardAdapter;
+
+    boardAdapter.SetBoard( brd );
+    boardAdapter.Set3dCacheManager( brd->GetProject()->Get3DCacheManager() );
+    boardAdapter.m_Cfg = Pgm().GetSettingsManager().GetAppSettings<EDA_3D_VIEWER_SETTINGS>();
+
+    const wxSize size( aRenderJob->m_width, aRenderJob->m_height );
+    TRACK_BALL   camera( 2 * RANGE_SCALE_3D );
+
+    camera.SetCurWindowSize( size );
+
+    // Same orientations as the 3D viewer view presets
+    switch( aRenderJob->m_side )
+    {
+    case JOB_PCB_RENDER::SIDE::TOP:
+        break;
+
+    case JOB_PCB_RENDER::SIDE::BOTTOM:
+        camera.RotateY( glm::radians( 180.0f ) );
+        break;
+
+    case JOB_PCB_RENDER::SIDE::LEFT:
+        camera.RotateZ( glm::radians( 90.0f ) );
+        camera.RotateX( glm::radians( -90.0f ) );
+        break;
+
+    case JOB_PCB_RENDER::SIDE::RIGHT:
+        camera.RotateZ( glm::radians( -90.0f ) );
+        camera.RotateX( glm::radians( -90.0f ) );
+        break;
+
+    case JOB_PCB_RENDER::SIDE::FRONT:
+        camera.RotateX( glm::radians( -90.0f ) );
+        break;
+
+    case JOB_PCB_RENDER::SIDE::BACK:
+        camera.RotateX( glm::radians( -90.0f ) );
+        camera.RotateZ( glm::radians( 180.0f ) );
+        break;
+    }
+
+    RENDER_3D_RAYTRACE_RAM renderer( boardAdapter, camera );
+
+    renderer.SetThreadCount( aRenderJob->m_threads );
+    renderer.SetCurWindowSize( size );
+
+    if( aJob->IsCli() )
+        wxPrintf( _( "Rendering board\n" ) );
+
+    renderer.Redraw( false, nullptr, nullptr );
+
+    if( aJob->IsCli() )
+    {
+        const RENDER_3D_RAYTRACE_RAM::TIMINGS& timings = renderer.GetTimings();
+
+        wxPrintf( _( "Scene build: %.1f ms\n" ), timings.m_reload );
+        wxPrintf( _( "Tracing: %.1f ms\n" ), timings.m_tracing );
+        wxPrintf( _( "Post-process shading: %.1f ms\n" ), timings.m_postProcessShading );
+        wxPrintf( _( "Post-process blur: %.1f ms\n" ), timings.m_postProcessBlurFinish );
+    }
+
+    if( wxImage::FindHandler( wxBITMAP_TYPE_PNG ) == nullptr )
+        wxImage::AddHandler( new wxPNGHandler );
+
+    if( !renderer.GetImage().SaveFile( aRenderJob->m_outputFile, wxBITMAP_TYPE_PNG ) )
+    {
+        wxFprintf( stderr, _( "Unable to write '%s'\n" ), aRenderJob->m_outputFile );
+        return CLI::EXIT_CODES::ERR_UNKNOWN;
+    }
+
+    if( aJob->IsCli() )
+        wxPrintf( _( "Wrote %s\n" ), aRenderJob->m_outputFile );
+
+    return CLI::EXIT_CODES::OK;
+}
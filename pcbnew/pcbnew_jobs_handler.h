@@ -35,6 +35,7 @@ public:
     int JobExportDrill( JOB* aJob );
     int JobExportPos( JOB* aJob );
     int JobExportFpUpgrade( JOB* aJob );
+    int JobRender( JOB* aJob );
 };
 
 #endif
\ No newline at end of file
@@ -2130,7 +2130,8 @@ void ALTIUM_PCB::ParseRegions6Data( const ALTIUM_COMPOUND_FILE&     aAltiumPcbFi
             }
 
             if( zone->HasFilledPolysForLayer( klayer ) )
-                fill.BooleanAdd( *zone->GetFill( klayer ), SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+                fill.BooleanAdd( *zone->GetFilledPolysList( klayer ),
+                                SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
 
             fill.Fracture( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
 
@@ -2073,7 +2073,9 @@ void CADSTAR_PCB_ARCHIVE_LOADER::loadCoppers()
 
             if( pouredZone->HasFilledPolysForLayer( getKiCadLayer( csCopper.LayerID ) ) )
             {
-                fill.BooleanAdd( *pouredZone->GetFill( getKiCadLayer( csCopper.LayerID ) ),
+                PCB_LAYER_ID layer = getKiCadLayer( csCopper.LayerID );
+
+                fill.BooleanAdd( *pouredZone->GetFilledPolysList( layer ),
                                  SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
             }
 
@@ -0,0 +1,122 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pns_hull_cache.h"
+#include "pns_item.h"
+
+namespace PNS {
+
+// The cache is flushed when it grows past this many hulls, so that long routing sessions
+// on large boards don't accumulate hulls of obstacles that are never hit again.
+static const int MAX_CACHED_HULLS = 65536;
+
+
+HULL_CACHE::HULL_CACHE() :
+        m_entryCount( 0 ),
+        m_hits( 0 ),
+        m_misses( 0 )
+{
+}
+
+
+const SHAPE_LINE_CHAIN HULL_CACHE::Hull( const ITEM* aItem, int aClearance,
+                                         int aWalkaroundThickness, int aLayer )
+{
+    return getHull( aItem, aClearance, aWalkaroundThickness, aLayer, false );
+}
+
+
+const SHAPE_LINE_CHAIN HULL_CACHE::HoleHull( const ITEM* aItem, int aClearance,
+                                             int aWalkaroundThickness, int aLayer )
+{
+    return getHull( aItem, aClearance, aWalkaroundThickness, aLayer, true );
+}
+
+
+const SHAPE_LINE_CHAIN HULL_CACHE::getHull( const ITEM* aItem, int aClearance,
+                                            int aWalkaroundThickness, int aLayer, bool aHole )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        auto it = m_entries.find( aItem );
+
+        if( it != m_entries.end() )
+        {
+            for( const ENTRY& entry : it->second )
+            {
+                if( entry.m_clearance == aClearance
+                        && entry.m_walkaroundThickness == aWalkaroundThickness
+                        && entry.m_layer == aLayer
+                        && entry.m_hole == aHole )
+                {
+                    m_hits++;
+                    return entry.m_hull;
+                }
+            }
+        }
+
+        m_misses++;
+    }
+
+    // Build the hull without holding the lock; the concurrent walkarounds would otherwise
+    // serialize on expensive pad hulls.
+    SHAPE_LINE_CHAIN hull = aHole ? aItem->HoleHull( aClearance, aWalkaroundThickness, aLayer )
+                                  : aItem->Hull( aClearance, aWalkaroundThickness, aLayer );
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    if( m_entryCount >= MAX_CACHED_HULLS )
+    {
+        m_entries.clear();
+        m_entryCount = 0;
+    }
+
+    m_entries[aItem].push_back( { aClearance, aWalkaroundThickness, aLayer, aHole, hull } );
+    m_entryCount++;
+
+    return hull;
+}
+
+
+void HULL_CACHE::Invalidate( const ITEM* aItem )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    auto it = m_entries.find( aItem );
+
+    if( it != m_entries.end() )
+    {
+        m_entryCount -= it->second.size();
+        m_entries.erase( it );
+    }
+}
+
+
+void HULL_CACHE::Clear()
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    m_entries.clear();
+    m_entryCount = 0;
+    m_hits = 0;
+    m_misses = 0;
+}
+
+}
@@ -0,0 +1,93 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_HULL_CACHE_H
+#define __PNS_HULL_CACHE_H
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <geometry/shape_line_chain.h>
+
+namespace PNS {
+
+class ITEM;
+
+/**
+ * HULL_CACHE
+ *
+ * Keeps the walkaround hulls already built for the items of a node hierarchy, keyed by the
+ * item, the clearance, the walkaround thickness and the layer. Building a hull for a complex
+ * pad is expensive and the same obstacle is usually hit many times within a single routing
+ * step. The cache is owned by the root node, which invalidates the entries of every item that
+ * is removed or freed. It can be queried from several threads at once.
+ **/
+class HULL_CACHE
+{
+public:
+    HULL_CACHE();
+
+    /**
+     * Return the hull of \a aItem (see ITEM::Hull()), building it only if it isn't cached yet.
+     */
+    const SHAPE_LINE_CHAIN Hull( const ITEM* aItem, int aClearance, int aWalkaroundThickness,
+                                 int aLayer );
+
+    /**
+     * Return the hole hull of \a aItem (see ITEM::HoleHull()), building it only if it isn't
+     * cached yet.
+     */
+    const SHAPE_LINE_CHAIN HoleHull( const ITEM* aItem, int aClearance, int aWalkaroundThickness,
+                                     int aLayer );
+
+    /**
+     * Drop all the hulls cached for \a aItem.
+     */
+    void Invalidate( const ITEM* aItem );
+
+    void Clear();
+
+    size_t Hits() const { return m_hits; }
+    size_t Misses() const { return m_misses; }
+
+private:
+    struct ENTRY
+    {
+        int              m_clearance;
+        int              m_walkaroundThickness;
+        int              m_layer;
+        bool             m_hole;
+        SHAPE_LINE_CHAIN m_hull;
+    };
+
+    const SHAPE_LINE_CHAIN getHull( const ITEM* aItem, int aClearance, int aWalkaroundThickness,
+                                    int aLayer, bool aHole );
+
+    std::mutex                                            m_mutex;
+    std::unordered_map<const ITEM*, std::vector<ENTRY>>   m_entries;
+    int                                                   m_entryCount;
+    std::atomic<size_t>                                   m_hits;
+    std::atomic<size_t>                                   m_misses;
+};
+
+}
+
+#endif    // __PNS_HULL_CACHE_H
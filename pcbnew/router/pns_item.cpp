@@ -29,7 +29,8 @@ typedef VECTOR2I::extended_type ecoord;
 
 namespace PNS {
 
-bool ITEM::collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly, int aOverrideClearance ) const
+bool ITEM::collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly,
+                          int aOverrideClearance, bool* aThisHole, bool* aOtherHole ) const
 {
     const ROUTER_IFACE* iface = ROUTER::GetInstance()->GetInterface();
     const SHAPE*        shapeA = Shape();
@@ -99,15 +100,21 @@ bool ITEM::collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferent
     {
         int holeClearance = aNode->GetHoleClearance( this, aOther );
 
+        // The items are shared by concurrent queries, so which hole collides is returned rather
+        // than marked on them
         if( holeClearance >= 0 && holeA && holeA->Collide( shapeB, holeClearance + lineWidthB ) )
         {
-            Mark( Marker() | MK_HOLE );
+            if( aThisHole )
+                *aThisHole = true;
+
             return true;
         }
 
         if( holeB && holeClearance >= 0 && holeB->Collide( shapeA, holeClearance + lineWidthA ) )
         {
-            aOther->Mark( aOther->Marker() | MK_HOLE );
+            if( aOtherHole )
+                *aOtherHole = true;
+
             return true;
         }
 
@@ -117,8 +124,12 @@ bool ITEM::collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferent
 
             if( holeToHoleClearance >= 0 && holeA->Collide( holeB, holeToHoleClearance ) )
             {
-                Mark( Marker() | MK_HOLE );
-                aOther->Mark( aOther->Marker() | MK_HOLE );
+                if( aThisHole )
+                    *aThisHole = true;
+
+                if( aOtherHole )
+                    *aOtherHole = true;
+
                 return true;
             }
         }
@@ -166,9 +177,10 @@ bool ITEM::collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferent
 }
 
 
-bool ITEM::Collide( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly, int aOverrideClearance ) const
+bool ITEM::Collide( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly,
+                    int aOverrideClearance, bool* aHole ) const
 {
-    if( collideSimple( aOther, aNode, aDifferentNetsOnly, aOverrideClearance ) )
+    if( collideSimple( aOther, aNode, aDifferentNetsOnly, aOverrideClearance, aHole, nullptr ) )
         return true;
 
     // Special cases for "head" lines with vias attached at the end.  Note that this does not
@@ -179,16 +191,24 @@ bool ITEM::Collide( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOn
     {
         const LINE* line = static_cast<const LINE*>( this );
 
-        if( line->EndsWithVia() && line->Via().collideSimple( aOther, aNode, aDifferentNetsOnly, aOverrideClearance ) )
+        if( line->EndsWithVia()
+                && line->Via().collideSimple( aOther, aNode, aDifferentNetsOnly,
+                                              aOverrideClearance, aHole, nullptr ) )
+        {
             return true;
+        }
     }
 
     if( aOther->m_kind == LINE_T )
     {
         const LINE* line = static_cast<const LINE*>( aOther );
 
-        if( line->EndsWithVia() && line->Via().collideSimple( this, aNode, aDifferentNetsOnly, aOverrideClearance ) )
+        if( line->EndsWithVia()
+                && line->Via().collideSimple( this, aNode, aDifferentNetsOnly,
+                                              aOverrideClearance, nullptr, aHole ) )
+        {
             return true;
+        }
     }
 
     return false;
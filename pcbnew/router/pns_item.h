@@ -41,8 +41,7 @@ enum LineMarker {
     MK_HEAD         = ( 1 << 0 ),
     MK_VIOLATION    = ( 1 << 3 ),
     MK_LOCKED       = ( 1 << 4 ),
-    MK_DP_COUPLED   = ( 1 << 5 ),
-    MK_HOLE         = ( 1 << 6 )
+    MK_DP_COUPLED   = ( 1 << 5 )
 };
 
 
@@ -192,9 +191,11 @@ public:
      * Optionally returns a minimum translation vector for force propagation algorithm.
      *
      * @param aOther is the item to check collision against.
+     * @param aHole (optional) is set to true when it is the hole of this item which collides.
      * @return true, if a collision was found.
      */
-    bool Collide( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly = true, int aOverrideClearance = -1 ) const;
+    bool Collide( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly = true,
+                  int aOverrideClearance = -1, bool* aHole = nullptr ) const;
 
     /**
      * Return the geometrical shape of the item. Used for collision detection and spatial indexing.
@@ -248,7 +249,8 @@ public:
     virtual const std::string Format() const;
 
 private:
-    bool collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly, int aOverrideClearance ) const;
+    bool collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly,
+                        int aOverrideClearance, bool* aThisHole, bool* aOtherHole ) const;
 
 protected:
     PnsKind       m_kind;
@@ -52,6 +52,7 @@
 #include <wx/log.h>
 
 #include <memory>
+#include <mutex>
 
 #include <advanced_config.h>
 #include <pcbnew_settings.h>
@@ -155,6 +156,12 @@ private:
     std::unordered_map<CLEARANCE_CACHE_KEY, int> m_clearanceCache;
     std::unordered_map<CLEARANCE_CACHE_KEY, int> m_holeClearanceCache;
     std::unordered_map<CLEARANCE_CACHE_KEY, int> m_holeToHoleClearanceCache;
+
+    ///< The walkaround queries clearances from several threads.  The caches above are only
+    ///< locked for lookups and inserts, so that the rules are evaluated concurrently; the dummy
+    ///< items are locked while they stand in for unparented items.
+    std::mutex m_cacheMutex;
+    std::mutex m_dummyMutex;
 };
 
 
@@ -296,7 +303,12 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
     BOARD_ITEM*    parentB = aItemB ? aItemB->Parent() : nullptr;
     DRC_CONSTRAINT hostConstraint;
 
+    std::unique_lock<std::mutex> dummyLock( m_dummyMutex, std::defer_lock );
+
     // A track being routed may not have a BOARD_ITEM associated yet.
+    if( ( aItemA && !parentA ) || ( aItemB && !parentB ) )
+        dummyLock.lock();
+
     if( aItemA && !parentA )
     {
         switch( aItemA->Kind() )
@@ -370,6 +382,8 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
 
 void PNS_PCBNEW_RULE_RESOLVER::ClearCacheForItem( const PNS::ITEM* aItem )
 {
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
+
     CLEARANCE_CACHE_KEY key = { aItem, nullptr, false };
     m_clearanceCache.erase( key );
 
@@ -380,6 +394,8 @@ void PNS_PCBNEW_RULE_RESOLVER::ClearCacheForItem( const PNS::ITEM* aItem )
 
 void PNS_PCBNEW_RULE_RESOLVER::ClearCaches()
 {
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
+
     m_clearanceCache.clear();
     m_holeClearanceCache.clear();
     m_holeToHoleClearanceCache.clear();
@@ -390,10 +406,14 @@ int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* a
                                          bool aUseClearanceEpsilon )
 {
     CLEARANCE_CACHE_KEY key = { aA, aB, aUseClearanceEpsilon };
-    auto it = m_clearanceCache.find( key );
 
-    if( it != m_clearanceCache.end() )
-        return it->second;
+    {
+        std::lock_guard<std::mutex> lock( m_cacheMutex );
+        auto it = m_clearanceCache.find( key );
+
+        if( it != m_clearanceCache.end() )
+            return it->second;
+    }
 
     PNS::CONSTRAINT constraint;
     int             rv = 0;
@@ -435,6 +455,7 @@ int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* a
     if( aUseClearanceEpsilon )
         rv -= m_clearanceEpsilon;
 
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
     m_clearanceCache[ key ] = rv;
     return rv;
 }
@@ -444,10 +465,14 @@ int PNS_PCBNEW_RULE_RESOLVER::HoleClearance( const PNS::ITEM* aA, const PNS::ITE
                                              bool aUseClearanceEpsilon )
 {
     CLEARANCE_CACHE_KEY key = { aA, aB, aUseClearanceEpsilon };
-    auto it = m_holeClearanceCache.find( key );
 
-    if( it != m_holeClearanceCache.end() )
-        return it->second;
+    {
+        std::lock_guard<std::mutex> lock( m_cacheMutex );
+        auto it = m_holeClearanceCache.find( key );
+
+        if( it != m_holeClearanceCache.end() )
+            return it->second;
+    }
 
     PNS::CONSTRAINT constraint;
     int rv = 0;
@@ -464,6 +489,7 @@ int PNS_PCBNEW_RULE_RESOLVER::HoleClearance( const PNS::ITEM* aA, const PNS::ITE
     if( aUseClearanceEpsilon )
         rv -= m_clearanceEpsilon;
 
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
     m_holeClearanceCache[ key ] = rv;
     return rv;
 }
@@ -473,10 +499,14 @@ int PNS_PCBNEW_RULE_RESOLVER::HoleToHoleClearance( const PNS::ITEM* aA, const PN
                                                    bool aUseClearanceEpsilon )
 {
     CLEARANCE_CACHE_KEY key = { aA, aB, aUseClearanceEpsilon };
-    auto it = m_holeToHoleClearanceCache.find( key );
 
-    if( it != m_holeToHoleClearanceCache.end() )
-        return it->second;
+    {
+        std::lock_guard<std::mutex> lock( m_cacheMutex );
+        auto it = m_holeToHoleClearanceCache.find( key );
+
+        if( it != m_holeToHoleClearanceCache.end() )
+            return it->second;
+    }
 
     PNS::CONSTRAINT constraint;
     int rv = 0;
@@ -493,6 +523,7 @@ int PNS_PCBNEW_RULE_RESOLVER::HoleToHoleClearance( const PNS::ITEM* aA, const PN
     if( aUseClearanceEpsilon )
         rv -= m_clearanceEpsilon;
 
+    std::lock_guard<std::mutex> lock( m_cacheMutex );
     m_holeToHoleClearanceCache[ key ] = rv;
     return rv;
 }
@@ -47,6 +47,7 @@ LINE::LINE( const LINE& aOther )
     m_marker = aOther.m_marker;
     m_rank = aOther.m_rank;
     m_blockingObstacle = aOther.m_blockingObstacle;
+    m_blockingObstacleIsHole = aOther.m_blockingObstacleIsHole;
 
     copyLinks( &aOther );
 }
@@ -71,6 +72,7 @@ LINE& LINE::operator=( const LINE& aOther )
     m_owner = aOther.m_owner;
     m_snapThreshhold = aOther.m_snapThreshhold;
     m_blockingObstacle = aOther.m_blockingObstacle;
+    m_blockingObstacleIsHole = aOther.m_blockingObstacleIsHole;
 
     copyLinks( &aOther );
 
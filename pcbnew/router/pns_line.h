@@ -65,7 +65,8 @@ public:
      */
     LINE() :
         LINK_HOLDER( LINE_T ),
-        m_blockingObstacle( nullptr )
+        m_blockingObstacle( nullptr ),
+        m_blockingObstacleIsHole( false )
     {
         m_hasVia = false;
         m_width = 1;        // Dummy value
@@ -82,7 +83,8 @@ public:
         m_line( aLine ),
         m_width( aBase.m_width ),
         m_snapThreshhold( aBase.m_snapThreshhold ),
-        m_blockingObstacle( nullptr )
+        m_blockingObstacle( nullptr ),
+        m_blockingObstacleIsHole( false )
     {
         m_net = aBase.m_net;
         m_layers = aBase.m_layers;
@@ -94,7 +96,8 @@ public:
      */
     LINE( const VIA& aVia ) :
         LINK_HOLDER( LINE_T ),
-        m_blockingObstacle( nullptr )
+        m_blockingObstacle( nullptr ),
+        m_blockingObstacleIsHole( false )
     {
         m_hasVia = true;
         m_via = aVia;
@@ -205,8 +208,14 @@ public:
     virtual void Unmark( int aMarker = -1 ) const override;
     virtual int Marker() const override;
 
-    void SetBlockingObstacle( ITEM* aObstacle ) { m_blockingObstacle = aObstacle; }
+    void SetBlockingObstacle( ITEM* aObstacle, bool aIsHole = false )
+    {
+        m_blockingObstacle = aObstacle;
+        m_blockingObstacleIsHole = aIsHole;
+    }
+
     ITEM* GetBlockingObstacle() const { return m_blockingObstacle; }
+    bool IsBlockingObstacleHole() const { return m_blockingObstacleIsHole; }
 
     void DragSegment( const VECTOR2I& aP, int aIndex, bool aFreeAngle = false );
     void DragCorner( const VECTOR2I& aP, int aIndex, bool aFreeAngle = false );
@@ -253,6 +262,7 @@ private:
     VIA              m_via;
 
     ITEM*            m_blockingObstacle;    ///< For mark obstacle mode.
+    bool             m_blockingObstacleIsHole;  ///< ... and whether it blocks with its hole
 };
 
 }
@@ -823,7 +823,7 @@ bool LINE_PLACER::rhMarkObstacles( const VECTOR2I& aP, LINE& aNewHead, LINE& aNe
     if( obs )
     {
         int cl = m_currentNode->GetClearance( obs->m_item, &m_head, false );
-        auto hull = obs->m_item->Hull( cl, m_head.Width() );
+        auto hull = m_currentNode->HullCache().Hull( obs->m_item, cl, m_head.Width(), -1 );
 
         auto nearest = hull.NearestPoint( aP );
 
@@ -845,7 +845,7 @@ bool LINE_PLACER::rhMarkObstacles( const VECTOR2I& aP, LINE& aNewHead, LINE& aNe
         if( obs && obs->m_distFirst != INT_MAX )
         {
             buildInitialLine( obs->m_ipFirst, m_head );
-            m_head.SetBlockingObstacle( obs->m_item );
+            m_head.SetBlockingObstacle( obs->m_item, obs->m_isHole );
         }
     }
 #endif
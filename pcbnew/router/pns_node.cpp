@@ -51,11 +51,18 @@ namespace PNS {
 static std::unordered_set<NODE*> allocNodes;
 #endif
 
+// Branches only store their own changes and look everything else up through their parents, so
+// the cost of a query grows with the length of that chain. Past this many levels a new branch
+// starts over from a flat copy of its parents' contents.
+static const int MAX_OVERLAY_DEPTH = 16;
+
 NODE::NODE()
 {
     m_depth = 0;
     m_root = this;
     m_parent = nullptr;
+    m_base = nullptr;
+    m_overlayDepth = 0;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_ruleResolver = nullptr;
     m_index = new INDEX;
@@ -90,7 +97,10 @@ NODE::~NODE()
     for( ITEM* item : *m_index )
     {
         if( item->BelongsTo( this ) )
+        {
+            m_root->m_hullCache.Invalidate( item );
             delete item;
+        }
     }
 
     releaseGarbage();
@@ -141,6 +151,7 @@ NODE* NODE::Branch()
     NODE* child = new NODE;
 
     m_children.insert( child );
+    m_root->m_stats.m_branches++;
 
     child->m_depth = m_depth + 1;
     child->m_parent = this;
@@ -149,21 +160,22 @@ NODE* NODE::Branch()
     child->m_maxClearance = m_maxClearance;
     child->m_collisionQueryScope = m_collisionQueryScope;
 
-    // Immediate offspring of the root branch needs not copy anything. For the rest, deep-copy
-    // joints, overridden item maps and pointers to stored items.
-    if( !isRoot() )
-    {
-        JOINT_MAP::iterator j;
-
-        for( ITEM* item : *m_index )
-            child->m_index->Add( item );
+    // The child only records its own changes on top of this node: items and joints are looked
+    // up through the chain of parent branches. The overridden item set is the exception; it is
+    // kept complete in every branch so that hiding an inherited item is a single lookup.
+    child->m_base = this;
+    child->m_overlayDepth = m_overlayDepth + 1;
 
-        child->m_joints = m_joints;
+    if( !isRoot() )
         child->m_override = m_override;
-    }
+
+    if( child->m_overlayDepth > MAX_OVERLAY_DEPTH )
+        child->flatten();
 
 #if 0
-    wxLogTrace( wxT( "PNS" ), wxT( "%d items, %d joints, %d overrides" ),
+    wxLogTrace( wxT( "PNS" ), wxT( "depth %d, overlay depth %d, %d items, %d joints, %d overrides" ),
+                child->m_depth,
+                child->m_overlayDepth,
                 child->m_index->Size(),
                 (int) child->m_joints.size(),
                 (int) child->m_override.size() );
@@ -173,6 +185,121 @@ NODE* NODE::Branch()
 }
 
 
+void NODE::flatten()
+{
+    if( isRoot() || m_base->isRoot() )
+        return;
+
+    for( NODE* base = m_base; !base->isRoot(); base = base->m_base )
+    {
+        for( ITEM* item : *base->m_index )
+        {
+            if( !Overrides( item ) )
+                m_index->Add( item );
+        }
+    }
+
+    std::vector<JOINT*> joints;
+
+    m_base->collectBranchJoints( joints );
+
+    for( JOINT* joint : joints )
+    {
+        // joints modified or removed in this node supersede the inherited ones
+        if( m_joints.find( joint->Tag() ) == m_joints.end() && !m_removedJoints.count( joint->Tag() ) )
+            m_joints.insert( TagJointPair( joint->Tag(), *joint ) );
+    }
+
+    // From now on only the root's items can show through, so there is no need to keep track of
+    // the parent branches' ones.
+    for( auto it = m_override.begin(); it != m_override.end(); )
+    {
+        if( !( *it )->BelongsTo( m_root ) )
+            it = m_override.erase( it );
+        else
+            ++it;
+    }
+
+    m_removedJoints.clear();
+    m_base = m_root;
+    m_overlayDepth = 1;
+}
+
+
+void NODE::unshareChildren()
+{
+    if( isRoot() )
+        return;
+
+    // Children look up whatever they haven't changed themselves in this node, so give them
+    // their own copy before it gets modified.
+    for( NODE* child : m_children )
+    {
+        if( child->m_base == this )
+            child->flatten();
+    }
+}
+
+
+void NODE::collectBranchItems( ITEM_VECTOR& aItems )
+{
+    for( ITEM* item : *m_index )
+        aItems.push_back( item );
+
+    for( NODE* base = m_base; base && !base->isRoot(); base = base->m_base )
+    {
+        for( ITEM* item : *base->m_index )
+        {
+            if( !Overrides( item ) )
+                aItems.push_back( item );
+        }
+    }
+}
+
+
+void NODE::collectBranchJoints( std::vector<JOINT*>& aJoints )
+{
+    if( isRoot() )
+    {
+        for( JOINT_MAP::value_type& j : m_joints )
+            aJoints.push_back( &j.second );
+
+        return;
+    }
+
+    JOINT_TAG_SET superseded;
+
+    for( NODE* node = this; !node->isRoot(); node = node->m_base )
+    {
+        for( JOINT_MAP::value_type& j : node->m_joints )
+        {
+            if( !superseded.count( j.first ) )
+                aJoints.push_back( &j.second );
+        }
+
+        for( const JOINT_MAP::value_type& j : node->m_joints )
+            superseded.insert( j.first );
+
+        superseded.insert( node->m_removedJoints.begin(), node->m_removedJoints.end() );
+    }
+}
+
+
+NODE::JOINT_MAP* NODE::branchJointMap( const JOINT::HASH_TAG& aTag )
+{
+    for( NODE* node = this; !node->isRoot(); node = node->m_base )
+    {
+        if( node->m_joints.find( aTag ) != node->m_joints.end() )
+            return &node->m_joints;
+
+        if( node->m_removedJoints.count( aTag ) )
+            return nullptr;
+    }
+
+    return nullptr;
+}
+
+
 void NODE::unlinkParent()
 {
     if( isRoot() )
@@ -248,14 +375,20 @@ struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
         if( visit( aCandidate ) )
             return true;
 
-        if( !aCandidate->Collide( m_item, m_node, m_differentNetsOnly, m_overrideClearance ) )
+        bool isHole = false;
+
+        if( !aCandidate->Collide( m_item, m_node, m_differentNetsOnly, m_overrideClearance,
+                                  &isHole ) )
+        {
             return true;
+        }
 
         OBSTACLE obs;
 
         obs.m_item = aCandidate;
         obs.m_head = m_item;
         obs.m_distFirst = INT_MAX;
+        obs.m_isHole = isHole;
         m_tab.push_back( obs );
 
         m_matchCount++;
@@ -275,6 +408,8 @@ int NODE::QueryColliding( const ITEM* aItem, NODE::OBSTACLES& aObstacles, int aK
     if( aItem->IsVirtual() )
         return 0;
 
+    m_root->m_stats.m_collisionQueries++;
+
     DEFAULT_OBSTACLE_VISITOR visitor( aObstacles, aItem, aKindMask, aDifferentNetsOnly, aOverrideClearance );
 
 #ifdef DEBUG
@@ -287,11 +422,14 @@ int NODE::QueryColliding( const ITEM* aItem, NODE::OBSTACLES& aObstacles, int aK
     // first, look for colliding items in the local index
     m_index->Query( aItem, m_maxClearance, visitor );
 
-    // if we haven't found enough items, look in the root branch as well.
-    if( !isRoot() && ( visitor.m_matchCount < aLimitCount || aLimitCount < 0 ) )
+    // if we haven't found enough items, look in the parent branches and the root as well.
+    for( NODE* base = m_base; base; base = base->m_base )
     {
-        visitor.SetWorld( m_root, this );
-        m_root->m_index->Query( aItem, m_maxClearance, visitor );
+        if( aLimitCount >= 0 && visitor.m_matchCount >= aLimitCount )
+            break;
+
+        visitor.SetWorld( base->isRoot() ? base : this, this );
+        base->m_index->Query( aItem, m_maxClearance, visitor );
     }
 
     return aObstacles.size();
@@ -324,6 +462,7 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aLine, int aKindMask,
     OBSTACLE nearest;
     nearest.m_item = nullptr;
     nearest.m_distFirst = INT_MAX;
+    nearest.m_isHole = false;
 
     auto updateNearest =
             [&]( const SHAPE_LINE_CHAIN::INTERSECTION& pt, ITEM* obstacle,
@@ -337,9 +476,7 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aLine, int aKindMask,
                     nearest.m_ipFirst = pt.p;
                     nearest.m_item = obstacle;
                     nearest.m_hull = hull;
-
-                    obstacle->Mark( isHole ? obstacle->Marker() | MK_HOLE
-                                           : obstacle->Marker() & ~MK_HOLE );
+                    nearest.m_isHole = isHole;
                 }
             };
 
@@ -357,7 +494,7 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aLine, int aKindMask,
         int clearance =
             GetClearance( obstacle.m_item, aLine, aUseClearanceEpsilon ) + aLine->Width() / 2;
 
-        obstacleHull = obstacle.m_item->Hull( clearance, 0, layer );
+        obstacleHull = HullCache().Hull( obstacle.m_item, clearance, 0, layer );
         //debugDecorator->AddLine( obstacleHull, 2, 40000, "obstacle-hull-test" );
         //debugDecorator->AddLine( aLine->CLine(), 5, 40000, "obstacle-test-line" );
 
@@ -386,7 +523,7 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aLine, int aKindMask,
             if( holeClearance > viaClearance )
                 viaClearance = holeClearance;
 
-            obstacleHull = obstacle.m_item->Hull( viaClearance, 0, layer );
+            obstacleHull = HullCache().Hull( obstacle.m_item, viaClearance, 0, layer );
             //debugDecorator->AddLine( obstacleHull, 3 );
 
             intersectingPts.clear();
@@ -408,7 +545,8 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aLine, int aKindMask,
 
             clearance = std::max( clearance, copperClearance );
 
-            obstacleHull = obstacle.m_item->HoleHull( clearance, aLine->Width(), layer );
+            obstacleHull = HullCache().HoleHull( obstacle.m_item, clearance,
+                                                 aLine->Width(), layer );
 
             intersectingPts.clear();
             HullIntersection( obstacleHull, aLine->CLine(), intersectingPts );
@@ -436,7 +574,7 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aLine, int aKindMask,
                 if( holeToHole > viaClearance )
                     viaClearance = holeToHole;
 
-                obstacleHull = obstacle.m_item->Hull( viaClearance, 0, layer );
+                obstacleHull = HullCache().Hull( obstacle.m_item, viaClearance, 0, layer );
                 //debugDecorator->AddLine( obstacleHull, 5 );
 
                 intersectingPts.clear();
@@ -551,14 +689,14 @@ const ITEM_SET NODE::HitTest( const VECTOR2I& aPoint ) const
 
     m_index->Query( &s, m_maxClearance, visitor );
 
-    if( !isRoot() )    // fixme: could be made cleaner
+    for( const NODE* base = m_base; base; base = base->m_base )    // fixme: could be made cleaner
     {
-        ITEM_SET items_root;
-        visitor.SetWorld( m_root, nullptr );
-        HIT_VISITOR  visitor_root( items_root, aPoint );
-        m_root->m_index->Query( &s, m_maxClearance, visitor_root );
+        ITEM_SET items_base;
+        HIT_VISITOR  visitor_base( items_base, aPoint );
+        visitor_base.SetWorld( base, nullptr );
+        base->m_index->Query( &s, m_maxClearance, visitor_base );
 
-        for( ITEM* item : items_root.Items() )
+        for( ITEM* item : items_base.Items() )
         {
             if( !Overrides( item ) )
                 items.Add( item );
@@ -571,6 +709,8 @@ const ITEM_SET NODE::HitTest( const VECTOR2I& aPoint ) const
 
 void NODE::addSolid( SOLID* aSolid )
 {
+    unshareChildren();
+
     if( aSolid->IsRoutable() )
         linkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
 
@@ -587,6 +727,8 @@ void NODE::Add( std::unique_ptr< SOLID > aSolid )
 
 void NODE::addVia( VIA* aVia )
 {
+    unshareChildren();
+
     linkJoint( aVia->Pos(), aVia->Layers(), aVia->Net(), aVia );
 
     m_index->Add( aVia );
@@ -654,6 +796,8 @@ void NODE::Add( LINE& aLine, bool aAllowRedundant )
 
 void NODE::addSegment( SEGMENT* aSeg )
 {
+    unshareChildren();
+
     linkJoint( aSeg->Seg().A, aSeg->Layers(), aSeg->Net(), aSeg );
     linkJoint( aSeg->Seg().B, aSeg->Layers(), aSeg->Net(), aSeg );
 
@@ -682,6 +826,8 @@ bool NODE::Add( std::unique_ptr< SEGMENT > aSegment, bool aAllowRedundant )
 
 void NODE::addArc( ARC* aArc )
 {
+    unshareChildren();
+
     linkJoint( aArc->Anchor( 0 ), aArc->Layers(), aArc->Net(), aArc );
     linkJoint( aArc->Anchor( 1 ), aArc->Layers(), aArc->Net(), aArc );
 
@@ -745,14 +891,17 @@ bool NODE::QueryEdgeExclusions( const VECTOR2I& aPos ) const
 
 void NODE::doRemove( ITEM* aItem )
 {
-    // case 1: removing an item that is stored in the root node from any branch:
-    // mark it as overridden, but do not remove
-    if( aItem->BelongsTo( m_root ) && !isRoot() )
+    unshareChildren();
+
+    m_root->m_hullCache.Invalidate( aItem );
+
+    // case 1: removing an item that is stored in the root node or in a parent branch from any
+    // branch: mark it as overridden, but do not remove
+    if( !isRoot() && !m_index->Contains( aItem ) )
         m_override.insert( aItem );
 
-    // case 2: the item belongs to this branch or a parent, non-root branch,
-    // or the root itself and we are the root: remove from the index
-    else if( !aItem->BelongsTo( m_root ) || isRoot() )
+    // case 2: the item is stored in this node: remove from the index
+    else
         m_index->Remove( aItem );
 
     // the item belongs to this particular branch: un-reference it
@@ -791,6 +940,20 @@ void NODE::rebuildJoint( JOINT* aJoint, ITEM* aItem )
     tag.net = net;
     tag.pos = aJoint->Pos();
 
+    unshareChildren();
+
+    // a joint inherited from a parent branch is about to be modified: take a copy first
+    if( !isRoot() && m_joints.find( tag ) == m_joints.end() )
+    {
+        if( JOINT_MAP* joints = branchJointMap( tag ) )
+        {
+            auto range = joints->equal_range( tag );
+
+            for( auto f = range.first; f != range.second; ++f )
+                m_joints.insert( *f );
+        }
+    }
+
     bool split;
 
     do
@@ -814,6 +977,10 @@ void NODE::rebuildJoint( JOINT* aJoint, ITEM* aItem )
         }
     } while( split );
 
+    // don't let the parent branches' version of the joint show through
+    if( !isRoot() && m_joints.find( tag ) == m_joints.end() )
+        m_removedJoints.insert( tag );
+
     // and re-link them, using the former via's link list
     for( ITEM* link : links )
     {
@@ -1119,10 +1286,13 @@ void NODE::FixupVirtualVias()
 {
     SEGMENT* locked_seg = nullptr;
     std::vector<VVIA*> vvias;
+    std::vector<JOINT*> joints;
+
+    collectBranchJoints( joints );
 
-    for( auto& jointPair : m_joints )
+    for( JOINT* branchJoint : joints )
     {
-        JOINT joint = jointPair.second;
+        JOINT joint = *branchJoint;
 
         if( joint.Layers().IsMultilayer() )
             continue;
@@ -1193,13 +1363,12 @@ JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
+    JOINT_MAP* joints = branchJointMap( tag );
 
-    if( f == end && !isRoot() )
-    {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
-    }
+    if( !joints )
+        joints = &m_root->m_joints;
+
+    JOINT_MAP::iterator f = joints->find( tag ), end = joints->end();
 
     if( f == end )
         return nullptr;
@@ -1230,18 +1399,28 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     tag.pos = aPos;
     tag.net = aNet;
 
+    unshareChildren();
+
     // try to find the joint in this node.
     JOINT_MAP::iterator f = m_joints.find( tag );
 
     std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
 
-    // not found and we are not root? find in the root and copy results here.
+    // not found and we are not root? find in the nearest parent branch holding it (or the root)
+    // and copy results here.
     if( f == m_joints.end() && !isRoot() )
     {
-        range = m_root->m_joints.equal_range( tag );
+        JOINT_MAP* joints = branchJointMap( tag );
+
+        if( !joints )
+            joints = &m_root->m_joints;
+
+        range = joints->equal_range( tag );
 
         for( f = range.first; f != range.second; ++f )
             m_joints.insert( *f );
+
+        m_removedJoints.erase( tag );
     }
 
     // now insert and combine overlapping joints
@@ -1400,11 +1579,14 @@ void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
     if( m_index->Size() )
         aAdded.reserve( m_index->Size() );
 
+    // items of the parent branches which were overridden here never made it to the root
     for( ITEM* item : m_override )
-        aRemoved.push_back( item );
+    {
+        if( item->BelongsTo( m_root ) )
+            aRemoved.push_back( item );
+    }
 
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-        aAdded.push_back( *i );
+    collectBranchItems( aAdded );
 }
 
 
@@ -1429,7 +1611,10 @@ void NODE::releaseGarbage()
     for( ITEM* item : m_garbageItems )
     {
         if( !item->BelongsTo( this ) )
+        {
+            m_hullCache.Invalidate( item );
             delete item;
+        }
     }
 
     m_garbageItems.clear();
@@ -1441,10 +1626,14 @@ void NODE::Commit( NODE* aNode )
     if( aNode->isRoot() )
         return;
 
-    for( ITEM* item : aNode->m_override )
+    ITEM_VECTOR removed, added;
+
+    aNode->GetUpdatedItems( removed, added );
+
+    for( ITEM* item : removed )
         Remove( item );
 
-    for( ITEM* item : *aNode->m_index )
+    for( ITEM* item : added )
     {
         item->SetRank( -1 );
         item->Unmark();
@@ -1475,13 +1664,13 @@ void NODE::AllItemsInNet( int aNet, std::set<ITEM*>& aItems, int aKindMask )
         }
     }
 
-    if( !isRoot() )
+    for( NODE* base = m_base; base; base = base->m_base )
     {
-        INDEX::NET_ITEMS_LIST* l_root = m_root->m_index->GetItemsForNet( aNet );
+        INDEX::NET_ITEMS_LIST* l_base = base->m_index->GetItemsForNet( aNet );
 
-        if( l_root )
+        if( l_base )
         {
-            for( ITEM* item : *l_root )
+            for( ITEM* item : *l_base )
             {
                 if( !Overrides( item ) && item->OfKind( aKindMask ) && item->IsRoutable() )
                     aItems.insert( item );
@@ -1493,7 +1682,11 @@ void NODE::AllItemsInNet( int aNet, std::set<ITEM*>& aItems, int aKindMask )
 
 void NODE::ClearRanks( int aMarkerMask )
 {
-    for( ITEM* item : *m_index )
+    ITEM_VECTOR items;
+
+    collectBranchItems( items );
+
+    for( ITEM* item : items )
     {
         item->SetRank( -1 );
         item->Mark( item->Marker() & ~aMarkerMask );
@@ -1503,9 +1696,12 @@ void NODE::ClearRanks( int aMarkerMask )
 
 void NODE::RemoveByMarker( int aMarker )
 {
-    std::vector<ITEM*> garbage;
+    ITEM_VECTOR items;
+    ITEM_VECTOR garbage;
 
-    for( ITEM* item : *m_index )
+    collectBranchItems( items );
+
+    for( ITEM* item : items )
     {
         if( item->Marker() & aMarker )
             garbage.emplace_back( item );
@@ -1593,14 +1789,18 @@ int NODE::QueryJoints( const BOX2I& aBox, std::vector<JOINT*>& aJoints, LAYER_RA
 
     aJoints.clear();
 
-    for( JOINT_MAP::value_type& j : m_joints )
+    std::vector<JOINT*> joints;
+
+    collectBranchJoints( joints );
+
+    for( JOINT* joint : joints )
     {
-        if( !j.second.Layers().Overlaps( aLayerMask ) )
+        if( !joint->Layers().Overlaps( aLayerMask ) )
             continue;
 
-        if( aBox.Contains( j.second.Pos() ) && j.second.LinkCount( aKindMask ) )
+        if( aBox.Contains( joint->Pos() ) && joint->LinkCount( aKindMask ) )
         {
-            aJoints.push_back( &j.second );
+            aJoints.push_back( joint );
             n++;
         }
     }
@@ -1630,16 +1830,24 @@ ITEM *NODE::FindItemByParent( const BOARD_ITEM* aParent )
     {
         const BOARD_CONNECTED_ITEM* cItem = static_cast<const BOARD_CONNECTED_ITEM*>( aParent );
 
-        INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( cItem->GetNetCode() );
+        // look through this branch and its non-root parents (or just the root if we are it)
+        NODE* node = this;
 
-        if( l_cur )
+        do
         {
-            for( ITEM* item : *l_cur )
+            INDEX::NET_ITEMS_LIST* l_cur = node->m_index->GetItemsForNet( cItem->GetNetCode() );
+
+            if( l_cur )
             {
-                if( item->Parent() == aParent )
-                    return item;
+                for( ITEM* item : *l_cur )
+                {
+                    if( item->Parent() == aParent && !Overrides( item ) )
+                        return item;
+                }
             }
-        }
+
+            node = node->m_base;
+        } while( node && !node->isRoot() );
     }
 
     return nullptr;
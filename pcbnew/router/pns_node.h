@@ -23,6 +23,7 @@
 #ifndef __PNS_NODE_H
 #define __PNS_NODE_H
 
+#include <atomic>
 #include <vector>
 #include <list>
 #include <unordered_set>
@@ -31,6 +32,7 @@
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_index.h>
 
+#include "pns_hull_cache.h"
 #include "pns_item.h"
 #include "pns_joint.h"
 #include "pns_itemset.h"
@@ -118,6 +120,7 @@ struct OBSTACLE
     VECTOR2I         m_ipFirst;        ///< First intersection between m_head and m_hull
     int              m_distFirst;      ///< ... and the distance thereof
     int              m_maxFanoutWidth; ///< worst case (largest) width of the tracks connected to the item
+    bool             m_isHole;         ///< The collision is with the hole of m_item
 };
 
 class OBSTACLE_VISITOR
@@ -199,7 +202,26 @@ public:
         return m_ruleResolver;
     }
 
-    ///< Return the number of joints.
+    ///< Return the hull cache shared by all the nodes of this hierarchy.
+    HULL_CACHE& HullCache()
+    {
+        return m_root->m_hullCache;
+    }
+
+    ///< Counters shared by all the nodes of this hierarchy, reported by the router benchmarks.
+    struct STATS
+    {
+        std::atomic<int> m_branches{ 0 };
+        std::atomic<int> m_collisionQueries{ 0 };
+    };
+
+    STATS& Stats()
+    {
+        return m_root->m_stats;
+    }
+
+    ///< Return the number of joints stored in this node (not including the ones inherited from
+    ///< parent branches).
     int JointCount() const
     {
         return m_joints.size();
@@ -389,7 +411,7 @@ public:
 
     void AllItemsInNet( int aNet, std::set<ITEM*>& aItems, int aKindMask = -1 );
 
-    void ClearRanks( int aMarkerMask = MK_HEAD | MK_VIOLATION | MK_HOLE );
+    void ClearRanks( int aMarkerMask = MK_HEAD | MK_VIOLATION );
 
     void RemoveByMarker( int aMarker );
 
@@ -405,7 +427,8 @@ public:
         return m_parent;
     }
 
-    ///< Check if this branch contains an updated version of the m_item from the root branch.
+    ///< Check if this branch contains an updated version of the m_item from the root branch
+    ///< or one of the parent branches.
     bool Overrides( ITEM* aItem ) const
     {
         return m_override.find( aItem ) != m_override.end();
@@ -457,6 +480,17 @@ private:
     void releaseGarbage();
     void rebuildJoint( JOINT* aJoint, ITEM* aItem );
 
+    ///< Give the children of this (non-root) node their own copy of everything they inherit from
+    ///< it, so that this node can be modified without affecting them.
+    void unshareChildren();
+
+    ///< Copy the items and joints inherited from the parent branches into this node, making it
+    ///< overlay the root directly.
+    void flatten();
+
+    ///< Collect the items of this branch and of its non-root parents which are still present.
+    void collectBranchItems( ITEM_VECTOR& aItems );
+
     bool isRoot() const
     {
         return m_parent == nullptr;
@@ -477,21 +511,36 @@ private:
 private:
     struct DEFAULT_OBSTACLE_VISITOR;
     typedef std::unordered_multimap<JOINT::HASH_TAG, JOINT, JOINT::JOINT_TAG_HASH> JOINT_MAP;
+    typedef std::unordered_set<JOINT::HASH_TAG, JOINT::JOINT_TAG_HASH> JOINT_TAG_SET;
     typedef JOINT_MAP::value_type TagJointPair;
 
+    ///< Return the joint map of the nearest non-root node in the overlay chain that holds joints
+    ///< for \a aTag, or nullptr if they have to be looked up in the root.
+    JOINT_MAP* branchJointMap( const JOINT::HASH_TAG& aTag );
+
+    ///< Collect the joints of this branch and of its non-root parents, skipping the ones that
+    ///< have been superseded further down the chain.
+    void collectBranchJoints( std::vector<JOINT*>& aJoints );
+
     JOINT_MAP       m_joints;           ///< hash table with the joints, linking the items. Joints
                                         ///< are hashed by their position, layer set and net.
+                                        ///< Branches only store the joints they have modified.
+    JOINT_TAG_SET   m_removedJoints;    ///< joints inherited from the parent branches which have
+                                        ///< been removed in this node
 
     NODE*           m_parent;           ///< node this node was branched from
     NODE*           m_root;             ///< root node of the whole hierarchy
+    NODE*           m_base;             ///< node whose items and joints this node overlays
+                                        ///< (the parent, or the root for flattened branches)
+    int             m_overlayDepth;     ///< number of non-root nodes in the overlay chain
     std::set<NODE*> m_children;         ///< list of nodes branched from this one
 
-    std::unordered_set<ITEM*> m_override;   ///< hash of root's items that have been changed
-                                            ///< in this node
+    std::unordered_set<ITEM*> m_override;   ///< hash of the root's and parent branches' items
+                                            ///< that have been changed in this node
 
     int             m_maxClearance;     ///< worst case item-item clearance
     RULE_RESOLVER*  m_ruleResolver;     ///< Design rules resolver
-    INDEX*          m_index;            ///< Geometric/Net index of the items
+    INDEX*          m_index;            ///< Geometric/Net index of the items added in this node
     int             m_depth;            ///< depth of the node (number of parent nodes in the
                                         ///< inheritance chain)
 
@@ -499,6 +548,9 @@ private:
 
     std::unordered_set<ITEM*> m_garbageItems;
 
+    HULL_CACHE      m_hullCache;        ///< obstacle hulls (only used in the root node)
+    STATS           m_stats;            ///< hierarchy counters (only used in the root node)
+
     COLLISION_QUERY_SCOPE m_collisionQueryScope;
 };
 
@@ -605,14 +605,13 @@ bool ROUTER::moveDragging( const VECTOR2I& aP, ITEM* aEndItem )
 void ROUTER::markViolations( NODE* aNode, ITEM_SET& aCurrent, NODE::ITEM_VECTOR& aRemoved )
 {
     auto updateItem =
-            [&]( ITEM* currentItem, ITEM* itemToMark )
+            [&]( ITEM* currentItem, ITEM* itemToMark, bool aIsHole )
             {
                 std::unique_ptr<ITEM> tmp( itemToMark->Clone() );
 
                 int  clearance;
                 bool removeOriginal = true;
-                bool holeOnly       = ( ( itemToMark->Marker() & MK_HOLE )
-                                        && !( itemToMark->Marker() & MK_VIOLATION ) );
+                bool holeOnly       = aIsHole && !( itemToMark->Marker() & MK_VIOLATION );
 
                 if( holeOnly )
                     clearance = aNode->GetHoleClearance( currentItem, itemToMark );
@@ -680,7 +679,7 @@ void ROUTER::markViolations( NODE* aNode, ITEM_SET& aCurrent, NODE::ITEM_VECTOR&
                 continue;
 
             obs.m_item->Mark( obs.m_item->Marker() | MK_VIOLATION );
-            updateItem( item, obs.m_item );
+            updateItem( item, obs.m_item, obs.m_isHole );
         }
 
         if( item->Kind() == ITEM::LINE_T )
@@ -689,7 +688,10 @@ void ROUTER::markViolations( NODE* aNode, ITEM_SET& aCurrent, NODE::ITEM_VECTOR&
 
             // Show clearance on any blocking obstacles
             if( line->GetBlockingObstacle() )
-                updateItem( item, line->GetBlockingObstacle() );
+            {
+                updateItem( item, line->GetBlockingObstacle(),
+                            line->IsBlockingObstacleHole() );
+            }
         }
     }
 }
@@ -19,9 +19,11 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <future>
 #include <optional>
 
 #include <geometry/shape_line_chain.h>
+#include <thread_pool.h>
 
 #include "pns_walkaround.h"
 #include "pns_optimizer.h"
@@ -74,7 +76,8 @@ void WALKAROUND::RestrictToSet( bool aEnabled, const std::set<ITEM*>& aSet )
 }
 
 
-WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath, bool aWindingDirection )
+WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath, bool aWindingDirection,
+                                                     int aIteration )
 {
     std::optional<OBSTACLE>& current_obs =
         aWindingDirection ? m_currentObstacle[0] : m_currentObstacle[1];
@@ -89,9 +92,9 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath, bool aWinding
     bool s_cw = aPath.Walkaround( current_obs->m_hull, path_walk, aWindingDirection );
 
     PNS_DBG( Dbg(), BeginGroup, "hull/walk", 1 );
-    PNS_DBG( Dbg(), AddShape, &current_obs->m_hull, RED, 0, wxString::Format( "hull-%s-%d", aWindingDirection ? wxT( "cw" ) : wxT( "ccw" ), m_iteration ) );
-    PNS_DBG( Dbg(), AddShape, &aPath.CLine(), GREEN, 0, wxString::Format( "path-%s-%d", aWindingDirection ? wxT( "cw" ) : wxT( "ccw" ), m_iteration ) );
-    PNS_DBG( Dbg(), AddShape, &path_walk, BLUE, 0, wxString::Format( "result-%s-%d", aWindingDirection ? wxT( "cw" ) : wxT( "ccw" ), m_iteration ) );
+    PNS_DBG( Dbg(), AddShape, &current_obs->m_hull, RED, 0, wxString::Format( "hull-%s-%d", aWindingDirection ? wxT( "cw" ) : wxT( "ccw" ), aIteration ) );
+    PNS_DBG( Dbg(), AddShape, &aPath.CLine(), GREEN, 0, wxString::Format( "path-%s-%d", aWindingDirection ? wxT( "cw" ) : wxT( "ccw" ), aIteration ) );
+    PNS_DBG( Dbg(), AddShape, &path_walk, BLUE, 0, wxString::Format( "result-%s-%d", aWindingDirection ? wxT( "cw" ) : wxT( "ccw" ), aIteration ) );
     PNS_DBG( Dbg(), Message, wxString::Format( wxT( "Stat cw %d" ), !!s_cw ) );
     PNS_DBGN( Dbg(), EndGroup );
 
@@ -131,10 +134,11 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
 
     start( aInitialPath );
 
-    m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
+    HULL_CACHE& hullCache = m_world->HullCache();
+    size_t      hullHits = hullCache.Hits();
+    size_t      hullMisses = hullCache.Misses();
 
-    result.lineCw = aInitialPath;
-    result.lineCcw = aInitialPath;
+    m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
 
     if( m_forceWinding )
     {
@@ -149,47 +153,58 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
     const int maxWalkDistFactor = 10;
     long long lengthLimit       = aInitialPath.CLine().Length() * maxWalkDistFactor;
 
-    while( m_iteration < m_iterationLimit )
+    // The clockwise and counter-clockwise walks don't depend on each other (the world is only
+    // read from), so each one gets the full iteration budget and they run side by side.
+    auto walk =
+            [&]( LINE& aPath, WALKAROUND_STATUS& aStatus, bool aWindingDirection )
+            {
+                for( int iteration = 0; iteration < m_iterationLimit; iteration++ )
+                {
+                    if( aStatus != IN_PROGRESS )
+                        break;
+
+                    aStatus = singleStep( aPath, aWindingDirection, iteration );
+
+                    // Safety valve.  Each walk stops on its own length: the walks used to go
+                    // on until both of them were too long, but that would make each one depend
+                    // on how far the other one got.  A walk which gets too long now stops
+                    // earlier (as ALMOST_DONE) even if the other one is still short.
+                    if( m_lengthLimitOn && aPath.Line().Length() > lengthLimit )
+                        break;
+                }
+            };
+
+    // The debug decorator isn't thread-safe.
+    if( Dbg() && Dbg()->IsDebugEnabled() )
     {
-        if( s_cw != STUCK && s_cw != ALMOST_DONE )
-            s_cw = singleStep( path_cw, true );
-
-        if( s_ccw != STUCK && s_ccw != ALMOST_DONE )
-            s_ccw = singleStep( path_ccw, false );
-
-        if( s_cw != IN_PROGRESS )
-        {
-            result.lineCw = path_cw;
-            result.statusCw = s_cw;
-        }
-
-        if( s_ccw != IN_PROGRESS )
-        {
-            result.lineCcw = path_ccw;
-            result.statusCcw = s_ccw;
-        }
-
-        if( s_cw != IN_PROGRESS && s_ccw != IN_PROGRESS )
-            break;
-
-        // Safety valve
-        if( m_lengthLimitOn && path_cw.Line().Length() > lengthLimit && path_ccw.Line().Length() > lengthLimit )
-            break;
-
-        m_iteration++;
+        walk( path_cw, s_cw, true );
+        walk( path_ccw, s_ccw, false );
     }
-
-    if( s_cw == IN_PROGRESS )
+    else
     {
-        result.lineCw = path_cw;
-        result.statusCw = ALMOST_DONE;
+        thread_pool&      tp = GetKiCadThreadPool();
+        std::future<void> ccw = tp.submit( [&]()
+                                           {
+                                               walk( path_ccw, s_ccw, false );
+                                           } );
+
+        walk( path_cw, s_cw, true );
+        ccw.get();
     }
 
-    if( s_ccw == IN_PROGRESS )
-    {
-        result.lineCcw = path_ccw;
-        result.statusCcw = ALMOST_DONE;
-    }
+    hullHits = hullCache.Hits() - hullHits;
+    hullMisses = hullCache.Misses() - hullMisses;
+
+    PNS_DBG( Dbg(), Message,
+             wxString::Format( wxT( "hull cache: %zu hits, %zu misses (%.0f%%)" ), hullHits,
+                               hullMisses,
+                               hullHits + hullMisses ? 100.0 * hullHits / ( hullHits + hullMisses )
+                                                     : 0.0 ) );
+
+    result.lineCw = path_cw;
+    result.statusCw = s_cw == IN_PROGRESS ? ALMOST_DONE : s_cw;
+    result.lineCcw = path_ccw;
+    result.statusCcw = s_ccw == IN_PROGRESS ? ALMOST_DONE : s_ccw;
 
     if( result.lineCw.SegmentCount() < 1 || result.lineCw.CPoint( 0 ) != aInitialPath.CPoint( 0 ) )
     {
@@ -259,10 +274,10 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath, LINE&
             s_ccw = STUCK; // ccw path is empty, can't continue
 
         if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
+            s_cw = singleStep( path_cw, true, m_iteration );
 
         if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
+            s_ccw = singleStep( path_ccw, false, m_iteration );
 
         if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
         {
@@ -35,6 +35,8 @@ using namespace std::placeholders;
 #include <pcb_target.h>
 #include <footprint.h>
 #include <pad.h>
+#include <pcb_shape.h>
+#include <zone.h>
 #include <origin_viewitem.h>
 #include <connectivity/connectivity_data.h>
 #include <tool/tool_manager.h>
@@ -584,6 +586,80 @@ void PCB_BASE_EDIT_FRAME::ClearUndoORRedoList( UNDO_REDO_LIST whichList, int aIt
 }
 
 
+static size_t polySetMemoryUsage( const SHAPE_POLY_SET& aPolySet )
+{
+    // Each point of a SHAPE_LINE_CHAIN also has an entry in its shape (arc) index
+    size_t size = sizeof( SHAPE_POLY_SET )
+                  + aPolySet.FullPointCount()
+                            * ( sizeof( VECTOR2I ) + sizeof( std::pair<ssize_t, ssize_t> ) );
+
+    for( unsigned ii = 0; ii < aPolySet.TriangulatedPolyCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* tri = aPolySet.TriangulatedPolygon( ii );
+
+        size += tri->GetVertexCount() * sizeof( VECTOR2I )
+                + tri->GetTriangleCount() * sizeof( SHAPE_POLY_SET::TRIANGULATED_POLYGON::TRI );
+    }
+
+    return size;
+}
+
+
+size_t PCB_BASE_EDIT_FRAME::GetBoardItemMemoryUsage( const EDA_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_ZONE_T:
+    case PCB_FP_ZONE_T:
+    {
+        const ZONE* zone = static_cast<const ZONE*>( aItem );
+        size_t      size = sizeof( ZONE ) + polySetMemoryUsage( *zone->Outline() );
+
+        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+        {
+            if( !zone->HasFilledPolysForLayer( layer ) )
+                continue;
+
+            const std::shared_ptr<SHAPE_POLY_SET>& fill = zone->GetFilledPolysList( layer );
+
+            if( fill )
+                size += polySetMemoryUsage( *fill ) / std::max( fill.use_count(), 1L );
+        }
+
+        return size;
+    }
+
+    case PCB_FOOTPRINT_T:
+    {
+        const FOOTPRINT* footprint = static_cast<const FOOTPRINT*>( aItem );
+        size_t           size = sizeof( FOOTPRINT );
+
+        for( const PAD* pad : footprint->Pads() )
+            size += GetBoardItemMemoryUsage( pad );
+
+        for( const BOARD_ITEM* item : footprint->GraphicalItems() )
+            size += GetBoardItemMemoryUsage( item );
+
+        for( const FP_ZONE* zone : footprint->Zones() )
+            size += GetBoardItemMemoryUsage( zone );
+
+        return size;
+    }
+
+    case PCB_SHAPE_T:
+    case PCB_FP_SHAPE_T:
+        return sizeof( PCB_SHAPE )
+               + polySetMemoryUsage( static_cast<const PCB_SHAPE*>( aItem )->GetPolyShape() );
+
+    case PCB_PAD_T:   return sizeof( PAD );
+    case PCB_TRACE_T: return sizeof( PCB_TRACK );
+    case PCB_ARC_T:   return sizeof( PCB_ARC );
+    case PCB_VIA_T:   return sizeof( PCB_VIA );
+    default:          return sizeof( BOARD_ITEM );
+    }
+}
+
+
 void PCB_BASE_EDIT_FRAME::ClearListAndDeleteItems( PICKED_ITEMS_LIST* aList )
 {
     aList->ClearListAndDeleteItems( []( EDA_ITEM* item )
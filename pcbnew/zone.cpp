@@ -149,12 +149,15 @@ void ZONE::InitDataFromSrcInCopyCtor( const ZONE& aZone )
     delete m_CornerSelection;
     m_CornerSelection         = nullptr;
 
+    // The filled polygons are shared with aZone rather than copied: copies of a zone are
+    // mostly made for the undo list and the filled areas can be huge.  They are only copied
+    // when one of the zones modifies them in place (see detachFill()).
     for( PCB_LAYER_ID layer : aZone.GetLayerSet().Seq() )
     {
         std::shared_ptr<SHAPE_POLY_SET> fill = aZone.m_FilledPolysList.at( layer );
 
         if( fill )
-            m_FilledPolysList[layer] = std::make_shared<SHAPE_POLY_SET>( *fill );
+            m_FilledPolysList[layer] = fill;
         else
             m_FilledPolysList[layer] = std::make_shared<SHAPE_POLY_SET>();
 
@@ -180,6 +183,17 @@ EDA_ITEM* ZONE::Clone() const
 }
 
 
+SHAPE_POLY_SET& ZONE::detachFill( PCB_LAYER_ID aLayer )
+{
+    std::shared_ptr<SHAPE_POLY_SET>& fill = m_FilledPolysList.at( aLayer );
+
+    if( fill.use_count() > 1 )
+        fill = std::make_shared<SHAPE_POLY_SET>( *fill );
+
+    return *fill;
+}
+
+
 bool ZONE::HigherPriority( const ZONE* aOther ) const
 {
     // Teardrops are always higher priority than regular zones, so if one zone is a teardrop
@@ -211,7 +225,9 @@ bool ZONE::UnFill()
     {
         change |= !pair.second->IsEmpty();
         m_insulatedIslands[pair.first].clear();
-        pair.second->RemoveAllContours();
+
+        // Don't clear the fill in place: it can be shared with a copy of this zone
+        pair.second = std::make_shared<SHAPE_POLY_SET>();
     }
 
     m_isFilled = false;
@@ -632,7 +648,7 @@ void ZONE::Move( const VECTOR2I& offset )
 
     /* move fills */
     for( std::pair<const PCB_LAYER_ID, std::shared_ptr<SHAPE_POLY_SET>>& pair : m_FilledPolysList )
-        pair.second->Move( offset );
+        detachFill( pair.first ).Move( offset );
 
     /*
      * move boundingbox cache
@@ -685,7 +701,7 @@ void ZONE::Rotate( const VECTOR2I& aCentre, const EDA_ANGLE& aAngle )
 
     /* rotate filled areas: */
     for( std::pair<const PCB_LAYER_ID, std::shared_ptr<SHAPE_POLY_SET>>& pair : m_FilledPolysList )
-        pair.second->Rotate( aAngle, aCentre );
+        detachFill( pair.first ).Rotate( aAngle, aCentre );
 }
 
 
@@ -704,7 +720,7 @@ void ZONE::Mirror( const VECTOR2I& aMirrorRef, bool aMirrorLeftRight )
     HatchBorder();
 
     for( std::pair<const PCB_LAYER_ID, std::shared_ptr<SHAPE_POLY_SET>>& pair : m_FilledPolysList )
-        pair.second->Mirror( aMirrorLeftRight, !aMirrorLeftRight, aMirrorRef );
+        detachFill( pair.first ).Mirror( aMirrorLeftRight, !aMirrorLeftRight, aMirrorRef );
 }
 
 
@@ -1001,17 +1017,27 @@ void ZONE::swapData( BOARD_ITEM* aImage )
 
 void ZONE::CacheTriangulation( PCB_LAYER_ID aLayer )
 {
+    // The fill can be shared with copies of this zone (see InitDataFromSrcInCopyCtor()), which
+    // may be triangulated at the same time by other threads: detach it before building the
+    // triangulation.  Checking it first avoids copying fills that are already triangulated.
+    auto cacheFillTriangulation =
+            [&]( PCB_LAYER_ID layer )
+            {
+                if( !m_FilledPolysList.at( layer )->IsTriangulationUpToDate() )
+                    detachFill( layer ).CacheTriangulation();
+            };
+
     if( aLayer == UNDEFINED_LAYER )
     {
         for( auto& [ layer, poly ] : m_FilledPolysList )
-            poly->CacheTriangulation();
+            cacheFillTriangulation( layer );
 
         m_Poly->CacheTriangulation( false );
     }
     else
     {
         if( m_FilledPolysList.count( aLayer ) )
-            m_FilledPolysList[ aLayer ]->CacheTriangulation();
+            cacheFillTriangulation( aLayer );
     }
 }
 
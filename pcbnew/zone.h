@@ -605,10 +605,14 @@ public:
         return m_FilledPolysList.at( aLayer );
     }
 
+    /**
+     * @return the filled polygons of \a aLayer, to be modified in place.  They are first copied
+     *         if they are shared with a copy of this zone.
+     */
     SHAPE_POLY_SET* GetFill( PCB_LAYER_ID aLayer )
     {
         wxASSERT( m_FilledPolysList.count( aLayer ) );
-        return m_FilledPolysList.at( aLayer ).get();
+        return &detachFill( aLayer );
     }
 
     /**
@@ -783,6 +787,14 @@ public:
 #endif
 
 protected:
+    /**
+     * Copies of a zone share their filled polygons with the original.  Make sure the fill of
+     * \a aLayer is owned only by this zone before it is modified in place.
+     *
+     * @return the fill of \a aLayer.
+     */
+    SHAPE_POLY_SET& detachFill( PCB_LAYER_ID aLayer );
+
     virtual void swapData( BOARD_ITEM* aImage ) override;
 
 protected:
@@ -308,7 +308,10 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
 
                             if( zone->Outline()->Collide( viaShape.get() ) )
                             {
-                                if( zone->GetFill( layer )->Collide( flashedShape.get() ) )
+                                const std::shared_ptr<SHAPE_POLY_SET>& fill =
+                                        zone->GetFilledPolysList( layer );
+
+                                if( fill->Collide( flashedShape.get() ) )
                                     via->ZoneConnectionCache( layer ) = ZLC_CONNECTED;
                                 else
                                     via->ZoneConnectionCache( layer ) = ZLC_UNCONNECTED;
@@ -335,7 +338,10 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
 
                             if( zone->Outline()->Collide( padShape.get() ) )
                             {
-                                if( zone->GetFill( layer )->Collide( flashedShape.get() ) )
+                                const std::shared_ptr<SHAPE_POLY_SET>& fill =
+                                        zone->GetFilledPolysList( layer );
+
+                                if( fill->Collide( flashedShape.get() ) )
                                     pad->ZoneConnectionCache( layer ) = ZLC_CONNECTED;
                                 else
                                     pad->ZoneConnectionCache( layer ) = ZLC_UNCONNECTED;
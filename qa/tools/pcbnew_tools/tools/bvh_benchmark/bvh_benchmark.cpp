@@ -0,0 +1,200 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Compares the BVH builders of the ray tracer on the tracks of a board: the build time of each
+ * split method and the number of rays per second traced through the resulting trees.
+ */
+
+#include <pcbnew_utils/board_file_utils.h>
+
+#include <qa_utils/utility_registry.h>
+
+#include <board.h>
+#include <pcb_track.h>
+#include <profile.h>
+
+#include <3d-viewer/3d_rendering/raytracing/accelerators/bvh_pbrt.h>
+#include <3d-viewer/3d_rendering/raytracing/accelerators/container_2d.h>
+#include <3d-viewer/3d_rendering/raytracing/accelerators/container_3d.h>
+#include <3d-viewer/3d_rendering/raytracing/shapes2D/round_segment_2d.h>
+#include <3d-viewer/3d_rendering/raytracing/shapes3D/round_segment_3d.h>
+
+#include <cstdio>
+#include <limits>
+#include <random>
+
+
+#define BVH_BENCHMARK_RAYS 1000000
+
+// Board units to ray tracer units, in the range used by BOARD_ADAPTER
+static const float s_biuTo3d = 1.0f / pcbIUScale.IU_PER_MM / 100.0f;
+
+
+enum BVH_BENCHMARK_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    NO_TRACKS,
+};
+
+
+static void benchmark2D( BVH_CONTAINER_2D& aContainer, BVH_SPLIT_2D aMethod, const char* aName,
+                         const std::vector<RAYSEG2D>& aRays )
+{
+    PROF_TIMER build;
+    aContainer.BuildBVH( aMethod );
+    build.Stop();
+
+    PROF_TIMER trace;
+    size_t     hits = 0;
+
+    for( const RAYSEG2D& ray : aRays )
+    {
+        if( aContainer.IntersectAny( ray ) )
+            hits++;
+    }
+
+    trace.Stop();
+
+    printf( "2D %-12s build %8.2f ms, %10.0f rays/s, %zu hits\n", aName, build.msecs(),
+            aRays.size() / ( trace.msecs() / 1000.0 ), hits );
+}
+
+
+static void benchmark3D( const CONTAINER_3D& aContainer, SPLITMETHOD aMethod,
+                         bool aParallelBuild, const char* aName, const std::vector<RAY>& aRays )
+{
+    PROF_TIMER build;
+    BVH_PBRT   accelerator( aContainer, 8, aMethod, aParallelBuild );
+    build.Stop();
+
+    PROF_TIMER trace;
+    size_t     hits = 0;
+
+    for( const RAY& ray : aRays )
+    {
+        HITINFO hitInfo;
+        hitInfo.m_tHit = std::numeric_limits<float>::infinity();
+
+        if( accelerator.Intersect( ray, hitInfo ) )
+            hits++;
+    }
+
+    trace.Stop();
+
+    printf( "3D %-12s build %8.2f ms, %10.0f rays/s, %zu hits\n", aName, build.msecs(),
+            aRays.size() / ( trace.msecs() / 1000.0 ), hits );
+}
+
+
+int bvh_benchmark_main( int argc, char *argv[] )
+{
+    std::string filename;
+
+    if( argc > 1 )
+        filename = argv[1];
+
+    auto brd = KI_TEST::ReadBoardFromFileOrStream( filename );
+
+    if( !brd )
+        return BVH_BENCHMARK_RET_CODES::LOAD_FAILED;
+
+    BVH_CONTAINER_2D container2D;
+    CONTAINER_3D     container3D;
+    const float      zMin = 0.0f;
+    const float      zMax = 0.035f;
+
+    for( PCB_TRACK* track : brd->Tracks() )
+    {
+        if( track->Type() != PCB_TRACE_T )
+            continue;
+
+        const SFVEC2F start( track->GetStart().x * s_biuTo3d, -track->GetStart().y * s_biuTo3d );
+        const SFVEC2F end( track->GetEnd().x * s_biuTo3d, -track->GetEnd().y * s_biuTo3d );
+
+        ROUND_SEGMENT_2D* seg = new ROUND_SEGMENT_2D( start, end, track->GetWidth() * s_biuTo3d,
+                                                      *track );
+
+        container2D.Add( seg );
+        container3D.Add( new ROUND_SEGMENT( *seg, zMin, zMax ) );
+    }
+
+    if( container2D.GetList().empty() )
+        return BVH_BENCHMARK_RET_CODES::NO_TRACKS;
+
+    printf( "%zu track segments\n", container2D.GetList().size() );
+
+    // Use the same rays for all the builders
+    const BOX2I   bbox = brd->GetBoundingBox();
+    const SFVEC2F bboxMin( bbox.GetLeft() * s_biuTo3d, -bbox.GetBottom() * s_biuTo3d );
+    const SFVEC2F bboxMax( bbox.GetRight() * s_biuTo3d, -bbox.GetTop() * s_biuTo3d );
+    const float   maxLength = glm::length( bboxMax - bboxMin ) * 0.05f;
+
+    std::mt19937                          rng( 0 );
+    std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+
+    auto randomPoint =
+            [&]() -> SFVEC2F
+            {
+                return bboxMin + SFVEC2F( unit( rng ), unit( rng ) ) * ( bboxMax - bboxMin );
+            };
+
+    std::vector<RAYSEG2D> rays2D;
+    std::vector<RAY>      rays3D( BVH_BENCHMARK_RAYS );
+
+    rays2D.reserve( BVH_BENCHMARK_RAYS );
+
+    for( int i = 0; i < BVH_BENCHMARK_RAYS; ++i )
+    {
+        const SFVEC2F start = randomPoint();
+        const SFVEC2F dir = glm::normalize( randomPoint() - start );
+
+        rays2D.emplace_back( start, start + dir * maxLength * unit( rng ) );
+    }
+
+    // Look down on the board from a bit above it, with some tilt
+    for( RAY& ray : rays3D )
+    {
+        const SFVEC2F origin = randomPoint();
+        const SFVEC2F target = randomPoint();
+
+        ray.Init( SFVEC3F( origin.x, origin.y, zMax + maxLength ),
+                  glm::normalize( SFVEC3F( ( target - origin ) * 0.2f, -maxLength ) ) );
+    }
+
+    benchmark2D( container2D, BVH_SPLIT_2D::MIDDLE, "middle", rays2D );
+    benchmark2D( container2D, BVH_SPLIT_2D::SAH, "sah", rays2D );
+
+    benchmark3D( container3D, SPLITMETHOD::MIDDLE, false, "middle", rays3D );
+    benchmark3D( container3D, SPLITMETHOD::SAH, false, "sah", rays3D );
+    benchmark3D( container3D, SPLITMETHOD::SAH, true, "sah parallel", rays3D );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "bvh_benchmark",
+        "Compare the ray tracer BVH builders on the tracks of a PCB",
+        bvh_benchmark_main,
+} );
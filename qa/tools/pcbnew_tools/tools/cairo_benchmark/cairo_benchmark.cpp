@@ -0,0 +1,309 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Headless Cairo rendering benchmark: draws boards (e.g. the demo boards) through the Cairo GAL
+ * and its compositor into offscreen images at several zoom levels, and reports the time taken
+ * per frame. No window and no GPU are needed.
+ */
+
+#include <pcbnew_utils/board_file_utils.h>
+
+#include <qa_utils/utility_registry.h>
+
+#include <wx/cmdline.h>
+#include <wx/filename.h>
+
+#include <board.h>
+#include <footprint.h>
+#include <kiway.h>
+#include <macros.h>
+#include <pcb_painter.h>
+#include <pcb_track.h>
+#include <pcb_view.h>
+#include <pgm_base.h>
+#include <profile.h>
+#include <settings/settings_manager.h>
+#include <zone.h>
+
+#include <gal/cairo/cairo_gal.h>
+
+#include <cstdio>
+
+
+using namespace KIGFX;
+
+
+/**
+ * Cairo GAL drawing to an image surface instead of a window.  The targets are composited by
+ * #CAIRO_COMPOSITING_GAL, like in #CAIRO_GAL.
+ */
+class OFFSCREEN_CAIRO_GAL : public CAIRO_COMPOSITING_GAL
+{
+public:
+    OFFSCREEN_CAIRO_GAL( GAL_DISPLAY_OPTIONS& aOptions, int aWidth, int aHeight ) :
+            CAIRO_COMPOSITING_GAL( aOptions )
+    {
+        ResizeScreen( aWidth, aHeight );
+
+        m_surface = cairo_image_surface_create( GAL_FORMAT, aWidth, aHeight );
+        m_context = cairo_create( m_surface );
+        m_currentContext = m_context;
+    }
+
+    void BeginDrawing() override
+    {
+        // Like CAIRO_GAL, start each frame with the output surface
+        m_currentContext = m_context;
+
+        CAIRO_GAL_BASE::BeginDrawing();
+
+        beginCompositing();
+    }
+
+    void EndDrawing() override
+    {
+        CAIRO_GAL_BASE::EndDrawing();
+
+        endCompositing();
+
+        cairo_surface_flush( m_surface );
+    }
+
+    bool SavePng( const wxString& aFileName )
+    {
+        return cairo_surface_write_to_png( m_surface, aFileName.fn_str() ) == CAIRO_STATUS_SUCCESS;
+    }
+};
+
+
+/**
+ * The painter reads the viewer and color settings through Pgm(), so give the kiface a program
+ * with a headless settings manager.
+ */
+struct BENCHMARK_PGM : public PGM_BASE
+{
+    bool OnPgmInit() override
+    {
+        m_settings_manager = std::make_unique<SETTINGS_MANAGER>( true );
+        return m_settings_manager->IsOK();
+    }
+
+    void OnPgmExit() override {}
+
+    void MacOpenFile( const wxString& aFileName ) override {}
+};
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "n", "frames",
+            _( "frames drawn at each zoom level (default 10)" ).mb_str(), wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "W", "width", _( "image width in pixels (default 1920)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "H", "height", _( "image height in pixels (default 1080)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "o", "output", _( "save the last frame of each zoom level as PNG in "
+                                           "this directory" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "board file" ).mb_str(), wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum CAIRO_BENCHMARK_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    SETTINGS_FAILED,
+};
+
+
+// Zoom levels, relative to the one showing the whole board
+static const double s_zoomLevels[] = { 1.0, 4.0, 16.0, 64.0 };
+
+
+static void drawFrame( OFFSCREEN_CAIRO_GAL& aGal, PCB_VIEW& aView, RENDER_SETTINGS* aSettings )
+{
+    // Same sequence as EDA_DRAW_PANEL_GAL::DoRePaint() for a full redraw
+    GAL_DRAWING_CONTEXT ctx( &aGal );
+
+    aGal.SetClearColor( aSettings->GetBackgroundColor() );
+    aGal.SetGridColor( aSettings->GetGridColor() );
+    aGal.ClearScreen();
+
+    aView.MarkDirty();
+    aView.ClearTargets();
+    aView.Redraw();
+}
+
+
+static bool benchmarkBoard( const std::string& aFilename, int aFrames, int aWidth, int aHeight,
+                            const wxString& aOutputDir )
+{
+    std::unique_ptr<BOARD> brd = KI_TEST::ReadBoardFromFileOrStream( aFilename );
+
+    if( !brd )
+        return false;
+
+    brd->CacheTriangulation();
+
+    GAL_DISPLAY_OPTIONS options;
+    OFFSCREEN_CAIRO_GAL gal( options, aWidth, aHeight );
+    PCB_PAINTER         painter( &gal, FRAME_PCB_EDITOR );
+    PCB_VIEW            view;
+
+    painter.GetSettings()->LoadColors( Pgm().GetSettingsManager().GetColorSettings() );
+
+    view.SetGAL( &gal );
+    view.SetPainter( &painter );
+
+    PROF_TIMER index;
+    view.BeginBulkAdd();
+
+    for( BOARD_ITEM* drawing : brd->Drawings() )
+        view.Add( drawing );
+
+    for( PCB_TRACK* track : brd->Tracks() )
+        view.Add( track );
+
+    for( FOOTPRINT* footprint : brd->Footprints() )
+        view.Add( footprint );
+
+    for( ZONE* zone : brd->Zones() )
+        view.Add( zone );
+
+    view.EndBulkAdd();
+    view.UpdateItems();
+    index.Stop();
+
+    printf( "%s: %dx%d, view built in %.2f ms\n", aFilename.c_str(), aWidth, aHeight,
+            index.msecs() );
+
+    // Find the scale showing the whole board
+    const BOX2I bbox = brd->GetBoundingBox();
+
+    view.SetScale( 1.0 );
+
+    const VECTOR2D screenSize = view.ToWorld( VECTOR2D( aWidth, aHeight ), false );
+    double         fitScale = 1.0;
+
+    if( bbox.GetWidth() > 0 && bbox.GetHeight() > 0 )
+    {
+        fitScale = std::min( std::abs( screenSize.x ) / bbox.GetWidth(),
+                             std::abs( screenSize.y ) / bbox.GetHeight() );
+    }
+
+    for( double zoom : s_zoomLevels )
+    {
+        view.SetScale( fitScale * zoom );
+        view.SetCenter( bbox.Centre() );
+
+        // The first frame warms up the caches (e.g. the text shaping)
+        drawFrame( gal, view, painter.GetSettings() );
+
+        PROF_TIMER frames;
+
+        for( int i = 0; i < aFrames; i++ )
+            drawFrame( gal, view, painter.GetSettings() );
+
+        frames.Stop();
+
+        printf( "  zoom %5.1fx: %8.2f ms/frame\n", zoom, frames.msecs() / aFrames );
+
+        if( !aOutputDir.IsEmpty() )
+        {
+            wxFileName png( aOutputDir, wxFileName( aFilename ).GetName() );
+            png.SetName( wxString::Format( wxT( "%s_zoom%g" ), png.GetName(), zoom ) );
+            png.SetExt( wxT( "png" ) );
+
+            if( !gal.SavePng( png.GetFullPath() ) )
+                printf( "  could not write %s\n", TO_UTF8( png.GetFullPath() ) );
+        }
+    }
+
+    return true;
+}
+
+
+int cairo_benchmark_main( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "Draws boards with the Cairo GAL into offscreen images at several "
+                               "zoom levels and reports the time taken per frame." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long     frames = 10;
+    long     width = 1920;
+    long     height = 1080;
+    wxString outputDir;
+
+    cl_parser.Found( "frames", &frames );
+    cl_parser.Found( "width", &width );
+    cl_parser.Found( "height", &height );
+    cl_parser.Found( "output", &outputDir );
+
+    if( frames < 1 || width < 1 || height < 1 )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    BENCHMARK_PGM program;
+
+    if( !program.OnPgmInit() )
+        return CAIRO_BENCHMARK_RET_CODES::SETTINGS_FAILED;
+
+    int kifaceVersion = 0;
+    KIFACE_GETTER( &kifaceVersion, KIFACE_VERSION, &program );
+
+    bool ok = true;
+
+    for( size_t i = 0; i < cl_parser.GetParamCount(); i++ )
+    {
+        std::string filename = cl_parser.GetParam( i ).ToStdString();
+
+        if( !benchmarkBoard( filename, (int) frames, (int) width, (int) height, outputDir ) )
+        {
+            printf( "%s: could not load the board\n", filename.c_str() );
+            ok = false;
+        }
+    }
+
+    program.OnPgmExit();
+
+    return ok ? KI_TEST::RET_CODES::OK : CAIRO_BENCHMARK_RET_CODES::LOAD_FAILED;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "cairo_benchmark",
+        "Time the Cairo rendering of PCBs to offscreen images at several zoom levels",
+        cairo_benchmark_main,
+} );
@@ -0,0 +1,308 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Headless router benchmark: replays every P&S log found in a directory a number of times
+ * and reports the per-event latency percentiles together with the number of node branches,
+ * collision queries and heap allocations made by the router. The results can be written
+ * as JSON to compare two builds.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <new>
+
+#include <wx/cmdline.h>
+#include <wx/dir.h>
+#include <wx/init.h>
+
+#include <nlohmann/json.hpp>
+
+#include <qa_utils/utility_registry.h>
+#include <pcbnew_utils/board_test_utils.h>
+
+#include "pns_log_file.h"
+#include "pns_log_player.h"
+
+
+static std::atomic<uint64_t> s_allocations( 0 );
+
+
+// Count every heap allocation made by the process. The array forms end up here too.
+void* operator new( std::size_t aSize )
+{
+    s_allocations++;
+
+    if( void* ptr = std::malloc( aSize ? aSize : 1 ) )
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+
+void operator delete( void* aPtr ) noexcept
+{
+    std::free( aPtr );
+}
+
+
+void operator delete( void* aPtr, std::size_t ) noexcept
+{
+    std::free( aPtr );
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "n",
+            "runs",
+            _( "number of times each log is replayed (default 5)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "o",
+            "output",
+            _( "write the results as JSON to this file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            "directory",
+            "directory",
+            _( "directory searched (recursively) for P&S logs" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_OPTION_MANDATORY,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+
+static const char* eventName( PNS::LOGGER::EVENT_TYPE aType )
+{
+    switch( aType )
+    {
+    case PNS::LOGGER::EVT_START_ROUTE: return "route-start";
+    case PNS::LOGGER::EVT_START_DRAG:  return "drag-start";
+    case PNS::LOGGER::EVT_FIX:         return "fix";
+    case PNS::LOGGER::EVT_MOVE:        return "move";
+    case PNS::LOGGER::EVT_ABORT:       return "abort";
+    case PNS::LOGGER::EVT_TOGGLE_VIA:  return "toggle-via";
+    case PNS::LOGGER::EVT_UNFIX:       return "unfix";
+    default:                           return "unknown";
+    }
+}
+
+
+static double percentile( const std::vector<double>& aSorted, double aPercentile )
+{
+    if( aSorted.empty() )
+        return 0.0;
+
+    // nearest-rank method
+    size_t rank = (size_t) std::ceil( aPercentile / 100.0 * aSorted.size() );
+
+    return aSorted[ std::max<size_t>( rank, 1 ) - 1 ];
+}
+
+
+/**
+ * Summarize the events of all the replays of a log, either all of them or only the ones of a
+ * given type.
+ */
+static nlohmann::json summarize( const std::vector<PNS_LOG_PLAYER::EVENT_STATS>& aEvents,
+                                 int aRuns )
+{
+    std::vector<double> times;
+    uint64_t            branches = 0;
+    uint64_t            queries = 0;
+    uint64_t            allocations = 0;
+
+    for( const PNS_LOG_PLAYER::EVENT_STATS& evt : aEvents )
+    {
+        times.push_back( evt.m_timeUs );
+        branches += evt.m_branches;
+        queries += evt.m_collisionQueries;
+        allocations += evt.m_allocations;
+    }
+
+    std::sort( times.begin(), times.end() );
+
+    double total = 0.0;
+
+    for( double t : times )
+        total += t;
+
+    nlohmann::json j;
+
+    j["events"] = times.size() / std::max( aRuns, 1 );
+    j["latency_us"] = { { "p50", percentile( times, 50 ) },
+                        { "p95", percentile( times, 95 ) },
+                        { "p99", percentile( times, 99 ) },
+                        { "max", times.empty() ? 0.0 : times.back() },
+                        { "mean", times.empty() ? 0.0 : total / times.size() } };
+
+    // Counts are per replay, so that runs with a different repeat count can be compared.
+    j["branches"] = branches / std::max( aRuns, 1 );
+    j["collision_queries"] = queries / std::max( aRuns, 1 );
+    j["allocations"] = allocations / std::max( aRuns, 1 );
+
+    return j;
+}
+
+
+static bool benchmarkLog( const wxFileName& aLogName, int aRuns, REPORTER* aReporter,
+                          nlohmann::json& aResult )
+{
+    std::vector<PNS_LOG_PLAYER::EVENT_STATS> events;
+
+    for( int run = 0; run < aRuns; run++ )
+    {
+        // Reload the log for every run, so that each replay starts from the recorded board.
+        PNS_LOG_FILE   logFile;
+        PNS_LOG_PLAYER player;
+
+        if( !logFile.Load( aLogName, aReporter ) )
+        {
+            aReporter->Report( wxString::Format( "Failed to load log '%s'",
+                                                 aLogName.GetFullPath() ),
+                               RPT_SEVERITY_ERROR );
+            return false;
+        }
+
+        player.SetDebugEnabled( false );
+        player.SetAllocationCounter( []() -> uint64_t
+                                     {
+                                         return s_allocations;
+                                     } );
+        player.ReplayLog( &logFile, 0 );
+
+        const std::vector<PNS_LOG_PLAYER::EVENT_STATS>& stats = player.GetEventStats();
+        events.insert( events.end(), stats.begin(), stats.end() );
+    }
+
+    std::map<PNS::LOGGER::EVENT_TYPE, std::vector<PNS_LOG_PLAYER::EVENT_STATS>> eventsByType;
+
+    for( const PNS_LOG_PLAYER::EVENT_STATS& evt : events )
+        eventsByType[evt.m_type].push_back( evt );
+
+    aResult = summarize( events, aRuns );
+    aResult["name"] = aLogName.GetFullPath().ToStdString();
+
+    for( const auto& [type, typeEvents] : eventsByType )
+        aResult["per_event_type"][eventName( type )] = summarize( typeEvents, aRuns );
+
+    const nlohmann::json& latency = aResult["latency_us"];
+
+    aReporter->Report( wxString::Format( "%s: %d events, p50 %.1f us, p95 %.1f us, "
+                                         "p99 %.1f us, %d branches, %d collision queries, "
+                                         "%llu allocations",
+                                         aLogName.GetFullPath(),
+                                         aResult["events"].get<int>(),
+                                         latency["p50"].get<double>(),
+                                         latency["p95"].get<double>(),
+                                         latency["p99"].get<double>(),
+                                         aResult["branches"].get<int>(),
+                                         aResult["collision_queries"].get<int>(),
+                                         aResult["allocations"].get<unsigned long long>() ),
+                       RPT_SEVERITY_INFO );
+
+    return true;
+}
+
+
+int main( int argc, char* argv[] )
+{
+    wxInitialize( argc, argv );
+
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "P&S router benchmark. Replays the logs written by the ROUTER_TOOL "
+                               "and reports how long the router took to process each event." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cl_parser.Found( "help" ) )
+        return 0;
+
+    if( cmd_parsed_ok != 0 )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    long     runs = 5;
+    wxString outputPath;
+
+    cl_parser.Found( "runs", &runs );
+    cl_parser.Found( "output", &outputPath );
+
+    KI_TEST::CONSOLE_LOG          log;
+    KI_TEST::CONSOLE_MSG_REPORTER reporter( &log );
+
+    wxArrayString logFiles;
+    wxDir::GetAllFiles( cl_parser.GetParam( 0 ), &logFiles, wxT( "*.log" ) );
+    logFiles.Sort();
+
+    nlohmann::json results;
+    bool           ok = true;
+
+    results["runs"] = runs;
+    results["logs"] = nlohmann::json::array();
+
+    for( const wxString& logFile : logFiles )
+    {
+        wxFileName     logName( logFile );
+        nlohmann::json logResult;
+
+        logName.ClearExt();
+
+        if( benchmarkLog( logName, (int) runs, &reporter, logResult ) )
+            results["logs"].push_back( logResult );
+        else
+            ok = false;
+    }
+
+    if( !outputPath.IsEmpty() )
+    {
+        std::ofstream out( outputPath.ToStdString() );
+        out << std::setw( 2 ) << results << std::endl;
+    }
+
+    wxUninitialize();
+
+    return ok ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::TOOL_SPECIFIC;
+}
@@ -26,12 +26,16 @@
 #include "pns_log_player.h"
 
 #include <pcbnew_utils/board_test_utils.h>
+#include <profile.h>
 
 #define PNSLOGINFO PNS::DEBUG_DECORATOR::SRC_LOCATION_INFO( __FILE__, __FUNCTION__, __LINE__ )
 
 using namespace PNS;
 
-PNS_LOG_PLAYER::PNS_LOG_PLAYER()
+PNS_LOG_PLAYER::PNS_LOG_PLAYER() :
+        m_debugDecorator( nullptr ),
+        m_timeLimitUs( 0 ),
+        m_debugEnabled( true )
 {
     SetReporter( &NULL_REPORTER::GetInstance() );
 }
@@ -60,6 +64,7 @@ void PNS_LOG_PLAYER::createRouter()
 
     m_debugDecorator = new PNS_TEST_DEBUG_DECORATOR;
     m_debugDecorator->Clear();
+    m_debugDecorator->SetDebugEnabled( m_debugEnabled );
     m_iface->SetDebugDecorator( m_debugDecorator );
 }
 
@@ -95,6 +100,8 @@ void PNS_LOG_PLAYER::ReplayLog( PNS_LOG_FILE* aLog, int aStartEventIndex, int aF
     int eventIdx = 0;
     int totalEvents = aLog->Events().size();
 
+    m_eventStats.clear();
+
     for( auto evt : aLog->Events() )
     {
         if( eventIdx < aFrom || ( aTo >= 0 && eventIdx > aTo ) )
@@ -105,6 +112,16 @@ void PNS_LOG_PLAYER::ReplayLog( PNS_LOG_FILE* aLog, int aStartEventIndex, int aF
 
         eventIdx++;
 
+        PNS::NODE::STATS& nodeStats = m_router->GetWorld()->Stats();
+        EVENT_STATS       stats;
+
+        stats.m_type = evt.type;
+        stats.m_branches = nodeStats.m_branches;
+        stats.m_collisionQueries = nodeStats.m_collisionQueries;
+        stats.m_allocations = m_allocationCounter ? m_allocationCounter() : 0;
+
+        PROF_TIMER timer;
+
         switch( evt.type )
         {
         case LOGGER::EVT_START_ROUTE:
@@ -187,6 +204,17 @@ void PNS_LOG_PLAYER::ReplayLog( PNS_LOG_FILE* aLog, int aStartEventIndex, int aF
         default: break;
         }
 
+        timer.Stop();
+
+        stats.m_timeUs = timer.msecs() * 1000.0;
+        stats.m_branches = nodeStats.m_branches - stats.m_branches;
+        stats.m_collisionQueries = nodeStats.m_collisionQueries - stats.m_collisionQueries;
+
+        if( m_allocationCounter )
+            stats.m_allocations = m_allocationCounter() - stats.m_allocations;
+
+        m_eventStats.push_back( stats );
+
         PNS::NODE* node = nullptr;
 
 #if 0
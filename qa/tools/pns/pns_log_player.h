@@ -23,6 +23,7 @@
 #ifndef __PNS_LOG_PLAYER_H
 #define __PNS_LOG_PLAYER_H
 
+#include <functional>
 #include <map>
 #include <pcbnew/board.h>
 
@@ -79,6 +80,16 @@ private:
 class PNS_LOG_PLAYER
 {
 public:
+    ///< Cost of replaying a single log event, as gathered for the router benchmarks.
+    struct EVENT_STATS
+    {
+        PNS::LOGGER::EVENT_TYPE m_type;
+        double                  m_timeUs;
+        int                     m_branches;
+        int                     m_collisionQueries;
+        uint64_t                m_allocations;
+    };
+
     PNS_LOG_PLAYER();
     ~PNS_LOG_PLAYER();
 
@@ -91,6 +102,23 @@ public:
 
     void SetTimeLimit( uint64_t microseconds ) { m_timeLimitUs = microseconds; }
 
+    /**
+     * Enable or disable the debug decorator output. It is on by default; the benchmarks turn
+     * it off as it is expensive and forces the router onto a single thread.
+     */
+    void SetDebugEnabled( bool aEnabled ) { m_debugEnabled = aEnabled; }
+
+    /**
+     * Set the function returning the number of heap allocations made so far. The allocations
+     * aren't reported if it isn't set.
+     */
+    void SetAllocationCounter( std::function<uint64_t()> aCounter )
+    {
+        m_allocationCounter = aCounter;
+    }
+
+    const std::vector<EVENT_STATS>& GetEventStats() const { return m_eventStats; }
+
     bool CompareResults( PNS_LOG_FILE* aLog );
     const PNS_LOG_FILE::COMMIT_STATE GetRouterUpdatedItems();
 
@@ -104,6 +132,10 @@ private:
     std::unique_ptr<PNS::ROUTER>          m_router;
     uint64_t m_timeLimitUs;
     REPORTER* m_reporter;
+    bool      m_debugEnabled;
+
+    std::function<uint64_t()> m_allocationCounter;
+    std::vector<EVENT_STATS>  m_eventStats;
 };
 
 #endif
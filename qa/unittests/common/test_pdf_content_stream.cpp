@@ -0,0 +1,179 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for PDF_CONTENT_STREAM: the PDF operators it formats must be the same as the ones
+ * formatted by printf before
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+// Code under test
+#include <plotters/pdf_content_stream.h>
+
+#include <locale_io.h>
+
+#include <wx/mstream.h>
+#include <wx/zstream.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+
+class TEST_PDF_CONTENT_STREAM_FIXTURE
+{
+public:
+    TEST_PDF_CONTENT_STREAM_FIXTURE()
+    {
+        m_file = tmpfile();
+        BOOST_REQUIRE( m_file );
+    }
+
+    ~TEST_PDF_CONTENT_STREAM_FIXTURE()
+    {
+        fclose( m_file );
+    }
+
+    /**
+     * Print the usual PDF_PLOTTER operators to \a aStream, with values of all magnitudes, and
+     * return the same content formatted with printf, which PDF_PLOTTER used before.
+     */
+    std::string PrintOperators( PDF_CONTENT_STREAM& aStream )
+    {
+        // The plotter runs with the C locale
+        LOCALE_IO toggle;
+
+        std::mt19937                           rng( 0 );
+        std::uniform_real_distribution<double> mantissa( -1.0, 1.0 );
+        std::uniform_int_distribution<int>     exponent( -12, 12 );
+        std::uniform_int_distribution<int>     length( 0, 100000 );
+        std::string                            expected;
+        char                                   buffer[256];
+
+        auto value =
+                [&]() -> double
+                {
+                    return mantissa( rng ) * std::pow( 10.0, exponent( rng ) );
+                };
+
+        // Enough content to fill the buffer several times
+        for( int ii = 0; ii < 20000; ii++ )
+        {
+            double x = value();
+            double y = value();
+            double w = value();
+            double h = value();
+            int    dash = length( rng );
+            char   op = ( ii % 2 ) ? 'S' : 'B';
+
+            aStream.Print( "{:g} {:g} {:g} {:g} re {}\n", x, y, w, h, op );
+            snprintf( buffer, sizeof( buffer ), "%g %g %g %g re %c\n", x, y, w, h, op );
+            expected += buffer;
+
+            aStream.Print( "{:g} {:g} m ", x, y );
+            snprintf( buffer, sizeof( buffer ), "%g %g m ", x, y );
+            expected += buffer;
+
+            aStream.Print( "[{} {}] 0 d\n", dash, -dash );
+            snprintf( buffer, sizeof( buffer ), "[%d %d] 0 d\n", dash, -dash );
+            expected += buffer;
+
+            aStream.Print( "q {:f} {:f} {:f} {:f} {:g} {:g} cm BT {} {:g} Tf {} Tr {:g} Tz ",
+                           x, y, w, h, x, y, "/KicadFont", h, ii % 3, w * 100 );
+            snprintf( buffer, sizeof( buffer ),
+                      "q %f %f %f %f %g %g cm BT %s %g Tf %d Tr %g Tz ",
+                      x, y, w, h, x, y, "/KicadFont", h, ii % 3, w * 100 );
+            expected += buffer;
+
+            aStream.Write( "S\n" );
+            expected += "S\n";
+        }
+
+        // A few values that are formatted differently
+        for( double special : { 0.0, -0.0, 1.0, 0.1, 1e-5, 1e-4, 123456.0, 1234567.0, 1e100 } )
+        {
+            aStream.Print( "{:g} {:f} w\n", special, special );
+            snprintf( buffer, sizeof( buffer ), "%g %f w\n", special, special );
+            expected += buffer;
+        }
+
+        return expected;
+    }
+
+    std::string ReadFile()
+    {
+        std::string content( ftell( m_file ), '\0' );
+
+        rewind( m_file );
+        BOOST_REQUIRE_EQUAL( fread( content.data(), 1, content.size(), m_file ), content.size() );
+
+        return content;
+    }
+
+    FILE* m_file;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PdfContentStream, TEST_PDF_CONTENT_STREAM_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( SameAsPrintf )
+{
+    PDF_CONTENT_STREAM stream( m_file, false );
+    std::string        expected = PrintOperators( stream );
+    size_t             written = stream.Finish();
+
+    BOOST_CHECK_EQUAL( written, expected.size() );
+    BOOST_CHECK_EQUAL( stream.GetRawSize(), expected.size() );
+
+    // Byte for byte, but don't dump megabytes of text if it fails
+    BOOST_CHECK( ReadFile() == expected );
+}
+
+
+BOOST_AUTO_TEST_CASE( Compressed )
+{
+    PDF_CONTENT_STREAM stream( m_file, true );
+    std::string        expected = PrintOperators( stream );
+    size_t             written = stream.Finish();
+    std::string        compressed = ReadFile();
+
+    BOOST_CHECK_EQUAL( stream.GetRawSize(), expected.size() );
+    BOOST_CHECK_EQUAL( written, compressed.size() );
+    BOOST_CHECK_LT( written, expected.size() );
+
+    wxMemoryInputStream mis( compressed.data(), compressed.size() );
+    wxZlibInputStream   zis( mis, wxZLIB_ZLIB );
+    std::string         inflated;
+    char                buffer[4096];
+
+    while( zis.Read( buffer, sizeof( buffer ) ).LastRead() > 0 )
+        inflated.append( buffer, zis.LastRead() );
+
+    BOOST_CHECK( inflated == expected );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,208 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for RTree::BulkLoad(), used to build the VIEW trees: a bulk-loaded tree must find
+ * the same entries as a tree built by inserting them one by one
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <geometry/rtree.h>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+
+// Same parameters as the VIEW trees
+typedef RTree<int, int, 2, double> TEST_RTREE;
+
+
+struct RTREE_BULK_LOAD_FIXTURE
+{
+    RTREE_BULK_LOAD_FIXTURE() :
+            m_random( 42 )
+    {
+    }
+
+    /**
+     * Fill m_entries with \a aCount boxes of all sizes, the data being the index of the box.
+     */
+    void MakeEntries( int aCount )
+    {
+        std::uniform_int_distribution<int> position( -1000000, 1000000 );
+        std::uniform_int_distribution<int> size( 0, 20000 );
+
+        m_entries.clear();
+
+        for( int ii = 0; ii < aCount; ++ii )
+        {
+            TEST_RTREE::Rect rect;
+
+            for( int axis = 0; axis < 2; ++axis )
+            {
+                rect.m_min[axis] = position( m_random );
+                rect.m_max[axis] = rect.m_min[axis] + size( m_random ) * ( ii % 10 == 0 ? 20 : 1 );
+            }
+
+            m_entries.emplace_back( rect, ii );
+        }
+    }
+
+    /**
+     * Return the sorted data of the entries of \a aTree overlapping \a aRect.
+     */
+    static std::vector<int> Search( const TEST_RTREE& aTree, const TEST_RTREE::Rect& aRect )
+    {
+        std::vector<int> found;
+
+        aTree.Search( aRect.m_min, aRect.m_max,
+                      [&]( const int& aData )
+                      {
+                          found.push_back( aData );
+                          return true;
+                      } );
+
+        std::sort( found.begin(), found.end() );
+        return found;
+    }
+
+    /**
+     * Check that \a aBulk and \a aInserted find the same entries in many windows, from
+     * empty ones to the whole space.
+     */
+    void CheckSameResults( const TEST_RTREE& aBulk, const TEST_RTREE& aInserted )
+    {
+        std::uniform_int_distribution<int> position( -1100000, 1100000 );
+        std::uniform_int_distribution<int> size( 0, 300000 );
+
+        for( int ii = 0; ii < 200; ++ii )
+        {
+            TEST_RTREE::Rect window;
+
+            for( int axis = 0; axis < 2; ++axis )
+            {
+                window.m_min[axis] = position( m_random );
+                window.m_max[axis] = window.m_min[axis] + size( m_random );
+            }
+
+            BOOST_CHECK( Search( aBulk, window ) == Search( aInserted, window ) );
+        }
+
+        const int        lowest = std::numeric_limits<int>::lowest();
+        const int        highest = std::numeric_limits<int>::max();
+        TEST_RTREE::Rect all = { { lowest, lowest }, { highest, highest } };
+
+        BOOST_CHECK( Search( aBulk, all ) == Search( aInserted, all ) );
+        BOOST_CHECK_EQUAL( aBulk.Count(), aInserted.Count() );
+    }
+
+    std::mt19937                                  m_random;
+    std::vector<std::pair<TEST_RTREE::Rect, int>> m_entries;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( RTreeBulkLoad, RTREE_BULK_LOAD_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( SameAsInsert )
+{
+    const int maxNodes = TEST_RTREE::MAXNODES;
+
+    // From an empty tree to several levels
+    for( int count : { 0, 1, maxNodes, maxNodes + 1, 1000, 20000 } )
+    {
+        BOOST_TEST_CONTEXT( count << " entries" )
+        {
+            MakeEntries( count );
+
+            TEST_RTREE inserted;
+
+            for( const auto& [ rect, data ] : m_entries )
+                inserted.Insert( rect.m_min, rect.m_max, data );
+
+            TEST_RTREE bulk;
+
+            // Loading replaces the previous content
+            TEST_RTREE::Rect stale = { { 0, 0 }, { 1, 1 } };
+
+            bulk.Insert( stale.m_min, stale.m_max, count );
+            bulk.BulkLoad( m_entries );
+
+            BOOST_CHECK_EQUAL( bulk.Count(), count );
+            CheckSameResults( bulk, inserted );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( EditAfterBulkLoad )
+{
+    MakeEntries( 20000 );
+
+    std::vector<std::pair<TEST_RTREE::Rect, int>> entries = m_entries;
+    TEST_RTREE                                    inserted;
+    TEST_RTREE                                    bulk;
+
+    for( const auto& [ rect, data ] : entries )
+        inserted.Insert( rect.m_min, rect.m_max, data );
+
+    bulk.BulkLoad( m_entries );
+
+    // Remove returns false on success
+    for( size_t ii = 0; ii < entries.size(); ii += 3 )
+    {
+        const auto& [ rect, data ] = entries[ii];
+
+        BOOST_CHECK( !inserted.Remove( rect.m_min, rect.m_max, data ) );
+        BOOST_CHECK( !bulk.Remove( rect.m_min, rect.m_max, data ) );
+    }
+
+    CheckSameResults( bulk, inserted );
+
+    // Items moved after the loading are removed and inserted again
+    for( size_t ii = 1; ii < entries.size(); ii += 5 )
+    {
+        if( ii % 3 == 0 )
+            continue;
+
+        auto& [ rect, data ] = entries[ii];
+
+        inserted.Remove( rect.m_min, rect.m_max, data );
+        bulk.Remove( rect.m_min, rect.m_max, data );
+
+        rect.m_min[0] += 5000;
+        rect.m_max[0] += 5000;
+
+        inserted.Insert( rect.m_min, rect.m_max, data );
+        bulk.Insert( rect.m_min, rect.m_max, data );
+    }
+
+    CheckSameResults( bulk, inserted );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,178 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the indexed loading of the s-expression symbol library cache.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+// Code under test
+#include <sch_plugins/kicad/sch_sexpr_lib_plugin_cache.h>
+
+#include <lib_symbol.h>
+#include <sch_file_versions.h>
+
+#include <wx/ffile.h>
+#include <wx/textfile.h>
+
+
+class TEST_SEXPR_LIB_CACHE_FIXTURE
+{
+public:
+    TEST_SEXPR_LIB_CACHE_FIXTURE()
+    {
+        m_libFile = wxFileName::CreateTempFileName( wxT( "qa_sexpr_lib" ) );
+        wxRemoveFile( m_libFile.GetFullPath() );
+        m_libFile.SetExt( wxT( "kicad_sym" ) );
+
+        wxFFile file( m_libFile.GetFullPath(), wxT( "wb" ) );
+
+        file.Write( wxString::Format(
+                "(kicad_symbol_lib (version %d) (generator kicad_symbol_editor)\n"
+                "  (symbol \"R\" (in_bom yes) (on_board yes)\n"
+                "    (property \"Reference\" \"R\" (id 0) (at 0 0 0)\n"
+                "      (effects (font (size 1.27 1.27))))\n"
+                "    (property \"Description\" \"(not a symbol\" (id 4) (at 0 0 0)\n"
+                "      (effects (font (size 1.27 1.27)) hide))\n"
+                "  )\n"
+                "  (symbol \"R_Small\" (extends \"R\")\n"
+                "    (property \"Reference\" \"R\" (id 0) (at 0 0 0)\n"
+                "      (effects (font (size 1.27 1.27))))\n"
+                "  )\n"
+                "  (symbol \"GND\" (power) (in_bom yes) (on_board yes))\n"
+                "  (symbol \"GND_Alt\" (extends \"GND\"))\n"
+                ")\n", SEXPR_SYMBOL_LIB_FILE_VERSION ) );
+        file.Close();
+    }
+
+    ~TEST_SEXPR_LIB_CACHE_FIXTURE()
+    {
+        wxRemoveFile( m_libFile.GetFullPath() );
+    }
+
+    wxFileName m_libFile;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SchSexprLibCache, TEST_SEXPR_LIB_CACHE_FIXTURE )
+
+
+/**
+ * Check the index finds every top level symbol without parsing any of them.
+ */
+BOOST_AUTO_TEST_CASE( IndexNames )
+{
+    SCH_SEXPR_PLUGIN_CACHE cache( m_libFile.GetFullPath() );
+
+    BOOST_REQUIRE( cache.LoadIndex() );
+    BOOST_CHECK( cache.IsIndexOnly() );
+
+    wxArrayString names;
+    cache.GetIndexedSymbolNames( names, false );
+
+    BOOST_CHECK_EQUAL( names.size(), 4u );
+
+    wxArrayString powerNames;
+    cache.GetIndexedSymbolNames( powerNames, true );
+
+    BOOST_REQUIRE_EQUAL( powerNames.size(), 2u );
+    BOOST_CHECK_EQUAL( powerNames[0], wxT( "GND" ) );
+    BOOST_CHECK_EQUAL( powerNames[1], wxT( "GND_Alt" ) );
+}
+
+
+/**
+ * Check that a derived symbol is loaded together with its parent.
+ */
+BOOST_AUTO_TEST_CASE( LoadDerived )
+{
+    SCH_SEXPR_PLUGIN_CACHE cache( m_libFile.GetFullPath() );
+
+    BOOST_REQUIRE( cache.LoadIndex() );
+
+    LIB_SYMBOL* symbol = cache.LoadIndexedSymbol( wxT( "R_Small" ) );
+
+    BOOST_REQUIRE( symbol );
+    BOOST_CHECK_EQUAL( symbol->GetName(), wxT( "R_Small" ) );
+    BOOST_REQUIRE( symbol->IsAlias() );
+    BOOST_CHECK_EQUAL( symbol->GetParent().lock()->GetName(), wxT( "R" ) );
+
+    BOOST_CHECK_EQUAL( cache.LoadIndexedSymbol( wxT( "R" ) ), symbol->GetParent().lock().get() );
+    BOOST_CHECK( cache.LoadIndexedSymbol( wxT( "C" ) ) == nullptr );
+
+    // Completing the load must keep the symbols already handed out.
+    cache.Load();
+
+    BOOST_CHECK( !cache.IsIndexOnly() );
+    BOOST_CHECK_EQUAL( cache.LoadIndexedSymbol( wxT( "R_Small" ) ), symbol );
+}
+
+
+/**
+ * Check that a truncated index cache file is rebuilt instead of dropping symbols.
+ */
+BOOST_AUTO_TEST_CASE( TruncatedIndexCache )
+{
+    wxFileName cacheFile;
+
+    {
+        SCH_SEXPR_PLUGIN_CACHE cache( m_libFile.GetFullPath() );
+
+        BOOST_REQUIRE( cache.LoadIndex() );
+        cacheFile = cache.GetIndexCacheFile();
+    }
+
+    BOOST_REQUIRE( cacheFile.FileExists() );
+
+    // In the middle of the last entry, then at the end of the previous one
+    for( size_t lines : { 1u, 5u } )
+    {
+        wxTextFile file( cacheFile.GetFullPath() );
+
+        BOOST_REQUIRE( file.Open() );
+        BOOST_REQUIRE( file.GetLineCount() > 6 + lines );
+
+        for( size_t ii = 0; ii < lines; ++ii )
+            file.RemoveLine( file.GetLineCount() - 1 );
+
+        BOOST_REQUIRE( file.Write() );
+        file.Close();
+
+        SCH_SEXPR_PLUGIN_CACHE cache( m_libFile.GetFullPath() );
+
+        BOOST_REQUIRE( cache.LoadIndex() );
+
+        wxArrayString names;
+        cache.GetIndexedSymbolNames( names, false );
+
+        BOOST_CHECK_EQUAL( names.size(), 4u );
+        BOOST_CHECK( cache.LoadIndexedSymbol( wxT( "GND_Alt" ) ) != nullptr );
+    }
+
+    wxRemoveFile( cacheFile.GetFullPath() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
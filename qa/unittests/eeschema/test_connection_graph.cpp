@@ -0,0 +1,348 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * Test suite for CONNECTION_GRAPH::RecalculateIncremental(): after an edit, the incremental
+ * update must give the same nets as a full recalculation
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include "eeschema_test_utils.h"
+
+#include <connection_graph.h>
+#include <lib_symbol.h>
+#include <locale_io.h>
+#include <sch_label.h>
+#include <sch_line.h>
+#include <sch_screen.h>
+#include <sch_symbol.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <tuple>
+
+
+/**
+ * What a net map describes, by net name: the net codes of both calculations may differ, but
+ * the items are the same objects.
+ */
+struct NET_SNAPSHOT
+{
+    /// Net name -> ( sheet path, item )
+    std::map<wxString, std::set<std::pair<wxString, SCH_ITEM*>>> m_netItems;
+
+    /// ( net name, sheet path, driver )
+    std::set<std::tuple<wxString, wxString, SCH_ITEM*>> m_drivers;
+};
+
+
+class TEST_CONNECTION_GRAPH_FIXTURE : public KI_TEST::SCHEMATIC_TEST_FIXTURE
+{
+public:
+    ~TEST_CONNECTION_GRAPH_FIXTURE()
+    {
+        // Removed items are only deleted now: the graph may still know their address
+        for( SCH_ITEM* item : m_removedItems )
+            delete item;
+    }
+
+    /**
+     * Load the hierarchy, whose sub-sheet is used twice: an edit there changes the nets of
+     * both sheet instances.
+     */
+    SCH_SCREEN* LoadSubSheet()
+    {
+        LoadSchematic( "complex_hierarchy" );
+
+        for( const SCH_SHEET_PATH& sheet : m_schematic.GetSheets() )
+        {
+            if( sheet.LastScreen()->GetFileName().EndsWith( wxT( "ampli_ht.kicad_sch" ) ) )
+                return sheet.LastScreen();
+        }
+
+        BOOST_FAIL( "Sub-sheet not found" );
+        return nullptr;
+    }
+
+    NET_SNAPSHOT Snapshot()
+    {
+        NET_SNAPSHOT snapshot;
+
+        for( const auto& [ key, subgraphs ] : m_schematic.ConnectionGraph()->GetNetMap() )
+        {
+            for( CONNECTION_SUBGRAPH* subgraph : subgraphs )
+            {
+                wxString netName = subgraph->GetNetName();
+                wxString path = subgraph->m_sheet.Path().AsString();
+
+                for( SCH_ITEM* item : subgraph->m_items )
+                    snapshot.m_netItems[ netName ].emplace( path, item );
+
+                snapshot.m_drivers.emplace( netName, path, subgraph->m_driver );
+            }
+        }
+
+        return snapshot;
+    }
+
+    /**
+     * Update the graph incrementally after an edit, and compare it to a full recalculation.
+     *
+     * @param aMustBeIncremental is true for the edits that must not fall back to a full
+     *                           recalculation.
+     */
+    void CheckIncremental( bool aMustBeIncremental )
+    {
+        CONNECTION_GRAPH* graph = m_schematic.ConnectionGraph();
+        SCH_SHEET_LIST    sheets = m_schematic.GetSheets();
+
+        bool         incremental = graph->RecalculateIncremental( sheets );
+        NET_SNAPSHOT updated = Snapshot();
+
+        BOOST_TEST_MESSAGE( ( incremental ? "Incremental update" : "Full update" ) );
+
+        if( aMustBeIncremental )
+            BOOST_CHECK( incremental );
+
+        graph->Recalculate( sheets, true );
+
+        NET_SNAPSHOT rebuilt = Snapshot();
+
+        BOOST_CHECK_EQUAL( updated.m_netItems.size(), rebuilt.m_netItems.size() );
+
+        for( const auto& [ netName, items ] : rebuilt.m_netItems )
+        {
+            BOOST_CHECK_MESSAGE( updated.m_netItems[ netName ] == items,
+                                 "Net " << netName << " differs" );
+        }
+
+        BOOST_CHECK( updated.m_drivers == rebuilt.m_drivers );
+    }
+
+    void Add( SCH_SCREEN* aScreen, SCH_ITEM* aItem )
+    {
+        aItem->SetConnectivityDirty();
+        aScreen->Append( aItem );
+    }
+
+    void Remove( SCH_SCREEN* aScreen, SCH_ITEM* aItem )
+    {
+        BOOST_REQUIRE( aScreen->Remove( aItem ) );
+        m_removedItems.push_back( aItem );
+    }
+
+    std::vector<SCH_LINE*> Wires( SCH_SCREEN* aScreen )
+    {
+        std::vector<SCH_LINE*> wires;
+
+        for( SCH_ITEM* item : aScreen->Items().OfType( SCH_LINE_T ) )
+        {
+            if( static_cast<SCH_LINE*>( item )->IsWire() )
+                wires.push_back( static_cast<SCH_LINE*>( item ) );
+        }
+
+        BOOST_REQUIRE( wires.size() >= 2 );
+        return wires;
+    }
+
+    /**
+     * Return the wires of \a aScreen, from the ones on the smallest nets: the edits of those
+     * are far below the size where a full recalculation is cheaper.
+     */
+    std::vector<SCH_LINE*> WiresOnSmallNets( SCH_SCREEN* aScreen )
+    {
+        CONNECTION_GRAPH*                            graph = m_schematic.ConnectionGraph();
+        std::map<const CONNECTION_SUBGRAPH*, size_t> netSizes;
+
+        for( const auto& [ key, subgraphs ] : graph->GetNetMap() )
+        {
+            size_t size = 0;
+
+            for( CONNECTION_SUBGRAPH* subgraph : subgraphs )
+                size += subgraph->m_items.size();
+
+            for( CONNECTION_SUBGRAPH* subgraph : subgraphs )
+                netSizes[ subgraph ] = size;
+        }
+
+        std::vector<SCH_LINE*> wires = Wires( aScreen );
+
+        auto netSize =
+                [&]( SCH_LINE* aWire ) -> size_t
+                {
+                    CONNECTION_SUBGRAPH* subgraph = graph->GetSubgraphForItem( aWire );
+
+                    if( !subgraph )
+                        return 0;
+
+                    auto it = netSizes.find( subgraph );
+                    return it != netSizes.end() ? it->second : subgraph->m_items.size();
+                };
+
+        std::stable_sort( wires.begin(), wires.end(),
+                          [&]( SCH_LINE* aLhs, SCH_LINE* aRhs )
+                          {
+                              return netSize( aLhs ) < netSize( aRhs );
+                          } );
+
+        return wires;
+    }
+
+    SCH_SYMBOL* FirstSymbol( SCH_SCREEN* aScreen )
+    {
+        for( SCH_ITEM* item : aScreen->Items().OfType( SCH_SYMBOL_T ) )
+        {
+            SCH_SYMBOL* symbol = static_cast<SCH_SYMBOL*>( item );
+
+            if( symbol->GetLibSymbolRef() && !symbol->GetLibSymbolRef()->IsPower() )
+                return symbol;
+        }
+
+        BOOST_FAIL( "No symbol found" );
+        return nullptr;
+    }
+
+    std::vector<SCH_ITEM*> m_removedItems;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ConnectionGraph, TEST_CONNECTION_GRAPH_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( IncrementalAddWire )
+{
+    LOCALE_IO   dummy;
+    SCH_SCREEN* screen = LoadSubSheet();
+
+    // Over a wire of a small net: only that net changes
+    SCH_LINE* smallNetWire = WiresOnSmallNets( screen ).front();
+    SCH_LINE* wire = new SCH_LINE( smallNetWire->GetStartPoint(), LAYER_WIRE );
+
+    wire->SetEndPoint( smallNetWire->GetEndPoint() );
+    Add( screen, wire );
+
+    CheckIncremental( true );
+
+    // Join two nets.  The new wire may cross a large part of the sheet.
+    std::vector<SCH_LINE*> wires = Wires( screen );
+
+    wire = new SCH_LINE( wires.front()->GetStartPoint(), LAYER_WIRE );
+    wire->SetEndPoint( wires.back()->GetEndPoint() );
+    Add( screen, wire );
+
+    CheckIncremental( false );
+}
+
+
+BOOST_AUTO_TEST_CASE( IncrementalRemoveWire )
+{
+    LOCALE_IO   dummy;
+    SCH_SCREEN* screen = LoadSubSheet();
+
+    std::vector<SCH_LINE*> wires = WiresOnSmallNets( screen );
+
+    // Splitting a small net
+    Remove( screen, wires.front() );
+    CheckIncremental( true );
+
+    // The others may be on large nets, which are recalculated in full
+    for( size_t ii = 1; ii < wires.size(); ++ii )
+    {
+        Remove( screen, wires[ii] );
+        CheckIncremental( false );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( IncrementalAddLabel )
+{
+    LOCALE_IO   dummy;
+    SCH_SCREEN* screen = LoadSubSheet();
+
+    CONNECTION_GRAPH*      graph = m_schematic.ConnectionGraph();
+    std::vector<SCH_LINE*> wires = WiresOnSmallNets( screen );
+    SCH_LINE*              other = nullptr;
+
+    for( SCH_LINE* wire : wires )
+    {
+        if( graph->GetSubgraphForItem( wire ) != graph->GetSubgraphForItem( wires.front() ) )
+        {
+            other = wire;
+            break;
+        }
+    }
+
+    BOOST_REQUIRE( other );
+
+    // A new net name, then the same name on another small net to join them
+    Add( screen, new SCH_LABEL( wires.front()->GetStartPoint(), wxT( "INCREMENTAL" ) ) );
+    CheckIncremental( true );
+
+    Add( screen, new SCH_LABEL( other->GetStartPoint(), wxT( "INCREMENTAL" ) ) );
+    CheckIncremental( true );
+}
+
+
+BOOST_AUTO_TEST_CASE( IncrementalRemoveLabel )
+{
+    LOCALE_IO   dummy;
+    SCH_SCREEN* screen = LoadSubSheet();
+
+    std::vector<SCH_ITEM*> labels;
+
+    for( SCH_ITEM* item : screen->Items().OfType( SCH_LABEL_T ) )
+        labels.push_back( item );
+
+    BOOST_REQUIRE( !labels.empty() );
+
+    // Removing a label only rebuilds the net it named
+    for( SCH_ITEM* label : labels )
+    {
+        Remove( screen, label );
+        CheckIncremental( true );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( IncrementalAddSymbol )
+{
+    LOCALE_IO   dummy;
+    SCH_SCREEN* screen = LoadSubSheet();
+
+    // On top of the original: each pin joins the net of the pin it overlaps
+    Add( screen, FirstSymbol( screen )->Duplicate() );
+
+    CheckIncremental( false );
+}
+
+
+BOOST_AUTO_TEST_CASE( IncrementalRemoveSymbol )
+{
+    LOCALE_IO   dummy;
+    SCH_SCREEN* screen = LoadSubSheet();
+
+    Remove( screen, FirstSymbol( screen ) );
+
+    CheckIncremental( false );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
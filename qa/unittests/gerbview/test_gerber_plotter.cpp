@@ -0,0 +1,245 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for GERBER_PLOTTER: the files it writes are read back by GerbView
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+// Code under test
+#include <plotters/plotter_gerber.h>
+
+#include <base_units.h>
+#include <gbr_metadata.h>
+#include <geometry/shape_poly_set.h>
+#include <trigo.h>
+
+#include <dcode.h>
+#include <gerber_draw_item.h>
+#include <gerber_file_image.h>
+
+#include <wx/filename.h>
+
+#include <set>
+
+
+// VECTOR2I's operator< compares the lengths, use the coordinates to store positions in sets
+using POSITION = std::pair<int, int>;
+
+
+static POSITION toPosition( const VECTOR2I& aPos )
+{
+    return { aPos.x, aPos.y };
+}
+
+
+class TEST_GERBER_PLOTTER_FIXTURE
+{
+public:
+    TEST_GERBER_PLOTTER_FIXTURE()
+    {
+        m_gbrFile = wxFileName::CreateTempFileName( wxT( "qa_gerber_plotter" ) );
+        wxRemoveFile( m_gbrFile.GetFullPath() );
+        m_gbrFile.SetExt( wxT( "gbr" ) );
+    }
+
+    ~TEST_GERBER_PLOTTER_FIXTURE()
+    {
+        wxRemoveFile( m_gbrFile.GetFullPath() );
+    }
+
+    /**
+     * Open a plotter on the test file, using the GerbView internal units as plotter units
+     * so that the coordinates read back can be compared to the plotted ones.
+     */
+    void StartPlot( GERBER_PLOTTER& aPlotter )
+    {
+        aPlotter.SetViewport( VECTOR2I( 0, 0 ), gerbIUScale.IU_PER_MILS / 10, 1.0, false );
+        aPlotter.SetGerberCoordinatesFormat( 6 );
+        aPlotter.AddLineToHeader( wxT( "%TF.GenerationSoftware,KiCad,Pcbnew,qa*%" ) );
+        aPlotter.AddLineToHeader( wxT( "%TF.FileFunction,Copper,L1,Top*%" ) );
+
+        BOOST_REQUIRE( aPlotter.OpenFile( m_gbrFile.GetFullPath() ) );
+        BOOST_REQUIRE( aPlotter.StartPlot( wxT( "1" ) ) );
+    }
+
+    /**
+     * The outline of an L shaped custom pad at \a aPos, rotated by \a aOrient.
+     */
+    SHAPE_POLY_SET CustomPadShape( const VECTOR2I& aPos, const EDA_ANGLE& aOrient )
+    {
+        const int      mm = gerbIUScale.mmToIU( 1 );
+        SHAPE_POLY_SET shape;
+
+        shape.NewOutline();
+
+        for( VECTOR2I corner : { VECTOR2I( -mm, -mm ), VECTOR2I( mm, -mm ), VECTOR2I( mm, 0 ),
+                                 VECTOR2I( 0, 0 ), VECTOR2I( 0, mm ), VECTOR2I( -mm, mm ) } )
+        {
+            RotatePoint( corner, aOrient );
+            shape.Append( corner + aPos );
+        }
+
+        return shape;
+    }
+
+    wxFileName m_gbrFile;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( GerberPlotter, TEST_GERBER_PLOTTER_FIXTURE )
+
+
+/**
+ * Plot the same custom pad many times, round pads, a track and an arc, and check GerbView
+ * reads back the same items, with their X2 attributes, and that the repeated pads share their
+ * aperture (and aperture macro).
+ */
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    const int          mm = gerbIUScale.mmToIU( 1 );
+    const int          padCount = 100;
+    std::set<POSITION> padPositions;
+
+    GBR_METADATA padMetadata;
+    padMetadata.SetApertureAttrib( GBR_APERTURE_METADATA::GBR_APERTURE_ATTRIB_SMDPAD_CUDEF );
+    padMetadata.SetNetAttribType( GBR_NETLIST_METADATA::GBR_NETINFO_NET );
+    padMetadata.SetNetName( wxT( "GND" ) );
+    padMetadata.SetCopper( true );
+
+    GBR_METADATA trackMetadata;
+    trackMetadata.SetApertureAttrib( GBR_APERTURE_METADATA::GBR_APERTURE_ATTRIB_CONDUCTOR );
+    trackMetadata.SetNetAttribType( GBR_NETLIST_METADATA::GBR_NETINFO_NET );
+    trackMetadata.SetNetName( wxT( "VCC" ) );
+    trackMetadata.SetCopper( true );
+
+    {
+        GERBER_PLOTTER plotter;
+        StartPlot( plotter );
+
+        // Around the origin, to get negative coordinates too
+        for( int ii = 0; ii < padCount; ii++ )
+        {
+            VECTOR2I  pos( ( ii % 10 - 5 ) * 5 * mm, ( ii / 10 - 5 ) * 5 * mm );
+            EDA_ANGLE orient = ( ii % 2 ) ? ANGLE_90 : ANGLE_0;
+
+            SHAPE_POLY_SET shape = CustomPadShape( pos, orient );
+
+            plotter.FlashPadCustom( pos, VECTOR2I( 2 * mm, 2 * mm ), orient, &shape, FILLED,
+                                    &padMetadata );
+            padPositions.insert( toPosition( pos ) );
+        }
+
+        for( int ii = 0; ii < padCount; ii++ )
+        {
+            VECTOR2I pos( ( ii % 10 - 5 ) * 5 * mm + 2 * mm, ( ii / 10 - 5 ) * 5 * mm + 2 * mm );
+
+            plotter.FlashPadCircle( pos, mm, FILLED, &padMetadata );
+            padPositions.insert( toPosition( pos ) );
+        }
+
+        plotter.ThickSegment( VECTOR2I( -30 * mm, -30 * mm ), VECTOR2I( 30 * mm, 30 * mm ),
+                              mm / 4, FILLED, &trackMetadata );
+        plotter.ThickArc( VECTOR2I( 0, 0 ), VECTOR2I( 35 * mm, 0 ), VECTOR2I( 0, -35 * mm ),
+                          mm / 4, FILLED, &trackMetadata );
+
+        BOOST_REQUIRE( plotter.EndPlot() );
+    }
+
+    GERBER_FILE_IMAGE image( 0 );
+
+    BOOST_REQUIRE( image.LoadGerberFile( m_gbrFile.GetFullPath() ) );
+
+    BOOST_CHECK( image.m_IsX2_file );
+    BOOST_CHECK( image.m_FileFunction != nullptr );
+    BOOST_REQUIRE_EQUAL( image.GetItemsCount(), 2 * padCount + 2 );
+
+    // The custom pads in both orientations, the round pads and the track width
+    BOOST_CHECK_EQUAL( image.GetDcodesCount(), 4 );
+
+    std::set<int>      customPadDcodes;
+    std::set<POSITION> flashedPositions;
+    int                segmentCount = 0;
+    int                arcCount = 0;
+
+    for( GERBER_DRAW_ITEM* item : image.GetItems() )
+    {
+        D_CODE* dcode = item->GetDcodeDescr();
+        BOOST_REQUIRE( dcode );
+
+        if( item->m_Flashed )
+        {
+            BOOST_CHECK_EQUAL( dcode->m_AperFunction, wxT( "SMDPad,CuDef" ) );
+            BOOST_CHECK_EQUAL( item->GetNetAttributes().m_Netname, wxT( "GND" ) );
+
+            flashedPositions.insert( toPosition( item->GetABPosition( item->m_Start ) ) );
+
+            if( item->Shape() == GBR_SPOT_MACRO )
+                customPadDcodes.insert( item->m_DCode );
+            else
+                BOOST_CHECK_EQUAL( item->Shape(), GBR_SPOT_CIRCLE );
+        }
+        else
+        {
+            BOOST_CHECK_EQUAL( dcode->m_AperFunction, wxT( "Conductor" ) );
+            BOOST_CHECK_EQUAL( item->GetNetAttributes().m_Netname, wxT( "VCC" ) );
+
+            VECTOR2I start = item->GetABPosition( item->m_Start );
+            VECTOR2I end = item->GetABPosition( item->m_End );
+
+            if( item->Shape() == GBR_ARC )
+            {
+                // The plotter may reverse the arc
+                if( start.x == 0 )
+                    std::swap( start, end );
+
+                BOOST_CHECK( item->GetABPosition( item->m_ArcCentre ) == VECTOR2I( 0, 0 ) );
+                BOOST_CHECK( start == VECTOR2I( 35 * mm, 0 ) );
+                BOOST_CHECK( end == VECTOR2I( 0, -35 * mm ) );
+                arcCount++;
+            }
+            else
+            {
+                BOOST_CHECK_EQUAL( item->Shape(), GBR_SEGMENT );
+                BOOST_CHECK( start == VECTOR2I( -30 * mm, -30 * mm ) );
+                BOOST_CHECK( end == VECTOR2I( 30 * mm, 30 * mm ) );
+                segmentCount++;
+            }
+        }
+    }
+
+    BOOST_CHECK_EQUAL( segmentCount, 1 );
+    BOOST_CHECK_EQUAL( arcCount, 1 );
+
+    // One aperture per orientation, both using the same aperture macro
+    BOOST_REQUIRE_EQUAL( customPadDcodes.size(), 2 );
+    BOOST_CHECK( image.GetDCODE( *customPadDcodes.begin() )->GetMacro()
+                 == image.GetDCODE( *customPadDcodes.rbegin() )->GetMacro() );
+
+    BOOST_CHECK( flashedPositions == padPositions );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,171 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the effective polygon of pads: it is shared by the pads having the same
+ * geometry and moved to each of them, which must give the same vertices as building it in place
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <board.h>
+#include <board_design_settings.h>
+#include <convert_basic_shapes_to_polygon.h>
+#include <footprint.h>
+#include <pad.h>
+
+
+struct PAD_POLYGON_FIXTURE
+{
+    PAD_POLYGON_FIXTURE() :
+            m_board(),
+            m_footprint( &m_board )
+    {
+    }
+
+    /**
+     * Set up \a aPad as a pad of shape \a aShape, at an odd position, with an offset.
+     */
+    void SetupPad( PAD& aPad, PAD_SHAPE aShape, const VECTOR2I& aPos, const EDA_ANGLE& aAngle )
+    {
+        const int mm = pcbIUScale.mmToIU( 1 );
+
+        aPad.SetAttribute( PAD_ATTRIB::SMD );
+        aPad.SetLayerSet( PAD::SMDMask() );
+        aPad.SetSize( VECTOR2I( 3 * mm / 2 + 1, mm + 3 ) );
+        aPad.SetOffset( VECTOR2I( mm / 7, -mm / 3 ) );
+        aPad.SetPosition( aPos );
+        aPad.SetOrientation( aAngle );
+
+        if( aShape == PAD_SHAPE::CUSTOM )
+        {
+            std::vector<VECTOR2I> triangle = { VECTOR2I( 0, 0 ), VECTOR2I( 2 * mm, mm / 3 ),
+                                               VECTOR2I( mm, 2 * mm + 7 ) };
+
+            aPad.SetShape( PAD_SHAPE::CUSTOM );
+            aPad.SetAnchorPadShape( PAD_SHAPE::CIRCLE );
+            aPad.AddPrimitivePoly( triangle, 0, true );
+        }
+        else
+        {
+            aPad.SetShape( aShape );
+            aPad.SetDelta( VECTOR2I( 0, mm / 5 ) );
+            aPad.SetRoundRectRadiusRatio( 0.2 );
+            aPad.SetChamferRectRatio( 0.15 );
+            aPad.SetChamferPositions( RECT_CHAMFER_TOP_LEFT | RECT_CHAMFER_BOTTOM_RIGHT );
+        }
+    }
+
+    BOARD     m_board;
+    FOOTPRINT m_footprint;
+};
+
+
+static void checkSameVertices( const SHAPE_POLY_SET& aActual, const SHAPE_POLY_SET& aExpected )
+{
+    BOOST_REQUIRE_EQUAL( aActual.OutlineCount(), aExpected.OutlineCount() );
+    BOOST_REQUIRE_EQUAL( aActual.TotalVertices(), aExpected.TotalVertices() );
+
+    for( int ii = 0; ii < aExpected.TotalVertices(); ++ii )
+        BOOST_CHECK( aActual.CVertex( ii ) == aExpected.CVertex( ii ) );
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( PadPolygon, PAD_POLYGON_FIXTURE )
+
+
+/**
+ * Pads of all the shapes, in several orientations and at several positions, must have the
+ * polygon they had when it was built in place.
+ */
+BOOST_AUTO_TEST_CASE( SameAsInPlace )
+{
+    const int maxError = m_board.GetDesignSettings().m_MaxError;
+
+    for( PAD_SHAPE shape : { PAD_SHAPE::CIRCLE, PAD_SHAPE::OVAL, PAD_SHAPE::RECT,
+                             PAD_SHAPE::TRAPEZOID, PAD_SHAPE::ROUNDRECT,
+                             PAD_SHAPE::CHAMFERED_RECT, PAD_SHAPE::CUSTOM } )
+    {
+        for( double degrees : { 0.0, 30.0, 90.0, 137.5, 270.0 } )
+        {
+            for( VECTOR2I pos : { VECTOR2I( 0, 0 ), VECTOR2I( 12345679, -9876541 ),
+                                  VECTOR2I( -1, 3 ) } )
+            {
+                BOOST_TEST_CONTEXT( PAD_SHAPE_T_asString( shape ) << " at " << degrees
+                                    << " deg, " << pos.x << ", " << pos.y )
+                {
+                    PAD pad( &m_footprint );
+                    SetupPad( pad, shape, pos, EDA_ANGLE( degrees, DEGREES_T ) );
+
+                    SHAPE_POLY_SET expected;
+                    pad.TransformShapeToPolygon( expected, UNDEFINED_LAYER, 0, maxError,
+                                                 ERROR_INSIDE );
+
+                    checkSameVertices( *pad.GetEffectivePolygon(), expected );
+
+                    BOOST_CHECK( pad.HitTest( pad.ShapePos() )
+                                 == expected.Contains( pad.ShapePos(), -1, 0 ) );
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * Moving, rotating and reshaping a pad must not leave it with the polygon of its old geometry.
+ */
+BOOST_AUTO_TEST_CASE( FollowsChanges )
+{
+    const int maxError = m_board.GetDesignSettings().m_MaxError;
+    const int mm = pcbIUScale.mmToIU( 1 );
+
+    PAD first( &m_footprint );
+    PAD second( &m_footprint );
+
+    SetupPad( first, PAD_SHAPE::ROUNDRECT, VECTOR2I( 0, 0 ), ANGLE_0 );
+    SetupPad( second, PAD_SHAPE::ROUNDRECT, VECTOR2I( 10 * mm, 0 ), ANGLE_0 );
+
+    // Both use the same polygon now
+    first.GetEffectivePolygon();
+    second.GetEffectivePolygon();
+
+    second.SetPosition( VECTOR2I( 20 * mm, 5 * mm ) );
+    second.SetOrientation( ANGLE_45 );
+    second.SetSize( VECTOR2I( 2 * mm, 2 * mm ) );
+
+    for( PAD* pad : { &first, &second } )
+    {
+        SHAPE_POLY_SET expected;
+        pad->TransformShapeToPolygon( expected, UNDEFINED_LAYER, 0, maxError, ERROR_INSIDE );
+
+        checkSameVertices( *pad->GetEffectivePolygon(), expected );
+    }
+
+    BOOST_CHECK( second.HitTest( VECTOR2I( 20 * mm, 5 * mm ) ) );
+    BOOST_CHECK( !second.HitTest( VECTOR2I( 0, 0 ) ) );
+    BOOST_CHECK( first.HitTest( VECTOR2I( 0, 0 ) ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
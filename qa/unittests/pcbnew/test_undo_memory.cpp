@@ -0,0 +1,185 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the memory accounting of the board items stored in the undo and redo lists,
+ * and for the trimming of the lists when they use too much memory
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <board.h>
+#include <pcb_base_edit_frame.h>
+#include <pcb_track.h>
+#include <undo_redo_container.h>
+#include <zone.h>
+
+
+struct UNDO_MEMORY_FIXTURE
+{
+    UNDO_MEMORY_FIXTURE() :
+            m_board()
+    {
+    }
+
+    ~UNDO_MEMORY_FIXTURE()
+    {
+        for( PICKED_ITEMS_LIST* command : m_list.m_CommandsList )
+        {
+            command->ClearListAndDeleteItems( []( EDA_ITEM* aItem )
+                                              {
+                                                  delete aItem;
+                                              } );
+        }
+    }
+
+    /**
+     * Push a command owning \a aTrackCount deleted tracks to the list.
+     */
+    void PushCommand( int aTrackCount )
+    {
+        PICKED_ITEMS_LIST* command = new PICKED_ITEMS_LIST();
+
+        for( int ii = 0; ii < aTrackCount; ++ii )
+        {
+            command->PushItem( ITEM_PICKER( nullptr, new PCB_TRACK( &m_board ),
+                                            UNDO_REDO::DELETED ) );
+        }
+
+        m_list.PushCommand( command );
+    }
+
+    BOARD               m_board;
+    UNDO_REDO_CONTAINER m_list;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( UndoMemory, UNDO_MEMORY_FIXTURE )
+
+
+/**
+ * Copies of a zone share its fill, so they only account for their part of it.
+ */
+BOOST_AUTO_TEST_CASE( SharedZoneFill )
+{
+    const int mm = pcbIUScale.mmToIU( 1 );
+
+    ZONE zone( &m_board );
+    zone.SetLayer( F_Cu );
+    zone.Outline()->NewOutline();
+    zone.Outline()->Append( 0, 0 );
+    zone.Outline()->Append( 50 * mm, 0 );
+    zone.Outline()->Append( 50 * mm, 50 * mm );
+    zone.Outline()->Append( 0, 50 * mm );
+
+    SHAPE_POLY_SET fill;
+
+    for( int ii = 0; ii < 100; ++ii )
+    {
+        fill.NewOutline();
+        fill.Append( ii * mm / 2, 0 );
+        fill.Append( ii * mm / 2 + mm / 4, 0 );
+        fill.Append( ii * mm / 2 + mm / 4, 50 * mm );
+        fill.Append( ii * mm / 2, 50 * mm );
+    }
+
+    zone.SetFilledPolysList( F_Cu, fill );
+
+    const size_t alone = PCB_BASE_EDIT_FRAME::GetBoardItemMemoryUsage( &zone );
+
+    BOOST_CHECK_GT( alone, sizeof( ZONE ) + 400 * sizeof( VECTOR2I ) );
+
+    std::unique_ptr<ZONE> copy( static_cast<ZONE*>( zone.Clone() ) );
+
+    const size_t shared = PCB_BASE_EDIT_FRAME::GetBoardItemMemoryUsage( &zone );
+
+    BOOST_CHECK_LT( shared, alone );
+    BOOST_CHECK_EQUAL( PCB_BASE_EDIT_FRAME::GetBoardItemMemoryUsage( copy.get() ), shared );
+
+    // Once modified, the copy has its own fill
+    copy->Move( VECTOR2I( mm, 0 ) );
+
+    BOOST_CHECK_EQUAL( PCB_BASE_EDIT_FRAME::GetBoardItemMemoryUsage( &zone ), alone );
+    BOOST_CHECK_EQUAL( PCB_BASE_EDIT_FRAME::GetBoardItemMemoryUsage( copy.get() ), alone );
+}
+
+
+/**
+ * Only the items owned by the commands are accounted for.
+ */
+BOOST_AUTO_TEST_CASE( OwnedItems )
+{
+    PCB_TRACK          track( &m_board );
+    PICKED_ITEMS_LIST* command = new PICKED_ITEMS_LIST();
+
+    command->PushItem( ITEM_PICKER( nullptr, &track, UNDO_REDO::CHANGED ) );
+    m_list.PushCommand( command );
+
+    const size_t empty = m_list.GetMemoryUsage( []( const EDA_ITEM* )
+                                                {
+                                                    return 1000;
+                                                } );
+
+    BOOST_CHECK_LT( empty, size_t( 1000 ) );
+
+    command->ClearItemsList();
+    PushCommand( 2 );
+
+    BOOST_CHECK_GE( m_list.GetMemoryUsage( PCB_BASE_EDIT_FRAME::GetBoardItemMemoryUsage ),
+                    2 * sizeof( PCB_TRACK ) );
+}
+
+
+/**
+ * The oldest commands are trimmed until the list fits in the memory limit, but the last
+ * command is always kept.
+ */
+BOOST_AUTO_TEST_CASE( TrimOldestCommands )
+{
+    auto itemSize =
+            []( const EDA_ITEM* )
+            {
+                return 1000;
+            };
+
+    PushCommand( 1 );
+    PushCommand( 2 );
+    PushCommand( 3 );
+
+    const size_t first = m_list.m_CommandsList[0]->GetMemoryUsage( itemSize );
+    const size_t second = m_list.m_CommandsList[1]->GetMemoryUsage( itemSize );
+    const size_t total = m_list.GetMemoryUsage( itemSize );
+
+    BOOST_CHECK_EQUAL( m_list.GetCommandCountOverMemory( total, itemSize ), 0 );
+    BOOST_CHECK_EQUAL( m_list.GetCommandCountOverMemory( total - 1, itemSize ), 1 );
+    BOOST_CHECK_EQUAL( m_list.GetCommandCountOverMemory( total - first, itemSize ), 1 );
+    BOOST_CHECK_EQUAL( m_list.GetCommandCountOverMemory( total - first - 1, itemSize ), 2 );
+    BOOST_CHECK_EQUAL( m_list.GetCommandCountOverMemory( total - first - second, itemSize ), 2 );
+
+    // The last command is kept even when it alone is over the limit
+    BOOST_CHECK_EQUAL( m_list.GetCommandCountOverMemory( 1, itemSize ), 2 );
+    BOOST_CHECK_EQUAL( m_list.GetCommandCountOverMemory( 0, itemSize ), 2 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
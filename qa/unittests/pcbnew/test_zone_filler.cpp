@@ -233,3 +233,42 @@ BOOST_FIXTURE_TEST_CASE( RegressionZoneFillTests, ZONE_FILL_TEST_FIXTURE )
     }
 }
 
+
+
+BOOST_FIXTURE_TEST_CASE( SharedZoneFills, ZONE_FILL_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, "notched_zones", m_board );
+
+    KI_TEST::FillZones( m_board.get() );
+
+    for( ZONE* zone : m_board->Zones() )
+    {
+        if( !zone->GetLayerSet().Contains( F_Cu ) )
+            continue;
+
+        // Copies (such as the ones stored in the undo list) share the filled polygons...
+        std::unique_ptr<ZONE> copy( static_cast<ZONE*>( zone->Clone() ) );
+
+        BOOST_CHECK( copy->GetFilledPolysList( F_Cu ) == zone->GetFilledPolysList( F_Cu ) );
+
+        // ... until one of them is modified
+        SHAPE_POLY_SET original = zone->GetFilledPolysList( F_Cu )->CloneDropTriangulation();
+        VECTOR2I       offset( pcbIUScale.mmToIU( 1 ), 0 );
+
+        copy->Move( offset );
+
+        BOOST_CHECK( copy->GetFilledPolysList( F_Cu ) != zone->GetFilledPolysList( F_Cu ) );
+        BOOST_CHECK_EQUAL( zone->GetFilledPolysList( F_Cu )->BBox().GetOrigin(),
+                           original.BBox().GetOrigin() );
+        BOOST_CHECK_EQUAL( copy->GetFilledPolysList( F_Cu )->BBox().GetOrigin(),
+                           original.BBox().GetOrigin() + offset );
+
+        // Unfilling must not clear the copy
+        copy.reset( static_cast<ZONE*>( zone->Clone() ) );
+        zone->UnFill();
+
+        BOOST_CHECK( zone->GetFilledPolysList( F_Cu )->IsEmpty() );
+        BOOST_CHECK_EQUAL( copy->GetFilledPolysList( F_Cu )->OutlineCount(),
+                           original.OutlineCount() );
+    }
+}
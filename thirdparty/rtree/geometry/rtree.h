@@ -212,6 +212,12 @@ public:
     /// Remove all entries from tree
     void    RemoveAll();
 
+    /// Replace the content of the tree by the given entries, packing them with the
+    /// Sort-Tile-Recursive algorithm.  Much faster than inserting the entries one by one, and
+    /// gives fully loaded nodes with little overlap.  The entries are reordered.
+    /// \param a_entries Bounding rects and data of the entries
+    void    BulkLoad( std::vector<std::pair<Rect, DATATYPE>>& a_entries );
+
     /// Count the data elements in this container.  This is slow as no internal counter is maintained.
     int     Count() const;
 
@@ -605,6 +611,8 @@ protected:
 
     void    RemoveAllRec( Node* a_node ) const;
     void    Reset() const;
+    void    TileBranches( typename std::vector<Branch>::iterator a_begin,
+                          typename std::vector<Branch>::iterator a_end, int a_axis ) const;
     void    CountRec( const Node* a_node, int& a_count ) const;
 
     bool    SaveRec( const Node* a_node, RTFileStream& a_stream ) const;
@@ -1126,6 +1134,85 @@ void RTREE_QUAL::RemoveAll()
 }
 
 
+RTREE_TEMPLATE
+void RTREE_QUAL::BulkLoad( std::vector<std::pair<Rect, DATATYPE>>& a_entries )
+{
+    // Delete all existing nodes
+    Reset();
+
+    std::vector<Branch> branches( a_entries.size() );
+
+    for( size_t index = 0; index < a_entries.size(); ++index )
+    {
+        branches[index].m_rect = a_entries[index].first;
+        branches[index].m_data = a_entries[index].second;
+    }
+
+    // Pack each level in full nodes, bottom-up, until the remaining branches fit in the root
+    int level = 0;
+
+    while( branches.size() > (size_t) MAXNODES )
+    {
+        TileBranches( branches.begin(), branches.end(), 0 );
+
+        std::vector<Branch> parents;
+        parents.reserve( ( branches.size() + MAXNODES - 1 ) / MAXNODES );
+
+        for( size_t first = 0; first < branches.size(); first += MAXNODES )
+        {
+            size_t last = std::min( first + MAXNODES, branches.size() );
+            Node*  node = AllocNode();
+
+            node->m_level = level;
+
+            for( size_t index = first; index < last; ++index )
+                node->m_branch[node->m_count++] = branches[index];
+
+            Branch parent;
+            parent.m_rect = NodeCover( node );
+            parent.m_child = node;
+            parents.push_back( parent );
+        }
+
+        branches.swap( parents );
+        level++;
+    }
+
+    m_root = AllocNode();
+    m_root->m_level = level;
+
+    for( const Branch& branch : branches )
+        m_root->m_branch[m_root->m_count++] = branch;
+}
+
+
+// Sort the branches so that each run of MAXNODES consecutive ones is a tile of nearby branches:
+// the range is sorted along a_axis and cut in slabs, each slab being tiled along the next axis.
+RTREE_TEMPLATE
+void RTREE_QUAL::TileBranches( typename std::vector<Branch>::iterator a_begin,
+                               typename std::vector<Branch>::iterator a_end, int a_axis ) const
+{
+    std::sort( a_begin, a_end,
+               [a_axis]( const Branch& a_a, const Branch& a_b )
+               {
+                   return (ELEMTYPEREAL) a_a.m_rect.m_min[a_axis] + a_a.m_rect.m_max[a_axis]
+                          < (ELEMTYPEREAL) a_b.m_rect.m_min[a_axis] + a_b.m_rect.m_max[a_axis];
+               } );
+
+    if( a_axis == NUMDIMS - 1 )
+        return;
+
+    size_t count = a_end - a_begin;
+    size_t nodeCount = ( count + MAXNODES - 1 ) / MAXNODES;
+    size_t slabCount = (size_t) std::ceil( std::pow( (double) nodeCount,
+                                                     1.0 / ( NUMDIMS - a_axis ) ) );
+    size_t slabSize = MAXNODES * ( ( nodeCount + slabCount - 1 ) / slabCount );
+
+    for( size_t first = 0; first < count; first += slabSize )
+        TileBranches( a_begin + first, a_begin + std::min( first + slabSize, count ), a_axis + 1 );
+}
+
+
 RTREE_TEMPLATE
 void RTREE_QUAL::Reset() const
 {